@@ -95,6 +95,22 @@ endif
 # 'y' to set the Alignment Check Enable bit in SCTLR/SCTLR_EL1, 'n' to clear it
 CFG_SCTLR_ALIGNMENT_CHECK ?= n
 
+# Sampling profiler for the TEE core. When enabled, the secure physical
+# timer interrupt CFG_CORE_PROF_TIMER_IT (a PPI, which must not be used by
+# the platform for anything else) samples the interrupted PC and call stack
+# of each CPU into a per-CPU histogram of CFG_CORE_PROF_NUM_STACKS (a power
+# of two) unique stacks of at most CFG_CORE_PROF_MAX_DEPTH frames. The
+# core_prof pseudo TA starts and stops sampling and exports the histograms
+# as collapsed stacks, see scripts/symbolize_prof.py.
+CFG_CORE_PROF_SAMPLING ?= n
+CFG_CORE_PROF_TIMER_IT ?= 29
+CFG_CORE_PROF_NUM_STACKS ?= 128
+CFG_CORE_PROF_MAX_DEPTH ?= 8
+$(eval $(call cfg-depends-all,CFG_CORE_PROF_SAMPLING,CFG_ARM64_core CFG_UNWIND CFG_CORE_HAS_GENERIC_TIMER))
+ifeq (y-y,$(CFG_CORE_PROF_SAMPLING)-$(CFG_TIMER_WHEEL))
+$(error CFG_CORE_PROF_SAMPLING and CFG_TIMER_WHEEL both use the secure physical timer)
+endif
+
 ifeq ($(CFG_CORE_LARGE_PHYS_ADDR),y)
 $(call force,CFG_WITH_LPAE,y)
 endif
@@ -39,6 +39,14 @@ static inline uint64_t arm_cnt_us2cnt(uint32_t us)
 	return ((uint64_t)us * (uint64_t)read_cntfrq()) / 1000000ULL;
 }
 
+/* Converts a number of counter ticks, as a duration, to microseconds */
+static inline uint64_t timer_cnt2us(uint64_t cnt)
+{
+	uint64_t freq = read_cntfrq();
+
+	return (cnt / freq) * 1000000ULL + ((cnt % freq) * 1000000ULL) / freq;
+}
+
 static inline uint64_t timeout_init_us(uint32_t us)
 {
 	return barrier_read_counter_timer() + arm_cnt_us2cnt(us);
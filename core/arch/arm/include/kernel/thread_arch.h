@@ -390,6 +390,14 @@ static inline void thread_user_clear_vfp(struct user_mode_ctx *uctx __unused)
 }
 #endif
 
+/*
+ * thread_user_clear_vfp_state() - Clears the vfp state
+ * @uvfp:	pointer to the saved state to clear
+ */
+#ifdef CFG_WITH_VFP
+void thread_user_clear_vfp_state(struct thread_user_vfp_state *uvfp);
+#endif
+
 #ifdef ARM64
 /*
  * thread_get_saved_thread_sp() - Returns the saved sp of current thread
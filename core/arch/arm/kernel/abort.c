@@ -395,6 +395,12 @@ static void handle_user_mode_vfp(void)
 {
 	struct ts_session *s = ts_get_current_session();
 
+#ifdef CFG_TA_CONCURRENT
+	if (s->umt) {
+		thread_user_enable_vfp(&s->umt->vfp);
+		return;
+	}
+#endif
 	thread_user_enable_vfp(&to_user_mode_ctx(s->ctx)->vfp);
 }
 #endif /*CFG_WITH_VFP*/
@@ -0,0 +1,379 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#include <arm.h>
+#include <atomic.h>
+#include <keep.h>
+#include <kernel/core_prof.h>
+#include <kernel/interrupt.h>
+#include <kernel/linker.h>
+#include <kernel/misc.h>
+#include <kernel/mutex.h>
+#include <kernel/thread.h>
+#include <kernel/thread_private.h>
+#include <printk.h>
+#include <string.h>
+#include <trace.h>
+#include <unw/unwind.h>
+#include <util.h>
+
+#define PROF_NUM_STACKS		CFG_CORE_PROF_NUM_STACKS
+#define PROF_MAX_DEPTH		CFG_CORE_PROF_MAX_DEPTH
+
+static_assert(IS_POWER_OF_TWO(PROF_NUM_STACKS));
+static_assert(PROF_MAX_DEPTH > 0);
+
+/*
+ * Pseudo program counters for samples taken outside the TEE core, they
+ * can't collide with core addresses.
+ */
+#define PROF_PC_NORMAL_WORLD	0
+#define PROF_PC_USER		1
+
+/*
+ * struct prof_stack - Histogram entry
+ * @count:	Number of samples with this stack, 0 if the entry is free
+ * @depth:	Number of valid entries in @pc
+ * @pc:		Sampled PC followed by the return addresses of the callers
+ */
+struct prof_stack {
+	uint32_t count;
+	uint32_t depth;
+	vaddr_t pc[PROF_MAX_DEPTH];
+};
+
+/*
+ * struct prof_cpu - Per-CPU sampling state, only updated by the owning
+ * CPU while sampling
+ * @armed_gen:	Value of prof_gen when the timer of this CPU was armed
+ * @samples:	Number of samples taken
+ * @lost:	Number of samples which didn't fit in @stacks
+ * @stacks:	Histogram, open addressing hash table of unique stacks
+ */
+struct prof_cpu {
+	unsigned int armed_gen;
+	uint32_t samples;
+	uint32_t lost;
+	struct prof_stack stacks[PROF_NUM_STACKS];
+};
+
+static struct prof_cpu prof_cpus[CFG_TEE_CORE_NB_CORE] __nex_bss;
+static uint32_t prof_ticks __nex_bss;
+static unsigned int prof_gen __nex_bss;
+static unsigned int prof_running __nex_bss;
+static bool prof_itr_added __nex_bss;
+static struct mutex prof_mu __nex_data = MUTEX_INITIALIZER;
+
+static bool is_from_user(uint64_t spsr)
+{
+	if (spsr & (SPSR_MODE_RW_32 << SPSR_MODE_RW_SHIFT))
+		return true;
+	if (((spsr >> SPSR_64_MODE_EL_SHIFT) & SPSR_64_MODE_EL_MASK) ==
+	     SPSR_64_MODE_EL0)
+		return true;
+	return false;
+}
+
+static void arm_timer(void)
+{
+	write_cntps_tval(prof_ticks);
+	write_cntps_ctl(1);
+}
+
+static size_t stack_hash(const vaddr_t *pc, size_t depth)
+{
+	uint32_t h = 2166136261;	/* FNV-1a */
+	size_t n = 0;
+
+	for (n = 0; n < depth; n++) {
+		h ^= (uint32_t)pc[n];
+		h *= 16777619;
+	}
+
+	return h;
+}
+
+static void account_stack(struct prof_cpu *cpu, const vaddr_t *pc,
+			  size_t depth)
+{
+	size_t idx = stack_hash(pc, depth) & (PROF_NUM_STACKS - 1);
+	struct prof_stack *s = NULL;
+	size_t n = 0;
+
+	for (n = 0; n < PROF_NUM_STACKS; n++) {
+		s = cpu->stacks + idx;
+		if (!s->count) {
+			s->depth = depth;
+			memcpy(s->pc, pc, depth * sizeof(*pc));
+			s->count = 1;
+			return;
+		}
+		if (s->depth == depth &&
+		    !memcmp(s->pc, pc, depth * sizeof(*pc))) {
+			s->count++;
+			return;
+		}
+		idx = (idx + 1) & (PROF_NUM_STACKS - 1);
+	}
+
+	cpu->lost++;
+}
+
+/*
+ * The interrupt handler runs on the temporary stack and the entry code
+ * doesn't save x29. The outermost frame record on the temporary stack
+ * therefore holds the frame pointer of the interrupted code.
+ */
+static vaddr_t get_interrupted_fp(struct thread_core_local *l)
+{
+	vaddr_t end = l->tmp_stack_va_end;
+	vaddr_t start = end - STACK_TMP_SIZE;
+	vaddr_t fp = read_fp();
+
+	while (fp >= start && fp < end)
+		fp = *(vaddr_t *)fp;
+
+	return fp;
+}
+
+static void take_sample(struct prof_cpu *cpu)
+{
+	struct thread_core_local *l = thread_get_core_local();
+	struct unwind_state_arm64 state = { };
+	vaddr_t pc[PROF_MAX_DEPTH] = { };
+	vaddr_t stack_end = 0;
+	size_t depth = 1;
+
+	cpu->samples++;
+
+	/*
+	 * Without the IRQ or FIQ flag set we've been entered via the
+	 * secure monitor, that is, the normal world was interrupted.
+	 */
+	if (!(l->flags & (THREAD_CLF_IRQ | THREAD_CLF_FIQ))) {
+		pc[0] = PROF_PC_NORMAL_WORLD;
+		goto out;
+	}
+
+	if (is_from_user(read_spsr_el1())) {
+		pc[0] = PROF_PC_USER;
+		goto out;
+	}
+
+	state.pc = read_elr_el1();
+	pc[0] = state.pc;
+
+	/*
+	 * Only unwind when a thread was interrupted, the temporary and
+	 * abort stacks are normally used with foreign and native interrupts
+	 * masked.
+	 */
+	if ((l->flags >> THREAD_CLF_SAVED_SHIFT) & THREAD_CLF_MASK)
+		goto out;
+	if (l->curr_thread < 0 || l->curr_thread >= CFG_NUM_THREADS)
+		goto out;
+
+	stack_end = threads[l->curr_thread].stack_va_end;
+	state.fp = get_interrupted_fp(l);
+	while (depth < PROF_MAX_DEPTH &&
+	       unwind_stack_arm64(&state, stack_end - STACK_THREAD_SIZE,
+				  STACK_THREAD_SIZE))
+		pc[depth++] = state.pc;
+out:
+	account_stack(cpu, pc, depth);
+}
+
+static enum itr_return prof_itr_cb(struct itr_handler *h __unused)
+{
+	struct prof_cpu *cpu = prof_cpus + get_core_pos();
+
+	write_cntps_ctl(0);
+
+	/* Leave the timer disabled if sampling was stopped or restarted */
+	if (!atomic_load_uint(&prof_running) ||
+	    cpu->armed_gen != atomic_load_uint(&prof_gen))
+		return ITRR_HANDLED;
+
+	take_sample(cpu);
+	arm_timer();
+
+	return ITRR_HANDLED;
+}
+DECLARE_KEEP_PAGER(prof_itr_cb);
+
+static struct itr_handler prof_itr __nex_data = {
+	.it = CFG_CORE_PROF_TIMER_IT,
+	.flags = ITRF_TRIGGER_LEVEL,
+	.handler = prof_itr_cb,
+};
+DECLARE_KEEP_PAGER(prof_itr);
+
+void core_prof_cpu_arm(void)
+{
+	uint32_t exceptions = 0;
+	struct prof_cpu *cpu = NULL;
+	unsigned int gen = 0;
+
+	if (!atomic_load_uint(&prof_running))
+		return;
+
+	exceptions = thread_mask_exceptions(THREAD_EXCP_ALL);
+	cpu = prof_cpus + get_core_pos();
+	gen = atomic_load_uint(&prof_gen);
+	if (cpu->armed_gen != gen) {
+		cpu->armed_gen = gen;
+		/* The timer interrupt is a PPI, enable it on this CPU */
+		interrupt_enable(prof_itr.chip, prof_itr.it);
+		arm_timer();
+	}
+	thread_unmask_exceptions(exceptions);
+}
+
+TEE_Result core_prof_start(uint32_t period_us)
+{
+	TEE_Result res = TEE_SUCCESS;
+	uint64_t ticks = 0;
+	size_t n = 0;
+
+	if (!period_us)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	ticks = ((uint64_t)read_cntfrq() * period_us) / 1000000;
+	if (ticks > UINT32_MAX)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	mutex_lock(&prof_mu);
+
+	if (prof_running) {
+		res = TEE_ERROR_BAD_STATE;
+		goto out;
+	}
+
+	if (!prof_itr_added) {
+		res = interrupt_add_handler_with_chip(interrupt_get_main_chip(),
+						      &prof_itr);
+		if (res)
+			goto out;
+		prof_itr_added = true;
+	}
+
+	for (n = 0; n < ARRAY_SIZE(prof_cpus); n++) {
+		prof_cpus[n].samples = 0;
+		prof_cpus[n].lost = 0;
+		memset(prof_cpus[n].stacks, 0, sizeof(prof_cpus[n].stacks));
+	}
+
+	prof_ticks = MAX(ticks, 1ULL);
+	atomic_store_uint(&prof_gen, prof_gen + 1);
+	atomic_store_uint(&prof_running, 1);
+
+	DMSG("Sampling every %"PRIu32" us", period_us);
+out:
+	mutex_unlock(&prof_mu);
+
+	if (!res)
+		core_prof_cpu_arm();
+
+	return res;
+}
+
+void core_prof_stop(void)
+{
+	uint32_t exceptions = 0;
+
+	mutex_lock(&prof_mu);
+
+	/* Each CPU disables its timer on the next tick */
+	atomic_store_uint(&prof_running, 0);
+
+	exceptions = thread_mask_exceptions(THREAD_EXCP_ALL);
+	write_cntps_ctl(0);
+	thread_unmask_exceptions(exceptions);
+
+	mutex_unlock(&prof_mu);
+}
+
+static int format_stack(char *buf, size_t len, const struct prof_stack *s)
+{
+	size_t pos = 0;
+	size_t n = 0;
+	int l = 0;
+
+	/* Collapsed stacks are printed outermost frame first */
+	for (n = s->depth; n > 0; n--) {
+		vaddr_t pc = s->pc[n - 1];
+		const char *sep = n == s->depth ? "" : ";";
+
+		if (pc == PROF_PC_NORMAL_WORLD)
+			l = snprintk(buf + pos, len - pos, "%s[normal_world]",
+				     sep);
+		else if (pc == PROF_PC_USER)
+			l = snprintk(buf + pos, len - pos, "%s[user]", sep);
+		else
+			l = snprintk(buf + pos, len - pos, "%s%#"PRIxVA, sep,
+				     pc - VCORE_START_VA);
+		if (l < 0 || (size_t)l >= len - pos)
+			return -1;
+		pos += l;
+	}
+
+	l = snprintk(buf + pos, len - pos, " %"PRIu32"\n", s->count);
+	if (l < 0 || (size_t)l >= len - pos)
+		return -1;
+
+	return pos + l;
+}
+
+TEE_Result core_prof_export(uint32_t *cursor, char *buf, size_t *len,
+			    uint32_t *samples, uint32_t *lost)
+{
+	const size_t max_pos = ARRAY_SIZE(prof_cpus) * PROF_NUM_STACKS;
+	TEE_Result res = TEE_SUCCESS;
+	struct prof_stack *s = NULL;
+	size_t pos = *cursor;
+	size_t offs = 0;
+	size_t n = 0;
+	int l = 0;
+
+	if (pos >= max_pos)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	mutex_lock(&prof_mu);
+
+	if (prof_running) {
+		res = TEE_ERROR_BAD_STATE;
+		goto out;
+	}
+
+	for (; pos < max_pos; pos++) {
+		s = prof_cpus[pos / PROF_NUM_STACKS].stacks +
+		    pos % PROF_NUM_STACKS;
+		if (!s->count)
+			continue;
+		l = format_stack(buf + offs, *len - offs, s);
+		if (l < 0)
+			break;
+		offs += l;
+	}
+
+	if (pos < max_pos && !offs) {
+		res = TEE_ERROR_SHORT_BUFFER;
+		goto out;
+	}
+
+	*samples = 0;
+	*lost = 0;
+	for (n = 0; n < ARRAY_SIZE(prof_cpus); n++) {
+		*samples += prof_cpus[n].samples;
+		*lost += prof_cpus[n].lost;
+	}
+
+	*cursor = pos < max_pos ? pos : 0;
+	*len = offs;
+out:
+	mutex_unlock(&prof_mu);
+
+	return res;
+}
@@ -2,7 +2,12 @@ srcs-y += rpc_io_i2c.c
 srcs-y += idle.c
 
 srcs-$(CFG_SECURE_TIME_SOURCE_CNTPCT) += tee_time_arm_cntpct.c
+ifeq ($(CFG_TIMER_WHEEL),y)
+srcs-y += timer_wheel.c
+else
 srcs-$(CFG_ARM64_core) += timer_a64.c
+endif
+srcs-$(CFG_CORE_PROF_SAMPLING) += core_prof.c
 
 srcs-$(CFG_ARM32_core) += spin_lock_a32.S
 srcs-$(CFG_ARM64_core) += spin_lock_a64.S
@@ -14,6 +14,7 @@
 #include <keep.h>
 #include <kernel/asan.h>
 #include <kernel/boot.h>
+#include <kernel/evtrace.h>
 #include <kernel/interrupt.h>
 #include <kernel/linker.h>
 #include <kernel/lockdep.h>
@@ -251,8 +252,12 @@ static void __thread_alloc_and_run(uint32_t a0, uint32_t a1, uint32_t a2,
 
 	thread_unlock_global();
 
-	if (!found_thread)
+	if (!found_thread) {
+		evtrace_record(PTA_EVTRACE_ID_THREAD_ALLOC, -1, flags);
 		return;
+	}
+
+	evtrace_record(PTA_EVTRACE_ID_THREAD_ALLOC, n, flags);
 
 	l->curr_thread = n;
 
@@ -939,9 +944,8 @@ void thread_user_save_vfp(void)
 	tuv->lazy_saved = true;
 }
 
-void thread_user_clear_vfp(struct user_mode_ctx *uctx)
+void thread_user_clear_vfp_state(struct thread_user_vfp_state *uvfp)
 {
-	struct thread_user_vfp_state *uvfp = &uctx->vfp;
 	struct thread_ctx *thr = threads + thread_get_id();
 
 	if (uvfp == thr->vfp_state.uvfp)
@@ -949,6 +953,11 @@ void thread_user_clear_vfp(struct user_mode_ctx *uctx)
 	uvfp->lazy_saved = false;
 	uvfp->saved = false;
 }
+
+void thread_user_clear_vfp(struct user_mode_ctx *uctx)
+{
+	thread_user_clear_vfp_state(&uctx->vfp);
+}
 #endif /*CFG_WITH_VFP*/
 
 #ifdef ARM32
@@ -7,6 +7,8 @@
 #include <compiler.h>
 #include <config.h>
 #include <io.h>
+#include <kernel/core_prof.h>
+#include <kernel/evtrace.h>
 #include <kernel/misc.h>
 #include <kernel/msg_param.h>
 #include <kernel/notif.h>
@@ -58,6 +60,9 @@ uint32_t thread_handle_std_smc(uint32_t a0, uint32_t a1, uint32_t a2,
 
 	thread_check_canaries();
 
+	evtrace_record(PTA_EVTRACE_ID_STD_SMC, a0, a1);
+	core_prof_cpu_arm();
+
 	if (IS_ENABLED(CFG_NS_VIRTUALIZATION) && virt_set_guest(a7))
 		return OPTEE_SMC_RETURN_ENOTAVAIL;
 
@@ -614,10 +619,16 @@ uint32_t thread_rpc_cmd(uint32_t cmd, size_t num_params,
 	if (ret)
 		return ret;
 
+	evtrace_record(PTA_EVTRACE_ID_RPC_ENTER, cmd, num_params);
+
 	reg_pair_from_64(carg, rpc_args + 1, rpc_args + 2);
 	thread_rpc(rpc_args);
 
-	return get_rpc_arg_res(arg, num_params, params);
+	ret = get_rpc_arg_res(arg, num_params, params);
+
+	evtrace_record(PTA_EVTRACE_ID_RPC_EXIT, cmd, ret);
+
+	return ret;
 }
 
 /*
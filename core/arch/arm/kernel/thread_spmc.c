@@ -8,6 +8,7 @@
 #include <ffa.h>
 #include <initcall.h>
 #include <io.h>
+#include <kernel/evtrace.h>
 #include <kernel/interrupt.h>
 #include <kernel/panic.h>
 #include <kernel/secure_partition.h>
@@ -1565,9 +1566,15 @@ uint32_t thread_rpc_cmd(uint32_t cmd, size_t num_params,
 	if (ret)
 		return ret;
 
+	evtrace_record(PTA_EVTRACE_ID_RPC_ENTER, cmd, num_params);
+
 	thread_rpc(&rpc_arg);
 
-	return get_rpc_arg_res(arg, num_params, params);
+	ret = get_rpc_arg_res(arg, num_params, params);
+
+	evtrace_record(PTA_EVTRACE_ID_RPC_EXIT, cmd, ret);
+
+	return ret;
 }
 
 uint32_t thread_rpc_ocall2_cmd(uint32_t param[2] __unused)
@@ -0,0 +1,220 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#include <arm.h>
+#include <assert.h>
+#include <kernel/misc.h>
+#include <kernel/panic.h>
+#include <kernel/spinlock.h>
+#include <kernel/timer_wheel.h>
+#include <trace.h>
+#include <util.h>
+
+/*
+ * A pending timer is in the slot indexed by its expiry tick modulo
+ * TIMER_WHEEL_SLOTS. Each tick, the slots of the ticks elapsed since the
+ * previous one are checked for expired timers. Timers expiring more than
+ * a turn of the wheel later are skipped until their turn comes.
+ *
+ * The ticks are counted with the system counter so a late timer
+ * interrupt doesn't delay the timers expiring after it.
+ *
+ * The secure physical timer and its interrupt are private to each CPU.
+ * The wheel is driven by the timer of the CPU starting the first timer,
+ * with the interrupt enabled on that CPU, until no timer is pending. The
+ * timers started meanwhile on other CPUs are only added to the wheel.
+ */
+#define TIMER_WHEEL_SLOTS	64
+
+static_assert(IS_POWER_OF_TWO(TIMER_WHEEL_SLOTS));
+
+TAILQ_HEAD(tw_timer_head, tw_timer);
+
+/* Protects the timers and the fields below */
+static unsigned int tw_lock = SPINLOCK_UNLOCK;
+static struct tw_timer_head tw_slots[TIMER_WHEEL_SLOTS];
+/* Expired timers waiting for their callback to be called */
+static struct tw_timer_head tw_expired = TAILQ_HEAD_INITIALIZER(tw_expired);
+static struct itr_chip *tw_chip;
+static size_t tw_itr_num;
+static uint64_t tw_cnt_per_tick;
+static uint64_t tw_last_tick;
+static size_t tw_count;
+static size_t tw_core;
+static bool tw_ticking;
+
+static uint64_t get_tick(void)
+{
+	return barrier_read_counter_timer() / tw_cnt_per_tick;
+}
+
+static uint32_t ms_to_ticks(uint32_t ms)
+{
+	return DIV_ROUND_UP(ms, CFG_TIMER_WHEEL_TICK_MS);
+}
+
+static struct tw_timer_head *get_head(struct tw_timer *t)
+{
+	if (t->expires <= tw_last_tick)
+		return &tw_expired;
+
+	return tw_slots + (t->expires & (TIMER_WHEEL_SLOTS - 1));
+}
+
+/* Arms the timer of the current CPU to interrupt at the next tick */
+static void arm_tick(void)
+{
+	write_cntps_ctl(0);
+	write_cntps_tval(tw_cnt_per_tick);
+	write_cntps_ctl(1);
+}
+
+/* Called with tw_lock held */
+static void add_timer(struct tw_timer *t, uint64_t expires)
+{
+	if (!tw_ticking) {
+		tw_last_tick = get_tick();
+		tw_core = get_core_pos();
+		/* The interrupt of the timer is banked per CPU */
+		interrupt_enable(tw_chip, tw_itr_num);
+		arm_tick();
+		tw_ticking = true;
+	}
+
+	expires = MAX(expires, tw_last_tick + 1);
+	if (t->slack > 1)
+		expires = DIV_ROUND_UP(expires, t->slack) * t->slack;
+
+	t->expires = expires;
+	t->pending = true;
+	TAILQ_INSERT_TAIL(get_head(t), t, link);
+	tw_count++;
+}
+
+/* Called with tw_lock held */
+static void remove_timer(struct tw_timer *t)
+{
+	TAILQ_REMOVE(get_head(t), t, link);
+	t->pending = false;
+	tw_count--;
+}
+
+void tw_timer_start(struct tw_timer *t, uint32_t delay_ms, uint32_t period_ms,
+		    uint32_t slack_ms)
+{
+	uint32_t exceptions = 0;
+
+	assert(t && t->fn && tw_cnt_per_tick);
+
+	exceptions = cpu_spin_lock_xsave(&tw_lock);
+
+	if (t->pending)
+		remove_timer(t);
+	t->period = ms_to_ticks(period_ms);
+	t->slack = ms_to_ticks(slack_ms);
+	add_timer(t, get_tick() + MAX(ms_to_ticks(delay_ms), 1U));
+
+	cpu_spin_unlock_xrestore(&tw_lock, exceptions);
+}
+
+void tw_timer_stop(struct tw_timer *t)
+{
+	uint32_t exceptions = cpu_spin_lock_xsave(&tw_lock);
+
+	if (t->pending)
+		remove_timer(t);
+
+	cpu_spin_unlock_xrestore(&tw_lock, exceptions);
+}
+
+/* Called with tw_lock held */
+static void expire_timers(uint64_t now)
+{
+	struct tw_timer_head *slot = NULL;
+	struct tw_timer *next = NULL;
+	struct tw_timer *t = NULL;
+	uint64_t tick = 0;
+
+	/* A turn of the wheel covers all the slots */
+	tick = MAX(tw_last_tick + 1, now - MIN(now, TIMER_WHEEL_SLOTS - 1));
+	for (; tick <= now; tick++) {
+		slot = tw_slots + (tick & (TIMER_WHEEL_SLOTS - 1));
+		TAILQ_FOREACH_SAFE(t, slot, link, next) {
+			if (t->expires <= now) {
+				TAILQ_REMOVE(slot, t, link);
+				TAILQ_INSERT_TAIL(&tw_expired, t, link);
+			}
+		}
+	}
+	tw_last_tick = now;
+}
+
+static enum itr_return tw_itr_cb(struct itr_handler *h __unused)
+{
+	struct tw_timer *t = NULL;
+	uint32_t exceptions = 0;
+	uint64_t now = 0;
+
+	exceptions = cpu_spin_lock_xsave(&tw_lock);
+
+	/* A CPU which stopped driving the wheel may see a late interrupt */
+	if (!tw_ticking || tw_core != get_core_pos()) {
+		write_cntps_ctl(0);
+		cpu_spin_unlock_xrestore(&tw_lock, exceptions);
+		return ITRR_HANDLED;
+	}
+
+	arm_tick();
+	now = get_tick();
+	expire_timers(now);
+
+	while ((t = TAILQ_FIRST(&tw_expired))) {
+		remove_timer(t);
+		if (t->period)
+			add_timer(t, MAX(t->expires + t->period,
+					 now + t->period));
+
+		cpu_spin_unlock_xrestore(&tw_lock, exceptions);
+		t->fn(t);
+		exceptions = cpu_spin_lock_xsave(&tw_lock);
+	}
+
+	/* Stop ticking until a timer is started, possibly on another CPU */
+	if (!tw_count) {
+		write_cntps_ctl(0);
+		tw_ticking = false;
+	}
+
+	cpu_spin_unlock_xrestore(&tw_lock, exceptions);
+
+	return ITRR_HANDLED;
+}
+
+TEE_Result timer_wheel_init(struct itr_chip *chip, size_t itr_num)
+{
+	TEE_Result res = TEE_ERROR_GENERIC;
+	size_t n = 0;
+
+	assert(!tw_cnt_per_tick);
+
+	tw_cnt_per_tick = (uint64_t)read_cntfrq() * CFG_TIMER_WHEEL_TICK_MS /
+			  1000;
+	if (!tw_cnt_per_tick)
+		panic();
+
+	for (n = 0; n < ARRAY_SIZE(tw_slots); n++)
+		TAILQ_INIT(tw_slots + n);
+
+	res = interrupt_alloc_add_handler(chip, itr_num, tw_itr_cb,
+					  ITRF_TRIGGER_LEVEL, NULL, NULL);
+	if (res)
+		return res;
+
+	/* Enabled on the CPU arming its timer, see add_timer() */
+	tw_chip = chip;
+	tw_itr_num = itr_num;
+
+	return TEE_SUCCESS;
+}
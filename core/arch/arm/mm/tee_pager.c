@@ -11,6 +11,7 @@
 #include <kernel/abort.h>
 #include <kernel/asan.h>
 #include <kernel/cache_helpers.h>
+#include <kernel/evtrace.h>
 #include <kernel/linker.h>
 #include <kernel/panic.h>
 #include <kernel/spinlock.h>
@@ -1760,6 +1761,8 @@ bool tee_pager_handle_fault(struct abort_info *ai)
 	bool ret;
 	bool clean_user_cache = false;
 
+	evtrace_record(PTA_EVTRACE_ID_PAGER_FAULT_ENTER, ai->va, 0);
+
 #ifdef TEE_PAGER_DEBUG_PRINT
 	if (!abort_is_user_exception(ai))
 		abort_print(ai);
@@ -1820,6 +1823,9 @@ out_success:
 	ret = true;
 out:
 	pager_unlock(exceptions);
+
+	evtrace_record(PTA_EVTRACE_ID_PAGER_FAULT_EXIT, ai->va, ret);
+
 	return ret;
 }
 
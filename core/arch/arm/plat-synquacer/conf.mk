@@ -3,6 +3,8 @@ PLATFORM_FLAVOR ?= developerbox
 $(call force,CFG_SECURE_TIME_SOURCE_CNTPCT,y)
 $(call force,CFG_GIC,y)
 $(call force,CFG_PL011,y)
+# The secure physical timer collects entropy, see generic_timer_start()
+$(call force,CFG_TIMER_WHEEL,n)
 
 include core/arch/arm/cpu/cortex-armv8-0.mk
 $(call force,CFG_TEE_CORE_NB_CORE,24)
@@ -19,6 +19,7 @@
 #include <kernel/panic.h>
 #include <kernel/spinlock.h>
 #include <kernel/tee_time.h>
+#include <kernel/timer_wheel.h>
 #include <mm/core_memprot.h>
 #include <mm/core_mmu.h>
 #include <platform_config.h>
@@ -187,6 +188,14 @@ static TEE_Result init_tzc400(void)
 service_init(init_tzc400);
 #endif /*CFG_TZC400*/
 
+#if defined(CFG_TIMER_WHEEL) && defined(IT_SEC_TIMER)
+static TEE_Result init_timer_wheel(void)
+{
+	return timer_wheel_init(interrupt_get_main_chip(), IT_SEC_TIMER);
+}
+driver_init(init_timer_wheel);
+#endif
+
 #if defined(PLATFORM_FLAVOR_qemu_virt)
 static void release_secondary_early_hpen(size_t pos)
 {
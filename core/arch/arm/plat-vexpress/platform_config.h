@@ -72,6 +72,7 @@
 #define UART1_BASE		0x09040000
 
 #define IT_UART1		40
+#define IT_SEC_TIMER		29
 
 #define CONSOLE_UART_BASE	UART1_BASE
 #define IT_CONSOLE_UART		IT_UART1
@@ -16,6 +16,14 @@ static inline uint64_t timeout_init_us(uint32_t us)
 	return read_time() + ((uint64_t)us * read_cntfrq()) / 1000000ULL;
 }
 
+/* Converts a number of counter ticks, as a duration, to microseconds */
+static inline uint64_t timer_cnt2us(uint64_t cnt)
+{
+	uint64_t freq = read_cntfrq();
+
+	return (cnt / freq) * 1000000ULL + ((cnt % freq) * 1000000ULL) / freq;
+}
+
 static inline bool timeout_elapsed(uint64_t expire)
 {
 	return read_time() > expire;
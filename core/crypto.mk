@@ -91,6 +91,15 @@ ifeq ($(call cfg-all-enabled,CFG_WITH_SOFTWARE_PRNG CFG_WITH_TRNG),y)
 $(error CFG_WITH_SOFTWARE_PRNG and CFG_WITH_TRNG are exclusive)
 endif
 
+# CFG_WITH_SOFTWARE_PRNG_PER_CORE, when enabled, serves small random number
+# requests from per-core AES-CTR generators seeded from the software PRNG
+# instead of serializing all callers on the software PRNG.
+ifeq ($(CFG_WITH_SOFTWARE_PRNG),y)
+CFG_WITH_SOFTWARE_PRNG_PER_CORE ?= n
+else
+$(call force,CFG_WITH_SOFTWARE_PRNG_PER_CORE,n)
+endif
+
 ifeq ($(CFG_WITH_PAGER),y)
 ifneq ($(CFG_CRYPTO_SHA256),y)
 $(warning Warning: Enabling CFG_CRYPTO_SHA256 [required by CFG_WITH_PAGER])
@@ -99,6 +108,7 @@ endif
 endif
 
 $(eval $(call cryp-enable-all-depends,CFG_WITH_SOFTWARE_PRNG, AES ECB SHA256))
+$(eval $(call cryp-enable-all-depends,CFG_WITH_SOFTWARE_PRNG_PER_CORE, AES CTR))
 
 ifeq ($(CFG_CRYPTO_WITH_CE82),y)
 $(call force,CFG_CRYPTO_WITH_CE,y,required with CFG_CRYPTO_WITH_CE82)
@@ -9,11 +9,14 @@
 
 #include <assert.h>
 #include <crypto/crypto.h>
+#include <kernel/misc.h>
 #include <kernel/mutex.h>
 #include <kernel/refcount.h>
 #include <kernel/spinlock.h>
 #include <kernel/tee_time.h>
+#include <kernel/thread.h>
 #include <string.h>
+#include <string_ext.h>
 #include <types_ext.h>
 #include <utee_defines.h>
 #include <util.h>
@@ -27,6 +30,14 @@
 #define MAX_EVENT_DATA_LEN	32U
 #define RING_BUF_DATA_SIZE	4U
 
+/*
+ * Per core child generators, see struct rng_child below
+ */
+#define CHILD_ALGO		TEE_ALG_AES_CTR
+#define CHILD_MAX_REQ		512
+#define CHILD_RESEED_READS	64
+#define CHILD_RESEED_BYTES	(64 * 1024)
+
 /*
  * struct fortuna_state - state of the Fortuna PRNG
  * @ctx:		Cipher context used to produce the random numbers
@@ -50,7 +61,7 @@ static struct fortuna_state {
 	unsigned int pool0_length;
 	void *pool_ctx[NUM_POOLS];
 	void *reseed_ctx;
-	uint32_t reseed_count;
+	unsigned int reseed_count;
 #ifndef CFG_SECURE_TIME_SOURCE_REE
 	TEE_Time next_reseed_time;
 #endif
@@ -127,6 +138,54 @@ static void fortuna_done(void)
 	state.ctx = NULL;
 }
 
+#ifdef CFG_WITH_SOFTWARE_PRNG_PER_CORE
+/*
+ * struct rng_child - per core generator seeded from Fortuna
+ * @mu:			Protects the child, contended only by the threads
+ *			which happened to run on the same core
+ * @ctx:		AES-256-CTR context, NULL if the child couldn't be
+ *			allocated and Fortuna is to be used directly
+ * @seeded:		True when @ctx holds a key taken from Fortuna
+ * @reseed_count:	Value of state.reseed_count when last seeded
+ * @reads:		Number of requests served since last seeded
+ * @bytes:		Number of bytes produced since last seeded
+ *
+ * A child produces the requested bytes as the key stream of AES-CTR and
+ * then, like the Fortuna generator, replaces its key with the next bytes
+ * of the key stream so that a compromised key cannot reveal earlier
+ * output. The child takes a new key from Fortuna once Fortuna has
+ * reseeded from the pools, and after CHILD_RESEED_READS requests or
+ * CHILD_RESEED_BYTES bytes. Taking a key from Fortuna goes through
+ * fortuna_read() which drains the queued events and gives maybe_reseed()
+ * a chance to run.
+ */
+struct rng_child {
+	struct mutex mu;
+	void *ctx;
+	bool seeded;
+	unsigned int reseed_count;
+	unsigned int reads;
+	size_t bytes;
+};
+
+static struct rng_child children[CFG_TEE_CORE_NB_CORE];
+
+static void children_init(void)
+{
+	size_t n = 0;
+
+	for (n = 0; n < ARRAY_SIZE(children); n++) {
+		mutex_init(&children[n].mu);
+		if (crypto_cipher_alloc_ctx(&children[n].ctx, CHILD_ALGO))
+			children[n].ctx = NULL;
+	}
+}
+#else
+static void children_init(void)
+{
+}
+#endif
+
 TEE_Result crypto_rng_init(const void *data, size_t dlen)
 {
 	TEE_Result res;
@@ -166,6 +225,7 @@ TEE_Result crypto_rng_init(const void *data, size_t dlen)
 		return res;
 	inc_counter(state.counter);
 	state.ctx = ctx;
+	children_init();
 	return TEE_SUCCESS;
 err:
 	fortuna_done();
@@ -511,12 +571,152 @@ out:
 	return res;
 }
 
+#ifdef CFG_WITH_SOFTWARE_PRNG_PER_CORE
+static struct rng_child *get_child(void)
+{
+	uint32_t exceptions = thread_mask_exceptions(THREAD_EXCP_FOREIGN_INTR);
+	struct rng_child *child = children + get_core_pos();
+
+	thread_unmask_exceptions(exceptions);
+
+	return child;
+}
+
+static TEE_Result child_set_key(struct rng_child *child,
+				uint8_t key[KEY_SIZE])
+{
+	/* Each key is used once, starting the counter at 0 is fine */
+	static const uint8_t iv[BLOCK_SIZE];
+
+	if (child->seeded)
+		crypto_cipher_final(child->ctx);
+	child->seeded = false;
+
+	return crypto_cipher_init(child->ctx, TEE_MODE_ENCRYPT, key, KEY_SIZE,
+				  NULL, 0, iv, sizeof(iv));
+}
+
+static TEE_Result child_reseed(struct rng_child *child)
+{
+	unsigned int reseed_count = atomic_load_uint(&state.reseed_count);
+	uint8_t key[KEY_SIZE] = { };
+	TEE_Result res = TEE_SUCCESS;
+
+	res = fortuna_read(key, sizeof(key));
+	if (!res)
+		res = child_set_key(child, key);
+	memzero_explicit(key, sizeof(key));
+	if (res)
+		return res;
+
+	child->seeded = true;
+	/*
+	 * Sampled before fortuna_read() so that a reseed of Fortuna racing
+	 * with us results in an extra reseed of the child, not a missed one.
+	 */
+	child->reseed_count = reseed_count;
+	child->reads = 0;
+	child->bytes = 0;
+
+	return TEE_SUCCESS;
+}
+
+static bool child_need_reseed(struct rng_child *child, size_t blen)
+{
+	return !child->seeded || child->reads >= CHILD_RESEED_READS ||
+	       child->bytes + blen > CHILD_RESEED_BYTES ||
+	       child->reseed_count != atomic_load_uint(&state.reseed_count);
+}
+
+/* Key stream of the child, @buf is used as zeroed input */
+static TEE_Result child_generate(struct rng_child *child, void *buf,
+				 size_t blen)
+{
+	size_t len = ROUNDDOWN(blen, BLOCK_SIZE);
+	uint8_t block[BLOCK_SIZE] = { };
+	uint8_t key[KEY_SIZE] = { };
+	TEE_Result res = TEE_SUCCESS;
+
+	if (len) {
+		memset(buf, 0, len);
+		res = crypto_cipher_update(child->ctx, TEE_MODE_ENCRYPT, false,
+					   buf, len, buf);
+		if (res)
+			return res;
+	}
+
+	if (blen % BLOCK_SIZE) {
+		res = crypto_cipher_update(child->ctx, TEE_MODE_ENCRYPT, false,
+					   block, sizeof(block), block);
+		if (res)
+			return res;
+		memcpy((uint8_t *)buf + len, block, blen % BLOCK_SIZE);
+		memzero_explicit(block, sizeof(block));
+	}
+
+	/* Replace the key to protect the output we've just produced */
+	res = crypto_cipher_update(child->ctx, TEE_MODE_ENCRYPT, false,
+				   key, sizeof(key), key);
+	if (!res)
+		res = child_set_key(child, key);
+	memzero_explicit(key, sizeof(key));
+	if (!res)
+		child->seeded = true;
+
+	return res;
+}
+
+/* Returns true if the request was handled by a child, result in @res */
+static bool child_read(void *buf, size_t blen, TEE_Result *res)
+{
+	struct rng_child *child = NULL;
+
+	if (!blen || blen > CHILD_MAX_REQ)
+		return false;
+
+	child = get_child();
+	if (!child->ctx)
+		return false;
+
+	if (!state.ctx) {
+		*res = TEE_ERROR_BAD_STATE;
+		return true;
+	}
+
+	mutex_lock(&child->mu);
+
+	*res = TEE_SUCCESS;
+	if (child_need_reseed(child, blen))
+		*res = child_reseed(child);
+	if (!*res)
+		*res = child_generate(child, buf, blen);
+	child->reads++;
+	child->bytes += blen;
+	/* Don't trust a key stream which failed, start over from Fortuna */
+	if (*res)
+		child->reads = CHILD_RESEED_READS;
+
+	mutex_unlock(&child->mu);
+
+	return true;
+}
+#else
+static bool child_read(void *buf __unused, size_t blen __unused,
+		       TEE_Result *res __unused)
+{
+	return false;
+}
+#endif
+
 TEE_Result crypto_rng_read(void *buf, size_t blen)
 {
+	TEE_Result res = TEE_SUCCESS;
 	size_t offs = 0;
 
+	if (child_read(buf, blen, &res))
+		return res;
+
 	while (true) {
-		TEE_Result res;
 		size_t n;
 
 		/* Draw at most 1 MiB of random on a single key */
@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ *
+ * Crypto asynchronous job interface implementation.
+ */
+#include <crypto/crypto.h>
+#include <drvcrypt.h>
+#include <drvcrypt_async.h>
+#include <kernel/mutex.h>
+
+/* Protects drvcrypt_job.completed and serializes the waiters */
+static struct mutex job_mu = MUTEX_INITIALIZER;
+static struct condvar job_cv = CONDVAR_INITIALIZER;
+
+TEE_Result drvcrypt_job_exec(struct drvcrypt_job *job)
+{
+	switch (job->type) {
+	case DRVCRYPT_JOB_CIPHER_UPDATE:
+		if (job->dst.length < job->src.length)
+			return TEE_ERROR_SHORT_BUFFER;
+		return crypto_cipher_update(job->ctx, job->mode, job->last,
+					    job->src.data, job->src.length,
+					    job->dst.data);
+	case DRVCRYPT_JOB_HASH_UPDATE:
+		return crypto_hash_update(job->ctx, job->src.data,
+					  job->src.length);
+	default:
+		return TEE_ERROR_BAD_PARAMETERS;
+	}
+}
+
+static TEE_Result submit_one(struct drvcrypt_async *engine,
+			     struct drvcrypt_job *job)
+{
+	job->completed = false;
+	job->res = TEE_ERROR_GENERIC;
+
+	return engine->submit(job);
+}
+
+TEE_Result drvcrypt_job_submit(struct drvcrypt_job *job)
+{
+	struct drvcrypt_async *engine = drvcrypt_get_ops(CRYPTO_ASYNC);
+	TEE_Result res = TEE_SUCCESS;
+
+	if (!engine)
+		return TEE_ERROR_NOT_SUPPORTED;
+
+	res = submit_one(engine, job);
+	if (!res)
+		engine->kick();
+
+	return res;
+}
+
+TEE_Result drvcrypt_job_submit_batch(struct drvcrypt_job **jobs, size_t num,
+				     size_t *submitted)
+{
+	struct drvcrypt_async *engine = drvcrypt_get_ops(CRYPTO_ASYNC);
+	TEE_Result res = TEE_SUCCESS;
+	size_t n = 0;
+
+	*submitted = 0;
+	if (!engine)
+		return TEE_ERROR_NOT_SUPPORTED;
+
+	for (n = 0; n < num; n++) {
+		res = submit_one(engine, jobs[n]);
+		if (res)
+			break;
+	}
+
+	if (n)
+		engine->kick();
+
+	CRYPTO_TRACE("Submitted %zu/%zu jobs", n, num);
+	*submitted = n;
+
+	return res;
+}
+
+/*
+ * Wait for @job, or for any job to complete if @job is NULL. The
+ * function is called and returns with job_mu held.
+ */
+static void wait_locked(struct drvcrypt_async *engine,
+			struct drvcrypt_job *job)
+{
+	bool polled = false;
+
+	while (!job || !job->completed) {
+		if (engine->poll) {
+			mutex_unlock(&job_mu);
+			polled = engine->poll();
+			mutex_lock(&job_mu);
+		}
+
+		if (job && job->completed)
+			break;
+		if (!polled)
+			condvar_wait(&job_cv, &job_mu);
+		if (!job)
+			break;
+	}
+}
+
+TEE_Result drvcrypt_job_wait(struct drvcrypt_job *job)
+{
+	struct drvcrypt_async *engine = drvcrypt_get_ops(CRYPTO_ASYNC);
+
+	if (!engine)
+		return TEE_ERROR_NOT_SUPPORTED;
+
+	mutex_lock(&job_mu);
+	wait_locked(engine, job);
+	mutex_unlock(&job_mu);
+
+	return job->res;
+}
+
+void drvcrypt_job_complete(struct drvcrypt_job *job, TEE_Result res)
+{
+	job->res = res;
+	if (job->done)
+		job->done(job);
+
+	mutex_lock(&job_mu);
+	job->completed = true;
+	condvar_broadcast(&job_cv);
+	mutex_unlock(&job_mu);
+}
+
+static TEE_Result run_sync(struct drvcrypt_job **jobs, size_t num)
+{
+	TEE_Result res = TEE_SUCCESS;
+	size_t n = 0;
+
+	for (n = 0; n < num; n++) {
+		jobs[n]->res = drvcrypt_job_exec(jobs[n]);
+		jobs[n]->completed = true;
+		if (jobs[n]->done)
+			jobs[n]->done(jobs[n]);
+		if (jobs[n]->res && !res)
+			res = jobs[n]->res;
+	}
+
+	return res;
+}
+
+TEE_Result drvcrypt_job_run(struct drvcrypt_job **jobs, size_t num,
+			    size_t *nb_busy)
+{
+	struct drvcrypt_async *engine = drvcrypt_get_ops(CRYPTO_ASYNC);
+	TEE_Result first_res = TEE_SUCCESS;
+	TEE_Result res = TEE_SUCCESS;
+	size_t submitted = 0;
+	size_t waited = 0;
+	size_t busy = 0;
+	size_t n = 0;
+
+	if (!engine)
+		return run_sync(jobs, num);
+
+	while (submitted < num) {
+		res = drvcrypt_job_submit_batch(jobs + submitted,
+						num - submitted, &n);
+		submitted += n;
+		if (res == TEE_ERROR_BUSY) {
+			/* Back-pressure, make room in the engine queue */
+			busy++;
+			if (waited < submitted) {
+				res = drvcrypt_job_wait(jobs[waited]);
+				waited++;
+				if (res && !first_res)
+					first_res = res;
+			} else {
+				/* The queue is full of jobs of other threads */
+				mutex_lock(&job_mu);
+				wait_locked(engine, NULL);
+				mutex_unlock(&job_mu);
+			}
+			continue;
+		}
+		if (res) {
+			first_res = res;
+			break;
+		}
+	}
+
+	for (; waited < submitted; waited++) {
+		res = drvcrypt_job_wait(jobs[waited]);
+		if (res && !first_res)
+			first_res = res;
+	}
+
+	if (nb_busy)
+		*nb_busy = busy;
+
+	return first_res;
+}
@@ -0,0 +1 @@
+srcs-y += async.c
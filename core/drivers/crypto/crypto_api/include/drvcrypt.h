@@ -60,6 +60,7 @@ enum drvcrypt_algo_id {
 	CRYPTO_DH,       /* Asymmetric DH driver */
 	CRYPTO_DSA,	 /* Asymmetric DSA driver */
 	CRYPTO_AUTHENC,  /* Authenticated Encryption driver */
+	CRYPTO_ASYNC,    /* Asynchronous job engine */
 	CRYPTO_MAX_ALGO  /* Maximum number of algo supported */
 };
 
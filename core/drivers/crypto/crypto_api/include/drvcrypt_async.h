@@ -0,0 +1,139 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ *
+ * Brief   Asynchronous crypto job interface of the crypto drivers.
+ */
+#ifndef __DRVCRYPT_ASYNC_H__
+#define __DRVCRYPT_ASYNC_H__
+
+#include <drvcrypt.h>
+#include <sys/queue.h>
+#include <tee_api_types.h>
+
+/*
+ * A job describes one operation on a context of the TEE crypto API
+ * (crypto_cipher_*(), crypto_hash_*()). Jobs are queued to the
+ * registered asynchronous engine which completes them with
+ * drvcrypt_job_complete() from a thread context, typically a bottom half
+ * of the engine interrupt. The thread waiting for a job sleeps in the
+ * normal world in the meantime.
+ */
+enum drvcrypt_job_type {
+	DRVCRYPT_JOB_CIPHER_UPDATE, /* crypto_cipher_update() */
+	DRVCRYPT_JOB_HASH_UPDATE,   /* crypto_hash_update() */
+};
+
+struct drvcrypt_job;
+
+/*
+ * Job completion callback, called by drvcrypt_job_complete() before the
+ * waiters of the job are woken up
+ */
+typedef void (*drvcrypt_job_done_cb)(struct drvcrypt_job *job);
+
+/*
+ * Asynchronous job
+ */
+struct drvcrypt_job {
+	enum drvcrypt_job_type type;  /* Operation to do */
+	void *ctx;		      /* Crypto API context */
+	TEE_OperationMode mode;	      /* Cipher direction */
+	bool last;		      /* Last cipher block to handle */
+	struct drvcrypt_buf src;      /* Input data */
+	struct drvcrypt_buf dst;      /* Cipher output, same length as src */
+	drvcrypt_job_done_cb done;    /* Optional completion callback */
+	void *cb_data;		      /* Callback private data */
+	TEE_Result res;		      /* Job result once completed */
+	bool completed;		      /* Set when the job is completed */
+	STAILQ_ENTRY(drvcrypt_job) link; /* For use by the engine */
+};
+
+/*
+ * Crypto library asynchronous engine operations
+ */
+struct drvcrypt_async {
+	/*
+	 * Queue a job, TEE_ERROR_BUSY if the engine queue is full. The job
+	 * may not be started before the next call to @kick.
+	 */
+	TEE_Result (*submit)(struct drvcrypt_job *job);
+	/* Start processing the queued jobs */
+	void (*kick)(void);
+	/*
+	 * Optional, called by a thread about to wait for a job. Returns
+	 * true if queued jobs have been processed in the calling thread,
+	 * false if they're processed elsewhere and the thread can sleep.
+	 */
+	bool (*poll)(void);
+};
+
+/*
+ * Register an asynchronous engine in the crypto API
+ *
+ * @ops - Engine operations
+ */
+static inline TEE_Result drvcrypt_register_async(struct drvcrypt_async *ops)
+{
+	return drvcrypt_register(CRYPTO_ASYNC, (void *)ops);
+}
+
+/*
+ * Execute a job synchronously in the calling thread with the TEE crypto
+ * API. Used by software engines and when no engine is registered.
+ *
+ * @job   Job to execute
+ */
+TEE_Result drvcrypt_job_exec(struct drvcrypt_job *job);
+
+/*
+ * Queue a job to the engine and start it.
+ * Returns TEE_ERROR_BUSY if the engine queue is full and
+ * TEE_ERROR_NOT_SUPPORTED if no engine is registered.
+ *
+ * @job   Job to submit
+ */
+TEE_Result drvcrypt_job_submit(struct drvcrypt_job *job);
+
+/*
+ * Queue up to @num jobs to the engine and start them with a single kick.
+ * Returns TEE_ERROR_BUSY if the engine queue got full before all jobs
+ * were queued, the jobs are queued in order.
+ *
+ * @jobs       Jobs to submit
+ * @num        Number of jobs
+ * @submitted  [out] Number of jobs queued
+ */
+TEE_Result drvcrypt_job_submit_batch(struct drvcrypt_job **jobs, size_t num,
+				     size_t *submitted);
+
+/*
+ * Wait for a submitted job to complete and return its result
+ *
+ * @job   Job to wait for
+ */
+TEE_Result drvcrypt_job_wait(struct drvcrypt_job *job);
+
+/*
+ * Run @num jobs and wait for all of them. The jobs are submitted in
+ * batches as long as the engine accepts them, when the engine queue is
+ * full the oldest job is waited for before submitting more. Falls back
+ * to drvcrypt_job_exec() if no engine is registered.
+ * Returns the first error of the jobs.
+ *
+ * @jobs     Jobs to run
+ * @num      Number of jobs
+ * @nb_busy  [out] Optional, number of times the engine queue was full
+ */
+TEE_Result drvcrypt_job_run(struct drvcrypt_job **jobs, size_t num,
+			    size_t *nb_busy);
+
+/*
+ * Called by the engine from a thread context to complete a job
+ *
+ * @job  Job completed
+ * @res  Result of the job
+ */
+void drvcrypt_job_complete(struct drvcrypt_job *job, TEE_Result res);
+
+#endif /* __DRVCRYPT_ASYNC_H__ */
@@ -0,0 +1,21 @@
+# CFG_CRYPTO_SW_ASYNC, when enabled, embeds a software emulated crypto
+# accelerator running the asynchronous jobs of the crypto driver
+# interface (drvcrypt_job_*()). The jobs are run from the bottom half of
+# the asynchronous notifications when the normal world has enabled them,
+# else in the thread waiting for a job.
+# CFG_CRYPTO_SW_ASYNC_QUEUE_DEPTH is the number of jobs the emulated
+# accelerator can queue before applying back-pressure.
+# CFG_CRYPTO_SW_ASYNC_DELAY_US is an emulated processing time added to each
+# job.
+
+ifeq ($(CFG_CRYPTO_SW_ASYNC),y)
+
+$(call force,CFG_CRYPTO_DRIVER,y)
+CFG_CRYPTO_DRIVER_DEBUG ?= 0
+
+$(call force,CFG_CRYPTO_DRV_ASYNC,y,Mandated by CFG_CRYPTO_SW_ASYNC)
+
+CFG_CRYPTO_SW_ASYNC_QUEUE_DEPTH ?= 16
+CFG_CRYPTO_SW_ASYNC_DELAY_US ?= 0
+
+endif # CFG_CRYPTO_SW_ASYNC
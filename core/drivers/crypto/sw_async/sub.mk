@@ -0,0 +1 @@
+srcs-y += sw_async.c
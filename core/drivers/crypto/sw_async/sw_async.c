@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ *
+ * Software emulated crypto accelerator running the drvcrypt asynchronous
+ * jobs. The jobs are queued in a bounded ring and run in the bottom half
+ * of the asynchronous notifications, or in the waiting thread when the
+ * normal world hasn't enabled asynchronous notifications.
+ */
+#include <assert.h>
+#include <drvcrypt.h>
+#include <drvcrypt_async.h>
+#include <initcall.h>
+#include <kernel/delay.h>
+#include <kernel/mutex.h>
+#include <kernel/notif.h>
+#include <kernel/spinlock.h>
+#include <trace.h>
+
+#define QUEUE_DEPTH	CFG_CRYPTO_SW_ASYNC_QUEUE_DEPTH
+
+static_assert(QUEUE_DEPTH > 0);
+
+static struct drvcrypt_job *queue[QUEUE_DEPTH];
+static size_t queue_head;
+static size_t queue_count;
+static unsigned int queue_lock = SPINLOCK_UNLOCK;
+
+/* Serializes the runs of the queue */
+static struct mutex run_mu = MUTEX_INITIALIZER;
+
+static TEE_Result sw_async_submit(struct drvcrypt_job *job)
+{
+	uint32_t exceptions = cpu_spin_lock_xsave(&queue_lock);
+	TEE_Result res = TEE_SUCCESS;
+
+	if (queue_count == QUEUE_DEPTH) {
+		res = TEE_ERROR_BUSY;
+	} else {
+		queue[(queue_head + queue_count) % QUEUE_DEPTH] = job;
+		queue_count++;
+	}
+
+	cpu_spin_unlock_xrestore(&queue_lock, exceptions);
+
+	return res;
+}
+
+static struct drvcrypt_job *dequeue(void)
+{
+	uint32_t exceptions = cpu_spin_lock_xsave(&queue_lock);
+	struct drvcrypt_job *job = NULL;
+
+	if (queue_count) {
+		job = queue[queue_head];
+		queue_head = (queue_head + 1) % QUEUE_DEPTH;
+		queue_count--;
+	}
+
+	cpu_spin_unlock_xrestore(&queue_lock, exceptions);
+
+	return job;
+}
+
+static void run_queue(void)
+{
+	struct drvcrypt_job *job = NULL;
+	TEE_Result res = TEE_SUCCESS;
+
+	mutex_lock(&run_mu);
+
+	while ((job = dequeue())) {
+		if (CFG_CRYPTO_SW_ASYNC_DELAY_US)
+			udelay(CFG_CRYPTO_SW_ASYNC_DELAY_US);
+		res = drvcrypt_job_exec(job);
+		drvcrypt_job_complete(job, res);
+	}
+
+	mutex_unlock(&run_mu);
+}
+
+static void sw_async_kick(void)
+{
+	if (notif_async_is_started())
+		notif_send_async(NOTIF_VALUE_DO_BOTTOM_HALF);
+}
+
+static bool sw_async_poll(void)
+{
+	if (notif_async_is_started())
+		return false;
+
+	run_queue();
+
+	return true;
+}
+
+static void sw_async_notif(struct notif_driver *ndrv __unused,
+			   enum notif_event ev)
+{
+	switch (ev) {
+	case NOTIF_EVENT_DO_BOTTOM_HALF:
+	case NOTIF_EVENT_STOPPED:
+		/* Don't leave jobs behind when notifications are stopped */
+		run_queue();
+		break;
+	default:
+		EMSG("Unknown event %d", (int)ev);
+	}
+}
+
+static struct notif_driver sw_async_notif_driver = {
+	.yielding_cb = sw_async_notif,
+};
+
+static struct drvcrypt_async sw_async_ops = {
+	.submit = sw_async_submit,
+	.kick = sw_async_kick,
+	.poll = sw_async_poll,
+};
+
+static TEE_Result sw_async_init(void)
+{
+	if (IS_ENABLED(CFG_CORE_ASYNC_NOTIF))
+		notif_register_driver(&sw_async_notif_driver);
+
+	return drvcrypt_register_async(&sw_async_ops);
+}
+driver_init(sw_async_init);
@@ -134,6 +134,15 @@ void scmi_msg_release_channel(struct scmi_msg_channel *channel);
  */
 void scmi_entry_smt(unsigned int channel_id, uint32_t *payload_buf);
 
+/*
+ * Process the pending messages of a channel using SMT shared memory protocol
+ * @channel: SCMI channel
+ * @channel_id: SCMI channel identifier of @channel
+ * @payload_buf: Secure buffer where to copy input message
+ */
+void scmi_smt_process_channel(struct scmi_msg_channel *channel,
+			      unsigned int channel_id, uint32_t *payload_buf);
+
 /*
  * Entry for processing a channel using SMT shared memory protocol
  *
@@ -4,10 +4,10 @@
  * Copyright (c) 2019-2022, Linaro Limited
  */
 #include <assert.h>
+#include <atomic.h>
 #include <drivers/scmi-msg.h>
 #include <drivers/scmi.h>
 #include <kernel/misc.h>
-#include <kernel/spinlock.h>
 #include <kernel/thread.h>
 #include <string.h>
 #include <trace.h>
@@ -31,26 +31,25 @@ __maybe_unused;
 static uint32_t fastcall_payload[CFG_TEE_CORE_NB_CORE][SCMI_PAYLOAD_U32_MAX]
 __maybe_unused;
 
-/* SMP protection on channel->busy field */
-static unsigned int smt_channels_lock;
-
-/* If channel is not busy, set busy and return true, otherwise return false */
+/*
+ * If channel is not busy, set busy and return true, otherwise return false.
+ * A channel is typically used by a single CPU at a time, an atomic update
+ * of channel->busy is enough to serialize the rare concurrent entries.
+ */
 bool scmi_msg_claim_channel(struct scmi_msg_channel *channel)
 {
-	uint32_t exceptions = cpu_spin_lock_xsave(&smt_channels_lock);
-	bool channel_is_busy = channel->busy;
-
-	if (!channel_is_busy)
-		channel->busy = true;
+	unsigned int busy = 0;
 
-	cpu_spin_unlock_xrestore(&smt_channels_lock, exceptions);
+	while (!atomic_cas_uint(&channel->busy, &busy, 1))
+		if (busy)
+			return false;
 
-	return !channel_is_busy;
+	return true;
 }
 
 void scmi_msg_release_channel(struct scmi_msg_channel *channel)
 {
-	channel->busy = false;
+	atomic_store_release_uint(&channel->busy, 0);
 }
 
 void scmi_status_response(struct scmi_msg *msg, int32_t status)
@@ -134,6 +133,15 @@ void scmi_smt_threaded_entry(unsigned int channel_id)
 }
 #endif
 
+#ifdef CFG_SCMI_MSG_SMT
+void scmi_smt_local_entry(struct scmi_msg_channel *channel,
+			  unsigned int channel_id)
+{
+	scmi_smt_process_channel(channel, channel_id,
+				 threaded_payload[thread_get_id()]);
+}
+#endif
+
 #ifdef CFG_SCMI_MSG_SHM_MSG
 TEE_Result scmi_msg_threaded_entry(unsigned int channel_id,
 				   void *in_buf, size_t in_size,
@@ -7,8 +7,15 @@
 #include <confine_array_index.h>
 #include <drivers/scmi-msg.h>
 #include <drivers/scmi.h>
+#include <initcall.h>
+#include <kernel/deferred_work.h>
+#include <kernel/delay.h>
+#include <kernel/spinlock.h>
+#include <malloc.h>
 #include <mm/core_memprot.h>
+#include <pta_stats.h>
 #include <string.h>
+#include <sys/queue.h>
 #include <util.h>
 
 #include "common.h"
@@ -16,7 +23,63 @@
 
 #define VERBOSE_MSG(...)		FMSG(__VA_ARGS__)
 
-static bool message_id_is_supported(unsigned int message_id);
+static bool message_id_is_supported(size_t message_id);
+
+/*
+ * struct perf_domain - Cached state of a performance domain
+ * @channel_id:	SCMI channel ID
+ * @domain_id:	SCMI performance domain ID
+ * @levels:	Descriptors of the levels, NULL until read from the platform
+ * @nb_levels:	Number of cells in @levels
+ * @level:	Current level, valid if @level_known
+ * @target:	Level to set, valid if @set_pending
+ * @level_known: True when @level is the level programmed in the platform
+ * @set_pending: True while a level set is queued
+ * @transition:	True while the platform programs a level
+ * @set_count:	Number of level transitions
+ * @skip_count:	Number of level set requests for the current level
+ * @ticks:	Counter ticks spent in level transitions
+ * @max_ticks:	Longest level transition in counter ticks
+ * @link:	Link in the queue of pending level sets
+ *
+ * The level is cached on the assumption that only this driver changes
+ * the level of the domain. It is unknown during a transition and after
+ * a failed one, and is then read again from the platform.
+ */
+struct perf_domain {
+	unsigned int channel_id;
+	unsigned int domain_id;
+	struct scmi_perf_level *levels;
+	size_t nb_levels;
+	unsigned int level;
+	unsigned int target;
+	bool level_known;
+	bool set_pending;
+	bool transition;
+	uint64_t set_count;
+	uint64_t skip_count;
+	uint64_t ticks;
+	uint64_t max_ticks;
+	TAILQ_ENTRY(perf_domain) link;
+};
+
+struct perf_channel {
+	unsigned int channel_id;
+	size_t count;
+	SLIST_ENTRY(perf_channel) link;
+	struct perf_domain domains[];
+};
+
+/* Protects the list of channels and the state of the domains */
+static unsigned int perf_lock = SPINLOCK_UNLOCK;
+static SLIST_HEAD(, perf_channel) perf_channels =
+	SLIST_HEAD_INITIALIZER(perf_channels);
+
+#ifdef CFG_SCMI_MSG_PERF_DOMAIN_ASYNC
+static TAILQ_HEAD(, perf_domain) perf_pending =
+	TAILQ_HEAD_INITIALIZER(perf_pending);
+static struct deferred_work perf_work;
+#endif
 
 /* Weak handlers platform shall override on purpose */
 size_t __weak plat_scmi_perf_count(unsigned int channel_id __unused)
@@ -77,6 +140,390 @@ int32_t __weak plat_scmi_perf_level_set(unsigned int channel_id __unused,
 	return SCMI_NOT_SUPPORTED;
 }
 
+void __weak plat_scmi_perf_level_set_done(unsigned int channel_id __unused,
+					  unsigned int domain_id __unused,
+					  unsigned int level __unused,
+					  int32_t status __unused)
+{
+}
+
+static struct perf_channel *find_channel(unsigned int channel_id)
+{
+	struct perf_channel *ch = NULL;
+
+	SLIST_FOREACH(ch, &perf_channels, link)
+		if (ch->channel_id == channel_id)
+			return ch;
+
+	return NULL;
+}
+
+/* Returns the state of a domain ID checked by sanitize_message() */
+static struct perf_domain *get_domain(unsigned int channel_id,
+				      unsigned int domain_id)
+{
+	size_t count = plat_scmi_perf_count(channel_id);
+	struct perf_channel *new_ch = NULL;
+	struct perf_channel *ch = NULL;
+	uint32_t exceptions = 0;
+	size_t n = 0;
+
+	exceptions = cpu_spin_lock_xsave(&perf_lock);
+	ch = find_channel(channel_id);
+	cpu_spin_unlock_xrestore(&perf_lock, exceptions);
+
+	if (!ch) {
+		new_ch = calloc(1, sizeof(*new_ch) +
+				   count * sizeof(struct perf_domain));
+		if (!new_ch)
+			return NULL;
+
+		new_ch->channel_id = channel_id;
+		new_ch->count = count;
+		for (n = 0; n < count; n++) {
+			new_ch->domains[n].channel_id = channel_id;
+			new_ch->domains[n].domain_id = n;
+		}
+
+		exceptions = cpu_spin_lock_xsave(&perf_lock);
+		ch = find_channel(channel_id);
+		if (!ch) {
+			SLIST_INSERT_HEAD(&perf_channels, new_ch, link);
+			ch = new_ch;
+			new_ch = NULL;
+		}
+		cpu_spin_unlock_xrestore(&perf_lock, exceptions);
+
+		free(new_ch);
+	}
+
+	if (domain_id >= ch->count)
+		return NULL;
+
+	return ch->domains + domain_id;
+}
+
+static int32_t read_levels(unsigned int channel_id, unsigned int domain_id,
+			   struct scmi_perf_level **levels, size_t *nb_levels)
+{
+	struct scmi_perf_level *descs = NULL;
+	unsigned int *plat_levels = NULL;
+	int32_t status = SCMI_GENERIC_ERROR;
+	size_t nb = 0;
+	size_t n = 0;
+
+	status = plat_scmi_perf_levels_array(channel_id, domain_id, 0, NULL,
+					     &nb);
+	if (status)
+		return status;
+	if (!nb)
+		return SCMI_INVALID_PARAMETERS;
+
+	plat_levels = calloc(nb, sizeof(*plat_levels));
+	descs = calloc(nb, sizeof(*descs));
+	if (!plat_levels || !descs) {
+		status = SCMI_GENERIC_ERROR;
+		goto out;
+	}
+
+	status = plat_scmi_perf_levels_array(channel_id, domain_id, 0,
+					     plat_levels, &nb);
+	if (status)
+		goto out;
+
+	for (n = 0; n < nb; n++) {
+		unsigned int latency = 0;
+		unsigned int power_cost = 0;
+		int32_t rc = SCMI_SUCCESS;
+
+		rc = plat_scmi_perf_level_latency_us(channel_id, domain_id,
+						     plat_levels[n], &latency);
+		if (rc != SCMI_SUCCESS && rc != SCMI_NOT_SUPPORTED)
+			panic();
+
+		latency &= SCMI_PERF_LEVEL_ATTRIBUTES_LATENCY_US_MASK;
+
+		rc = plat_scmi_perf_level_power_cost(channel_id, domain_id,
+						     plat_levels[n],
+						     &power_cost);
+		if (rc != SCMI_SUCCESS && rc != SCMI_NOT_SUPPORTED)
+			panic();
+
+		descs[n] = (struct scmi_perf_level){
+			.performance_level = plat_levels[n],
+			.power_cost = power_cost,
+			.attributes = latency,
+		};
+	}
+
+	*levels = descs;
+	*nb_levels = nb;
+	descs = NULL;
+
+out:
+	free(plat_levels);
+	free(descs);
+
+	return status;
+}
+
+/* Returns the level descriptors of @d, read once from the platform */
+static int32_t get_levels(struct perf_domain *d,
+			  const struct scmi_perf_level **levels,
+			  size_t *nb_levels)
+{
+	struct scmi_perf_level *descs = NULL;
+	int32_t status = SCMI_SUCCESS;
+	uint32_t exceptions = 0;
+	size_t nb = 0;
+
+	exceptions = cpu_spin_lock_xsave(&perf_lock);
+	*levels = d->levels;
+	*nb_levels = d->nb_levels;
+	cpu_spin_unlock_xrestore(&perf_lock, exceptions);
+
+	if (*levels)
+		return SCMI_SUCCESS;
+
+	status = read_levels(d->channel_id, d->domain_id, &descs, &nb);
+	if (status)
+		return status;
+
+	exceptions = cpu_spin_lock_xsave(&perf_lock);
+	if (!d->levels) {
+		d->levels = descs;
+		d->nb_levels = nb;
+		descs = NULL;
+	}
+	*levels = d->levels;
+	*nb_levels = d->nb_levels;
+	cpu_spin_unlock_xrestore(&perf_lock, exceptions);
+
+	free(descs);
+
+	return SCMI_SUCCESS;
+}
+
+/* Called with perf_lock held */
+static void start_transition(struct perf_domain *d)
+{
+	d->level_known = false;
+	d->transition = true;
+}
+
+/* Programs @level in the platform, start_transition() was called */
+static int32_t program_level(struct perf_domain *d, unsigned int level)
+{
+	int32_t status = SCMI_GENERIC_ERROR;
+	uint32_t exceptions = 0;
+	uint64_t start = 0;
+	uint64_t t = 0;
+
+	start = barrier_read_counter_timer();
+	status = plat_scmi_perf_level_set(d->channel_id, d->domain_id, level);
+	t = barrier_read_counter_timer() - start;
+
+	exceptions = cpu_spin_lock_xsave(&perf_lock);
+	d->transition = false;
+	if (status == SCMI_SUCCESS) {
+		d->level = level;
+		d->level_known = true;
+		d->set_count++;
+		d->ticks += t;
+		d->max_ticks = MAX(d->max_ticks, t);
+	}
+	cpu_spin_unlock_xrestore(&perf_lock, exceptions);
+
+	return status;
+}
+
+#ifdef CFG_SCMI_MSG_PERF_DOMAIN_ASYNC
+static void perf_work_fn(struct deferred_work *w __unused)
+{
+	struct perf_domain *d = NULL;
+	int32_t status = SCMI_SUCCESS;
+	uint32_t exceptions = 0;
+	unsigned int level = 0;
+
+	while (true) {
+		exceptions = cpu_spin_lock_xsave(&perf_lock);
+		d = TAILQ_FIRST(&perf_pending);
+		if (d) {
+			TAILQ_REMOVE(&perf_pending, d, link);
+			d->set_pending = false;
+			level = d->target;
+			start_transition(d);
+		}
+		cpu_spin_unlock_xrestore(&perf_lock, exceptions);
+
+		if (!d)
+			break;
+
+		status = program_level(d, level);
+		if (status)
+			EMSG("channel %u, domain %u: level %u: error %"PRId32,
+			     d->channel_id, d->domain_id, level, status);
+
+		plat_scmi_perf_level_set_done(d->channel_id, d->domain_id,
+					      level, status);
+	}
+}
+
+static int32_t set_level(struct perf_domain *d, unsigned int level)
+{
+	const struct scmi_perf_level *levels = NULL;
+	int32_t status = SCMI_SUCCESS;
+	uint32_t exceptions = 0;
+	size_t nb_levels = 0;
+	bool queue = false;
+	size_t n = 0;
+
+	/*
+	 * The level is checked before answering, the platform only reports
+	 * errors when programming it after the answer is sent.
+	 */
+	status = get_levels(d, &levels, &nb_levels);
+	if (status)
+		return status;
+
+	for (n = 0; n < nb_levels; n++)
+		if (levels[n].performance_level == level)
+			break;
+	if (n == nb_levels)
+		return SCMI_OUT_OF_RANGE;
+
+	exceptions = cpu_spin_lock_xsave(&perf_lock);
+
+	if (d->level_known && d->level == level) {
+		/* Supersedes a queued level set */
+		if (d->set_pending) {
+			TAILQ_REMOVE(&perf_pending, d, link);
+			d->set_pending = false;
+		}
+		d->skip_count++;
+	} else {
+		d->target = level;
+		if (!d->set_pending) {
+			TAILQ_INSERT_TAIL(&perf_pending, d, link);
+			d->set_pending = true;
+			queue = true;
+		}
+	}
+
+	cpu_spin_unlock_xrestore(&perf_lock, exceptions);
+
+	if (queue)
+		deferred_work_queue(&perf_work);
+
+	return SCMI_SUCCESS;
+}
+
+static TEE_Result perf_domain_init(void)
+{
+	deferred_work_init(&perf_work, "scmi-perf", perf_work_fn, NULL);
+
+	return TEE_SUCCESS;
+}
+service_init(perf_domain_init);
+#else
+static int32_t set_level(struct perf_domain *d, unsigned int level)
+{
+	uint32_t exceptions = cpu_spin_lock_xsave(&perf_lock);
+
+	if (d->level_known && d->level == level) {
+		d->skip_count++;
+		cpu_spin_unlock_xrestore(&perf_lock, exceptions);
+		return SCMI_SUCCESS;
+	}
+	start_transition(d);
+
+	cpu_spin_unlock_xrestore(&perf_lock, exceptions);
+
+	return program_level(d, level);
+}
+#endif /*CFG_SCMI_MSG_PERF_DOMAIN_ASYNC*/
+
+static int32_t get_level(struct perf_domain *d, unsigned int *level)
+{
+	int32_t status = SCMI_GENERIC_ERROR;
+	uint32_t exceptions = 0;
+	bool known = false;
+
+	exceptions = cpu_spin_lock_xsave(&perf_lock);
+	known = d->level_known;
+	*level = d->level;
+	cpu_spin_unlock_xrestore(&perf_lock, exceptions);
+
+	if (known)
+		return SCMI_SUCCESS;
+
+	status = plat_scmi_perf_level_get(d->channel_id, d->domain_id, level);
+	if (status)
+		return status;
+
+	/* Don't cache a level read while another is being programmed */
+	exceptions = cpu_spin_lock_xsave(&perf_lock);
+	if (!d->level_known && !d->set_pending && !d->transition) {
+		d->level = *level;
+		d->level_known = true;
+	}
+	cpu_spin_unlock_xrestore(&perf_lock, exceptions);
+
+	return SCMI_SUCCESS;
+}
+
+static void get_domain_stats(struct perf_domain *d,
+			     struct pta_stats_scmi_perf *st)
+{
+	*st = (struct pta_stats_scmi_perf){
+		.channel_id = d->channel_id,
+		.domain_id = d->domain_id,
+		.level = d->level_known ? d->level : 0,
+		.max_us = MIN(timer_cnt2us(d->max_ticks), (uint64_t)UINT32_MAX),
+		.set_count = d->set_count,
+		.skip_count = d->skip_count,
+		.total_us = timer_cnt2us(d->ticks),
+	};
+}
+
+TEE_Result scmi_perf_domain_stats(void *buf, size_t *buf_size)
+{
+	struct pta_stats_scmi_perf *stats = buf;
+	TEE_Result res = TEE_SUCCESS;
+	struct perf_channel *ch = NULL;
+	uint32_t exceptions = 0;
+	size_t count = 0;
+	size_t n = 0;
+
+	if (!buf_size)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	exceptions = cpu_spin_lock_xsave(&perf_lock);
+
+	SLIST_FOREACH(ch, &perf_channels, link)
+		count += ch->count;
+
+	if (!count) {
+		res = TEE_ERROR_ITEM_NOT_FOUND;
+	} else if (!buf || *buf_size < count * sizeof(*stats)) {
+		*buf_size = count * sizeof(*stats);
+		res = TEE_ERROR_SHORT_BUFFER;
+	} else if (!IS_ALIGNED_WITH_TYPE(buf, uint64_t)) {
+		res = TEE_ERROR_BAD_PARAMETERS;
+	} else {
+		count = 0;
+		SLIST_FOREACH(ch, &perf_channels, link)
+			for (n = 0; n < ch->count; n++)
+				get_domain_stats(ch->domains + n,
+						 stats + count++);
+		*buf_size = count * sizeof(*stats);
+	}
+
+	cpu_spin_unlock_xrestore(&perf_lock, exceptions);
+
+	return res;
+}
+
 static void protocol_version(struct scmi_msg *msg)
 {
 	struct scmi_protocol_version_p2a return_values = {
@@ -215,6 +662,7 @@ static void scmi_perf_level_get(struct scmi_msg *msg)
 	/* It is safe to read in_args->domain_id before sanitize_message() */
 	unsigned int domain_id = in_args->domain_id;
 	int32_t status = SCMI_GENERIC_ERROR;
+	struct perf_domain *d = NULL;
 	unsigned int level = 0;
 	struct scmi_perf_level_get_p2a return_values = {
 		.status = SCMI_SUCCESS,
@@ -228,7 +676,12 @@ static void scmi_perf_level_get(struct scmi_msg *msg)
 		return;
 	}
 
-	status = plat_scmi_perf_level_get(msg->channel_id, domain_id, &level);
+	d = get_domain(msg->channel_id, domain_id);
+	if (d)
+		status = get_level(d, &level);
+	else
+		status = plat_scmi_perf_level_get(msg->channel_id, domain_id,
+						  &level);
 	if (status) {
 		scmi_status_response(msg, status);
 		return;
@@ -251,13 +704,20 @@ static void scmi_perf_level_set(struct scmi_msg *msg)
 	unsigned int domain_id = in_args->domain_id;
 	unsigned int level = in_args->performance_level;
 	int32_t status = SCMI_GENERIC_ERROR;
+	struct perf_domain *d = NULL;
 
 	VERBOSE_MSG("channel %u, domain %u: set level %u", channel_id,
 		    domain_id, level);
 
 	status = sanitize_message(msg, &domain_id, sizeof(*in_args));
-	if (status == SCMI_SUCCESS)
-		status = plat_scmi_perf_level_set(channel_id, domain_id, level);
+	if (status == SCMI_SUCCESS) {
+		d = get_domain(channel_id, domain_id);
+		if (d)
+			status = set_level(d, level);
+		else
+			status = plat_scmi_perf_level_set(channel_id, domain_id,
+							  level);
+	}
 
 	scmi_status_response(msg, status);
 }
@@ -271,12 +731,13 @@ static void scmi_perf_level_set(struct scmi_msg *msg)
 static void scmi_perf_describe_levels(struct scmi_msg *msg)
 {
 	const struct scmi_perf_describe_levels_a2p *in_args = (void *)msg->in;
+	const struct scmi_perf_level *levels = NULL;
+	struct scmi_perf_describe_levels_p2a p2a = { };
 	size_t nb_levels = 0;
 	/* It is safe to read in_args->domain_id before sanitize_message() */
 	unsigned int domain_id = in_args->domain_id;
 	int32_t status = SCMI_GENERIC_ERROR;
-	/* Use the stack to get the returned a portion of the level array */
-	unsigned int plat_levels[LEVELS_ARRAY_SIZE] = { 0 };
+	struct perf_domain *d = NULL;
 	size_t ret_nb = 0;
 	size_t rem_nb = 0;
 
@@ -286,8 +747,13 @@ static void scmi_perf_describe_levels(struct scmi_msg *msg)
 	if (status)
 		goto err;
 
-	status = plat_scmi_perf_levels_array(msg->channel_id, domain_id, 0,
-					     NULL, &nb_levels);
+	d = get_domain(msg->channel_id, domain_id);
+	if (!d) {
+		status = SCMI_GENERIC_ERROR;
+		goto err;
+	}
+
+	status = get_levels(d, &levels, &nb_levels);
 	if (status)
 		goto err;
 
@@ -296,58 +762,18 @@ static void scmi_perf_describe_levels(struct scmi_msg *msg)
 		goto err;
 	}
 
-	ret_nb = MIN(ARRAY_SIZE(plat_levels), nb_levels - in_args->level_index);
+	ret_nb = MIN(LEVELS_ARRAY_SIZE, nb_levels - in_args->level_index);
 	rem_nb = nb_levels - in_args->level_index - ret_nb;
 
-	status =  plat_scmi_perf_levels_array(msg->channel_id, domain_id,
-					      in_args->level_index, plat_levels,
-					      &ret_nb);
-
-	if (status == SCMI_SUCCESS) {
-		struct scmi_perf_describe_levels_p2a p2a = { };
-		struct scmi_perf_level *levels = NULL;
-		size_t n = 0;
-
-		p2a.status = SCMI_SUCCESS;
-		p2a.num_levels = SCMI_PERF_NUM_LEVELS(ret_nb, rem_nb);
-		memcpy(msg->out, &p2a, sizeof(p2a));
-
-		/* By construction these values are 32bit aligned */
-		levels = (void *)(uintptr_t)(msg->out + sizeof(p2a));
-
-		for (n = 0; n < ret_nb; n++) {
-			unsigned int latency = 0;
-			unsigned int power_cost = 0;
-			int32_t rc = SCMI_SUCCESS;
-
-			rc = plat_scmi_perf_level_latency_us(msg->channel_id,
-							     domain_id,
-							     plat_levels[n],
-							     &latency);
-			if (rc != SCMI_SUCCESS && rc != SCMI_NOT_SUPPORTED)
-				panic();
-
-			latency &= SCMI_PERF_LEVEL_ATTRIBUTES_LATENCY_US_MASK;
-
-			rc = plat_scmi_perf_level_power_cost(msg->channel_id,
-							     domain_id,
-							     plat_levels[n],
-							     &power_cost);
-			if (rc != SCMI_SUCCESS && rc != SCMI_NOT_SUPPORTED)
-				panic();
-
-			levels[n] = (struct scmi_perf_level){
-				.performance_level = plat_levels[n],
-				.power_cost = power_cost,
-				.attributes = latency,
-			};
-		}
+	p2a.status = SCMI_SUCCESS;
+	p2a.num_levels = SCMI_PERF_NUM_LEVELS(ret_nb, rem_nb);
+	memcpy(msg->out, &p2a, sizeof(p2a));
+	memcpy(msg->out + sizeof(p2a), levels + in_args->level_index,
+	       ret_nb * sizeof(*levels));
 
-		msg->out_size_out =
-			sizeof(p2a) + ret_nb * sizeof(struct scmi_perf_level);
+	msg->out_size_out = sizeof(p2a) + ret_nb * sizeof(*levels);
 
-		return;
-	}
+	return;
 
 err:
 	assert(status);
@@ -14,42 +14,6 @@
 
 #include "common.h"
 
-/**
- * struct smt_header - SMT formatted header for SMT base shared memory transfer
- *
- * @status: Bit flags, see SMT_STATUS_*
- * @flags: Bit flags, see SMT_FLAG_*
- * @length: Byte size of message payload (variable) + ::message_header (32bit)
- * payload: SCMI message payload data
- */
-struct smt_header {
-	uint32_t reserved0;
-	uint32_t status;
-	uint64_t reserved1;
-	uint32_t flags;
-	uint32_t length; /* message_header + payload */
-	uint32_t message_header;
-	uint32_t payload[];
-};
-
-/* Flag set in smt_header::status when SMT does not contain pending message */
-#define SMT_STATUS_FREE			BIT(0)
-/* Flag set in smt_header::status when SMT reports an error */
-#define SMT_STATUS_ERROR		BIT(1)
-
-/* Flag set in smt_header::flags when SMT uses interrupts */
-#define SMT_FLAG_INTR_ENABLED		BIT(1)
-
-/* Bit fields packed in smt_header::message_header */
-#define SMT_MSG_ID_MASK			GENMASK_32(7, 0)
-#define SMT_HDR_MSG_ID(_hdr)		((_hdr) & SMT_MSG_ID_MASK)
-
-#define SMT_MSG_TYPE_MASK		GENMASK_32(9, 8)
-#define SMT_HDR_TYPE_ID(_hdr)		(((_hdr) & SMT_MSG_TYPE_MASK) >> 8)
-
-#define SMT_MSG_PROT_ID_MASK		GENMASK_32(17, 10)
-#define SMT_HDR_PROT_ID(_hdr)		(((_hdr) & SMT_MSG_PROT_ID_MASK) >> 10)
-
 static struct smt_header *channel_to_smt_hdr(struct scmi_msg_channel *channel)
 {
 	if (!channel)
@@ -59,37 +23,28 @@ static struct smt_header *channel_to_smt_hdr(struct scmi_msg_channel *channel)
 						sizeof(struct smt_header));
 }
 
+static struct smt_header *get_slot_hdr(struct scmi_msg_channel *channel,
+				       size_t slot)
+{
+	vaddr_t base = (vaddr_t)channel_to_smt_hdr(channel);
+
+	return (struct smt_header *)(base + slot * channel->shm_size);
+}
+
 /*
  * Creates a SCMI message instance in secure memory and push it in the SCMI
  * message drivers. Message structure contains SCMI protocol meta-data and
  * references to input payload in secure memory and output message buffer
  * in shared memory.
  */
-void scmi_entry_smt(unsigned int channel_id, uint32_t *payload_buf)
+static void process_smt_message(struct scmi_msg_channel *channel,
+				unsigned int channel_id,
+				struct smt_header *smt_hdr,
+				uint32_t *payload_buf)
 {
-	struct scmi_msg_channel *channel = NULL;
-	struct smt_header *smt_hdr = NULL;
 	size_t in_payload_size = 0;
 	uint32_t smt_status = 0;
 	struct scmi_msg msg = { };
-	bool error = true;
-
-	channel = plat_scmi_get_channel(channel_id);
-	if (!channel) {
-		DMSG("Invalid channel ID %u", channel_id);
-		return;
-	}
-
-	smt_hdr = channel_to_smt_hdr(channel);
-	if (!smt_hdr) {
-		DMSG("No shared buffer for channel ID %u", channel_id);
-		return;
-	}
-
-	if (!scmi_msg_claim_channel(channel)) {
-		DMSG("SCMI channel %u busy", channel_id);
-		goto out;
-	}
 
 	smt_status = READ_ONCE(smt_hdr->status);
 
@@ -98,13 +53,13 @@ void scmi_entry_smt(unsigned int channel_id, uint32_t *payload_buf)
 
 	if (in_payload_size > SCMI_SEC_PAYLOAD_SIZE) {
 		DMSG("SCMI payload too big %zu", in_payload_size);
-		goto out;
+		goto err;
 	}
 
 	if (smt_status & (SMT_STATUS_ERROR | SMT_STATUS_FREE)) {
 		DMSG("SCMI channel bad status 0x%x",
 		     smt_hdr->status & (SMT_STATUS_ERROR | SMT_STATUS_FREE));
-		goto out;
+		goto err;
 	}
 
 	/* Fill message */
@@ -126,31 +81,117 @@ void scmi_entry_smt(unsigned int channel_id, uint32_t *payload_buf)
 
 	/* Update message length with the length of the response message */
 	smt_hdr->length = msg.out_size_out + sizeof(smt_hdr->message_header);
+	smt_hdr->status |= SMT_STATUS_FREE;
+	return;
+
+err:
+	DMSG("SCMI error");
+	smt_hdr->status |= SMT_STATUS_ERROR | SMT_STATUS_FREE;
+}
+
+/*
+ * The slots of a ring are used in turn by the agent, the messages are
+ * processed in the same order from the slot following the last one
+ * processed, until a free slot is found.
+ */
+static void process_smt_ring(struct scmi_msg_channel *channel,
+			     unsigned int channel_id, uint32_t *payload_buf)
+{
+	struct smt_header *smt_hdr = NULL;
+	size_t n = 0;
+
+	for (n = 0; n < channel->ring_slots; n++) {
+		smt_hdr = get_slot_hdr(channel, channel->ring_next);
+		if (READ_ONCE(smt_hdr->status) & SMT_STATUS_FREE)
+			break;
 
-	scmi_msg_release_channel(channel);
-	error = false;
+		process_smt_message(channel, channel_id, smt_hdr, payload_buf);
 
-out:
-	if (error) {
-		DMSG("SCMI error");
-		smt_hdr->status |= SMT_STATUS_ERROR | SMT_STATUS_FREE;
-	} else {
-		smt_hdr->status |= SMT_STATUS_FREE;
+		channel->ring_next++;
+		if (channel->ring_next == channel->ring_slots)
+			channel->ring_next = 0;
 	}
 }
 
+/*
+ * An entry finding a ring busy leaves its message to the owner of the
+ * channel. The owner checks the next slot again once it has released the
+ * channel, the full barriers make sure that either the owner sees the
+ * message or the other entry sees the channel released.
+ */
+static bool ring_has_pending(struct scmi_msg_channel *channel)
+{
+	struct smt_header *smt_hdr = NULL;
+
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	smt_hdr = get_slot_hdr(channel, READ_ONCE(channel->ring_next));
+
+	return !(READ_ONCE(smt_hdr->status) & SMT_STATUS_FREE);
+}
+
+void scmi_smt_process_channel(struct scmi_msg_channel *channel,
+			      unsigned int channel_id, uint32_t *payload_buf)
+{
+	struct smt_header *smt_hdr = channel_to_smt_hdr(channel);
+	bool ring = channel->ring_slots > 1;
+
+	if (!smt_hdr) {
+		DMSG("No shared buffer for channel ID %u", channel_id);
+		return;
+	}
+
+	do {
+		if (ring)
+			__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+		if (!scmi_msg_claim_channel(channel)) {
+			DMSG("SCMI channel %u busy", channel_id);
+			if (!ring)
+				smt_hdr->status |= SMT_STATUS_ERROR |
+						   SMT_STATUS_FREE;
+			return;
+		}
+
+		if (ring)
+			process_smt_ring(channel, channel_id, payload_buf);
+		else
+			process_smt_message(channel, channel_id, smt_hdr,
+					    payload_buf);
+
+		scmi_msg_release_channel(channel);
+	} while (ring && ring_has_pending(channel));
+}
+
+void scmi_entry_smt(unsigned int channel_id, uint32_t *payload_buf)
+{
+	struct scmi_msg_channel *channel = NULL;
+
+	channel = plat_scmi_get_channel(channel_id);
+	if (!channel) {
+		DMSG("Invalid channel ID %u", channel_id);
+		return;
+	}
+
+	scmi_smt_process_channel(channel, channel_id, payload_buf);
+}
+
 /* Init a SMT header for a shared memory buffer: state it a free/no-error */
 void scmi_smt_init_agent_channel(struct scmi_msg_channel *channel)
 {
 	struct smt_header *smt_header = channel_to_smt_hdr(channel);
+	size_t n = 0;
 
 	static_assert(SCMI_SEC_PAYLOAD_SIZE + sizeof(struct smt_header) <=
 		      SMT_BUF_SLOT_SIZE &&
 		      IS_ALIGNED(SCMI_SEC_PAYLOAD_SIZE, sizeof(uint32_t)));
 	assert(smt_header);
 
-	memset(smt_header, 0, sizeof(*smt_header));
-	smt_header->status = SMT_STATUS_FREE;
+	for (n = 0; n < MAX(channel->ring_slots, 1U); n++) {
+		smt_header = get_slot_hdr(channel, n);
+		memset(smt_header, 0, sizeof(*smt_header));
+		smt_header->status = SMT_STATUS_FREE;
+	}
+	channel->ring_next = 0;
 }
 
 void scmi_smt_set_shared_buffer(struct scmi_msg_channel *channel, void *base)
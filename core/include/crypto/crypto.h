@@ -118,6 +118,12 @@ struct rsa_keypair {
 	struct bignum *qp;	/* 1/q mod p */
 	struct bignum *dp;	/* d mod (p-1) */
 	struct bignum *dq;	/* d mod (q-1) */
+
+	/*
+	 * Values precomputed by the implementation on first use of the key,
+	 * see crypto_acipher_clear_rsa_precomp()
+	 */
+	void *precomp;
 };
 
 struct rsa_public_key {
@@ -196,6 +202,11 @@ TEE_Result crypto_acipher_alloc_rsa_public_key(struct rsa_public_key *s,
 				   size_t key_size_bits);
 void crypto_acipher_free_rsa_public_key(struct rsa_public_key *s);
 void crypto_acipher_free_rsa_keypair(struct rsa_keypair *s);
+/*
+ * Drop the values precomputed for @s, must be called when the components
+ * of the key are changed. Also done by crypto_acipher_free_rsa_keypair().
+ */
+void crypto_acipher_clear_rsa_precomp(struct rsa_keypair *s);
 TEE_Result crypto_acipher_alloc_dsa_keypair(struct dsa_keypair *s,
 				size_t key_size_bits);
 TEE_Result crypto_acipher_alloc_dsa_public_key(struct dsa_public_key *s,
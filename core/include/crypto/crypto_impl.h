@@ -518,6 +518,8 @@ void sw_crypto_acipher_free_rsa_public_key(struct rsa_public_key *s);
 
 void sw_crypto_acipher_free_rsa_keypair(struct rsa_keypair *s);
 
+void sw_crypto_acipher_clear_rsa_precomp(struct rsa_keypair *s);
+
 TEE_Result sw_crypto_acipher_gen_rsa_key(struct rsa_keypair *key,
 					 size_t key_size);
 
@@ -13,6 +13,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <tee_api_types.h>
 
 /* Minimum size expected for SMT based shared memory message buffers */
 #define SMT_BUF_SLOT_SIZE	U(128)
@@ -29,16 +30,68 @@ struct scmi_msg_channel;
  *
  * @shm_addr: Address of the shared memory for the SCMI channel
  * @shm_size: Byte size of the shared memory for the SCMI channel
- * @busy: True when channel is busy, flase when channel is free
+ * @ring_slots: Number of @shm_size bytes SMT buffers in the shared memory,
+ *	0 or 1 for a single SMT buffer
+ * @ring_next: Index of the SMT buffer of the next message of the ring
+ * @busy: Non-zero when channel is busy, zero when channel is free
  * @threaded: True is executed in a threaded context, false otherwise
+ *
+ * With @ring_slots > 1 the channel is a ring of SMT buffers. The agent
+ * posts messages in the buffers in turn and notifies the server once for
+ * several messages, the server processes all the pending messages in
+ * order on each notification. A buffer is pending when the agent has
+ * cleared its SMT_STATUS_FREE status bit.
  */
 struct scmi_msg_channel {
 	struct io_pa_va shm_addr;
 	size_t shm_size;
-	bool busy;
+	size_t ring_slots;
+	size_t ring_next;
+	unsigned int busy;
 	bool threaded;
 };
 
+/**
+ * struct smt_header - SMT formatted header for SMT base shared memory transfer
+ *
+ * @status: Bit flags, see SMT_STATUS_*
+ * @flags: Bit flags, see SMT_FLAG_*
+ * @length: Byte size of message payload (variable) + ::message_header (32bit)
+ * payload: SCMI message payload data
+ */
+struct smt_header {
+	uint32_t reserved0;
+	uint32_t status;
+	uint64_t reserved1;
+	uint32_t flags;
+	uint32_t length; /* message_header + payload */
+	uint32_t message_header;
+	uint32_t payload[];
+};
+
+/* Flag set in smt_header::status when SMT does not contain pending message */
+#define SMT_STATUS_FREE			BIT(0)
+/* Flag set in smt_header::status when SMT reports an error */
+#define SMT_STATUS_ERROR		BIT(1)
+
+/* Flag set in smt_header::flags when SMT uses interrupts */
+#define SMT_FLAG_INTR_ENABLED		BIT(1)
+
+/* Bit fields packed in smt_header::message_header */
+#define SMT_MSG_ID_MASK			GENMASK_32(7, 0)
+#define SMT_HDR_MSG_ID(_hdr)		((_hdr) & SMT_MSG_ID_MASK)
+
+#define SMT_MSG_TYPE_MASK		GENMASK_32(9, 8)
+#define SMT_HDR_TYPE_ID(_hdr)		(((_hdr) & SMT_MSG_TYPE_MASK) >> 8)
+
+#define SMT_MSG_PROT_ID_MASK		GENMASK_32(17, 10)
+#define SMT_HDR_PROT_ID(_hdr)		(((_hdr) & SMT_MSG_PROT_ID_MASK) >> 10)
+
+/* Message header of message @_msg_id of protocol @_prot_id */
+#define SMT_HDR(_prot_id, _msg_id) \
+	((SHIFT_U32((_prot_id), 10) & SMT_MSG_PROT_ID_MASK) | \
+	 ((_msg_id) & SMT_MSG_ID_MASK))
+
 #ifdef CFG_SCMI_MSG_SMT
 /*
  * Initialize SMT memory buffer, called by platform at init for each
@@ -56,6 +109,18 @@ void scmi_smt_init_agent_channel(struct scmi_msg_channel *channel);
  * @base: virtual address of the shared buffer or NULL to clear the reference
  */
 void scmi_smt_set_shared_buffer(struct scmi_msg_channel *channel, void *base);
+
+/*
+ * Process the pending SMT formatted messages of a channel which isn't
+ * returned by plat_scmi_get_channel(), for instance the channel of a
+ * secure agent. Called in a TEE thread execution context.
+ * This function depends on CFG_SCMI_MSG_SMT.
+ *
+ * @channel: SCMI channel with a SMT shared buffer
+ * @channel_id: SCMI channel ID the messages are processed for
+ */
+void scmi_smt_local_entry(struct scmi_msg_channel *channel,
+			  unsigned int channel_id);
 #else
 static inline
 void scmi_smt_init_agent_channel(struct scmi_msg_channel *channel __unused)
@@ -501,4 +566,39 @@ int32_t plat_scmi_perf_level_get(unsigned int channel_id,
  */
 int32_t plat_scmi_perf_level_set(unsigned int channel_id,
 				 unsigned int domain_id, unsigned int level);
+
+/*
+ * Notify completion of a level change requested to the domain
+ * @channel_id: SCMI channel ID
+ * @domain_id: SCMI performance domain ID
+ * @level: Target performance level
+ * @status: Compliant SCMI error code returned by plat_scmi_perf_level_set()
+ *
+ * With CFG_SCMI_MSG_PERF_DOMAIN_ASYNC, the agent is answered before the
+ * level is set. This function is called from a thread context once
+ * plat_scmi_perf_level_set() returns.
+ */
+void plat_scmi_perf_level_set_done(unsigned int channel_id,
+				   unsigned int domain_id, unsigned int level,
+				   int32_t status);
+
+#ifdef CFG_SCMI_MSG_PERF_DOMAIN
+/*
+ * Get the statistics of the performance domains
+ * @buf: Array of struct pta_stats_scmi_perf, one per domain
+ * @buf_size: Size of @buf [in], size used in @buf [out]
+ *
+ * Only the domains of the channels which received a performance domain
+ * message are reported. Returns TEE_ERROR_SHORT_BUFFER with the required
+ * size in @buf_size if @buf is NULL or too small, TEE_ERROR_ITEM_NOT_FOUND
+ * if there's no domain to report.
+ */
+TEE_Result scmi_perf_domain_stats(void *buf, size_t *buf_size);
+#else
+static inline TEE_Result scmi_perf_domain_stats(void *buf __unused,
+						size_t *buf_size __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+#endif
 #endif /* SCMI_MSG_H */
@@ -0,0 +1,50 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+#ifndef __KERNEL_CORE_PROF_H
+#define __KERNEL_CORE_PROF_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <tee_api_types.h>
+
+/*
+ * Sampling profiler for the TEE core
+ *
+ * The secure physical timer of each CPU periodically interrupts the CPU.
+ * The interrupted PC and, when a thread was interrupted, its unwound call
+ * stack are accounted in a preallocated per-CPU histogram of unique
+ * stacks, no memory is allocated while sampling.
+ */
+
+#ifdef CFG_CORE_PROF_SAMPLING
+/* Clears the histograms and starts sampling every @period_us */
+TEE_Result core_prof_start(uint32_t period_us);
+void core_prof_stop(void);
+
+/*
+ * Arms the timer of the current CPU if sampling has been started since the
+ * CPU last armed it. Called on entry of standard calls so that every CPU
+ * entering the secure world gets sampled.
+ */
+void core_prof_cpu_arm(void);
+
+/*
+ * core_prof_export() - Export histograms as collapsed stacks
+ * @cursor:	In: 0 or value returned by the previous call, out: position
+ *		to pass on next call, 0 when all lines are exported
+ * @buf:	Output text buffer
+ * @len:	In: size of @buf, out: number of bytes written
+ * @samples:	Total number of samples
+ * @lost:	Number of samples which didn't fit in the histograms
+ */
+TEE_Result core_prof_export(uint32_t *cursor, char *buf, size_t *len,
+			    uint32_t *samples, uint32_t *lost);
+#else
+static inline void core_prof_cpu_arm(void)
+{
+}
+#endif
+
+#endif /*__KERNEL_CORE_PROF_H*/
@@ -0,0 +1,112 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+#ifndef __KERNEL_DEFERRED_WORK_H
+#define __KERNEL_DEFERRED_WORK_H
+
+#include <sys/queue.h>
+#include <tee_api_types.h>
+#include <types_ext.h>
+
+/*
+ * Work deferred out of the latency path of the caller. Queued work items
+ * are run by the threads delivering the asynchronous notification bottom
+ * half, so they run in a thread context and may sleep. They run as a
+ * notification worker, after the drivers' bottom halves which they don't
+ * delay. Work queued before the asynchronous notifications are started
+ * runs with the first bottom half delivered once they are.
+ */
+struct deferred_work;
+
+typedef void (*deferred_work_fn)(struct deferred_work *w);
+
+/*
+ * struct deferred_work - Deferred work item
+ * @name:	Name of the work for the statistics
+ * @fn:		Function doing the work
+ * @data:	Private data for @fn
+ * @queued:	True while the work is queued
+ * @running:	True while @fn is called
+ * @queued_at:	Counter value when the work was queued
+ * @count:	Number of calls of @fn
+ * @ticks:	Counter ticks spent in @fn
+ * @max_ticks:	Longest call of @fn in counter ticks
+ * @max_latency_ticks: Longest wait in counter ticks from queuing to @fn
+ * @link:	Link in the queue
+ * @all_link:	Link in the list of all work items
+ */
+struct deferred_work {
+	const char *name;
+	deferred_work_fn fn;
+	void *data;
+	bool queued;
+	bool running;
+	uint64_t queued_at;
+	uint64_t count;
+	uint64_t ticks;
+	uint64_t max_ticks;
+	uint64_t max_latency_ticks;
+	TAILQ_ENTRY(deferred_work) link;
+	SLIST_ENTRY(deferred_work) all_link;
+};
+
+#ifdef CFG_DEFERRED_WORK
+/*
+ * deferred_work_init() - Initialize a work item
+ * @w:		Work item
+ * @name:	Name of the work item, used in statistics
+ * @fn:		Function doing the work
+ * @data:	Private data for @fn
+ */
+void deferred_work_init(struct deferred_work *w, const char *name,
+			deferred_work_fn fn, void *data);
+
+/*
+ * deferred_work_queue() - Queue a work item
+ * @w:		Work item
+ *
+ * May be called from an interrupt context. Queuing a work that is already
+ * queued has no effect, the work runs once. A work queued while running
+ * runs again once done, a work never runs concurrently with itself.
+ *
+ * Returns false if @w was already queued.
+ */
+bool deferred_work_queue(struct deferred_work *w);
+
+/*
+ * deferred_work_cancel() - Cancel a queued work item
+ * @w:		Work item
+ *
+ * Returns false if @w wasn't queued. @w may still be running.
+ */
+bool deferred_work_cancel(struct deferred_work *w);
+
+/*
+ * deferred_work_remove() - Remove a work item
+ * @w:		Work item
+ *
+ * Cancels @w and waits until it isn't running any longer, @w can be freed
+ * when returning. Must not be called from @w itself.
+ */
+void deferred_work_remove(struct deferred_work *w);
+
+/*
+ * deferred_work_stats() - Get the statistics of the work items
+ * @buf:	Array of struct pta_stats_work, one per work item
+ * @buf_size:	Size of @buf [in], size used in @buf [out]
+ *
+ * Returns TEE_ERROR_SHORT_BUFFER with the required size in @buf_size if
+ * @buf is NULL or too small, TEE_ERROR_ITEM_NOT_FOUND if there's no work
+ * item.
+ */
+TEE_Result deferred_work_stats(void *buf, size_t *buf_size);
+#else
+static inline TEE_Result deferred_work_stats(void *buf __unused,
+					     size_t *buf_size __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+#endif
+
+#endif /*__KERNEL_DEFERRED_WORK_H*/
@@ -0,0 +1,59 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+#ifndef __KERNEL_EVTRACE_H
+#define __KERNEL_EVTRACE_H
+
+#include <atomic.h>
+#include <pta_evtrace.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <tee_api_types.h>
+#include <util.h>
+
+/*
+ * Low overhead event tracer for the OP-TEE core.
+ *
+ * Static tracepoints record a struct pta_evtrace_entry in a ring buffer
+ * owned by the current CPU. Each ring buffer has a single producer, the
+ * CPU it belongs to with all exceptions masked, and a single consumer,
+ * serialized by evtrace_drain(). Indexes are exchanged with acquire/release
+ * semantics so no lock is taken on the recording side. When a ring buffer
+ * is full new events are dropped and counted.
+ */
+
+#ifdef CFG_CORE_EVTRACE
+extern unsigned int evtrace_mask;
+
+void __evtrace_record(unsigned int id, uint64_t arg0, uint64_t arg1);
+
+static inline void evtrace_record(unsigned int id, uint64_t arg0,
+				  uint64_t arg1)
+{
+	if (atomic_load_uint(&evtrace_mask) & BIT(id))
+		__evtrace_record(id, arg0, arg1);
+}
+
+/* Sets the mask of enabled PTA_EVTRACE_ID_*, optionally flushing buffers */
+void evtrace_set_mask(unsigned int mask, bool flush);
+
+/*
+ * evtrace_drain() - Move recorded events of a CPU into a buffer
+ * @cpu:	CPU index
+ * @ent:	Destination array
+ * @count:	In: capacity of @ent, out: number of entries moved
+ * @remaining:	Number of entries still in the ring buffer
+ * @dropped:	Number of entries dropped by @cpu since boot
+ */
+TEE_Result evtrace_drain(size_t cpu, struct pta_evtrace_entry *ent,
+			 size_t *count, size_t *remaining, size_t *dropped);
+#else
+static inline void evtrace_record(unsigned int id __unused,
+				  uint64_t arg0 __unused,
+				  uint64_t arg1 __unused)
+{
+}
+#endif
+
+#endif /*__KERNEL_EVTRACE_H*/
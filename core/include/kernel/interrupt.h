@@ -21,6 +21,13 @@
 /* Forward the interrupt to all CPUs except the current CPU */
 #define ITR_CPU_MASK_TO_OTHER_CPUS	BIT(30)
 
+/*
+ * Number of handler lists of an interrupt controller, the handlers of an
+ * interrupt are in the list indexed by the interrupt number modulo
+ * ITR_HANDLER_BUCKETS. Must be a power of 2.
+ */
+#define ITR_HANDLER_BUCKETS	16
+
 struct itr_handler;
 
 /*
@@ -28,13 +35,17 @@ struct itr_handler;
  *
  * @ops Operation callback functions
  * @name Controller name, for debug purpose
- * @handlers Registered handlers list head
+ * @handlers Registered handlers list heads, see ITR_HANDLER_BUCKETS
+ * @link Link in the list of controllers reported by interrupt_stats()
  * @dt_get_irq Device tree node parsing function
  */
 struct itr_chip {
 	const struct itr_ops *ops;
 	const char *name;
-	SLIST_HEAD(, itr_handler) handlers;
+	SLIST_HEAD(itr_handler_head, itr_handler) handlers[ITR_HANDLER_BUCKETS];
+#ifdef CFG_WITH_STATS
+	SLIST_ENTRY(itr_chip) link;
+#endif
 	/*
 	 * dt_get_irq - parse a device tree interrupt property
 	 *
@@ -106,6 +117,9 @@ typedef enum itr_return (*itr_handler_t)(struct itr_handler *h);
  * @data Private data for that interrupt handler
  * @chip Interrupt controller chip device
  * @link Reference in controller handler list
+ * @count Number of calls of the handler, with CFG_WITH_STATS
+ * @ticks Counter ticks spent in the handler, with CFG_WITH_STATS
+ * @max_ticks Longest call of the handler in counter ticks, with CFG_WITH_STATS
  */
 struct itr_handler {
 	size_t it;
@@ -114,6 +128,11 @@ struct itr_handler {
 	void *data;
 	struct itr_chip *chip;
 	SLIST_ENTRY(itr_handler) link;
+#ifdef CFG_WITH_STATS
+	uint64_t count;
+	uint64_t ticks;
+	uint64_t max_ticks;
+#endif
 };
 
 #define ITR_HANDLER(_chip, _itr_num, _flags, _fn, _priv) \
@@ -153,6 +172,19 @@ struct itr_chip *interrupt_get_main_chip(void);
 /* Retrieve main interrupt controller reference, or NULL on failure */
 struct itr_chip *interrupt_get_main_chip_may_fail(void);
 
+#ifdef CFG_WITH_STATS
+/*
+ * interrupt_stats() - Get the statistics of the interrupt handlers
+ * @buf:	Array of struct pta_stats_itr, one per registered handler
+ * @buf_size:	Size of @buf [in], size used in @buf [out]
+ *
+ * Returns TEE_ERROR_SHORT_BUFFER with the required size in @buf_size if
+ * @buf is NULL or too small, TEE_ERROR_ITEM_NOT_FOUND if there's no
+ * handler.
+ */
+TEE_Result interrupt_stats(void *buf, size_t *buf_size);
+#endif
+
 #ifdef CFG_DT
 /*
  * Get the DT interrupt property at @node. In the DT an interrupt property can
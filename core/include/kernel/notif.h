@@ -136,15 +136,36 @@ TEE_Result notif_send_sync(uint32_t value);
 
 /*
  * Called by device drivers.
+ *
+ * A worker registered with notif_register_worker() is a driver whose
+ * @yielding_cb may keep the thread for long. It only receives
+ * @NOTIF_EVENT_DO_BOTTOM_HALF, after the drivers and outside of their
+ * serialization so it delays neither them nor another bottom half
+ * delivered on another thread. A worker can't be unregistered.
+ *
+ * notif_bottom_half_gen() returns the number of bottom halves requested
+ * so far. A worker can compare it with the value it started with to leave
+ * early when another bottom half is due.
  */
 #if defined(CFG_CORE_ASYNC_NOTIF)
 void notif_register_driver(struct notif_driver *ndrv);
 void notif_unregister_driver(struct notif_driver *ndrv);
+void notif_register_worker(struct notif_driver *ndrv);
+unsigned int notif_bottom_half_gen(void);
 #else
 static inline void notif_register_driver(struct notif_driver *ndrv __unused)
 {
 }
 
+static inline void notif_register_worker(struct notif_driver *ndrv __unused)
+{
+}
+
+static inline unsigned int notif_bottom_half_gen(void)
+{
+	return 0;
+}
+
 static inline void notif_unregister_driver(struct notif_driver *ndrv __unused)
 {
 }
@@ -0,0 +1,49 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+#ifndef __KERNEL_PARALLEL_H
+#define __KERNEL_PARALLEL_H
+
+#include <tee_api_types.h>
+#include <types_ext.h>
+
+/*
+ * Callback running item @idx of a parallel_for() job. Items of a job must
+ * be independent of each other, they may run concurrently and in any
+ * order.
+ */
+typedef TEE_Result (*parallel_item_fn)(void *arg, size_t idx);
+
+/*
+ * parallel_for() - Run items 0 to @count - 1 with @fn
+ * @count:	Number of items
+ * @fn:		Item callback
+ * @arg:	Argument passed to @fn
+ *
+ * With CFG_CORE_PARALLEL_WORKERS=y the calling thread is helped by up to
+ * CFG_CORE_PARALLEL_MAX_WORKERS threads entering OP-TEE to do the
+ * asynchronous notification bottom half. Otherwise, or if the helpers
+ * don't show up in time, the items are run by the calling thread.
+ *
+ * No more items are started once an item has failed. Returns the error of
+ * the failed item with the lowest index, or TEE_SUCCESS. The result is
+ * the same however the items happened to be scheduled.
+ */
+#ifdef CFG_CORE_PARALLEL_WORKERS
+TEE_Result parallel_for(size_t count, parallel_item_fn fn, void *arg);
+#else
+static inline TEE_Result parallel_for(size_t count, parallel_item_fn fn,
+				      void *arg)
+{
+	TEE_Result res = TEE_SUCCESS;
+	size_t n = 0;
+
+	for (n = 0; n < count && !res; n++)
+		res = fn(arg, n);
+
+	return res;
+}
+#endif
+
+#endif /*__KERNEL_PARALLEL_H*/
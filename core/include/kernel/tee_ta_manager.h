@@ -93,6 +93,8 @@ struct tee_ta_session {
 	struct condvar lock_cv;	/* CV used to wait for lock */
 	short int lock_thread;	/* Id of thread holding the lock */
 	bool unlink;		/* True if session is to be unlinked */
+	/* Memory granted to the session, see user_ta_grant_shm() */
+	SLIST_HEAD(ta_shm_grant_head, ta_shm_grant) shm_grants;
 };
 
 /* Registered contexts */
@@ -142,6 +144,16 @@ struct tee_ta_session *tee_ta_get_session(uint32_t id, bool exclusive,
 
 void tee_ta_put_session(struct tee_ta_session *sess);
 
+/*
+ * Marks @ctx busy, waiting until it isn't entered any longer. Returns
+ * false if waiting would dead-lock. Does nothing for a TA_FLAG_CONCURRENT
+ * context.
+ */
+bool tee_ta_try_set_busy(struct tee_ta_ctx *ctx);
+
+/* Undoes a successful tee_ta_try_set_busy() */
+void tee_ta_clear_busy(struct tee_ta_ctx *ctx);
+
 #if defined(CFG_TA_GPROF_SUPPORT)
 void tee_ta_update_session_utime_suspend(void);
 void tee_ta_update_session_utime_resume(void);
@@ -0,0 +1,82 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+#ifndef __KERNEL_TIMER_WHEEL_H
+#define __KERNEL_TIMER_WHEEL_H
+
+#include <kernel/interrupt.h>
+#include <sys/queue.h>
+#include <tee_api_types.h>
+#include <types_ext.h>
+
+/*
+ * Timers with a resolution of CFG_TIMER_WHEEL_TICK_MS, driven by the
+ * secure physical timer of one CPU at a time. The timer only ticks while
+ * timers are pending. The wheel owns the secure physical timer, the
+ * generic_timer_*() functions aren't available with CFG_TIMER_WHEEL.
+ *
+ * The callback of a timer is called from the timer interrupt, it must
+ * not sleep. Work that can't be done there is deferred with a struct
+ * deferred_work queued by the callback.
+ */
+struct tw_timer;
+
+typedef void (*tw_timer_fn)(struct tw_timer *t);
+
+/*
+ * struct tw_timer - Timer
+ * @fn:		Callback, set by the user of the timer
+ * @data:	Private data for @fn, set by the user of the timer
+ * @expires:	Tick at which the timer expires
+ * @period:	Period in ticks, or 0 for a one-shot timer
+ * @slack:	Ticks the expiry can be delayed by to align it with others
+ * @pending:	True while the timer is in the wheel
+ * @link:	Link in a slot of the wheel
+ */
+struct tw_timer {
+	tw_timer_fn fn;
+	void *data;
+	uint64_t expires;
+	uint32_t period;
+	uint32_t slack;
+	bool pending;
+	TAILQ_ENTRY(tw_timer) link;
+};
+
+#ifdef CFG_TIMER_WHEEL
+/*
+ * timer_wheel_init() - Drive the timers with the secure physical timer
+ * @chip:	Interrupt controller of the timer interrupt
+ * @itr_num:	Timer interrupt number, a PPI enabled by the wheel on the
+ *		CPU it's driven by
+ *
+ * Called once by the platform.
+ */
+TEE_Result timer_wheel_init(struct itr_chip *chip, size_t itr_num);
+
+/*
+ * tw_timer_start() - Start a timer
+ * @t:		Timer
+ * @delay_ms:	Time until the timer expires
+ * @period_ms:	Period of the timer once expired, or 0 for a one-shot timer
+ * @slack_ms:	Time the expiries of the timer can be delayed by
+ *
+ * The expiries are aligned on multiples of @slack_ms, so timers with a
+ * slack expire together instead of in successive ticks. A pending timer
+ * is restarted.
+ */
+void tw_timer_start(struct tw_timer *t, uint32_t delay_ms, uint32_t period_ms,
+		    uint32_t slack_ms);
+
+/*
+ * tw_timer_stop() - Stop a timer
+ * @t:		Timer
+ *
+ * The callback of the timer may still be running on another CPU when
+ * returning.
+ */
+void tw_timer_stop(struct tw_timer *t);
+#endif
+
+#endif /*__KERNEL_TIMER_WHEEL_H*/
@@ -31,6 +31,10 @@ struct ts_session {
 	 * syscalls to store handlers of opened TA/SP binaries.
 	 */
 	void *user_ctx;
+#if defined(CFG_TA_CONCURRENT)
+	/* Invocation state used while entered in a concurrent TA */
+	struct user_mode_thread *umt;
+#endif
 	bool (*handle_scall)(struct thread_scall_regs *regs);
 };
 
@@ -7,10 +7,34 @@
 #ifndef __KERNEL_USER_MODE_CTX_STRUCT_H
 #define __KERNEL_USER_MODE_CTX_STRUCT_H
 
+#include <kernel/mutex.h>
 #include <kernel/tee_ta_manager.h>
 #include <kernel/thread.h>
 #include <mm/tee_mmu_types.h>
 
+/*
+ * struct user_mode_thread - state of one invocation of a concurrent TA
+ * @stack_ptr:		Stack pointer
+ * @vfp:		State of VFP registers
+ * @bbuf:		Bounce buffer for user buffers
+ * @bbuf_size:		Size of bounce buffer
+ * @bbuf_offs:		Offset to unused part of bounce buffer
+ * @pgt_gen:		Value of user_mode_ctx::pgt_gen when the translation
+ *			tables of the invocation were last set up
+ * @busy:		True while an invocation is using this state
+ */
+struct user_mode_thread {
+	vaddr_t stack_ptr;
+#if defined(CFG_WITH_VFP)
+	struct thread_user_vfp_state vfp;
+#endif
+	uint8_t *bbuf;
+	size_t bbuf_size;
+	size_t bbuf_offs;
+	unsigned long pgt_gen;
+	bool busy;
+};
+
 /*
  * struct user_mode_ctx - user mode context
  * @vm_info:		Virtual memory map of this context
@@ -30,6 +54,12 @@
  * @bbuf:		Bounce buffer for user buffers
  * @bbuf_size:		Size of bounce buffer
  * @bbuf_offs:		Offset to unused part of bounce buffer
+ * @threads:		Invocation states of a concurrent TA, or NULL
+ * @thread_count:	Number of elements in @threads
+ * @pgt_gen:		Incremented each time unused translation tables are
+ *			kept for other invocations of a concurrent TA
+ * @vm_mutex:		Protects @vm_info and @pgt_gen of a concurrent TA
+ * @ldelf_mutex:	Serializes calls into ldelf of a concurrent TA
  */
 struct user_mode_ctx {
 	struct vm_info vm_info;
@@ -55,6 +85,13 @@ struct user_mode_ctx {
 	uint8_t *bbuf;
 	size_t bbuf_size;
 	size_t bbuf_offs;
+#ifdef CFG_TA_CONCURRENT
+	struct user_mode_thread *threads;
+	size_t thread_count;
+	unsigned long pgt_gen;
+	struct mutex vm_mutex;
+	struct mutex ldelf_mutex;
+#endif
 };
 #endif /*__KERNEL_USER_MODE_CTX_STRUCT_H*/
 
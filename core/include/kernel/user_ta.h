@@ -31,6 +31,17 @@ SLIST_HEAD(load_seg_head, load_seg);
  * @ta_time_offs:	Time reference used by the TA
  * @uctx:		Generic user mode context
  * @ctx:		Generic TA context
+ * @running:		Number of invocations of a concurrent TA in progress
+ * @exclusive:		True while one invocation needs the TA for itself
+ * @release_pending:	True if the state of a panicked concurrent TA is to
+ *			be released by the last invocation leaving
+ * @obj_mu:		Serializes the invocations of a concurrent TA in
+ *			syscalls using @cryp_states, @objects or
+ *			@storage_enums, see user_ta_lock_objects()
+ * @store_version:	Version of the TA stores a preloaded instance was
+ *			loaded at, see user_ta_pool_store_version()
+ * @fbuf:		ftrace buffer of a preloaded instance, handed to the
+ *			session claiming it
  */
 struct user_ta_ctx {
 	struct tee_ta_session_head open_sessions;
@@ -40,6 +51,18 @@ struct user_ta_ctx {
 	void *ta_time_offs;
 	struct user_mode_ctx uctx;
 	struct tee_ta_ctx ta_ctx;
+#ifdef CFG_TA_CONCURRENT
+	size_t running;
+	bool exclusive;
+	bool release_pending;
+	struct mutex obj_mu;
+#endif
+#ifdef CFG_TA_INSTANCE_POOL
+	unsigned int store_version;
+#ifdef CFG_FTRACE_SUPPORT
+	struct ftrace_buf *fbuf;
+#endif
+#endif
 };
 
 #ifdef CFG_WITH_USER_TA
@@ -57,6 +80,118 @@ static inline struct user_ta_ctx *to_user_ta_ctx(struct ts_ctx *ctx)
 	return container_of(ctx, struct user_ta_ctx, ta_ctx.ts_ctx);
 }
 
+/*
+ * user_ta_begin_exclusive() - Keep other invocations out of a TA
+ * @utc:	User TA context, the calling invocation is one of its
+ *
+ * Used around operations which may not run in parallel with other
+ * invocations of a TA with TA_FLAG_CONCURRENT, like unmapping memory.
+ * Returns TEE_ERROR_BUSY if other invocations are in progress, otherwise
+ * new invocations wait until user_ta_end_exclusive() is called.
+ */
+#ifdef CFG_TA_CONCURRENT
+TEE_Result user_ta_begin_exclusive(struct user_ta_ctx *utc);
+void user_ta_end_exclusive(struct user_ta_ctx *utc);
+#else
+static inline TEE_Result
+user_ta_begin_exclusive(struct user_ta_ctx *utc __unused)
+{
+	return TEE_SUCCESS;
+}
+
+static inline void user_ta_end_exclusive(struct user_ta_ctx *utc __unused)
+{
+}
+#endif
+
+/*
+ * user_ta_lock_objects() - Keep other invocations out of the cryp states,
+ *			    objects and enumerators of a TA
+ * @utc:	User TA context, the calling invocation is one of its
+ *
+ * Held for the whole cryptographic or storage syscall, since an object or
+ * state found in a list is used after the lookup and may otherwise be
+ * freed under the caller by another invocation of a TA with
+ * TA_FLAG_CONCURRENT.
+ */
+#ifdef CFG_TA_CONCURRENT
+static inline void user_ta_lock_objects(struct user_ta_ctx *utc)
+{
+	mutex_lock(&utc->obj_mu);
+}
+
+static inline void user_ta_unlock_objects(struct user_ta_ctx *utc)
+{
+	mutex_unlock(&utc->obj_mu);
+}
+#else
+static inline void user_ta_lock_objects(struct user_ta_ctx *utc __unused)
+{
+}
+
+static inline void user_ta_unlock_objects(struct user_ta_ctx *utc __unused)
+{
+}
+#endif
+
+/*
+ * Pool of instances of multi instance TAs loaded ahead of time, see
+ * CFG_TA_INSTANCE_POOL.
+ *
+ * user_ta_pool_claim() - Returns a loaded instance of the TA @uuid which
+ *			  has never been entered, or NULL if none is ready
+ * user_ta_pool_add() - Keeps instances of the multi instance TA @uuid
+ *			loaded ahead of time
+ * user_ta_pool_flush() - Releases the instances of the TA @uuid, called
+ *			  when the TA has been replaced
+ * user_ta_pool_store_version() - Returns a counter updated each time a TA
+ *				  is replaced in a TA store
+ * user_ta_pool_stale() - Returns true if the claimed instance @utc was
+ *			  loaded before its TA was replaced, it's then
+ *			  counted as a miss instead of a hit
+ * user_ta_pool_get_stats() - Returns the number of sessions of the TA
+ *			      @uuid which found an instance in the pool and
+ *			      the number of those which didn't
+ */
+#ifdef CFG_TA_INSTANCE_POOL
+struct user_ta_ctx *user_ta_pool_claim(const TEE_UUID *uuid);
+void user_ta_pool_add(const TEE_UUID *uuid);
+void user_ta_pool_flush(const TEE_UUID *uuid);
+unsigned int user_ta_pool_store_version(void);
+bool user_ta_pool_stale(struct user_ta_ctx *utc);
+void user_ta_pool_get_stats(const TEE_UUID *uuid, uint32_t *hits,
+			    uint32_t *misses);
+
+/*
+ * Load an instance of the TA @uuid without opening a session, released
+ * with user_ta_destroy_instance()
+ */
+TEE_Result user_ta_create_instance(const TEE_UUID *uuid,
+				   struct user_ta_ctx **utc);
+void user_ta_destroy_instance(struct user_ta_ctx *utc);
+#else
+static inline struct user_ta_ctx *
+user_ta_pool_claim(const TEE_UUID *uuid __unused)
+{
+	return NULL;
+}
+
+static inline void user_ta_pool_add(const TEE_UUID *uuid __unused)
+{
+}
+
+static inline void user_ta_pool_flush(const TEE_UUID *uuid __unused)
+{
+}
+
+static inline void user_ta_pool_get_stats(const TEE_UUID *uuid __unused,
+					  uint32_t *hits, uint32_t *misses)
+{
+	*hits = 0;
+	*misses = 0;
+}
+#endif
+
 #ifdef CFG_WITH_USER_TA
 /*
  * Setup session context for a user TA
@@ -73,6 +208,29 @@ TEE_Result tee_ta_init_user_ta_session(const TEE_UUID *uuid,
  * @sess: Session for which to finalize user TA context
  */
 TEE_Result tee_ta_complete_user_ta_session(struct tee_ta_session *s);
+
+/*
+ * user_ta_grant_shm() - Map memory of a TA into the TA of a session
+ * @s:		Session of the TA to map the memory into
+ * @mobj:	Memory object of the memory, page aligned
+ * @offs:	Offset of the memory in @mobj, page aligned
+ * @len:	Length of the memory, page aligned
+ * @writeable:	True if the TA of @s may write to the memory
+ *
+ * The memory remains mapped until @s is closed. Memory references inside
+ * the memory passed to @s use the mapping instead of being mapped for the
+ * call. The mapping is in the context of the TA, so TAs with
+ * TA_FLAG_MULTI_SESSION are refused with TEE_ERROR_NOT_SUPPORTED as their
+ * other sessions would see it. TEE_ERROR_BUSY is returned if the TA
+ * can't be made busy to change its mappings without a dead-lock.
+ *
+ * Must be called with @s locked with tee_ta_get_session().
+ */
+TEE_Result user_ta_grant_shm(struct tee_ta_session *s, struct mobj *mobj,
+			     size_t offs, size_t len, bool writeable);
+
+/* Unmaps the memory granted to @s, called when @s is destroyed */
+void user_ta_release_shm_grants(struct tee_ta_session *s);
 #else
 static inline TEE_Result
 tee_ta_init_user_ta_session(const TEE_UUID *uuid __unused,
@@ -86,5 +244,18 @@ tee_ta_complete_user_ta_session(struct tee_ta_session *s __unused)
 {
 	return TEE_ERROR_GENERIC;
 }
+
+static inline TEE_Result
+user_ta_grant_shm(struct tee_ta_session *s __unused,
+		  struct mobj *mobj __unused, size_t offs __unused,
+		  size_t len __unused, bool writeable __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+
+static inline void
+user_ta_release_shm_grants(struct tee_ta_session *s __unused)
+{
+}
 #endif /*CFG_WITH_USER_TA*/
 #endif /*__KERNEL_USER_TA_H*/
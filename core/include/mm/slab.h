@@ -0,0 +1,141 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+#ifndef __MM_SLAB_H
+#define __MM_SLAB_H
+
+#include <assert.h>
+#include <kernel/spinlock.h>
+#include <malloc.h>
+#include <pta_stats.h>
+#include <string.h>
+#include <sys/queue.h>
+#include <types_ext.h>
+
+/* Flag to indicate that the cache should use nex_malloc instead of malloc */
+#define SLAB_NEXUS		BIT(0)
+/*
+ * Flag to carve the slabs from the heap instead of pages of tee_mm_sec_ddr,
+ * needed by the caches used to allocate from a tee_mm pool
+ */
+#define SLAB_HEAP		BIT(1)
+
+/* Number of free objects kept per CPU in front of the slabs of a cache */
+#define SLAB_MAGAZINE_SIZE	8
+
+struct slab;
+
+struct slab_magazine {
+	unsigned int count;
+	void *obj[SLAB_MAGAZINE_SIZE];
+};
+
+/*
+ * struct slab_cache - Cache of fixed size objects
+ * @name:	Name of the cache, for debug
+ * @obj_size:	Size of an object
+ * @flags:	SLAB_* flags
+ * @ctor:	Optional constructor, called once for each object when a new
+ *		slab is added to the cache
+ * @lock:	Protects the fields below
+ * @partial:	Slabs with both used and free objects
+ * @full:	Slabs with no free objects
+ * @empty:	Slabs with no used objects, at most one is kept
+ * @num_slabs:	Number of slabs allocated
+ * @in_use:	Number of objects allocated from the slabs, including those
+ *		held in the per-CPU magazines
+ * @max_in_use:	Tracks max value of @in_use
+ * @num_fail:	Number of failed allocations
+ * @registered:	True once the cache is in the list of caches
+ * @link:	Link in the list of caches
+ * @mag:	Per-CPU magazines of free objects
+ *
+ * Define with SLAB_CACHE_INITIALIZER(), the cache is set up on first use.
+ */
+struct slab_cache {
+	const char *name;
+	size_t obj_size;
+	uint32_t flags;
+	void (*ctor)(void *obj);
+	unsigned int lock;
+	LIST_HEAD(, slab) partial;
+	LIST_HEAD(, slab) full;
+	LIST_HEAD(, slab) empty;
+	size_t num_slabs;
+	size_t in_use;
+	size_t max_in_use;
+	size_t num_fail;
+	bool registered;
+	SLIST_ENTRY(slab_cache) link;
+	struct slab_magazine mag[CFG_TEE_CORE_NB_CORE];
+};
+
+#define SLAB_CACHE_INITIALIZER(_name, _size, _flags, _ctor) { \
+		.name = (_name), .obj_size = (_size), .flags = (_flags), \
+		.ctor = (_ctor), .lock = SPINLOCK_UNLOCK, \
+	}
+
+#ifdef CFG_CORE_SLAB
+/*
+ * slab_alloc() - Allocate an object
+ * @cache:	Cache to allocate from
+ *
+ * Returns an object in the state left by the constructor or by the
+ * previous user, or NULL on failure.
+ */
+void *slab_alloc(struct slab_cache *cache);
+
+/*
+ * slab_free() - Free an object
+ * @cache:	Cache the object was allocated from
+ * @obj:	Object to free, in its constructed state if the cache has a
+ *		constructor, NULL is ignored
+ */
+void slab_free(struct slab_cache *cache, void *obj);
+
+#ifdef CFG_WITH_STATS
+/* Stats of all caches, the objects are accounted in the slab pages */
+void slab_get_stats(struct pta_stats_alloc *stats);
+void slab_reset_stats(void);
+#endif
+#else
+static inline void *slab_alloc(struct slab_cache *cache)
+{
+	void *obj = NULL;
+
+	if (cache->flags & SLAB_NEXUS)
+		obj = nex_malloc(cache->obj_size);
+	else
+		obj = malloc(cache->obj_size);
+	if (obj && cache->ctor)
+		cache->ctor(obj);
+
+	return obj;
+}
+
+static inline void slab_free(struct slab_cache *cache, void *obj)
+{
+	if (cache->flags & SLAB_NEXUS)
+		nex_free(obj);
+	else
+		free(obj);
+}
+#endif
+
+/*
+ * slab_zalloc() - Allocate a zero-filled object
+ * @cache:	Cache without constructor to allocate from
+ */
+static inline void *slab_zalloc(struct slab_cache *cache)
+{
+	void *obj = slab_alloc(cache);
+
+	assert(!cache->ctor);
+	if (obj)
+		memset(obj, 0, cache->obj_size);
+
+	return obj;
+}
+
+#endif /*__MM_SLAB_H*/
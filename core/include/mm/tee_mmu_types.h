@@ -71,6 +71,11 @@
  * functions.
  */
 #define VM_FLAG_READONLY		BIT(4)
+/*
+ * Tags TA mappings of memory granted by another TA for the lifetime of a
+ * session, memory references inside them are passed without mapping.
+ */
+#define VM_FLAG_GRANTED			BIT(5)
 
 /*
  * Set of flags used by tee_mmu_is_vbuf_inside_ta_private() and
@@ -97,6 +102,10 @@ struct vm_region {
 	size_t size;
 	uint16_t attr; /* TEE_MATTR_* above */
 	uint16_t flags; /* VM_FLAGS_* above */
+#ifdef CFG_TA_CONCURRENT
+	/* Invocation owning a VM_FLAG_EPHEMERAL region, or NULL */
+	struct user_mode_thread *owner;
+#endif
 	TAILQ_ENTRY(vm_region) link;
 };
 
@@ -57,10 +57,44 @@ TEE_Result vm_set_prot(struct user_mode_ctx *uctx, vaddr_t va, size_t len,
 
 TEE_Result vm_unmap(struct user_mode_ctx *uctx, vaddr_t va, size_t len);
 
-/* Map parameters for a user TA */
+/*
+ * Map parameters for a user TA, @umt is the invocation of a concurrent TA
+ * the mappings are made for or NULL. Memory references passed to the core
+ * by other invocations aren't resolved to these mappings, but they share
+ * the translation tables of the TA so user mode can still access them.
+ */
 TEE_Result vm_map_param(struct user_mode_ctx *uctx, struct tee_ta_param *param,
-			void *param_va[TEE_NUM_PARAMS]);
-void vm_clean_param(struct user_mode_ctx *uctx);
+			void *param_va[TEE_NUM_PARAMS],
+			struct user_mode_thread *umt);
+void vm_clean_param(struct user_mode_ctx *uctx, struct user_mode_thread *umt);
+
+/*
+ * Keep the regions of @uctx from changing while they are looked up
+ * directly. Only needed for TAs with TA_FLAG_CONCURRENT.
+ */
+#ifdef CFG_TA_CONCURRENT
+void vm_read_lock(const struct user_mode_ctx *uctx);
+void vm_read_unlock(const struct user_mode_ctx *uctx);
+#else
+static inline void vm_read_lock(const struct user_mode_ctx *uctx __unused)
+{
+}
+
+static inline void vm_read_unlock(const struct user_mode_ctx *uctx __unused)
+{
+}
+#endif
+
+/* Returns the invocation of @uctx run by the current thread, if any */
+#ifdef CFG_TA_CONCURRENT
+struct user_mode_thread *vm_get_current_umt(const struct user_mode_ctx *uctx);
+#else
+static inline struct user_mode_thread *
+vm_get_current_umt(const struct user_mode_ctx *uctx __unused)
+{
+	return NULL;
+}
+#endif
 
 /*
  * User mode private memory is defined as user mode image static segment
@@ -355,6 +355,46 @@
  */
 #define OPTEE_RPC_SOCKET_IOCTL	U(5)
 
+/* Events of OPTEE_RPC_SOCKET_POLL */
+#define OPTEE_RPC_SOCKET_POLL_IN	BIT(0)
+#define OPTEE_RPC_SOCKET_POLL_OUT	BIT(1)
+#define OPTEE_RPC_SOCKET_POLL_ERR	BIT(2)
+#define OPTEE_RPC_SOCKET_POLL_HUP	BIT(3)
+
+/*
+ * Wait for events on several sockets
+ *
+ * memref[1] is an array of entries made of three 32-bit words: socket
+ * handle, requested OPTEE_RPC_SOCKET_POLL_* events and returned events.
+ * OPTEE_RPC_SOCKET_POLL_ERR and OPTEE_RPC_SOCKET_POLL_HUP are always
+ * returned when they occur.
+ *
+ * [in]     value[0].a	    OPTEE_RPC_SOCKET_POLL
+ * [in]     value[0].b	    TA instance id
+ * [in/out] memref[1]	    Array of entries
+ * [in]     value[2].a	    Timeout ms or OPTEE_RPC_SOCKET_TIMEOUT_*
+ * [out]    value[2].b	    Number of entries with returned events
+ */
+#define OPTEE_RPC_SOCKET_POLL	U(6)
+
+/*
+ * Receive several datagrams on socket
+ *
+ * Waits for the first datagram as OPTEE_RPC_SOCKET_RECV, then adds the
+ * datagrams already received until the buffer or the maximum number of
+ * datagrams is full. Each datagram is stored as a 32-bit length followed
+ * by the data, padded to a multiple of 4 bytes.
+ *
+ * [in]     value[0].a	    OPTEE_RPC_SOCKET_RECV_BATCH
+ * [in]     value[0].b	    TA instance id
+ * [in]     value[0].c	    Socket handle
+ * [out]    memref[1]	    Buffer to receive
+ * [in]     value[2].a	    Timeout ms or OPTEE_RPC_SOCKET_TIMEOUT_*
+ * [in]     value[2].b	    Maximum number of datagrams
+ * [out]    value[2].c	    Number of datagrams received
+ */
+#define OPTEE_RPC_SOCKET_RECV_BATCH	U(7)
+
 /* End of definition of protocol for command OPTEE_RPC_CMD_SOCKET */
 
 /*
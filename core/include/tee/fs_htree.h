@@ -163,6 +163,20 @@ TEE_Result tee_fs_htree_truncate(struct tee_fs_htree **ht, size_t block_num);
  */
 TEE_Result tee_fs_htree_write_block(struct tee_fs_htree **ht, size_t block_num,
 				    const void *block);
+
+/**
+ * tee_fs_htree_write_block_user() - encrypt and write a user data block
+ * @ht:		hash tree
+ * @block_num:	block number
+ * @block:	user pointer to a block of stor->block_size size, the caller
+ *		has checked that it can be read
+ *
+ * Same as tee_fs_htree_write_block() but @block is encrypted directly
+ * from user space.
+ */
+TEE_Result tee_fs_htree_write_block_user(struct tee_fs_htree **ht,
+					 size_t block_num, const void *block);
+
 /**
  * tee_fs_htree_write_block() - read and decrypt a data block from storage
  * @ht:		hash tree
@@ -174,4 +188,18 @@ TEE_Result tee_fs_htree_write_block(struct tee_fs_htree **ht, size_t block_num,
 TEE_Result tee_fs_htree_read_block(struct tee_fs_htree **ht, size_t block_num,
 				   void *block);
 
+/**
+ * tee_fs_htree_read_block_user() - read and decrypt a data block to user
+ * @ht:		hash tree
+ * @block_num:	block number
+ * @block:	user pointer to a block of stor->block_size size, the caller
+ *		has checked that it can be written and is TA private memory
+ *
+ * Same as tee_fs_htree_read_block() but @block is decrypted directly to
+ * user space. @block holds unauthenticated data until the block is
+ * authenticated, it's wiped if that fails.
+ */
+TEE_Result tee_fs_htree_read_block_user(struct tee_fs_htree **ht,
+					size_t block_num, void *block);
+
 #endif /*__TEE_FS_HTREE_H*/
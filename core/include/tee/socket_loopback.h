@@ -0,0 +1,34 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+/*
+ * Loopback stand-in for tee-supplicant serving OPTEE_RPC_CMD_SOCKET, see
+ * CFG_SOCKET_LOOPBACK
+ */
+
+#ifndef __TEE_SOCKET_LOOPBACK_H
+#define __TEE_SOCKET_LOOPBACK_H
+
+#include <compiler.h>
+#include <kernel/thread.h>
+#include <stddef.h>
+#include <tee_api_types.h>
+
+/*
+ * socket_loopback_rpc() - Serves an OPTEE_RPC_CMD_SOCKET request in place
+ * of tee-supplicant, @params are as passed to thread_rpc_cmd()
+ */
+#ifdef CFG_SOCKET_LOOPBACK
+TEE_Result socket_loopback_rpc(size_t num_params, struct thread_param *params);
+#else
+static inline TEE_Result
+socket_loopback_rpc(size_t num_params __unused,
+		    struct thread_param *params __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+#endif
+
+#endif /*__TEE_SOCKET_LOOPBACK_H*/
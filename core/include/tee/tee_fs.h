@@ -24,6 +24,7 @@ struct tee_fs_dirent {
 struct tee_fs_dir;
 struct tee_file_handle;
 struct tee_pobj;
+struct ts_session;
 
 /*
  * tee_fs implements a POSIX like secure file system with GP extension
@@ -50,6 +51,17 @@ struct tee_file_operations {
 	TEE_Result (*opendir)(const TEE_UUID *uuid, struct tee_fs_dir **d);
 	TEE_Result (*readdir)(struct tee_fs_dir *d, struct tee_fs_dirent **ent);
 	void (*closedir)(struct tee_fs_dir *d);
+
+	/*
+	 * Optional transactions, the changes made by @owner between
+	 * begin_tx() and commit_tx() are committed atomically. abort_tx()
+	 * drops them and does nothing if @owner has no transaction.
+	 * begin_tx() waits for the transaction of another session to end,
+	 * it returns TEE_ERROR_BUSY if that session has called @owner.
+	 */
+	TEE_Result (*begin_tx)(struct ts_session *owner);
+	TEE_Result (*commit_tx)(struct ts_session *owner);
+	void (*abort_tx)(struct ts_session *owner);
 };
 
 #ifdef CFG_REE_FS
@@ -74,4 +74,20 @@ TEE_Result syscall_wait(unsigned long timeout);
 TEE_Result syscall_get_time(unsigned long cat, TEE_Time *time);
 TEE_Result syscall_set_ta_time(const TEE_Time *time);
 
+#ifdef CFG_TA_CONCURRENT
+TEE_Result syscall_futex_wait(uint32_t *uaddr, unsigned long val,
+			      unsigned long flags);
+TEE_Result syscall_futex_wake(uint32_t *uaddr, unsigned long count);
+
+/* Wakes all threads of @ctx waiting in syscall_futex_wait() */
+void tee_svc_futex_wake_all(struct ts_ctx *ctx);
+
+/* Makes threads of @sess in syscall_futex_wait() check for cancellation */
+void tee_svc_futex_cancel(struct ts_session *sess);
+#else
+static inline void tee_svc_futex_cancel(struct ts_session *sess __unused)
+{
+}
+#endif
+
 #endif /* __TEE_TEE_SVC_H */
@@ -45,6 +45,19 @@ TEE_Result syscall_storage_next_enum(unsigned long obj_enum,
 				     struct utee_object_info *info,
 				     void *obj_id, uint64_t *len);
 
+TEE_Result syscall_storage_next_enum_batch(unsigned long obj_enum,
+					   struct utee_object_enum_entry *entries,
+					   uint64_t *count);
+
+/*
+ * Persistent Object Transaction Functions
+ */
+TEE_Result syscall_storage_tx_begin(unsigned long storage_id);
+
+TEE_Result syscall_storage_tx_commit(unsigned long storage_id);
+
+TEE_Result syscall_storage_tx_abort(unsigned long storage_id);
+
 /*
  * Data Stream Access Functions
  */
@@ -60,6 +73,7 @@ TEE_Result syscall_storage_obj_seek(unsigned long obj, int32_t offset,
 				    unsigned long whence);
 
 void tee_svc_storage_close_all_enum(struct user_ta_ctx *utc);
+void tee_svc_storage_abort_all_tx(struct ts_session *sess);
 TEE_Result tee_svc_storage_write_usage(struct tee_obj *o, uint32_t usage);
 
 void tee_svc_storage_init(void);
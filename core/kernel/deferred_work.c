@@ -0,0 +1,221 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#include <assert.h>
+#include <initcall.h>
+#include <kernel/deferred_work.h>
+#include <kernel/delay.h>
+#include <kernel/mutex.h>
+#include <kernel/notif.h>
+#include <kernel/spinlock.h>
+#include <pta_stats.h>
+#include <string_ext.h>
+#include <trace.h>
+#include <util.h>
+
+/* Protects the queue and the state and statistics of the work items */
+static unsigned int work_lock = SPINLOCK_UNLOCK;
+static TAILQ_HEAD(, deferred_work) work_queue =
+	TAILQ_HEAD_INITIALIZER(work_queue);
+
+/* Protects the list of all work items */
+static struct mutex all_mu = MUTEX_INITIALIZER;
+static struct condvar work_done_cv = CONDVAR_INITIALIZER;
+static SLIST_HEAD(, deferred_work) all_works =
+	SLIST_HEAD_INITIALIZER(all_works);
+
+void deferred_work_init(struct deferred_work *w, const char *name,
+			deferred_work_fn fn, void *data)
+{
+	assert(w && fn);
+
+	*w = (struct deferred_work){
+		.name = name,
+		.fn = fn,
+		.data = data,
+	};
+
+	mutex_lock(&all_mu);
+	SLIST_INSERT_HEAD(&all_works, w, all_link);
+	mutex_unlock(&all_mu);
+}
+
+bool deferred_work_queue(struct deferred_work *w)
+{
+	uint32_t exceptions = cpu_spin_lock_xsave(&work_lock);
+
+	if (w->queued) {
+		cpu_spin_unlock_xrestore(&work_lock, exceptions);
+		return false;
+	}
+	w->queued = true;
+	w->queued_at = barrier_read_counter_timer();
+	TAILQ_INSERT_TAIL(&work_queue, w, link);
+
+	cpu_spin_unlock_xrestore(&work_lock, exceptions);
+
+	notif_send_async(NOTIF_VALUE_DO_BOTTOM_HALF);
+
+	return true;
+}
+
+bool deferred_work_cancel(struct deferred_work *w)
+{
+	uint32_t exceptions = cpu_spin_lock_xsave(&work_lock);
+	bool queued = w->queued;
+
+	if (queued) {
+		TAILQ_REMOVE(&work_queue, w, link);
+		w->queued = false;
+	}
+
+	cpu_spin_unlock_xrestore(&work_lock, exceptions);
+
+	return queued;
+}
+
+static bool is_running(struct deferred_work *w)
+{
+	uint32_t exceptions = cpu_spin_lock_xsave(&work_lock);
+	bool running = w->running;
+
+	cpu_spin_unlock_xrestore(&work_lock, exceptions);
+
+	return running;
+}
+
+void deferred_work_remove(struct deferred_work *w)
+{
+	mutex_lock(&all_mu);
+
+	deferred_work_cancel(w);
+	while (is_running(w))
+		condvar_wait(&work_done_cv, &all_mu);
+	SLIST_REMOVE(&all_works, w, deferred_work, all_link);
+
+	mutex_unlock(&all_mu);
+}
+
+/* Returns the first queued work which isn't already running */
+static struct deferred_work *claim_work(void)
+{
+	uint32_t exceptions = cpu_spin_lock_xsave(&work_lock);
+	struct deferred_work *w = NULL;
+
+	TAILQ_FOREACH(w, &work_queue, link) {
+		if (!w->running) {
+			TAILQ_REMOVE(&work_queue, w, link);
+			w->queued = false;
+			w->running = true;
+			break;
+		}
+	}
+
+	cpu_spin_unlock_xrestore(&work_lock, exceptions);
+
+	return w;
+}
+
+static void run_works(void)
+{
+	struct deferred_work *w = NULL;
+	uint32_t exceptions = 0;
+	uint64_t latency = 0;
+	uint64_t start = 0;
+	uint64_t t = 0;
+
+	while ((w = claim_work())) {
+		start = barrier_read_counter_timer();
+		latency = start - w->queued_at;
+
+		w->fn(w);
+
+		t = barrier_read_counter_timer() - start;
+
+		exceptions = cpu_spin_lock_xsave(&work_lock);
+		w->count++;
+		w->ticks += t;
+		w->max_ticks = MAX(w->max_ticks, t);
+		w->max_latency_ticks = MAX(w->max_latency_ticks, latency);
+		w->running = false;
+		cpu_spin_unlock_xrestore(&work_lock, exceptions);
+
+		mutex_lock(&all_mu);
+		condvar_broadcast(&work_done_cv);
+		mutex_unlock(&all_mu);
+	}
+}
+
+static void get_work_stats(struct deferred_work *w, struct pta_stats_work *st)
+{
+	uint32_t exceptions = cpu_spin_lock_xsave(&work_lock);
+
+	*st = (struct pta_stats_work){
+		.count = w->count,
+		.total_us = timer_cnt2us(w->ticks),
+		.max_us = MIN(timer_cnt2us(w->max_ticks), (uint64_t)UINT32_MAX),
+		.max_latency_us = MIN(timer_cnt2us(w->max_latency_ticks),
+				      (uint64_t)UINT32_MAX),
+	};
+
+	cpu_spin_unlock_xrestore(&work_lock, exceptions);
+
+	if (w->name)
+		strlcpy(st->name, w->name, sizeof(st->name));
+}
+
+TEE_Result deferred_work_stats(void *buf, size_t *buf_size)
+{
+	struct pta_stats_work *stats = buf;
+	TEE_Result res = TEE_SUCCESS;
+	struct deferred_work *w = NULL;
+	size_t count = 0;
+
+	if (!buf_size)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	mutex_lock(&all_mu);
+
+	SLIST_FOREACH(w, &all_works, all_link)
+		count++;
+
+	if (!count) {
+		res = TEE_ERROR_ITEM_NOT_FOUND;
+	} else if (!buf || *buf_size < count * sizeof(*stats)) {
+		*buf_size = count * sizeof(*stats);
+		res = TEE_ERROR_SHORT_BUFFER;
+	} else if (!IS_ALIGNED_WITH_TYPE(buf, uint64_t)) {
+		res = TEE_ERROR_BAD_PARAMETERS;
+	} else {
+		count = 0;
+		SLIST_FOREACH(w, &all_works, all_link)
+			get_work_stats(w, stats + count++);
+		*buf_size = count * sizeof(*stats);
+	}
+
+	mutex_unlock(&all_mu);
+
+	return res;
+}
+
+static void work_notif(struct notif_driver *ndrv __unused, enum notif_event ev)
+{
+	if (ev == NOTIF_EVENT_DO_BOTTOM_HALF)
+		run_works();
+	else
+		EMSG("Unknown event %d", (int)ev);
+}
+
+static struct notif_driver work_notif_worker = {
+	.yielding_cb = work_notif,
+};
+
+static TEE_Result deferred_work_service_init(void)
+{
+	notif_register_worker(&work_notif_worker);
+
+	return TEE_SUCCESS;
+}
+service_init(deferred_work_service_init);
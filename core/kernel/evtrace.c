@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#include <atomic.h>
+#include <compiler.h>
+#include <kernel/delay.h>
+#include <kernel/evtrace.h>
+#include <kernel/misc.h>
+#include <kernel/mutex.h>
+#include <kernel/thread.h>
+#include <string.h>
+#include <util.h>
+
+#define EVTRACE_NUM_ENTRIES	CFG_CORE_EVTRACE_NUM_ENTRIES
+#define EVTRACE_IDX_MASK	(EVTRACE_NUM_ENTRIES - 1)
+
+static_assert(IS_POWER_OF_TWO(EVTRACE_NUM_ENTRIES));
+static_assert(PTA_EVTRACE_ID_COUNT <= 32);
+
+/*
+ * struct evtrace_ring - Per-CPU ring buffer
+ * @head:	Index of the next entry to record, only written by the CPU
+ *		owning the ring buffer
+ * @tail:	Index of the oldest recorded entry, only written by
+ *		evtrace_drain()
+ * @dropped:	Number of entries which didn't fit in the ring buffer
+ * @ent:	Recorded entries
+ *
+ * @head and @tail are free running, the number of buffered entries is
+ * @head - @tail.
+ */
+struct evtrace_ring {
+	unsigned int head;
+	unsigned int tail;
+	unsigned int dropped;
+	struct pta_evtrace_entry ent[EVTRACE_NUM_ENTRIES];
+};
+
+unsigned int evtrace_mask __nex_bss;
+static struct evtrace_ring evtrace_rings[CFG_TEE_CORE_NB_CORE] __nex_bss;
+static struct mutex evtrace_mu __nex_data = MUTEX_INITIALIZER;
+
+void __noprof __evtrace_record(unsigned int id, uint64_t arg0, uint64_t arg1)
+{
+	uint32_t exceptions = thread_mask_exceptions(THREAD_EXCP_ALL);
+	size_t pos = get_core_pos();
+	struct evtrace_ring *r = evtrace_rings + pos;
+	struct pta_evtrace_entry *e = NULL;
+	unsigned int head = r->head;
+	short int thread_id = 0;
+
+	if (head - atomic_load_acquire_uint(&r->tail) >= EVTRACE_NUM_ENTRIES) {
+		atomic_store_uint(&r->dropped, r->dropped + 1);
+		goto out;
+	}
+
+	thread_id = thread_get_id_may_fail();
+
+	e = r->ent + (head & EVTRACE_IDX_MASK);
+	e->timestamp = barrier_read_counter_timer();
+	e->arg0 = arg0;
+	e->arg1 = arg1;
+	e->id = id;
+	if (thread_id == THREAD_ID_INVALID)
+		e->thread_id = PTA_EVTRACE_NO_THREAD;
+	else
+		e->thread_id = thread_id;
+	e->cpu = pos;
+	e->reserved = 0;
+
+	/* Publish the entry to evtrace_drain() */
+	atomic_store_release_uint(&r->head, head + 1);
+out:
+	thread_unmask_exceptions(exceptions);
+}
+
+void evtrace_set_mask(unsigned int mask, bool flush)
+{
+	size_t n = 0;
+
+	mutex_lock(&evtrace_mu);
+
+	atomic_store_uint(&evtrace_mask, mask & PTA_EVTRACE_MASK_ALL);
+
+	if (flush) {
+		for (n = 0; n < ARRAY_SIZE(evtrace_rings); n++)
+			atomic_store_release_uint(&evtrace_rings[n].tail,
+						  atomic_load_acquire_uint(
+							&evtrace_rings[n].head));
+	}
+
+	mutex_unlock(&evtrace_mu);
+}
+
+TEE_Result evtrace_drain(size_t cpu, struct pta_evtrace_entry *ent,
+			 size_t *count, size_t *remaining, size_t *dropped)
+{
+	struct evtrace_ring *r = NULL;
+	unsigned int head = 0;
+	unsigned int tail = 0;
+	size_t avail = 0;
+	size_t idx = 0;
+	size_t n = 0;
+
+	if (cpu >= ARRAY_SIZE(evtrace_rings))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	r = evtrace_rings + cpu;
+
+	mutex_lock(&evtrace_mu);
+
+	head = atomic_load_acquire_uint(&r->head);
+	tail = r->tail;
+	avail = head - tail;
+	n = MIN(avail, *count);
+
+	/* Copy in at most two chunks, the ring buffer may wrap */
+	idx = tail & EVTRACE_IDX_MASK;
+	if (idx + n > EVTRACE_NUM_ENTRIES) {
+		size_t sz = EVTRACE_NUM_ENTRIES - idx;
+
+		memcpy(ent, r->ent + idx, sz * sizeof(*ent));
+		memcpy(ent + sz, r->ent, (n - sz) * sizeof(*ent));
+	} else {
+		memcpy(ent, r->ent + idx, n * sizeof(*ent));
+	}
+
+	/* Hand the slots back to the producer */
+	atomic_store_release_uint(&r->tail, tail + n);
+
+	mutex_unlock(&evtrace_mu);
+
+	*count = n;
+	*remaining = avail - n;
+	*dropped = atomic_load_uint(&r->dropped);
+
+	return TEE_SUCCESS;
+}
@@ -3,12 +3,16 @@
  * Copyright (c) 2016-2019, Linaro Limited
  */
 
+#include <kernel/delay.h>
 #include <kernel/dt.h>
 #include <kernel/interrupt.h>
 #include <kernel/panic.h>
 #include <libfdt.h>
 #include <mm/core_memprot.h>
+#include <pta_stats.h>
 #include <stdlib.h>
+#include <string.h>
+#include <string_ext.h>
 #include <trace.h>
 #include <assert.h>
 
@@ -22,12 +26,32 @@
 
 static struct itr_chip *itr_main_chip __nex_bss;
 
+#ifdef CFG_WITH_STATS
+static SLIST_HEAD(, itr_chip) itr_chips __nex_data =
+	SLIST_HEAD_INITIALIZER(itr_chips);
+#endif
+
+static_assert(IS_POWER_OF_TWO(ITR_HANDLER_BUCKETS));
+
+static struct itr_handler_head *get_handlers(struct itr_chip *chip,
+					     size_t itr_num)
+{
+	return chip->handlers + (itr_num & (ITR_HANDLER_BUCKETS - 1));
+}
+
 TEE_Result itr_chip_init(struct itr_chip *chip)
 {
+	size_t n = 0;
+
 	if (!itr_chip_is_valid(chip))
 		return TEE_ERROR_BAD_PARAMETERS;
 
-	SLIST_INIT(&chip->handlers);
+	for (n = 0; n < ITR_HANDLER_BUCKETS; n++)
+		SLIST_INIT(chip->handlers + n);
+
+#ifdef CFG_WITH_STATS
+	SLIST_INSERT_HEAD(&itr_chips, chip, link);
+#endif
 
 	return TEE_SUCCESS;
 }
@@ -76,6 +100,28 @@ void __weak __noreturn interrupt_main_handler(void)
 	panic("Secure interrupt handler not defined");
 }
 
+static enum itr_return call_handler(struct itr_handler *h)
+{
+#ifdef CFG_WITH_STATS
+	uint64_t t = barrier_read_counter_timer();
+	enum itr_return res = h->handler(h);
+
+	/*
+	 * An interrupt isn't delivered again before it's handled, there's
+	 * no concurrent update of the statistics.
+	 */
+	t = barrier_read_counter_timer() - t;
+	h->count++;
+	h->ticks += t;
+	if (t > h->max_ticks)
+		h->max_ticks = t;
+
+	return res;
+#else
+	return h->handler(h);
+#endif
+}
+
 /*
  * Interrupt controller chip support
  */
@@ -86,9 +132,9 @@ void interrupt_call_handlers(struct itr_chip *chip, size_t itr_num)
 
 	assert(chip);
 
-	SLIST_FOREACH(h, &chip->handlers, link) {
+	SLIST_FOREACH(h, get_handlers(chip, itr_num), link) {
 		if (h->it == itr_num) {
-			if (h->handler(h) == ITRR_HANDLED)
+			if (call_handler(h) == ITRR_HANDLED)
 				was_handled = true;
 			else if (!(h->flags & ITRF_SHARED))
 				break;
@@ -118,7 +164,7 @@ static TEE_Result add_configure_handler(struct itr_handler *hdl,
 	assert(hdl && hdl->chip->ops && is_unpaged(hdl) &&
 	       hdl->handler && is_unpaged(hdl->handler));
 
-	SLIST_FOREACH(h, &hdl->chip->handlers, link) {
+	SLIST_FOREACH(h, get_handlers(hdl->chip, hdl->it), link) {
 		if (h->it == hdl->it &&
 		    (!(hdl->flags & ITRF_SHARED) ||
 		     !(h->flags & ITRF_SHARED))) {
@@ -131,7 +177,7 @@ static TEE_Result add_configure_handler(struct itr_handler *hdl,
 	if (configure)
 		interrupt_configure(hdl->chip, hdl->it, type, prio);
 
-	SLIST_INSERT_HEAD(&hdl->chip->handlers, hdl, link);
+	SLIST_INSERT_HEAD(get_handlers(hdl->chip, hdl->it), hdl, link);
 
 	return TEE_SUCCESS;
 }
@@ -176,13 +222,15 @@ TEE_Result interrupt_create_handler(struct itr_chip *itr_chip, size_t itr_num,
 
 void interrupt_remove_handler(struct itr_handler *hdl)
 {
+	struct itr_handler_head *head = NULL;
 	struct itr_handler *h = NULL;
 	bool disable_itr = true;
 
 	if (!hdl)
 		return;
 
-	SLIST_FOREACH(h, &hdl->chip->handlers, link)
+	head = get_handlers(hdl->chip, hdl->it);
+	SLIST_FOREACH(h, head, link)
 		if (h == hdl)
 			break;
 	if (!h) {
@@ -192,7 +240,7 @@ void interrupt_remove_handler(struct itr_handler *hdl)
 	}
 
 	if (hdl->flags & ITRF_SHARED) {
-		SLIST_FOREACH(h, &hdl->chip->handlers, link) {
+		SLIST_FOREACH(h, head, link) {
 			if (h != hdl && h->it == hdl->it) {
 				disable_itr = false;
 				break;
@@ -203,7 +251,7 @@ void interrupt_remove_handler(struct itr_handler *hdl)
 	if (disable_itr)
 		interrupt_disable(hdl->chip, hdl->it);
 
-	SLIST_REMOVE(&hdl->chip->handlers, hdl, itr_handler, link);
+	SLIST_REMOVE(head, hdl, itr_handler, link);
 }
 
 TEE_Result interrupt_alloc_add_conf_handler(struct itr_chip *chip,
@@ -242,6 +290,65 @@ void interrupt_remove_free_handler(struct itr_handler *hdl)
 	}
 }
 
+#ifdef CFG_WITH_STATS
+static void get_handler_stats(struct itr_handler *h, struct pta_stats_itr *st)
+{
+	*st = (struct pta_stats_itr){
+		.itr_num = h->it,
+		.flags = h->flags,
+		.max_us = MIN(timer_cnt2us(h->max_ticks), (uint64_t)UINT32_MAX),
+		.count = h->count,
+		.total_us = timer_cnt2us(h->ticks),
+	};
+	if (h->chip->name)
+		strlcpy(st->chip_name, h->chip->name, sizeof(st->chip_name));
+}
+
+TEE_Result interrupt_stats(void *buf, size_t *buf_size)
+{
+	struct pta_stats_itr *stats = buf;
+	struct itr_handler *h = NULL;
+	struct itr_chip *chip = NULL;
+	size_t count = 0;
+	size_t max = 0;
+	size_t n = 0;
+
+	if (!buf_size)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	SLIST_FOREACH(chip, &itr_chips, link)
+		for (n = 0; n < ITR_HANDLER_BUCKETS; n++)
+			SLIST_FOREACH(h, chip->handlers + n, link)
+				count++;
+
+	if (!count)
+		return TEE_ERROR_ITEM_NOT_FOUND;
+	if (!buf || *buf_size < count * sizeof(*stats)) {
+		*buf_size = count * sizeof(*stats);
+		return TEE_ERROR_SHORT_BUFFER;
+	}
+	if (!IS_ALIGNED_WITH_TYPE(buf, uint64_t))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	/* Handlers added since @buf was sized are left out */
+	max = count;
+	count = 0;
+	SLIST_FOREACH(chip, &itr_chips, link) {
+		for (n = 0; n < ITR_HANDLER_BUCKETS; n++) {
+			SLIST_FOREACH(h, chip->handlers + n, link) {
+				if (count == max)
+					goto out;
+				get_handler_stats(h, stats + count++);
+			}
+		}
+	}
+out:
+	*buf_size = count * sizeof(*stats);
+
+	return TEE_SUCCESS;
+}
+#endif
+
 #ifdef CFG_DT
 TEE_Result interrupt_register_provider(const void *fdt, int node,
 				       itr_dt_get_func dt_get_itr, void *data)
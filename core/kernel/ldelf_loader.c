@@ -8,11 +8,13 @@
 #include <assert.h>
 #include <kernel/ldelf_loader.h>
 #include <kernel/ldelf_syscalls.h>
+#include <kernel/mutex.h>
 #include <kernel/scall.h>
 #include <kernel/user_access.h>
 #include <ldelf.h>
 #include <mm/mobj.h>
 #include <mm/vm.h>
+#include <stdlib.h>
 
 #define BOUNCE_BUFFER_SIZE	4096
 
@@ -46,6 +48,80 @@ static TEE_Result alloc_and_map_fobj(struct user_mode_ctx *uctx, size_t sz,
 	return res;
 }
 
+#ifdef CFG_TA_CONCURRENT
+/*
+ * Sets up the invocation states of a TA with TA_FLAG_CONCURRENT, the
+ * first uses the stack of the main thread and the others the stacks
+ * mapped by ldelf.
+ */
+static TEE_Result init_threads(struct user_mode_ctx *uctx,
+			       const struct ldelf_arg *arg)
+{
+	struct user_mode_thread *umt = NULL;
+	TEE_Result res = TEE_SUCCESS;
+	vaddr_t bb_addr = 0;
+	size_t n = 0;
+
+	umt = calloc(CFG_TA_CONCURRENT_MAX_THREADS, sizeof(*umt));
+	if (!umt)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	uctx->threads = umt;
+	uctx->thread_count = CFG_TA_CONCURRENT_MAX_THREADS;
+
+	for (n = 0; n < uctx->thread_count; n++) {
+		if (n)
+			umt[n].stack_ptr = arg->thread_stack_ptr[n - 1];
+		else
+			umt[n].stack_ptr = arg->stack_ptr;
+		if (!umt[n].stack_ptr)
+			return TEE_ERROR_BAD_FORMAT;
+
+		bb_addr = 0;
+		res = alloc_and_map_fobj(uctx, BOUNCE_BUFFER_SIZE,
+					 TEE_MATTR_PRW, 0, &bb_addr);
+		if (res)
+			return res;
+		umt[n].bbuf = (void *)bb_addr;
+		umt[n].bbuf_size = BOUNCE_BUFFER_SIZE;
+	}
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result ldelf_lock(struct user_mode_ctx *uctx)
+{
+	/*
+	 * Another invocation of a concurrent TA is using ldelf, waiting
+	 * could dead-lock if that invocation is waiting for this one.
+	 */
+	if (uctx->threads && !mutex_trylock(&uctx->ldelf_mutex))
+		return TEE_ERROR_BUSY;
+
+	return TEE_SUCCESS;
+}
+
+static void ldelf_unlock(struct user_mode_ctx *uctx)
+{
+	if (uctx->threads)
+		mutex_unlock(&uctx->ldelf_mutex);
+}
+#else
+static TEE_Result init_threads(struct user_mode_ctx *uctx __unused,
+			       const struct ldelf_arg *arg __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+
+static TEE_Result ldelf_lock(struct user_mode_ctx *uctx __unused)
+{
+	return TEE_SUCCESS;
+}
+
+static void ldelf_unlock(struct user_mode_ctx *uctx __unused)
+{
+}
+#endif
+
 /*
  * This function may leave a few mappings behind on error, but that's taken
  * care of by tee_ta_init_user_ta_session() since the entire context is
@@ -162,8 +238,20 @@ TEE_Result ldelf_init_with_ldelf(struct ts_session *sess,
 		 * This is already checked by the elf loader, but since it runs
 		 * in user mode we're not trusting it entirely.
 		 */
-		if (arg_bbuf->flags & ~TA_FLAGS_MASK)
-			return TEE_ERROR_BAD_FORMAT;
+		if (arg_bbuf->flags & ~TA_FLAGS_MASK) {
+			res = TEE_ERROR_BAD_FORMAT;
+			goto out;
+		}
+
+		/* Only honoured for user TAs when supported */
+		if (!IS_ENABLED(CFG_TA_CONCURRENT))
+			arg_bbuf->flags &= ~TA_FLAG_CONCURRENT;
+
+		if (arg_bbuf->flags & TA_FLAG_CONCURRENT) {
+			res = init_threads(uctx, arg_bbuf);
+			if (res)
+				goto out;
+		}
 
 		to_user_ta_ctx(uctx->ts_ctx)->ta_ctx.flags = arg_bbuf->flags;
 	}
@@ -179,12 +267,13 @@ TEE_Result ldelf_init_with_ldelf(struct ts_session *sess,
 #endif
 	uctx->dl_entry_func = arg_bbuf->dl_entry;
 
+out:
 	bb_free(arg_bbuf, sizeof(*arg));
 
-	return TEE_SUCCESS;
+	return res;
 }
 
-TEE_Result ldelf_dump_state(struct user_mode_ctx *uctx)
+static TEE_Result dump_state(struct user_mode_ctx *uctx)
 {
 	TEE_Result res = TEE_SUCCESS;
 	uaddr_t usr_stack = uctx->ldelf_stack_ptr;
@@ -197,6 +286,8 @@ TEE_Result ldelf_dump_state(struct user_mode_ctx *uctx)
 	size_t arg_size = 0;
 	size_t n = 0;
 
+	vm_read_lock(uctx);
+
 	TAILQ_FOREACH(r, &uctx->vm_info.regions, link)
 		if (r->attr & TEE_MATTR_URWX)
 			n++;
@@ -208,8 +299,10 @@ TEE_Result ldelf_dump_state(struct user_mode_ctx *uctx)
 	usr_stack -= arg_size;
 
 	arg = bb_alloc(arg_size);
-	if (!arg)
+	if (!arg) {
+		vm_read_unlock(uctx);
 		return TEE_ERROR_OUT_OF_MEMORY;
+	}
 	memset(arg, 0, arg_size);
 
 	arg->num_maps = n;
@@ -237,6 +330,8 @@ TEE_Result ldelf_dump_state(struct user_mode_ctx *uctx)
 		}
 	}
 
+	vm_read_unlock(uctx);
+
 	arg->is_32bit = uctx->is_32bit;
 #ifdef ARM32
 	arg->arm32.regs[0] = tsd->abort_regs.r0;
@@ -311,9 +406,21 @@ TEE_Result ldelf_dump_state(struct user_mode_ctx *uctx)
 	return res;
 }
 
+TEE_Result ldelf_dump_state(struct user_mode_ctx *uctx)
+{
+	TEE_Result res = ldelf_lock(uctx);
+
+	if (res)
+		return res;
+	res = dump_state(uctx);
+	ldelf_unlock(uctx);
+
+	return res;
+}
+
 #ifdef CFG_FTRACE_SUPPORT
-TEE_Result ldelf_dump_ftrace(struct user_mode_ctx *uctx,
-			     void *buf, size_t *blen)
+static TEE_Result dump_ftrace(struct user_mode_ctx *uctx, void *buf,
+			      size_t *blen)
 {
 	uaddr_t usr_stack = uctx->ldelf_stack_ptr;
 	TEE_Result res = TEE_SUCCESS;
@@ -365,10 +472,23 @@ TEE_Result ldelf_dump_ftrace(struct user_mode_ctx *uctx,
 
 	return res;
 }
+
+TEE_Result ldelf_dump_ftrace(struct user_mode_ctx *uctx,
+			     void *buf, size_t *blen)
+{
+	TEE_Result res = ldelf_lock(uctx);
+
+	if (res)
+		return res;
+	res = dump_ftrace(uctx, buf, blen);
+	ldelf_unlock(uctx);
+
+	return res;
+}
 #endif /*CFG_FTRACE_SUPPORT*/
 
-TEE_Result ldelf_dlopen(struct user_mode_ctx *uctx, TEE_UUID *uuid,
-			uint32_t flags)
+static TEE_Result dlopen(struct user_mode_ctx *uctx, TEE_UUID *uuid,
+			 uint32_t flags)
 {
 	uaddr_t usr_stack = uctx->ldelf_stack_ptr;
 	TEE_Result res = TEE_ERROR_GENERIC;
@@ -422,8 +542,21 @@ TEE_Result ldelf_dlopen(struct user_mode_ctx *uctx, TEE_UUID *uuid,
 	return res;
 }
 
-TEE_Result ldelf_dlsym(struct user_mode_ctx *uctx, TEE_UUID *uuid,
-		       const char *sym, size_t symlen, vaddr_t *val)
+TEE_Result ldelf_dlopen(struct user_mode_ctx *uctx, TEE_UUID *uuid,
+			uint32_t flags)
+{
+	TEE_Result res = ldelf_lock(uctx);
+
+	if (res)
+		return res;
+	res = dlopen(uctx, uuid, flags);
+	ldelf_unlock(uctx);
+
+	return res;
+}
+
+static TEE_Result dlsym(struct user_mode_ctx *uctx, TEE_UUID *uuid,
+			const char *sym, size_t symlen, vaddr_t *val)
 {
 	uaddr_t usr_stack = uctx->ldelf_stack_ptr;
 	TEE_Result res = TEE_ERROR_GENERIC;
@@ -475,3 +608,16 @@ TEE_Result ldelf_dlsym(struct user_mode_ctx *uctx, TEE_UUID *uuid,
 
 	return res;
 }
+
+TEE_Result ldelf_dlsym(struct user_mode_ctx *uctx, TEE_UUID *uuid,
+		       const char *sym, size_t symlen, vaddr_t *val)
+{
+	TEE_Result res = ldelf_lock(uctx);
+
+	if (res)
+		return res;
+	res = dlsym(uctx, uuid, sym, symlen, val);
+	ldelf_unlock(uctx);
+
+	return res;
+}
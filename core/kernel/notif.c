@@ -26,6 +26,10 @@ static unsigned int notif_lock = SPINLOCK_UNLOCK;
 SLIST_HEAD(notif_driver_head, notif_driver);
 static struct notif_driver_head notif_driver_head =
 	SLIST_HEAD_INITIALIZER(&notif_driver_head);
+static struct notif_driver_head notif_worker_head =
+	SLIST_HEAD_INITIALIZER(&notif_worker_head);
+/* Number of bottom halves requested so far */
+static unsigned int bottom_half_gen;
 
 static bitstr_t bit_decl(notif_values, NOTIF_ASYNC_VALUE_MAX + 1);
 static bitstr_t bit_decl(notif_alloc_values, NOTIF_ASYNC_VALUE_MAX + 1);
@@ -115,6 +119,8 @@ void notif_send_async(uint32_t value)
 
 	DMSG("0x%"PRIx32, value);
 	bit_set(notif_values, value);
+	if (value == NOTIF_VALUE_DO_BOTTOM_HALF)
+		bottom_half_gen++;
 	interrupt_raise_pi(itr_chip, CFG_CORE_ASYNC_NOTIF_GIC_INTID);
 
 	cpu_spin_unlock_xrestore(&notif_lock, old_itr_status);
@@ -219,6 +225,29 @@ void notif_register_driver(struct notif_driver *ndrv)
 	cpu_spin_unlock_xrestore(&it_lock, old_itr_status);
 }
 
+void notif_register_worker(struct notif_driver *ndrv)
+{
+	uint32_t old_itr_status = 0;
+
+	assert(ndrv->yielding_cb && !ndrv->atomic_cb);
+
+	old_itr_status = cpu_spin_lock_xsave(&notif_lock);
+	SLIST_INSERT_HEAD(&notif_worker_head, ndrv, link);
+	cpu_spin_unlock_xrestore(&notif_lock, old_itr_status);
+}
+
+unsigned int notif_bottom_half_gen(void)
+{
+	uint32_t old_itr_status = 0;
+	unsigned int gen = 0;
+
+	old_itr_status = cpu_spin_lock_xsave(&notif_lock);
+	gen = bottom_half_gen;
+	cpu_spin_unlock_xrestore(&notif_lock, old_itr_status);
+
+	return gen;
+}
+
 void notif_unregister_driver(struct notif_driver *ndrv)
 {
 	uint32_t old_itr_status = 0;
@@ -253,11 +282,33 @@ out:
 	cpu_spin_unlock_xrestore(&notif_lock, old_itr_status);
 }
 
+/*
+ * The workers are called outside of the serialization of the drivers, a
+ * worker is never unregistered so the list can be walked without holding
+ * the lock while calling.
+ */
+static void deliver_to_workers(void)
+{
+	uint32_t old_itr_status = 0;
+	struct notif_driver *nd = NULL;
+
+	old_itr_status = cpu_spin_lock_xsave(&notif_lock);
+
+	SLIST_FOREACH(nd, &notif_worker_head, link) {
+		cpu_spin_unlock_xrestore(&notif_lock, old_itr_status);
+		nd->yielding_cb(nd, NOTIF_EVENT_DO_BOTTOM_HALF);
+		old_itr_status = cpu_spin_lock_xsave(&notif_lock);
+	}
+
+	cpu_spin_unlock_xrestore(&notif_lock, old_itr_status);
+}
+
 void notif_deliver_event(enum notif_event ev)
 {
 	uint32_t old_itr_status = 0;
 	struct notif_driver *nd = NULL;
 	struct notif_driver *nd_tmp = NULL;
+	bool do_workers = false;
 
 	assert(ev == NOTIF_EVENT_DO_BOTTOM_HALF || ev == NOTIF_EVENT_STOPPED);
 
@@ -272,6 +323,8 @@ void notif_deliver_event(enum notif_event ev)
 
 	if (ev == NOTIF_EVENT_STOPPED)
 		notif_started = false;
+	else
+		do_workers = true;
 
 	SLIST_FOREACH_SAFE(nd, &notif_driver_head, link, nd_tmp) {
 		cpu_spin_unlock_xrestore(&notif_lock, old_itr_status);
@@ -290,6 +343,9 @@ void notif_deliver_event(enum notif_event ev)
 out:
 	cpu_spin_unlock_xrestore(&notif_lock, old_itr_status);
 	mutex_unlock(&notif_mutex);
+
+	if (do_workers)
+		deliver_to_workers();
 }
 #endif /*CFG_CORE_ASYNC_NOTIF*/
 
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#include <initcall.h>
+#include <kernel/mutex.h>
+#include <kernel/notif.h>
+#include <kernel/parallel.h>
+#include <trace.h>
+
+/*
+ * OP-TEE has no threads of its own, a thread only runs while the normal
+ * world is calling in. The helpers of a job are the threads delivering
+ * the asynchronous notification bottom half: the job is published in
+ * @cur_job and a bottom half is requested, the thread doing it claims
+ * items of the job until none is left. The calling thread claims items
+ * in the same way so the job completes even if no helper shows up.
+ *
+ * The helpers run as a notification worker, outside of the bottom half
+ * drivers. A helper leaves the job after its current item when another
+ * bottom half is requested, the thread is then given back to normal
+ * world which can deliver it.
+ */
+struct parallel_job {
+	parallel_item_fn fn;
+	void *arg;
+	size_t count;
+	size_t next;		/* Next item to claim */
+	size_t running;		/* Items claimed but not completed */
+	size_t helpers;		/* Helper threads working on the job */
+	size_t err_idx;		/* Lowest index of a failed item */
+	TEE_Result res;		/* Result of item @err_idx */
+};
+
+/* Protects the jobs and @cur_job */
+static struct mutex job_mu = MUTEX_INITIALIZER;
+static struct condvar job_cv = CONDVAR_INITIALIZER;
+static struct parallel_job *cur_job;
+
+/*
+ * Runs items of @job until none is left, called with job_mu held. A
+ * helper passes the bottom half generation @gen it started with.
+ */
+static void run_items(struct parallel_job *job, bool helper,
+		      unsigned int gen)
+{
+	TEE_Result res = TEE_SUCCESS;
+	size_t idx = 0;
+
+	while (job->next < job->count && !job->res) {
+		if (helper && notif_bottom_half_gen() != gen)
+			break;
+
+		idx = job->next++;
+		job->running++;
+
+		mutex_unlock(&job_mu);
+		res = job->fn(job->arg, idx);
+		mutex_lock(&job_mu);
+
+		job->running--;
+		if (res && idx < job->err_idx) {
+			job->err_idx = idx;
+			job->res = res;
+		}
+	}
+}
+
+TEE_Result parallel_for(size_t count, parallel_item_fn fn, void *arg)
+{
+	struct parallel_job job = {
+		.fn = fn,
+		.arg = arg,
+		.count = count,
+		.err_idx = SIZE_MAX,
+	};
+	bool published = false;
+
+	mutex_lock(&job_mu);
+
+	/* Only one job at a time is published, the others run alone */
+	if (!cur_job && count > 1 && notif_async_is_started()) {
+		cur_job = &job;
+		published = true;
+	}
+
+	if (published) {
+		mutex_unlock(&job_mu);
+		notif_send_async(NOTIF_VALUE_DO_BOTTOM_HALF);
+		mutex_lock(&job_mu);
+	}
+
+	run_items(&job, false, 0);
+
+	if (published)
+		cur_job = NULL;
+	/* The job lives on this stack, wait until the helpers are done */
+	while (job.running || job.helpers)
+		condvar_wait(&job_cv, &job_mu);
+
+	mutex_unlock(&job_mu);
+
+	return job.res;
+}
+
+static void parallel_help(void)
+{
+	unsigned int gen = notif_bottom_half_gen();
+	struct parallel_job *job = NULL;
+
+	mutex_lock(&job_mu);
+
+	job = cur_job;
+	if (job && job->helpers < CFG_CORE_PARALLEL_MAX_WORKERS) {
+		job->helpers++;
+		run_items(job, true, gen);
+		job->helpers--;
+		condvar_broadcast(&job_cv);
+	}
+
+	mutex_unlock(&job_mu);
+}
+
+static void parallel_notif(struct notif_driver *ndrv __unused,
+			   enum notif_event ev)
+{
+	if (ev == NOTIF_EVENT_DO_BOTTOM_HALF)
+		parallel_help();
+	else
+		EMSG("Unknown event %d", (int)ev);
+}
+
+static struct notif_driver parallel_notif_worker = {
+	.yielding_cb = parallel_notif,
+};
+
+static TEE_Result parallel_init(void)
+{
+	notif_register_worker(&parallel_notif_worker);
+
+	return TEE_SUCCESS;
+}
+service_init(parallel_init);
@@ -5,8 +5,10 @@
  */
 
 #include <assert.h>
+#include <config.h>
 #include <kernel/abort.h>
 #include <kernel/arch_scall.h>
+#include <kernel/evtrace.h>
 #include <kernel/ldelf_syscalls.h>
 #include <kernel/misc.h>
 #include <kernel/panic.h>
@@ -120,6 +122,17 @@ static const struct syscall_entry tee_syscall_table[] = {
 	SYSCALL_ENTRY(syscall_not_supported),
 	SYSCALL_ENTRY(syscall_not_supported),
 	SYSCALL_ENTRY(syscall_cache_operation),
+	SYSCALL_ENTRY(syscall_storage_next_enum_batch),
+	SYSCALL_ENTRY(syscall_storage_tx_begin),
+	SYSCALL_ENTRY(syscall_storage_tx_commit),
+	SYSCALL_ENTRY(syscall_storage_tx_abort),
+#ifdef CFG_TA_CONCURRENT
+	SYSCALL_ENTRY(syscall_futex_wait),
+	SYSCALL_ENTRY(syscall_futex_wake),
+#else
+	SYSCALL_ENTRY(syscall_not_supported),
+	SYSCALL_ENTRY(syscall_not_supported),
+#endif
 };
 
 /*
@@ -206,11 +219,36 @@ static syscall_t get_tee_syscall_func(size_t num)
 				 &sc_table[TEE_SCN_MAX].fn + 1);
 }
 
+/*
+ * Returns the context of the calling TA, locked with
+ * user_ta_lock_objects(), if syscall @num uses its cryp states, objects
+ * or enumerators
+ */
+static struct user_ta_ctx *lock_ta_objects(size_t num)
+{
+	struct user_ta_ctx *utc = NULL;
+
+	if (!IS_ENABLED(CFG_TA_CONCURRENT))
+		return NULL;
+
+	if ((num < TEE_SCN_CRYP_STATE_ALLOC ||
+	     num > TEE_SCN_CRYP_OBJ_GENERATE_KEY) &&
+	    num != TEE_SCN_STORAGE_ENUM_NEXT_BATCH)
+		return NULL;
+
+	utc = to_user_ta_ctx(ts_get_current_session()->ctx);
+	user_ta_lock_objects(utc);
+
+	return utc;
+}
+
 bool scall_handle_user_ta(struct thread_scall_regs *regs)
 {
+	struct user_ta_ctx *utc = NULL;
 	size_t scn = 0;
 	size_t max_args = 0;
 	syscall_t scf = NULL;
+	uint32_t ret = 0;
 
 	bb_reset();
 	scall_get_max_args(regs, &scn, &max_args);
@@ -226,9 +264,15 @@ bool scall_handle_user_ta(struct thread_scall_regs *regs)
 	scf = get_tee_syscall_func(scn);
 
 	ftrace_syscall_enter(scn);
+	evtrace_record(PTA_EVTRACE_ID_SYSCALL_ENTER, scn, 0);
 
-	scall_set_retval(regs, scall_do_call(regs, scf));
+	utc = lock_ta_objects(scn);
+	ret = scall_do_call(regs, scf);
+	if (utc)
+		user_ta_unlock_objects(utc);
+	scall_set_retval(regs, ret);
 
+	evtrace_record(PTA_EVTRACE_ID_SYSCALL_EXIT, scn, ret);
 	ftrace_syscall_leave();
 
 	/*
@@ -258,6 +302,7 @@ bool scall_handle_ldelf(struct thread_scall_regs *regs)
 	size_t scn = 0;
 	size_t max_args = 0;
 	syscall_t scf = NULL;
+	uint32_t ret = 0;
 
 	bb_reset();
 	scall_get_max_args(regs, &scn, &max_args);
@@ -273,9 +318,12 @@ bool scall_handle_ldelf(struct thread_scall_regs *regs)
 	scf = get_ldelf_syscall_func(scn);
 
 	ftrace_syscall_enter(scn);
+	evtrace_record(PTA_EVTRACE_ID_SYSCALL_ENTER, scn, 0);
 
-	scall_set_retval(regs, scall_do_call(regs, scf));
+	ret = scall_do_call(regs, scf);
+	scall_set_retval(regs, ret);
 
+	evtrace_record(PTA_EVTRACE_ID_SYSCALL_EXIT, scn, ret);
 	ftrace_syscall_leave();
 
 	/*
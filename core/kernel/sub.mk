@@ -5,6 +5,7 @@ srcs-y += assert.c
 srcs-y += console.c
 srcs-$(CFG_DT) += dt.c
 srcs-$(CFG_DT) += dt_driver.c
+srcs-$(CFG_CORE_EVTRACE) += evtrace.c
 srcs-y += pm.c
 srcs-y += handle.c
 srcs-y += interrupt.c
@@ -36,6 +37,8 @@ srcs-$(CFG_CORE_TPM_EVENT_LOG) += tpm.c
 srcs-y += initcall.c
 srcs-$(CFG_WITH_USER_TA) += user_access.c
 srcs-y += mutex.c
+srcs-$(CFG_CORE_PARALLEL_WORKERS) += parallel.c
+srcs-$(CFG_DEFERRED_WORK) += deferred_work.c
 srcs-$(CFG_LOCKDEP) += mutex_lockdep.c
 srcs-y += wait_queue.c
 srcs-y += notif.c
@@ -43,6 +46,7 @@ srcs-y += thread.c
 
 ifeq ($(CFG_WITH_USER_TA),y)
 srcs-y += user_ta.c
+srcs-$(CFG_TA_INSTANCE_POOL) += user_ta_pool.c
 srcs-$(CFG_REE_FS_TA) += ree_fs_ta.c
 srcs-$(CFG_EARLY_TA) += early_ta.c
 srcs-$(CFG_SECSTOR_TA) += secstor_ta.c
@@ -28,6 +28,7 @@
 #include <tee_api_types.h>
 #include <tee/entry_std.h>
 #include <tee/tee_obj.h>
+#include <tee/tee_svc.h>
 #include <tee/tee_svc_cryp.h>
 #include <tee/tee_svc_storage.h>
 #include <tee/tui.h>
@@ -127,7 +128,7 @@ static struct tee_ta_ctx *ts_to_ta_ctx(struct ts_ctx *ctx)
 	panic("bad context");
 }
 
-static bool tee_ta_try_set_busy(struct tee_ta_ctx *ctx)
+bool tee_ta_try_set_busy(struct tee_ta_ctx *ctx)
 {
 	bool rc = true;
 
@@ -172,7 +173,7 @@ static void tee_ta_set_busy(struct tee_ta_ctx *ctx)
 		panic();
 }
 
-static void tee_ta_clear_busy(struct tee_ta_ctx *ctx)
+void tee_ta_clear_busy(struct tee_ta_ctx *ctx)
 {
 	if (ctx->flags & TA_FLAG_CONCURRENT)
 		return;
@@ -311,6 +312,7 @@ static void destroy_session(struct tee_ta_session *s,
 #endif
 
 	tui_close_session(&s->ts_sess);
+	user_ta_release_shm_grants(s);
 	tee_ta_unlink_session(s, open_sessions);
 #if defined(CFG_TA_GPROF_SUPPORT)
 	free(s->ts_sess.sbuf);
@@ -904,6 +906,8 @@ static TEE_Result dump_ta_stats(struct tee_ta_dump_ctx *dump_ctx,
 		       sizeof(dump_ctx[i].uuid));
 		stats->panicked = dump_ctx[i].panicked;
 		stats->sess_num = dump_ctx[i].sess_num;
+		user_ta_pool_get_stats(&dump_ctx[i].uuid, &stats->pool_hits,
+				       &stats->pool_misses);
 
 		/* Find a session from dump context */
 		for (j = 0, sess = NULL; j < dump_ctx[i].sess_num && !sess; j++)
@@ -1002,6 +1006,7 @@ TEE_Result tee_ta_cancel_command(TEE_ErrorOrigin *err,
 		return TEE_ERROR_BAD_PARAMETERS; /* intentional generic error */
 
 	sess->cancel = true;
+	tee_svc_futex_cancel(&sess->ts_sess);
 	return TEE_SUCCESS;
 }
 
@@ -16,6 +16,7 @@
 #include <kernel/thread.h>
 #include <kernel/thread_private.h>
 #include <mm/mobj.h>
+#include <mm/slab.h>
 
 struct thread_ctx threads[CFG_NUM_THREADS];
 
@@ -625,6 +626,10 @@ static void clear_shm_cache_entry(struct thread_shm_cache_entry *ce)
 	ce->size = 0;
 }
 
+static struct slab_cache shm_cache_entry_cache =
+	SLAB_CACHE_INITIALIZER("thread_shm_cache_entry",
+			       sizeof(struct thread_shm_cache_entry), 0, NULL);
+
 static struct thread_shm_cache_entry *
 get_shm_cache_entry(enum thread_shm_cache_user user)
 {
@@ -635,7 +640,7 @@ get_shm_cache_entry(enum thread_shm_cache_user user)
 		if (ce->user == user)
 			return ce;
 
-	ce = calloc(1, sizeof(*ce));
+	ce = slab_zalloc(&shm_cache_entry_cache);
 	if (ce) {
 		ce->user = user;
 		SLIST_INSERT_HEAD(cache, ce, link);
@@ -707,6 +712,6 @@ void thread_rpc_shm_cache_clear(struct thread_shm_cache *cache)
 			break;
 		SLIST_REMOVE_HEAD(cache, link);
 		clear_shm_cache_entry(ce);
-		free(ce);
+		slab_free(&shm_cache_entry_cache, ce);
 	}
 }
@@ -16,7 +16,7 @@
 
 #define BB_ALIGNMENT	(sizeof(long) * 2)
 
-static struct user_mode_ctx *get_current_uctx(void)
+static struct ts_session *get_current_user_session(void)
 {
 	struct ts_session *s = ts_get_current_session();
 
@@ -31,9 +31,49 @@ static struct user_mode_ctx *get_current_uctx(void)
 			return NULL;
 	}
 
+	return s;
+}
+
+static struct user_mode_ctx *get_current_uctx(void)
+{
+	struct ts_session *s = get_current_user_session();
+
+	if (!s)
+		return NULL;
+
 	return to_user_mode_ctx(s->ctx);
 }
 
+/*
+ * Returns the bounce buffer of the current session, each invocation of a
+ * concurrent TA has its own.
+ */
+static bool get_current_bb(uint8_t **bbuf, size_t *bbuf_size,
+			   size_t **bbuf_offs)
+{
+	struct ts_session *s = get_current_user_session();
+	struct user_mode_ctx *uctx = NULL;
+
+	if (!s)
+		return false;
+
+#ifdef CFG_TA_CONCURRENT
+	if (s->umt) {
+		*bbuf = s->umt->bbuf;
+		*bbuf_size = s->umt->bbuf_size;
+		*bbuf_offs = &s->umt->bbuf_offs;
+		return true;
+	}
+#endif
+
+	uctx = to_user_mode_ctx(s->ctx);
+	*bbuf = uctx->bbuf;
+	*bbuf_size = uctx->bbuf_size;
+	*bbuf_offs = &uctx->bbuf_offs;
+
+	return true;
+}
+
 TEE_Result check_user_access(uint32_t flags, const void *uaddr, size_t len)
 {
 	struct user_mode_ctx *uctx = get_current_uctx();
@@ -129,22 +169,23 @@ static void maybe_untag_bb(void *buf, size_t sz)
 
 void *bb_alloc(size_t len)
 {
-	struct user_mode_ctx *uctx = get_current_uctx();
+	size_t *bbuf_offs = NULL;
+	uint8_t *bbuf = NULL;
+	size_t bbuf_size = 0;
 	size_t offs = 0;
 	void *bb = NULL;
 
-	if (uctx && !ADD_OVERFLOW(uctx->bbuf_offs, len, &offs) &&
-	    offs <= uctx->bbuf_size) {
-		bb = maybe_tag_bb(uctx->bbuf + uctx->bbuf_offs, len);
-		uctx->bbuf_offs = ROUNDUP(offs, BB_ALIGNMENT);
+	if (get_current_bb(&bbuf, &bbuf_size, &bbuf_offs) &&
+	    !ADD_OVERFLOW(*bbuf_offs, len, &offs) && offs <= bbuf_size) {
+		bb = maybe_tag_bb(bbuf + *bbuf_offs, len);
+		*bbuf_offs = ROUNDUP(offs, BB_ALIGNMENT);
 	}
 	return bb;
 }
 
-static void bb_free_helper(struct user_mode_ctx *uctx, vaddr_t bb, size_t len)
+static void bb_free_helper(vaddr_t bbuf, size_t *bbuf_offs, vaddr_t bb,
+			   size_t len)
 {
-	vaddr_t bbuf = (vaddr_t)uctx->bbuf;
-
 	if (bb >= bbuf && IS_ALIGNED(bb, BB_ALIGNMENT)) {
 		size_t prev_offs = bb - bbuf;
 
@@ -154,17 +195,20 @@ static void bb_free_helper(struct user_mode_ctx *uctx, vaddr_t bb, size_t len)
 		 */
 		maybe_untag_bb((void *)bb, len);
 
-		if (prev_offs + ROUNDUP(len, BB_ALIGNMENT) == uctx->bbuf_offs)
-			uctx->bbuf_offs = prev_offs;
+		if (prev_offs + ROUNDUP(len, BB_ALIGNMENT) == *bbuf_offs)
+			*bbuf_offs = prev_offs;
 	}
 }
 
 void bb_free(void *bb, size_t len)
 {
-	struct user_mode_ctx *uctx = get_current_uctx();
+	size_t *bbuf_offs = NULL;
+	uint8_t *bbuf = NULL;
+	size_t bbuf_size = 0;
 
-	if (uctx)
-		bb_free_helper(uctx, memtag_strip_tag_vaddr(bb), len);
+	if (get_current_bb(&bbuf, &bbuf_size, &bbuf_offs))
+		bb_free_helper((vaddr_t)bbuf, bbuf_offs,
+			       memtag_strip_tag_vaddr(bb), len);
 }
 
 void bb_free_wipe(void *bb, size_t len)
@@ -176,16 +220,18 @@ void bb_free_wipe(void *bb, size_t len)
 
 void bb_reset(void)
 {
-	struct user_mode_ctx *uctx = get_current_uctx();
+	size_t *bbuf_offs = NULL;
+	uint8_t *bbuf = NULL;
+	size_t bbuf_size = 0;
 
-	if (uctx) {
+	if (get_current_bb(&bbuf, &bbuf_size, &bbuf_offs)) {
 		/*
 		 * Only the part up to the offset have been allocated, so
 		 * no need to clear tags beyond that.
 		 */
-		maybe_untag_bb(uctx->bbuf, uctx->bbuf_offs);
+		maybe_untag_bb(bbuf, *bbuf_offs);
 
-		uctx->bbuf_offs = 0;
+		*bbuf_offs = 0;
 	}
 }
 
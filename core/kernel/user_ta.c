@@ -13,6 +13,7 @@
 #include <keep.h>
 #include <kernel/ldelf_loader.h>
 #include <kernel/linker.h>
+#include <kernel/mutex.h>
 #include <kernel/panic.h>
 #include <kernel/scall.h>
 #include <kernel/tee_misc.h>
@@ -150,6 +151,249 @@ static void dec_recursion(void)
 	tsd->syscall_recursion--;
 }
 
+#ifdef CFG_TA_CONCURRENT
+/*
+ * Protects the invocation states and the fields of struct user_ta_ctx
+ * tracking the invocations of TAs with TA_FLAG_CONCURRENT
+ */
+static struct mutex umt_mu = MUTEX_INITIALIZER;
+static struct condvar umt_cv = CONDVAR_INITIALIZER;
+
+static void release_utc_state(struct user_ta_ctx *utc);
+
+/* Returns true if the current thread already runs an invocation of @utc */
+static bool is_entered(struct user_ta_ctx *utc)
+{
+	struct ts_session *s = NULL;
+
+	TAILQ_FOREACH(s, &thread_get_tsd()->sess_stack, link_tsd)
+		if (s->ctx == &utc->ta_ctx.ts_ctx)
+			return true;
+
+	return false;
+}
+
+static struct user_mode_thread *find_free_thread(struct user_ta_ctx *utc)
+{
+	size_t n = 0;
+
+	if (utc->exclusive)
+		return NULL;
+
+	for (n = 0; n < utc->uctx.thread_count; n++)
+		if (!utc->uctx.threads[n].busy)
+			return utc->uctx.threads + n;
+
+	return NULL;
+}
+
+/*
+ * Claims an invocation state of a concurrent TA, waiting for one to be
+ * released if needed. @umt is set to NULL for other TAs.
+ */
+static TEE_Result claim_thread(struct user_ta_ctx *utc,
+			       struct user_mode_thread **umt)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	*umt = NULL;
+	if (!utc->uctx.threads)
+		return TEE_SUCCESS;
+
+	mutex_lock(&umt_mu);
+	while (true) {
+		if (utc->ta_ctx.panicked) {
+			res = TEE_ERROR_TARGET_DEAD;
+			break;
+		}
+		*umt = find_free_thread(utc);
+		if (*umt) {
+			(*umt)->busy = true;
+			(*umt)->bbuf_offs = 0;
+			utc->running++;
+			break;
+		}
+		/* Waiting for ourselves would dead-lock */
+		if (is_entered(utc)) {
+			res = TEE_ERROR_BUSY;
+			break;
+		}
+		condvar_wait(&umt_cv, &umt_mu);
+	}
+	mutex_unlock(&umt_mu);
+
+	return res;
+}
+
+static void release_thread(struct user_ta_ctx *utc,
+			   struct user_mode_thread *umt)
+{
+	bool do_release = false;
+
+	if (!umt)
+		return;
+
+	mutex_lock(&umt_mu);
+	umt->busy = false;
+	assert(utc->running);
+	utc->running--;
+	if (!utc->running && utc->release_pending) {
+		utc->release_pending = false;
+		do_release = true;
+	}
+	condvar_broadcast(&umt_cv);
+	mutex_unlock(&umt_mu);
+
+	if (do_release)
+		release_utc_state(utc);
+}
+
+/*
+ * Records the panic of an invocation, thread_enter_user_mode() clears
+ * the panicked state when returning normally so it can't be passed the
+ * shared fields of a concurrent TA.
+ */
+static void set_panicked(struct user_ta_ctx *utc, uint32_t panicked,
+			 uint32_t panic_code)
+{
+	if (!utc->uctx.threads) {
+		utc->ta_ctx.panicked = panicked;
+		utc->ta_ctx.panic_code = panic_code;
+		return;
+	}
+
+	if (!panicked)
+		return;
+
+	mutex_lock(&umt_mu);
+	if (!utc->ta_ctx.panicked) {
+		utc->ta_ctx.panicked = true;
+		utc->ta_ctx.panic_code = panic_code;
+	}
+	mutex_unlock(&umt_mu);
+
+	/* Other invocations waiting in the TA will not be woken otherwise */
+	tee_svc_futex_wake_all(&utc->ta_ctx.ts_ctx);
+}
+
+static void set_session_thread(struct ts_session *s,
+			       struct user_mode_thread *umt)
+{
+	s->umt = umt;
+}
+
+static void clear_vfp(struct user_ta_ctx *utc, struct user_mode_thread *umt)
+{
+#ifdef CFG_WITH_VFP
+	if (umt) {
+		thread_user_clear_vfp_state(&umt->vfp);
+		return;
+	}
+#endif
+	thread_user_clear_vfp(&utc->uctx);
+}
+
+static vaddr_t get_stack_ptr(struct user_ta_ctx *utc,
+			     struct user_mode_thread *umt)
+{
+	if (umt)
+		return umt->stack_ptr;
+
+	return utc->uctx.stack_ptr;
+}
+
+TEE_Result user_ta_begin_exclusive(struct user_ta_ctx *utc)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	if (!utc->uctx.threads)
+		return TEE_SUCCESS;
+
+	mutex_lock(&umt_mu);
+	if (utc->running > 1 || utc->exclusive)
+		res = TEE_ERROR_BUSY;
+	else
+		utc->exclusive = true;
+	mutex_unlock(&umt_mu);
+
+	return res;
+}
+
+void user_ta_end_exclusive(struct user_ta_ctx *utc)
+{
+	if (!utc->uctx.threads)
+		return;
+
+	mutex_lock(&umt_mu);
+	assert(utc->exclusive);
+	utc->exclusive = false;
+	condvar_broadcast(&umt_cv);
+	mutex_unlock(&umt_mu);
+}
+
+/*
+ * The state of a panicked concurrent TA is released when the last
+ * invocation has left, returns true if that's now.
+ */
+static bool can_release_now(struct user_ta_ctx *utc)
+{
+	bool ret = true;
+
+	if (!utc->uctx.threads)
+		return true;
+
+	mutex_lock(&umt_mu);
+	if (utc->running) {
+		utc->release_pending = true;
+		ret = false;
+	}
+	mutex_unlock(&umt_mu);
+
+	return ret;
+}
+#else
+static TEE_Result claim_thread(struct user_ta_ctx *utc __unused,
+			       struct user_mode_thread **umt)
+{
+	*umt = NULL;
+	return TEE_SUCCESS;
+}
+
+static void release_thread(struct user_ta_ctx *utc __unused,
+			   struct user_mode_thread *umt __unused)
+{
+}
+
+static void set_panicked(struct user_ta_ctx *utc, uint32_t panicked,
+			 uint32_t panic_code)
+{
+	utc->ta_ctx.panicked = panicked;
+	utc->ta_ctx.panic_code = panic_code;
+}
+
+static void set_session_thread(struct ts_session *s __unused,
+			       struct user_mode_thread *umt __unused)
+{
+}
+
+static void clear_vfp(struct user_ta_ctx *utc,
+		      struct user_mode_thread *umt __unused)
+{
+	thread_user_clear_vfp(&utc->uctx);
+}
+
+static vaddr_t get_stack_ptr(struct user_ta_ctx *utc,
+			     struct user_mode_thread *umt __unused)
+{
+	return utc->uctx.stack_ptr;
+}
+
+static bool can_release_now(struct user_ta_ctx *utc __unused)
+{
+	return true;
+}
+#endif
+
 static TEE_Result user_ta_enter(struct ts_session *session,
 				enum utee_entry_func func, uint32_t cmd)
 {
@@ -160,24 +404,31 @@ static TEE_Result user_ta_enter(struct ts_session *session,
 	struct tee_ta_session *ta_sess = to_ta_session(session);
 	struct ts_session *ts_sess __maybe_unused = NULL;
 	void *param_va[TEE_NUM_PARAMS] = { NULL };
+	struct user_mode_thread *umt = NULL;
+	uint32_t panic_code = 0;
+	uint32_t panicked = 0;
 
 	if (!inc_recursion()) {
 		/* Using this error code since we've run out of resources. */
 		res = TEE_ERROR_OUT_OF_MEMORY;
 		goto out_clr_cancel;
 	}
+	res = claim_thread(utc, &umt);
+	if (res)
+		goto out;
 	if (ta_sess->param) {
 		/* Map user space memory */
-		res = vm_map_param(&utc->uctx, ta_sess->param, param_va);
+		res = vm_map_param(&utc->uctx, ta_sess->param, param_va, umt);
 		if (res != TEE_SUCCESS)
-			goto out;
+			goto out_release_thread;
 	}
 
 	/* Switch to user ctx */
+	set_session_thread(session, umt);
 	ts_push_current_session(session);
 
 	/* Make room for usr_params at top of stack */
-	usr_stack = utc->uctx.stack_ptr;
+	usr_stack = get_stack_ptr(utc, umt);
 	usr_stack -= ROUNDUP(sizeof(struct utee_params), STACK_ALIGNMENT);
 	usr_params = (struct utee_params *)usr_stack;
 	if (ta_sess->param)
@@ -191,15 +442,20 @@ static TEE_Result user_ta_enter(struct ts_session *session,
 	res = thread_enter_user_mode(func, kaddr_to_uref(session),
 				     (vaddr_t)usr_params, cmd, usr_stack,
 				     utc->uctx.entry_func, utc->uctx.is_32bit,
-				     &utc->ta_ctx.panicked,
-				     &utc->ta_ctx.panic_code);
+				     &panicked, &panic_code);
 
-	thread_user_clear_vfp(&utc->uctx);
+	clear_vfp(utc, umt);
+	set_panicked(utc, panicked, panic_code);
+	/* A storage transaction doesn't outlive the invocation */
+	tee_svc_storage_abort_all_tx(session);
 
-	if (utc->ta_ctx.panicked) {
+	if (panicked) {
 		abort_print_current_ts();
 		DMSG("tee_user_ta_enter: TA panicked with code 0x%x",
-		     utc->ta_ctx.panic_code);
+		     panic_code);
+		res = TEE_ERROR_TARGET_DEAD;
+	} else if (utc->ta_ctx.panicked) {
+		/* Another invocation of a concurrent TA panicked */
 		res = TEE_ERROR_TARGET_DEAD;
 	} else {
 		/*
@@ -220,11 +476,14 @@ out_pop_session:
 		 * Clear out the parameter mappings added with
 		 * vm_clean_param() above.
 		 */
-		vm_clean_param(&utc->uctx);
+		vm_clean_param(&utc->uctx, umt);
 	}
 	ts_sess = ts_pop_current_session();
 	assert(ts_sess == session);
+	set_session_thread(session, NULL);
 
+out_release_thread:
+	release_thread(utc, umt);
 out:
 	dec_recursion();
 out_clr_cancel:
@@ -394,12 +653,19 @@ static void release_utc_state(struct user_ta_ctx *utc)
 static void free_utc(struct user_ta_ctx *utc)
 {
 	release_utc_state(utc);
+#ifdef CFG_TA_CONCURRENT
+	free(utc->uctx.threads);
+	mutex_destroy(&utc->obj_mu);
+#endif
 	free(utc);
 }
 
 static void user_ta_release_state(struct ts_ctx *ctx)
 {
-	release_utc_state(to_user_ta_ctx(ctx));
+	struct user_ta_ctx *utc = to_user_ta_ctx(ctx);
+
+	if (can_release_now(utc))
+		release_utc_state(utc);
 }
 
 static void user_ta_ctx_destroy(struct ts_ctx *ctx)
@@ -457,18 +723,11 @@ static TEE_Result check_ta_store(void)
 }
 service_init(check_ta_store);
 
-TEE_Result tee_ta_init_user_ta_session(const TEE_UUID *uuid,
-				       struct tee_ta_session *s)
+static TEE_Result alloc_utc(const TEE_UUID *uuid, struct user_ta_ctx **ret)
 {
 	TEE_Result res = TEE_SUCCESS;
 	struct user_ta_ctx *utc = NULL;
 
-	/*
-	 * Caller is expected to hold tee_ta_mutex for safe changes
-	 * in @s and registering of the context in tee_ctxes list.
-	 */
-	assert(mutex_is_locked(&tee_ta_mutex));
-
 	utc = calloc(1, sizeof(struct user_ta_ctx));
 	if (!utc)
 		return TEE_ERROR_OUT_OF_MEMORY;
@@ -477,6 +736,9 @@ TEE_Result tee_ta_init_user_ta_session(const TEE_UUID *uuid,
 	TAILQ_INIT(&utc->cryp_states);
 	TAILQ_INIT(&utc->objects);
 	TAILQ_INIT(&utc->storage_enums);
+#ifdef CFG_TA_CONCURRENT
+	mutex_init(&utc->obj_mu);
+#endif
 	condvar_init(&utc->ta_ctx.busy_cv);
 	utc->ta_ctx.ref_count = 1;
 
@@ -494,12 +756,149 @@ TEE_Result tee_ta_init_user_ta_session(const TEE_UUID *uuid,
 		return res;
 	}
 
-	utc->ta_ctx.is_initializing = true;
-
 #ifdef CFG_TA_PAUTH
 	crypto_rng_read(&utc->uctx.keys, sizeof(utc->uctx.keys));
 #endif
 
+	*ret = utc;
+	return TEE_SUCCESS;
+}
+
+static TEE_Result load_utc(struct ts_session *s, struct user_ta_ctx *utc)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	ts_push_current_session(s);
+
+	res = ldelf_load_ldelf(&utc->uctx);
+	if (!res)
+		res = ldelf_init_with_ldelf(s, &utc->uctx);
+
+	ts_pop_current_session();
+
+	return res;
+}
+
+#ifdef CFG_TA_INSTANCE_POOL
+TEE_Result user_ta_create_instance(const TEE_UUID *uuid,
+				   struct user_ta_ctx **utc_ret)
+{
+	struct tee_ta_session *s = NULL;
+	struct user_ta_ctx *utc = NULL;
+	TEE_Result res = TEE_SUCCESS;
+	unsigned int store_version = 0;
+
+	/*
+	 * Read before loading, should the TA be replaced in between the
+	 * instance is found stale when claimed instead of being served.
+	 */
+	store_version = user_ta_pool_store_version();
+
+	/* Loading the TA needs a session even if it's never entered */
+	s = calloc(1, sizeof(*s));
+	if (!s)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	s->lock_thread = THREAD_ID_INVALID;
+	s->ref_count = 1;
+
+	res = alloc_utc(uuid, &utc);
+	if (res)
+		goto out;
+
+	s->ts_sess.ctx = &utc->ta_ctx.ts_ctx;
+	s->ts_sess.handle_scall = s->ts_sess.ctx->ops->handle_scall;
+	res = load_utc(&s->ts_sess, utc);
+	if (res) {
+		user_ta_destroy_instance(utc);
+		goto out;
+	}
+
+	utc->store_version = store_version;
+#ifdef CFG_FTRACE_SUPPORT
+	/* Set up by ldelf in the session, kept for the claiming session */
+	utc->fbuf = s->ts_sess.fbuf;
+#endif
+
+	*utc_ret = utc;
+out:
+	free(s);
+	return res;
+}
+
+void user_ta_destroy_instance(struct user_ta_ctx *utc)
+{
+	condvar_destroy(&utc->ta_ctx.busy_cv);
+	free_utc(utc);
+}
+
+/*
+ * Completes the session @s with the preloaded instance it claimed. If
+ * the TA has been replaced since the claim, the instance is swapped for a
+ * new context to load as usual.
+ */
+static TEE_Result complete_pooled_session(struct tee_ta_session *s)
+{
+	struct user_ta_ctx *utc = to_user_ta_ctx(s->ts_sess.ctx);
+	struct user_ta_ctx *new_utc = NULL;
+	TEE_Result res = TEE_SUCCESS;
+
+	if (!user_ta_pool_stale(utc)) {
+#ifdef CFG_FTRACE_SUPPORT
+		s->ts_sess.fbuf = utc->fbuf;
+#endif
+		return TEE_SUCCESS;
+	}
+
+	DMSG("Preloaded instance of TA %pUl is stale",
+	     (void *)&utc->ta_ctx.ts_ctx.uuid);
+
+	res = alloc_utc(&utc->ta_ctx.ts_ctx.uuid, &new_utc);
+
+	mutex_lock(&tee_ta_mutex);
+	TAILQ_REMOVE(&tee_ctxes, &utc->ta_ctx, link);
+	if (res) {
+		s->ts_sess.ctx = NULL;
+	} else {
+		new_utc->ta_ctx.is_initializing = true;
+		s->ts_sess.ctx = &new_utc->ta_ctx.ts_ctx;
+		s->ts_sess.handle_scall = s->ts_sess.ctx->ops->handle_scall;
+		TAILQ_INSERT_TAIL(&tee_ctxes, &new_utc->ta_ctx, link);
+	}
+	mutex_unlock(&tee_ta_mutex);
+
+	user_ta_destroy_instance(utc);
+
+	return res;
+}
+#else
+static TEE_Result complete_pooled_session(struct tee_ta_session *s __unused)
+{
+	return TEE_SUCCESS;
+}
+#endif /*CFG_TA_INSTANCE_POOL*/
+
+TEE_Result tee_ta_init_user_ta_session(const TEE_UUID *uuid,
+				       struct tee_ta_session *s)
+{
+	TEE_Result res = TEE_SUCCESS;
+	struct user_ta_ctx *utc = NULL;
+
+	/*
+	 * Caller is expected to hold tee_ta_mutex for safe changes
+	 * in @s and registering of the context in tee_ctxes list.
+	 */
+	assert(mutex_is_locked(&tee_ta_mutex));
+
+	/* An instance from the pool is already loaded */
+	utc = user_ta_pool_claim(uuid);
+	if (!utc) {
+		res = alloc_utc(uuid, &utc);
+		if (res)
+			return res;
+
+		utc->ta_ctx.is_initializing = true;
+	}
+
 	assert(!mutex_trylock(&tee_ta_mutex));
 
 	s->ts_sess.ctx = &utc->ta_ctx.ts_ctx;
@@ -518,23 +917,29 @@ TEE_Result tee_ta_complete_user_ta_session(struct tee_ta_session *s)
 {
 	struct user_ta_ctx *utc = to_user_ta_ctx(s->ts_sess.ctx);
 	TEE_Result res = TEE_SUCCESS;
+	bool add_to_pool = false;
+
+	/* Only a preloaded instance is already initialized */
+	if (!utc->ta_ctx.is_initializing) {
+		res = complete_pooled_session(s);
+		if (res)
+			return res;
+		utc = to_user_ta_ctx(s->ts_sess.ctx);
+		if (!utc->ta_ctx.is_initializing)
+			return TEE_SUCCESS;
+	}
 
 	/*
 	 * We must not hold tee_ta_mutex while allocating page tables as
 	 * that may otherwise lead to a deadlock.
 	 */
-	ts_push_current_session(&s->ts_sess);
-
-	res = ldelf_load_ldelf(&utc->uctx);
-	if (!res)
-		res = ldelf_init_with_ldelf(&s->ts_sess, &utc->uctx);
-
-	ts_pop_current_session();
+	res = load_utc(&s->ts_sess, utc);
 
 	mutex_lock(&tee_ta_mutex);
 
 	if (!res) {
 		utc->ta_ctx.is_initializing = false;
+		add_to_pool = !(utc->ta_ctx.flags & TA_FLAG_SINGLE_INSTANCE);
 	} else {
 		s->ts_sess.ctx = NULL;
 		TAILQ_REMOVE(&tee_ctxes, &utc->ta_ctx, link);
@@ -547,5 +952,99 @@ TEE_Result tee_ta_complete_user_ta_session(struct tee_ta_session *s)
 
 	mutex_unlock(&tee_ta_mutex);
 
+	/* Preload the next instances of this multi instance TA */
+	if (add_to_pool)
+		user_ta_pool_add(&utc->ta_ctx.ts_ctx.uuid);
+
 	return res;
 }
+
+/* Maximum number of memory grants to a session */
+#define SHM_GRANTS_MAX	8
+
+struct ta_shm_grant {
+	vaddr_t va;
+	size_t len;
+	SLIST_ENTRY(ta_shm_grant) link;
+};
+
+TEE_Result user_ta_grant_shm(struct tee_ta_session *s, struct mobj *mobj,
+			     size_t offs, size_t len, bool writeable)
+{
+	uint32_t prot = TEE_MATTR_PR | TEE_MATTR_UR;
+	struct ts_ctx *ctx = s->ts_sess.ctx;
+	struct ta_shm_grant *g = NULL;
+	struct user_ta_ctx *utc = NULL;
+	TEE_Result res = TEE_SUCCESS;
+	size_t n = 0;
+
+	if (!ctx || !is_user_ta_ctx(ctx))
+		return TEE_ERROR_NOT_SUPPORTED;
+	utc = to_user_ta_ctx(ctx);
+	if (utc->ta_ctx.panicked)
+		return TEE_ERROR_TARGET_DEAD;
+	/* The mapping would be visible to the other sessions of the TA */
+	if (utc->ta_ctx.flags & TA_FLAG_MULTI_SESSION)
+		return TEE_ERROR_NOT_SUPPORTED;
+
+	SLIST_FOREACH(g, &s->shm_grants, link)
+		n++;
+	if (n >= SHM_GRANTS_MAX)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	g = calloc(1, sizeof(*g));
+	if (!g)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	if (writeable)
+		prot = TEE_MATTR_PRW | TEE_MATTR_URW;
+
+	/*
+	 * The TA must not run while its mappings change. A concurrent TA
+	 * may run, its mappings are protected by vm_lock() instead.
+	 */
+	if (!tee_ta_try_set_busy(&utc->ta_ctx)) {
+		free(g);
+		return TEE_ERROR_BUSY;
+	}
+	res = vm_map(&utc->uctx, &g->va, len, prot,
+		     VM_FLAG_SHAREABLE | VM_FLAG_GRANTED, mobj, offs);
+	tee_ta_clear_busy(&utc->ta_ctx);
+	if (res) {
+		free(g);
+		return res;
+	}
+	g->len = len;
+	SLIST_INSERT_HEAD(&s->shm_grants, g, link);
+
+	return TEE_SUCCESS;
+}
+
+void user_ta_release_shm_grants(struct tee_ta_session *s)
+{
+	struct ts_ctx *ctx = s->ts_sess.ctx;
+	struct ta_shm_grant *g = NULL;
+	bool do_unmap = false;
+
+	if (SLIST_EMPTY(&s->shm_grants))
+		return;
+
+	/*
+	 * A panicked context isn't used again, the mappings are removed
+	 * when it's destroyed.
+	 */
+	do_unmap = ctx && !to_ta_ctx(ctx)->panicked;
+	if (do_unmap)
+		ts_push_current_session(&s->ts_sess);
+
+	while ((g = SLIST_FIRST(&s->shm_grants))) {
+		SLIST_REMOVE_HEAD(&s->shm_grants, link);
+		if (do_unmap && vm_unmap(&to_user_ta_ctx(ctx)->uctx, g->va,
+					 g->len))
+			DMSG("Can't unmap granted memory at %#"PRIxVA, g->va);
+		free(g);
+	}
+
+	if (do_unmap)
+		ts_pop_current_session();
+}
@@ -0,0 +1,359 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#include <atomic.h>
+#include <initcall.h>
+#include <kernel/mutex.h>
+#include <kernel/notif.h>
+#include <kernel/tee_ta_manager.h>
+#include <kernel/user_ta.h>
+#include <mm/vm.h>
+#include <string.h>
+#include <trace.h>
+
+/*
+ * Opening a session of a multi instance TA loads a new instance with
+ * ldelf, this is done ahead of time for the TAs in the pool. A TA gets an
+ * entry in the pool when it's loaded the first time, the least recently
+ * used entry is recycled when all are taken. The instances are loaded by
+ * a notification worker, outside the drivers' bottom halves, until
+ * there are CFG_TA_INSTANCE_POOL_PER_TA of them or they would use more
+ * than CFG_TA_INSTANCE_POOL_TA_BUDGET bytes.
+ *
+ * TA_CreateEntryPoint() is still called when the first session of an
+ * instance is opened since it needs a session.
+ *
+ * The entries are looked up by UUID. When a TA is replaced
+ * user_ta_pool_flush() updates the store version and records it in the
+ * entry of the TA. A pooled instance loaded at an older version is
+ * evicted when the TA is claimed instead of being handed out, and an
+ * instance claimed just before the flush is found stale when its first
+ * session is opened. Both are counted as misses. The REE FS TA store
+ * isn't told when a TA file is replaced, such a TA is only picked up once
+ * its entry is flushed or recycled.
+ */
+struct pool_entry {
+	TEE_UUID uuid;
+	bool used;
+	struct tee_ta_ctx_head instances;
+	size_t count;		/* Number of instances in @instances */
+	size_t loading;		/* Number of instances being loaded */
+	size_t inst_size;	/* Memory mapped by an instance, 0 if unknown */
+	unsigned int gen;	/* Updated each time the entry is recycled */
+	unsigned int flushed_at; /* Store version when the TA was replaced */
+	uint64_t last_use;
+	uint32_t hits;
+	uint32_t misses;
+};
+
+/* Protects the fields below */
+static struct mutex pool_mu = MUTEX_INITIALIZER;
+static struct pool_entry pool[CFG_TA_INSTANCE_POOL_MAX_TAS];
+static uint64_t pool_clock;
+static unsigned int store_version;
+static bool refilling;
+
+static struct pool_entry *find_entry(const TEE_UUID *uuid)
+{
+	size_t n = 0;
+
+	for (n = 0; n < ARRAY_SIZE(pool); n++)
+		if (pool[n].used && !memcmp(&pool[n].uuid, uuid, sizeof(*uuid)))
+			return pool + n;
+
+	return NULL;
+}
+
+static void destroy_instances(struct tee_ta_ctx_head *instances)
+{
+	struct tee_ta_ctx *ctx = NULL;
+
+	while ((ctx = TAILQ_FIRST(instances))) {
+		TAILQ_REMOVE(instances, ctx, link);
+		user_ta_destroy_instance(to_user_ta_ctx(&ctx->ts_ctx));
+	}
+}
+
+/*
+ * Returns an unused entry, or the least recently used one with its
+ * instances moved to @evicted. Called with pool_mu held.
+ */
+static struct pool_entry *get_free_entry(struct tee_ta_ctx_head *evicted)
+{
+	struct pool_entry *e = pool;
+	size_t n = 0;
+
+	for (n = 0; n < ARRAY_SIZE(pool); n++) {
+		if (!pool[n].used)
+			return pool + n;
+		if (pool[n].last_use < e->last_use)
+			e = pool + n;
+	}
+
+	TAILQ_CONCAT(evicted, &e->instances, link);
+	return e;
+}
+
+/*
+ * Returns true if @utc was loaded before its TA was replaced, @e is the
+ * entry of the TA if any. Called with pool_mu held.
+ */
+static bool is_stale(struct pool_entry *e, struct user_ta_ctx *utc)
+{
+	if (e)
+		return utc->store_version < e->flushed_at;
+	return utc->store_version != store_version;
+}
+
+static size_t instance_size(struct user_ta_ctx *utc)
+{
+	struct vm_region *r = NULL;
+	size_t sz = 0;
+
+	TAILQ_FOREACH(r, &utc->uctx.vm_info.regions, link)
+		sz += r->size;
+
+	return sz;
+}
+
+struct user_ta_ctx *user_ta_pool_claim(const TEE_UUID *uuid)
+{
+	struct tee_ta_ctx_head stale = TAILQ_HEAD_INITIALIZER(stale);
+	struct tee_ta_ctx *next = NULL;
+	struct tee_ta_ctx *ctx = NULL;
+	struct pool_entry *e = NULL;
+
+	mutex_lock(&pool_mu);
+	e = find_entry(uuid);
+	if (e) {
+		e->last_use = ++pool_clock;
+
+		/* Never hand out an instance of a replaced TA */
+		for (ctx = TAILQ_FIRST(&e->instances); ctx; ctx = next) {
+			next = TAILQ_NEXT(ctx, link);
+			if (is_stale(e, to_user_ta_ctx(&ctx->ts_ctx))) {
+				TAILQ_REMOVE(&e->instances, ctx, link);
+				TAILQ_INSERT_TAIL(&stale, ctx, link);
+				e->count--;
+			}
+		}
+
+		ctx = TAILQ_FIRST(&e->instances);
+		if (ctx) {
+			TAILQ_REMOVE(&e->instances, ctx, link);
+			e->count--;
+			e->hits++;
+		} else {
+			e->misses++;
+		}
+	}
+	mutex_unlock(&pool_mu);
+
+	destroy_instances(&stale);
+	if (!e)
+		return NULL;
+
+	notif_send_async(NOTIF_VALUE_DO_BOTTOM_HALF);
+	if (!ctx)
+		return NULL;
+
+	return to_user_ta_ctx(&ctx->ts_ctx);
+}
+
+void user_ta_pool_add(const TEE_UUID *uuid)
+{
+	struct tee_ta_ctx_head evicted = TAILQ_HEAD_INITIALIZER(evicted);
+	struct pool_entry *e = NULL;
+
+	mutex_lock(&pool_mu);
+	e = find_entry(uuid);
+	if (!e) {
+		e = get_free_entry(&evicted);
+		e->uuid = *uuid;
+		e->used = true;
+		TAILQ_INIT(&e->instances);
+		e->count = 0;
+		e->inst_size = 0;
+		e->gen++;
+		e->flushed_at = store_version;
+		e->hits = 0;
+		/* The instance loaded for this session */
+		e->misses = 1;
+	}
+	e->last_use = ++pool_clock;
+	mutex_unlock(&pool_mu);
+
+	destroy_instances(&evicted);
+	notif_send_async(NOTIF_VALUE_DO_BOTTOM_HALF);
+}
+
+void user_ta_pool_flush(const TEE_UUID *uuid)
+{
+	struct tee_ta_ctx_head flushed = TAILQ_HEAD_INITIALIZER(flushed);
+	struct pool_entry *e = NULL;
+
+	mutex_lock(&pool_mu);
+	e = find_entry(uuid);
+	if (e) {
+		TAILQ_CONCAT(&flushed, &e->instances, link);
+		e->count = 0;
+		e->inst_size = 0;
+		/* Instances being loaded may be of the replaced TA too */
+		e->gen++;
+	}
+	/* Instances already claimed are found stale with this */
+	atomic_store_uint(&store_version, store_version + 1);
+	if (e)
+		e->flushed_at = store_version;
+	mutex_unlock(&pool_mu);
+
+	destroy_instances(&flushed);
+	/* Preload instances of the new TA */
+	if (e)
+		notif_send_async(NOTIF_VALUE_DO_BOTTOM_HALF);
+}
+
+unsigned int user_ta_pool_store_version(void)
+{
+	return atomic_load_uint(&store_version);
+}
+
+bool user_ta_pool_stale(struct user_ta_ctx *utc)
+{
+	struct pool_entry *e = NULL;
+	bool stale = false;
+
+	mutex_lock(&pool_mu);
+	e = find_entry(&utc->ta_ctx.ts_ctx.uuid);
+	stale = is_stale(e, utc);
+	if (stale && e && e->hits) {
+		e->hits--;
+		e->misses++;
+	}
+	mutex_unlock(&pool_mu);
+
+	return stale;
+}
+
+void user_ta_pool_get_stats(const TEE_UUID *uuid, uint32_t *hits,
+			    uint32_t *misses)
+{
+	struct pool_entry *e = NULL;
+
+	*hits = 0;
+	*misses = 0;
+
+	mutex_lock(&pool_mu);
+	e = find_entry(uuid);
+	if (e) {
+		*hits = e->hits;
+		*misses = e->misses;
+	}
+	mutex_unlock(&pool_mu);
+}
+
+/* Called with pool_mu held */
+static struct pool_entry *get_entry_to_refill(void)
+{
+	size_t n = 0;
+	size_t i = 0;
+
+	for (i = 0; i < ARRAY_SIZE(pool); i++) {
+		if (!pool[i].used)
+			continue;
+
+		n = pool[i].count + pool[i].loading;
+		if (n >= CFG_TA_INSTANCE_POOL_PER_TA)
+			continue;
+		/* The size is only known once an instance is loaded */
+		if (!pool[i].inst_size) {
+			if (!n)
+				return pool + i;
+			continue;
+		}
+		if ((n + 1) * pool[i].inst_size <=
+		    CFG_TA_INSTANCE_POOL_TA_BUDGET)
+			return pool + i;
+	}
+
+	return NULL;
+}
+
+static void refill(void)
+{
+	struct user_ta_ctx *utc = NULL;
+	struct pool_entry *e = NULL;
+	TEE_Result res = TEE_SUCCESS;
+	unsigned int gen = 0;
+	TEE_UUID uuid = { };
+	size_t sz = 0;
+
+	mutex_lock(&pool_mu);
+	if (refilling)
+		goto out;
+	refilling = true;
+
+	while ((e = get_entry_to_refill())) {
+		uuid = e->uuid;
+		gen = e->gen;
+		e->loading++;
+		mutex_unlock(&pool_mu);
+
+		res = user_ta_create_instance(&uuid, &utc);
+
+		mutex_lock(&pool_mu);
+		e->loading--;
+		if (res) {
+			/* Retried the next time a session is opened */
+			DMSG("Can't preload TA %pUl: %#"PRIx32, &uuid, res);
+			break;
+		}
+
+		if (e->gen != gen ||
+		    (utc->ta_ctx.flags & TA_FLAG_SINGLE_INSTANCE)) {
+			if (e->gen == gen)
+				e->used = false;
+		} else {
+			sz = instance_size(utc);
+			if (!e->inst_size)
+				e->inst_size = sz;
+			if ((e->count + e->loading + 1) * sz <=
+			    CFG_TA_INSTANCE_POOL_TA_BUDGET) {
+				TAILQ_INSERT_TAIL(&e->instances, &utc->ta_ctx,
+						  link);
+				e->count++;
+				continue;
+			}
+		}
+
+		mutex_unlock(&pool_mu);
+		user_ta_destroy_instance(utc);
+		mutex_lock(&pool_mu);
+	}
+
+	refilling = false;
+out:
+	mutex_unlock(&pool_mu);
+}
+
+static void pool_notif(struct notif_driver *ndrv __unused, enum notif_event ev)
+{
+	if (ev == NOTIF_EVENT_DO_BOTTOM_HALF)
+		refill();
+	else
+		EMSG("Unknown event %d", (int)ev);
+}
+
+static struct notif_driver pool_notif_worker = {
+	.yielding_cb = pool_notif,
+};
+
+static TEE_Result pool_init(void)
+{
+	notif_register_worker(&pool_notif_worker);
+
+	return TEE_SUCCESS;
+}
+service_init(pool_init);
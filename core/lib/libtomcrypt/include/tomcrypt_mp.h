@@ -6,10 +6,36 @@
 #ifndef TOMCRYPT_MP_H_
 #define TOMCRYPT_MP_H_
 
+#include <stddef.h>
+
 #if defined(_CFG_CORE_LTC_ACIPHER)
 void init_mp_tomcrypt(void);
 #else
 static inline void init_mp_tomcrypt(void) { }
 #endif
 
+/*
+ * struct mp_exptmod_rr - R^2 mod a modulus kept by the caller
+ * @mod:	The modulus
+ * @rr:		R^2 mod @mod, computed with mp_exptmod_rr_compute().
+ *		Allocated with crypto_bignum_allocate() as it outlives the
+ *		scratch memory pool.
+ *
+ * While bound with mp_exptmod_rr_bind() the modular exponentiations of
+ * LibTomCrypt done by the calling thread with @mod as modulus use @rr
+ * instead of computing it. The values aren't modified by the
+ * exponentiations, they can be bound by several threads at the same
+ * time. Unbind them with mp_exptmod_rr_unbind() before @mod or @rr
+ * change.
+ */
+struct mp_exptmod_rr {
+	void *mod;
+	void *rr;
+};
+
+void mp_exptmod_rr_bind(const struct mp_exptmod_rr *rrs, size_t count);
+void mp_exptmod_rr_unbind(void);
+/* Computes R^2 mod @mod into @rr, returns CRYPT_OK or CRYPT_MEM */
+int mp_exptmod_rr_compute(void *rr, void *mod);
+
 #endif /* TOMCRYPT_MP_H_ */
@@ -5,6 +5,7 @@
 
 #include <crypto/crypto.h>
 #include <kernel/panic.h>
+#include <kernel/thread.h>
 #include <mbedtls/bignum.h>
 #include <mempool.h>
 #include <stdlib.h>
@@ -564,6 +565,74 @@ static void montgomery_deinit(void *a)
 	mempool_free(mbedtls_mpi_mempool, a);
 }
 
+/*
+ * Moduli bound with mp_exptmod_rr_bind() by each thread, only accessed
+ * by the thread itself
+ */
+static struct {
+	const struct mp_exptmod_rr *rrs;
+	size_t count;
+} exptmod_rrs[CFG_NUM_THREADS];
+
+void mp_exptmod_rr_bind(const struct mp_exptmod_rr *rrs, size_t count)
+{
+	short int ct = thread_get_id_may_fail();
+
+	if (ct < 0)
+		return;
+
+	exptmod_rrs[ct].rrs = rrs;
+	exptmod_rrs[ct].count = count;
+}
+
+void mp_exptmod_rr_unbind(void)
+{
+	short int ct = thread_get_id_may_fail();
+
+	if (ct < 0)
+		return;
+
+	exptmod_rrs[ct].rrs = NULL;
+	exptmod_rrs[ct].count = 0;
+}
+
+int mp_exptmod_rr_compute(void *rr, void *mod)
+{
+	mbedtls_mpi *n = mod;
+	int res = 0;
+
+	res = mbedtls_mpi_lset(rr, 1);
+	if (!res)
+		res = mbedtls_mpi_shift_l(rr, n->n * 2 * biL);
+	if (!res)
+		res = mbedtls_mpi_mod_mpi(rr, rr, n);
+	if (!res)
+		res = mbedtls_mpi_shrink(rr, n->n);
+	if (res)
+		return CRYPT_MEM;
+
+	return CRYPT_OK;
+}
+
+/*
+ * Returns R^2 mod @mod if the calling thread has bound the modulus, or
+ * NULL to let mbedtls_mpi_exp_mod() compute it
+ */
+static mbedtls_mpi *get_exptmod_rr(void *mod)
+{
+	short int ct = thread_get_id_may_fail();
+	size_t n = 0;
+
+	if (ct < 0)
+		return NULL;
+
+	for (n = 0; n < exptmod_rrs[ct].count; n++)
+		if (exptmod_rrs[ct].rrs[n].mod == mod)
+			return exptmod_rrs[ct].rrs[n].rr;
+
+	return NULL;
+}
+
 /*
  * This function calculates:
  *  d = a^b mod c
@@ -575,18 +644,19 @@ static void montgomery_deinit(void *a)
  */
 static int exptmod(void *a, void *b, void *c, void *d)
 {
+	mbedtls_mpi *rr = get_exptmod_rr(c);
 	int res;
 
 	if (d == a || d == b || d == c) {
 		mbedtls_mpi dest;
 
 		mbedtls_mpi_init_mempool(&dest);
-		res = mbedtls_mpi_exp_mod(&dest, a, b, c, NULL);
+		res = mbedtls_mpi_exp_mod(&dest, a, b, c, rr);
 		if (!res)
 			res = mbedtls_mpi_copy(d, &dest);
 		mbedtls_mpi_free(&dest);
 	} else {
-		res = mbedtls_mpi_exp_mod(d, a, b, c, NULL);
+		res = mbedtls_mpi_exp_mod(d, a, b, c, rr);
 	}
 
 	if (res)
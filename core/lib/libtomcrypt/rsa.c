@@ -12,6 +12,7 @@
 #include <tee_api_defines_extensions.h>
 #include <tee_api_types.h>
 #include <tee/tee_cryp_utl.h>
+#include <tomcrypt_mp.h>
 #include <trace.h>
 #include <utee_defines.h>
 
@@ -87,6 +88,120 @@ static TEE_Result tee_algo_to_ltc_hashindex(uint32_t algo, int *ltc_hashindex)
 		return TEE_SUCCESS;
 }
 
+/* Number of moduli of a key pair with precomputed values: N, p and q */
+#define RSA_PRECOMP_COUNT	3
+
+/*
+ * struct rsa_precomp - values precomputed for a key pair
+ * @n:	R^2 mod N
+ * @p:	R^2 mod p, NULL if the key has no CRT components
+ * @q:	R^2 mod q, NULL if the key has no CRT components
+ *
+ * The values are computed by the first private key operation with the
+ * key and published complete in the key, they aren't modified until the
+ * key changes. Several threads may use them at the same time.
+ */
+struct rsa_precomp {
+	struct bignum *n;
+	struct bignum *p;
+	struct bignum *q;
+};
+
+static void free_precomp(struct rsa_precomp *pc)
+{
+	if (!pc)
+		return;
+	crypto_bignum_free(&pc->n);
+	crypto_bignum_free(&pc->p);
+	crypto_bignum_free(&pc->q);
+	free(pc);
+}
+
+static struct bignum *compute_rr(struct bignum *mod)
+{
+	struct bignum *rr = crypto_bignum_allocate(0);
+
+	if (rr && mp_exptmod_rr_compute(rr, mod) != CRYPT_OK)
+		crypto_bignum_free(&rr);
+
+	return rr;
+}
+
+static struct rsa_precomp *get_precomp(struct rsa_keypair *key)
+{
+	struct rsa_precomp *pc = __compiler_atomic_load_acquire(&key->precomp);
+	void *old = NULL;
+
+	if (pc)
+		return pc;
+
+	pc = calloc(1, sizeof(*pc));
+	if (!pc)
+		return NULL;
+
+	pc->n = compute_rr(key->n);
+	if (!pc->n)
+		goto err;
+	if (key->p && crypto_bignum_num_bytes(key->p)) {
+		pc->p = compute_rr(key->p);
+		pc->q = compute_rr(key->q);
+		if (!pc->p || !pc->q)
+			goto err;
+	}
+
+	/* Another thread may have published its values meanwhile */
+	if (!__atomic_compare_exchange_n(&key->precomp, &old, pc, false,
+					 __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {
+		free_precomp(pc);
+		return old;
+	}
+
+	return pc;
+err:
+	free_precomp(pc);
+	return NULL;
+}
+
+/*
+ * Binds the values precomputed for the moduli of @key until
+ * unbind_precomp(). The precomputation is only a speedup, without it
+ * LibTomCrypt computes them as usual.
+ */
+static void bind_precomp(struct rsa_keypair *key, struct mp_exptmod_rr *rrs)
+{
+	struct rsa_precomp *pc = get_precomp(key);
+
+	if (!pc)
+		return;
+
+	rrs[0] = (struct mp_exptmod_rr){ .mod = key->n, .rr = pc->n };
+	if (pc->p) {
+		rrs[1] = (struct mp_exptmod_rr){ .mod = key->p, .rr = pc->p };
+		rrs[2] = (struct mp_exptmod_rr){ .mod = key->q, .rr = pc->q };
+	}
+	mp_exptmod_rr_bind(rrs, RSA_PRECOMP_COUNT);
+}
+
+static void unbind_precomp(void)
+{
+	mp_exptmod_rr_unbind();
+}
+
+static void ltc_key_from_keypair(rsa_key *ltc_key, struct rsa_keypair *key)
+{
+	ltc_key->type = PK_PRIVATE;
+	ltc_key->e = key->e;
+	ltc_key->N = key->n;
+	ltc_key->d = key->d;
+	if (key->p && crypto_bignum_num_bytes(key->p)) {
+		ltc_key->p = key->p;
+		ltc_key->q = key->q;
+		ltc_key->qP = key->qp;
+		ltc_key->dP = key->dp;
+		ltc_key->dQ = key->dq;
+	}
+}
+
 TEE_Result crypto_acipher_alloc_rsa_keypair(struct rsa_keypair *s,
 					    size_t key_size_bits __unused)
 __weak __alias("sw_crypto_acipher_alloc_rsa_keypair");
@@ -165,6 +280,18 @@ void sw_crypto_acipher_free_rsa_keypair(struct rsa_keypair *s)
 	crypto_bignum_free(&s->qp);
 	crypto_bignum_free(&s->dp);
 	crypto_bignum_free(&s->dq);
+	sw_crypto_acipher_clear_rsa_precomp(s);
+}
+
+void crypto_acipher_clear_rsa_precomp(struct rsa_keypair *s)
+__weak __alias("sw_crypto_acipher_clear_rsa_precomp");
+
+void sw_crypto_acipher_clear_rsa_precomp(struct rsa_keypair *s)
+{
+	if (!s)
+		return;
+	free_precomp(s->precomp);
+	s->precomp = NULL;
 }
 
 TEE_Result crypto_acipher_gen_rsa_key(struct rsa_keypair *key,
@@ -195,6 +322,7 @@ TEE_Result sw_crypto_acipher_gen_rsa_key(struct rsa_keypair *key,
 		ltc_mp.copy(ltc_tmp_key.qP, key->qp);
 		ltc_mp.copy(ltc_tmp_key.dP, key->dp);
 		ltc_mp.copy(ltc_tmp_key.dQ, key->dq);
+		sw_crypto_acipher_clear_rsa_precomp(key);
 
 		/* Free the temporary key */
 		rsa_free(&ltc_tmp_key);
@@ -297,22 +425,15 @@ TEE_Result sw_crypto_acipher_rsanopad_decrypt(struct rsa_keypair *key,
 					      size_t src_len, uint8_t *dst,
 					      size_t *dst_len)
 {
+	struct mp_exptmod_rr rrs[RSA_PRECOMP_COUNT] = { };
 	TEE_Result res;
 	rsa_key ltc_key = { 0, };
 
-	ltc_key.type = PK_PRIVATE;
-	ltc_key.e = key->e;
-	ltc_key.N = key->n;
-	ltc_key.d = key->d;
-	if (key->p && crypto_bignum_num_bytes(key->p)) {
-		ltc_key.p = key->p;
-		ltc_key.q = key->q;
-		ltc_key.qP = key->qp;
-		ltc_key.dP = key->dp;
-		ltc_key.dQ = key->dq;
-	}
+	ltc_key_from_keypair(&ltc_key, key);
 
+	bind_precomp(key, rrs);
 	res = rsadorep(&ltc_key, src, src_len, dst, dst_len);
+	unbind_precomp();
 	return res;
 }
 
@@ -337,18 +458,9 @@ TEE_Result sw_crypto_acipher_rsaes_decrypt(uint32_t algo,
 	int ltc_hashindex, ltc_res, ltc_stat, ltc_rsa_algo;
 	size_t mod_size;
 	rsa_key ltc_key = { 0, };
+	struct mp_exptmod_rr rrs[RSA_PRECOMP_COUNT] = { };
 
-	ltc_key.type = PK_PRIVATE;
-	ltc_key.e = key->e;
-	ltc_key.d = key->d;
-	ltc_key.N = key->n;
-	if (key->p && crypto_bignum_num_bytes(key->p)) {
-		ltc_key.p = key->p;
-		ltc_key.q = key->q;
-		ltc_key.qP = key->qp;
-		ltc_key.dP = key->dp;
-		ltc_key.dQ = key->dq;
-	}
+	ltc_key_from_keypair(&ltc_key, key);
 
 	/* Get the algorithm */
 	res = tee_algo_to_ltc_hashindex(algo, &ltc_hashindex);
@@ -378,10 +490,12 @@ TEE_Result sw_crypto_acipher_rsaes_decrypt(uint32_t algo,
 		goto out;
 	}
 
+	bind_precomp(key, rrs);
 	ltc_res = rsa_decrypt_key_ex(src, src_len, buf, &blen,
 				     ((label_len == 0) ? 0 : label), label_len,
 				     ltc_hashindex, ltc_rsa_algo, &ltc_stat,
 				     &ltc_key);
+	unbind_precomp();
 	switch (ltc_res) {
 	case CRYPT_PK_INVALID_PADDING:
 	case CRYPT_INVALID_PACKET:
@@ -503,18 +617,9 @@ TEE_Result sw_crypto_acipher_rsassa_sign(uint32_t algo, struct rsa_keypair *key,
 	int ltc_res, ltc_rsa_algo, ltc_hashindex;
 	unsigned long ltc_sig_len;
 	rsa_key ltc_key = { 0, };
+	struct mp_exptmod_rr rrs[RSA_PRECOMP_COUNT] = { };
 
-	ltc_key.type = PK_PRIVATE;
-	ltc_key.e = key->e;
-	ltc_key.N = key->n;
-	ltc_key.d = key->d;
-	if (key->p && crypto_bignum_num_bytes(key->p)) {
-		ltc_key.p = key->p;
-		ltc_key.q = key->q;
-		ltc_key.qP = key->qp;
-		ltc_key.dP = key->dp;
-		ltc_key.dQ = key->dq;
-	}
+	ltc_key_from_keypair(&ltc_key, key);
 
 	switch (algo) {
 	case TEE_ALG_RSASSA_PKCS1_V1_5:
@@ -569,9 +674,11 @@ TEE_Result sw_crypto_acipher_rsassa_sign(uint32_t algo, struct rsa_keypair *key,
 
 	ltc_sig_len = mod_size;
 
+	bind_precomp(key, rrs);
 	ltc_res = rsa_sign_hash_ex(msg, msg_len, sig, &ltc_sig_len,
 				   ltc_rsa_algo, NULL, find_prng("prng_crypto"),
 				   ltc_hashindex, salt_len, &ltc_key);
+	unbind_precomp();
 
 	*sig_len = ltc_sig_len;
 
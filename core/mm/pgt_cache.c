@@ -12,6 +12,7 @@
 #include <mm/core_mmu.h>
 #include <mm/pgt_cache.h>
 #include <mm/tee_pager.h>
+#include <mm/vm.h>
 #include <stdlib.h>
 #include <trace.h>
 #include <util.h>
@@ -166,12 +167,74 @@ static bool pgt_entry_matches(struct pgt *p, vaddr_t begin, vaddr_t last)
 				     last - begin);
 }
 
+static void prune_unused_tables(struct user_mode_ctx *uctx);
+
+#ifdef CFG_TA_CONCURRENT
+/*
+ * Other invocations of a TA with TA_FLAG_CONCURRENT may reference the
+ * translation tables of an unmapped range on other cores. Such unused
+ * tables are kept until each of these invocations has set up its
+ * translation tables again, tracked with user_mode_ctx::pgt_gen, or has
+ * returned. Called with user_mode_ctx::vm_mutex held.
+ */
+static bool others_use_tables(struct user_mode_ctx *uctx, bool outdated_only)
+{
+	struct user_mode_thread *cur = vm_get_current_umt(uctx);
+	struct user_mode_thread *umt = NULL;
+	size_t n = 0;
+
+	for (n = 0; n < uctx->thread_count; n++) {
+		umt = uctx->threads + n;
+		if (umt != cur && umt->busy &&
+		    (!outdated_only || umt->pgt_gen != uctx->pgt_gen))
+			return true;
+	}
+
+	return false;
+}
+
+/* Returns true if the tables of a range which just became unused are kept */
+static bool keep_unused_range(struct user_mode_ctx *uctx)
+{
+	if (!uctx->threads)
+		return false;
+
+	if (others_use_tables(uctx, false)) {
+		uctx->pgt_gen++;
+		return true;
+	}
+
+	/* The tables kept earlier aren't referenced any longer either */
+	prune_unused_tables(uctx);
+	return false;
+}
+
+/* Returns true if the tables kept earlier may still be referenced */
+static bool keep_unused_tables(struct user_mode_ctx *uctx)
+{
+	return uctx->threads && others_use_tables(uctx, true);
+}
+#else
+static bool keep_unused_range(struct user_mode_ctx *uctx __unused)
+{
+	return false;
+}
+
+static bool keep_unused_tables(struct user_mode_ctx *uctx __unused)
+{
+	return false;
+}
+#endif
+
 void pgt_flush_range(struct user_mode_ctx *uctx, vaddr_t begin, vaddr_t last)
 {
 	struct pgt_cache *pgt_cache = &uctx->pgt_cache;
 	struct pgt *next_p = NULL;
 	struct pgt *p = NULL;
 
+	if (keep_unused_range(uctx))
+		return;
+
 	/*
 	 * Do the special case where the first element in the list is
 	 * removed first.
@@ -268,7 +331,8 @@ static struct pgt *prune_before_va(struct pgt_cache *pgt_cache, struct pgt *p,
 	return p;
 }
 
-bool pgt_check_avail(struct user_mode_ctx *uctx)
+/* Frees the translation tables not covering any region */
+static void prune_unused_tables(struct user_mode_ctx *uctx)
 {
 	struct pgt_cache *pgt_cache = &uctx->pgt_cache;
 	struct vm_info *vm_info = &uctx->vm_info;
@@ -278,26 +342,19 @@ bool pgt_check_avail(struct user_mode_ctx *uctx)
 	vaddr_t va = 0;
 	bool p_used = false;
 
-	/*
-	 * Prune unused tables. This is normally not needed since
-	 * pgt_flush_range() does this too, but in the error path of for
-	 * instance vm_remap() such calls may not be done. So for increased
-	 * robustness remove all unused translation tables before we may
-	 * allocate new ones.
-	 */
 	TAILQ_FOREACH(r, &vm_info->regions, link) {
 		for (va = ROUNDDOWN(r->va, CORE_MMU_PGDIR_SIZE);
 		     va < r->va + r->size; va += CORE_MMU_PGDIR_SIZE) {
 			if (!p_used)
 				p = prune_before_va(pgt_cache, p, pp, va);
 			if (!p)
-				goto prune_done;
+				return;
 
 			if (p->vabase < va) {
 				pp = p;
 				p = SLIST_NEXT(pp, link);
 				if (!p)
-					goto prune_done;
+					return;
 				p_used = false;
 			}
 
@@ -305,14 +362,42 @@ bool pgt_check_avail(struct user_mode_ctx *uctx)
 				p_used = true;
 		}
 	}
-prune_done:
+
+	/* The tables following the last region are unused too */
+	if (p_used) {
+		pp = p;
+		p = SLIST_NEXT(pp, link);
+	}
+	prune_before_va(pgt_cache, p, pp, (vaddr_t)-1);
+}
+
+bool pgt_check_avail(struct user_mode_ctx *uctx)
+{
+	struct pgt_cache *pgt_cache = &uctx->pgt_cache;
+	struct vm_info *vm_info = &uctx->vm_info;
+	struct pgt *p = NULL;
+	struct vm_region *r = NULL;
+	struct pgt *pp = NULL;
+	vaddr_t va = 0;
+
+	/*
+	 * Prune unused tables. This is normally not needed since
+	 * pgt_flush_range() does this too, but in the error path of for
+	 * instance vm_remap() such calls may not be done. So for increased
+	 * robustness remove all unused translation tables before we may
+	 * allocate new ones.
+	 */
+	if (!keep_unused_tables(uctx))
+		prune_unused_tables(uctx);
+
 
 	p = SLIST_FIRST(pgt_cache);
 	pp = NULL;
 	TAILQ_FOREACH(r, &vm_info->regions, link) {
 		for (va = ROUNDDOWN(r->va, CORE_MMU_PGDIR_SIZE);
 		     va < r->va + r->size; va += CORE_MMU_PGDIR_SIZE) {
-			if (p && p->vabase < va) {
+			/* Unused tables are only present if kept */
+			while (p && p->vabase < va) {
 				pp = p;
 				p = SLIST_NEXT(pp, link);
 			}
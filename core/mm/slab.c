@@ -0,0 +1,329 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#include <assert.h>
+#include <compiler.h>
+#include <kernel/misc.h>
+#include <kernel/panic.h>
+#include <kernel/spinlock.h>
+#include <kernel/thread.h>
+#include <malloc.h>
+#include <memtag.h>
+#include <mm/core_memprot.h>
+#include <mm/slab.h>
+#include <mm/tee_mm.h>
+#include <string.h>
+#include <trace.h>
+#include <util.h>
+
+/*
+ * A slab is a page of secure DDR allocated from tee_mm_sec_ddr, or a page
+ * sized block of the heap for the caches with SLAB_HEAP or SLAB_NEXUS and
+ * when no page is available. Slabs are aligned to their size so that the
+ * slab of an object is found by rounding down the address of the object.
+ * The objects of a slab are linked in a free list of indexes kept in the
+ * slab header, the objects themselves are left untouched while free,
+ * preserving the state set by the constructor.
+ */
+#define SLAB_SIZE		SMALL_PAGE_SIZE
+#define SLAB_ALIGN		16
+#define SLAB_NO_OBJ		UINT8_MAX
+#define SLAB_MAX_OBJS		(SLAB_NO_OBJ - 1)
+#define SLAB_MIN_OBJS		4
+
+struct slab {
+	LIST_ENTRY(slab) link;
+	struct slab_cache *cache;
+	tee_mm_entry_t *mm;	/* NULL if allocated from the heap */
+	unsigned int in_use;
+	uint8_t free_head;
+	uint8_t next[SLAB_MAX_OBJS];
+};
+
+#define SLAB_HDR_SIZE		ROUNDUP(sizeof(struct slab), SLAB_ALIGN)
+
+SLIST_HEAD(slab_cache_head, slab_cache);
+
+static struct slab_cache_head slab_caches = SLIST_HEAD_INITIALIZER(slab_caches);
+static unsigned int slab_caches_lock = SPINLOCK_UNLOCK;
+static struct slab_cache_head nex_slab_caches __nex_data =
+	SLIST_HEAD_INITIALIZER(nex_slab_caches);
+static unsigned int nex_slab_caches_lock __nex_data = SPINLOCK_UNLOCK;
+
+static size_t obj_stride(struct slab_cache *cache)
+{
+	return ROUNDUP(cache->obj_size, SLAB_ALIGN);
+}
+
+static size_t objs_per_slab(struct slab_cache *cache)
+{
+	return MIN((SLAB_SIZE - SLAB_HDR_SIZE) / obj_stride(cache),
+		   (size_t)SLAB_MAX_OBJS);
+}
+
+static void *slab_obj(struct slab_cache *cache, struct slab *s, size_t idx)
+{
+	return (uint8_t *)s + SLAB_HDR_SIZE + idx * obj_stride(cache);
+}
+
+static void register_cache(struct slab_cache *cache)
+{
+	struct slab_cache_head *head = &slab_caches;
+	unsigned int *lock = &slab_caches_lock;
+	uint32_t exceptions = 0;
+
+	if (cache->flags & SLAB_NEXUS) {
+		head = &nex_slab_caches;
+		lock = &nex_slab_caches_lock;
+	}
+
+	exceptions = cpu_spin_lock_xsave(lock);
+	if (!cache->registered) {
+		SLIST_INSERT_HEAD(head, cache, link);
+		cache->registered = true;
+	}
+	cpu_spin_unlock_xrestore(lock, exceptions);
+}
+
+static struct slab *alloc_slab_page(tee_mm_entry_t **mm_ret)
+{
+	tee_mm_entry_t *mm = tee_mm_alloc(&tee_mm_sec_ddr, SLAB_SIZE);
+	struct slab *s = NULL;
+
+	if (!mm)
+		return NULL;
+
+	s = phys_to_virt(tee_mm_get_smem(mm), MEM_AREA_TA_RAM, SLAB_SIZE);
+	if (!s) {
+		tee_mm_free(mm);
+		return NULL;
+	}
+
+	memtag_clear_mem(s, SLAB_SIZE);
+	*mm_ret = mm;
+
+	return s;
+}
+
+static struct slab *new_slab(struct slab_cache *cache)
+{
+	size_t num = objs_per_slab(cache);
+	tee_mm_entry_t *mm = NULL;
+	struct slab *s = NULL;
+	size_t n = 0;
+
+	if (num < SLAB_MIN_OBJS)
+		panic("Object too large for slab cache");
+
+	if (!cache->registered)
+		register_cache(cache);
+
+	if (cache->flags & SLAB_NEXUS) {
+		s = nex_memalign(SLAB_SIZE, SLAB_SIZE);
+	} else {
+		if (!(cache->flags & SLAB_HEAP))
+			s = alloc_slab_page(&mm);
+		/* Secure DDR may be exhausted or not set up yet */
+		if (!s)
+			s = memalign(SLAB_SIZE, SLAB_SIZE);
+	}
+	if (!s)
+		return NULL;
+
+	s->cache = cache;
+	s->mm = mm;
+	s->in_use = 0;
+	s->free_head = 0;
+	for (n = 0; n < num; n++) {
+		s->next[n] = n + 1;
+		if (cache->ctor)
+			cache->ctor(slab_obj(cache, s, n));
+	}
+	s->next[num - 1] = SLAB_NO_OBJ;
+
+	return s;
+}
+
+static void release_slab(struct slab_cache *cache, struct slab *s)
+{
+	if (s->mm)
+		tee_mm_free(s->mm);
+	else if (cache->flags & SLAB_NEXUS)
+		nex_free(s);
+	else
+		free(s);
+}
+
+static void *alloc_from_slab(struct slab_cache *cache)
+{
+	uint32_t exceptions = cpu_spin_lock_xsave(&cache->lock);
+	struct slab *s = LIST_FIRST(&cache->partial);
+	size_t idx = 0;
+
+	if (!s) {
+		s = LIST_FIRST(&cache->empty);
+		if (s) {
+			LIST_REMOVE(s, link);
+			LIST_INSERT_HEAD(&cache->partial, s, link);
+		}
+	}
+
+	if (!s) {
+		/* The allocators have their own locks, don't nest them */
+		cpu_spin_unlock_xrestore(&cache->lock, exceptions);
+		s = new_slab(cache);
+		exceptions = cpu_spin_lock_xsave(&cache->lock);
+		if (!s) {
+			cache->num_fail++;
+			cpu_spin_unlock_xrestore(&cache->lock, exceptions);
+			return NULL;
+		}
+		cache->num_slabs++;
+		LIST_INSERT_HEAD(&cache->partial, s, link);
+	}
+
+	idx = s->free_head;
+	s->free_head = s->next[idx];
+	s->in_use++;
+	if (s->free_head == SLAB_NO_OBJ) {
+		LIST_REMOVE(s, link);
+		LIST_INSERT_HEAD(&cache->full, s, link);
+	}
+
+	cache->in_use++;
+	if (cache->in_use > cache->max_in_use)
+		cache->max_in_use = cache->in_use;
+
+	cpu_spin_unlock_xrestore(&cache->lock, exceptions);
+
+	return slab_obj(cache, s, idx);
+}
+
+static void free_to_slab(struct slab_cache *cache, void *obj)
+{
+	struct slab *s = (struct slab *)ROUNDDOWN((vaddr_t)obj, SLAB_SIZE);
+	size_t offs = (vaddr_t)obj - (vaddr_t)s - SLAB_HDR_SIZE;
+	struct slab *release = NULL;
+	uint32_t exceptions = 0;
+	bool was_full = false;
+	size_t idx = 0;
+
+	if (s->cache != cache || offs % obj_stride(cache))
+		panic("Invalid slab object");
+	idx = offs / obj_stride(cache);
+
+	exceptions = cpu_spin_lock_xsave(&cache->lock);
+
+	was_full = s->free_head == SLAB_NO_OBJ;
+	s->next[idx] = s->free_head;
+	s->free_head = idx;
+	s->in_use--;
+	cache->in_use--;
+
+	if (!s->in_use) {
+		LIST_REMOVE(s, link);
+		/* Keep one empty slab to avoid thrashing the allocators */
+		if (LIST_EMPTY(&cache->empty)) {
+			LIST_INSERT_HEAD(&cache->empty, s, link);
+		} else {
+			release = s;
+			cache->num_slabs--;
+		}
+	} else if (was_full) {
+		LIST_REMOVE(s, link);
+		LIST_INSERT_HEAD(&cache->partial, s, link);
+	}
+
+	cpu_spin_unlock_xrestore(&cache->lock, exceptions);
+
+	if (release)
+		release_slab(cache, release);
+}
+
+void *slab_alloc(struct slab_cache *cache)
+{
+	uint32_t exceptions = thread_mask_exceptions(THREAD_EXCP_ALL);
+	struct slab_magazine *m = cache->mag + get_core_pos();
+	void *obj = NULL;
+
+	if (m->count)
+		obj = m->obj[--m->count];
+
+	thread_unmask_exceptions(exceptions);
+
+	if (obj)
+		return obj;
+
+	return alloc_from_slab(cache);
+}
+
+void slab_free(struct slab_cache *cache, void *obj)
+{
+	uint32_t exceptions = 0;
+	struct slab_magazine *m = NULL;
+
+	if (!obj)
+		return;
+
+	exceptions = thread_mask_exceptions(THREAD_EXCP_ALL);
+	m = cache->mag + get_core_pos();
+	if (m->count < SLAB_MAGAZINE_SIZE) {
+		m->obj[m->count++] = obj;
+		obj = NULL;
+	}
+	thread_unmask_exceptions(exceptions);
+
+	if (obj)
+		free_to_slab(cache, obj);
+}
+
+#ifdef CFG_WITH_STATS
+static void add_stats(struct slab_cache_head *head, unsigned int *lock,
+		      struct pta_stats_alloc *stats, bool reset)
+{
+	uint32_t exceptions = cpu_spin_lock_xsave(lock);
+	struct slab_cache *c = NULL;
+
+	SLIST_FOREACH(c, head, link) {
+		uint32_t exceptions2 = cpu_spin_lock_xsave(&c->lock);
+
+		if (!reset)
+			DMSG("%s: %zu objects of %zu bytes in use (max %zu), "
+			     "%zu slabs", c->name, c->in_use, c->obj_size,
+			     c->max_in_use, c->num_slabs);
+
+		stats->allocated += c->in_use * c->obj_size;
+		stats->max_allocated += c->max_in_use * c->obj_size;
+		stats->size += c->num_slabs * SLAB_SIZE;
+		stats->num_alloc_fail += c->num_fail;
+		if (c->num_fail && c->obj_size > stats->biggest_alloc_fail)
+			stats->biggest_alloc_fail = c->obj_size;
+
+		if (reset) {
+			c->max_in_use = c->in_use;
+			c->num_fail = 0;
+		}
+
+		cpu_spin_unlock_xrestore(&c->lock, exceptions2);
+	}
+
+	cpu_spin_unlock_xrestore(lock, exceptions);
+}
+
+void slab_get_stats(struct pta_stats_alloc *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+	add_stats(&slab_caches, &slab_caches_lock, stats, false);
+	add_stats(&nex_slab_caches, &nex_slab_caches_lock, stats, false);
+}
+
+void slab_reset_stats(void)
+{
+	struct pta_stats_alloc stats = { };
+
+	add_stats(&slab_caches, &slab_caches_lock, &stats, true);
+	add_stats(&nex_slab_caches, &nex_slab_caches_lock, &stats, true);
+}
+#endif
@@ -6,4 +6,5 @@ srcs-y += vm.c
 srcs-y += core_mmu.c
 srcs-y += pgt_cache.c
 srcs-y += tee_mm.c
+srcs-$(CFG_CORE_SLAB) += slab.c
 
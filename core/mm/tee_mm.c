@@ -6,34 +6,41 @@
 #include <kernel/panic.h>
 #include <kernel/spinlock.h>
 #include <kernel/tee_common.h>
+#include <mm/slab.h>
 #include <mm/tee_mm.h>
 #include <mm/tee_pager.h>
 #include <pta_stats.h>
 #include <trace.h>
 #include <util.h>
 
-static void *pmalloc(tee_mm_pool_t *pool, size_t size)
+static struct slab_cache mm_entry_cache =
+	SLAB_CACHE_INITIALIZER("tee_mm_entry", sizeof(tee_mm_entry_t),
+			       SLAB_HEAP, NULL);
+static struct slab_cache nex_mm_entry_cache __nex_data =
+	SLAB_CACHE_INITIALIZER("nex_tee_mm_entry", sizeof(tee_mm_entry_t),
+			       SLAB_NEXUS, NULL);
+
+static struct slab_cache *entry_cache(tee_mm_pool_t *pool)
 {
 	if (pool->flags & TEE_MM_POOL_NEX_MALLOC)
-		return nex_malloc(size);
+		return &nex_mm_entry_cache;
 	else
-		return malloc(size);
+		return &mm_entry_cache;
 }
 
-static void *pcalloc(tee_mm_pool_t *pool, size_t num_el, size_t size)
+static tee_mm_entry_t *entry_alloc(tee_mm_pool_t *pool)
 {
-	if (pool->flags & TEE_MM_POOL_NEX_MALLOC)
-		return nex_calloc(num_el, size);
-	else
-		return calloc(num_el, size);
+	return slab_alloc(entry_cache(pool));
 }
 
-static void pfree(tee_mm_pool_t *pool, void *ptr)
+static tee_mm_entry_t *entry_zalloc(tee_mm_pool_t *pool)
 {
-	if (pool->flags & TEE_MM_POOL_NEX_MALLOC)
-		nex_free(ptr);
-	else
-		free(ptr);
+	return slab_zalloc(entry_cache(pool));
+}
+
+static void entry_free(tee_mm_pool_t *pool, tee_mm_entry_t *mm)
+{
+	slab_free(entry_cache(pool), mm);
 }
 
 bool tee_mm_init(tee_mm_pool_t *pool, paddr_t lo, paddr_size_t size,
@@ -55,7 +62,7 @@ bool tee_mm_init(tee_mm_pool_t *pool, paddr_t lo, paddr_size_t size,
 	pool->size = size;
 	pool->shift = shift;
 	pool->flags = flags;
-	pool->entry = pcalloc(pool, 1, sizeof(tee_mm_entry_t));
+	pool->entry = entry_zalloc(pool);
 
 	if (pool->entry == NULL)
 		return false;
@@ -76,7 +83,7 @@ void tee_mm_final(tee_mm_pool_t *pool)
 
 	while (pool->entry->next != NULL)
 		tee_mm_free(pool->entry->next);
-	pfree(pool, pool->entry);
+	entry_free(pool, pool->entry);
 	pool->entry = NULL;
 }
 
@@ -151,7 +158,7 @@ tee_mm_entry_t *tee_mm_alloc(tee_mm_pool_t *pool, size_t size)
 	if (!pool || !pool->entry)
 		return NULL;
 
-	nn = pmalloc(pool, sizeof(tee_mm_entry_t));
+	nn = entry_alloc(pool);
 	if (!nn)
 		return NULL;
 
@@ -221,7 +228,7 @@ tee_mm_entry_t *tee_mm_alloc(tee_mm_pool_t *pool, size_t size)
 	return nn;
 err:
 	cpu_spin_unlock_xrestore(&pool->lock, exceptions);
-	pfree(pool, nn);
+	entry_free(pool, nn);
 	return NULL;
 }
 
@@ -262,7 +269,7 @@ tee_mm_entry_t *tee_mm_alloc2(tee_mm_pool_t *pool, paddr_t base, size_t size)
 	if ((base + size) < base || base < pool->lo)
 		return NULL;
 
-	mm = pmalloc(pool, sizeof(tee_mm_entry_t));
+	mm = entry_alloc(pool);
 	if (!mm)
 		return NULL;
 
@@ -297,7 +304,7 @@ tee_mm_entry_t *tee_mm_alloc2(tee_mm_pool_t *pool, paddr_t base, size_t size)
 	return mm;
 err:
 	cpu_spin_unlock_xrestore(&pool->lock, exceptions);
-	pfree(pool, mm);
+	entry_free(pool, mm);
 	return NULL;
 }
 
@@ -322,7 +329,7 @@ void tee_mm_free(tee_mm_entry_t *p)
 	entry->next = entry->next->next;
 	cpu_spin_unlock_xrestore(&p->pool->lock, exceptions);
 
-	pfree(p->pool, p);
+	entry_free(p->pool, p);
 }
 
 size_t tee_mm_get_bytes(const tee_mm_entry_t *mm)
@@ -8,10 +8,13 @@
 #include <assert.h>
 #include <config.h>
 #include <initcall.h>
+#include <kernel/evtrace.h>
+#include <kernel/mutex.h>
 #include <kernel/panic.h>
 #include <kernel/spinlock.h>
 #include <kernel/tee_common.h>
 #include <kernel/tee_misc.h>
+#include <kernel/thread.h>
 #include <kernel/tlb_helpers.h>
 #include <kernel/user_mode_ctx.h>
 #include <kernel/virtualization.h>
@@ -45,6 +48,122 @@
 #define TEE_MMU_UCACHE_DEFAULT_ATTR	(TEE_MATTR_MEM_TYPE_CACHED << \
 					 TEE_MATTR_MEM_TYPE_SHIFT)
 
+#ifdef CFG_TA_CONCURRENT
+/*
+ * The regions of a TA with TA_FLAG_CONCURRENT may be changed by one
+ * invocation while others are looking them up. Other contexts only have
+ * their regions used by the thread running them, no locking is needed.
+ */
+static bool vm_is_shared(const struct user_mode_ctx *uctx)
+{
+	return uctx->threads;
+}
+
+static void vm_lock(struct user_mode_ctx *uctx)
+{
+	if (vm_is_shared(uctx))
+		mutex_lock(&uctx->vm_mutex);
+}
+
+static void vm_unlock(struct user_mode_ctx *uctx)
+{
+	if (vm_is_shared(uctx))
+		mutex_unlock(&uctx->vm_mutex);
+}
+
+void vm_read_lock(const struct user_mode_ctx *uctx)
+{
+	if (vm_is_shared(uctx))
+		mutex_read_lock(&((struct user_mode_ctx *)uctx)->vm_mutex);
+}
+
+void vm_read_unlock(const struct user_mode_ctx *uctx)
+{
+	if (vm_is_shared(uctx))
+		mutex_read_unlock(&((struct user_mode_ctx *)uctx)->vm_mutex);
+}
+
+/* vm_va2pa() and vm_pa2va() may be called where we can't sleep */
+static bool vm_read_trylock(const struct user_mode_ctx *uctx)
+{
+	if (!vm_is_shared(uctx) || !thread_is_in_normal_mode() ||
+	    (thread_get_exceptions() & THREAD_EXCP_FOREIGN_INTR))
+		return false;
+
+	vm_read_lock(uctx);
+	return true;
+}
+
+struct user_mode_thread *vm_get_current_umt(const struct user_mode_ctx *uctx)
+{
+	struct ts_session *s = NULL;
+
+	if (!uctx->threads)
+		return NULL;
+
+	TAILQ_FOREACH(s, &thread_get_tsd()->sess_stack, link_tsd)
+		if (s->ctx == uctx->ts_ctx)
+			return s->umt;
+
+	return NULL;
+}
+
+/*
+ * Parameters of one invocation aren't found when looking up memory on
+ * behalf of the others. This doesn't hide them from user mode, all
+ * invocations share the translation tables.
+ */
+static bool region_is_visible(const struct vm_region *r,
+			      struct user_mode_thread *umt)
+{
+	return !umt || !(r->flags & VM_FLAG_EPHEMERAL) || r->owner == umt;
+}
+
+static bool region_has_owner(const struct vm_region *r,
+			     struct user_mode_thread *umt)
+{
+	return r->owner == umt;
+}
+
+static void region_set_owner(struct vm_region *r,
+			     struct user_mode_thread *umt)
+{
+	r->owner = umt;
+}
+#else
+static void vm_lock(struct user_mode_ctx *uctx __unused)
+{
+}
+
+static void vm_unlock(struct user_mode_ctx *uctx __unused)
+{
+}
+
+static bool vm_read_trylock(const struct user_mode_ctx *uctx __unused)
+{
+	return false;
+}
+
+static bool region_is_visible(const struct vm_region *r __unused,
+			      struct user_mode_thread *umt __unused)
+{
+	return true;
+}
+
+static bool region_has_owner(const struct vm_region *r __unused,
+			     struct user_mode_thread *umt __unused)
+{
+	return true;
+}
+
+static void region_set_owner(struct vm_region *r __unused,
+			     struct user_mode_thread *umt __unused)
+{
+}
+#endif
+
+static void set_ctx(struct ts_ctx *ctx);
+
 static vaddr_t select_va_in_range(const struct vm_region *prev_reg,
 				  const struct vm_region *next_reg,
 				  const struct vm_region *reg,
@@ -52,15 +171,16 @@ static vaddr_t select_va_in_range(const struct vm_region *prev_reg,
 				  size_t granul)
 {
 	const uint32_t f = VM_FLAG_EPHEMERAL | VM_FLAG_PERMANENT |
-			    VM_FLAG_SHAREABLE;
+			    VM_FLAG_SHAREABLE | VM_FLAG_GRANTED;
 	vaddr_t begin_va = 0;
 	vaddr_t end_va = 0;
 	size_t pad = 0;
 
 	/*
 	 * Insert an unmapped entry to separate regions with differing
-	 * VM_FLAG_EPHEMERAL, VM_FLAG_PERMANENT or VM_FLAG_SHAREABLE
-	 * bits as they never are to be contiguous with another region.
+	 * VM_FLAG_EPHEMERAL, VM_FLAG_PERMANENT, VM_FLAG_SHAREABLE or
+	 * VM_FLAG_GRANTED bits as they never are to be contiguous with
+	 * another region.
 	 */
 	if (prev_reg->flags && (prev_reg->flags & f) != (reg->flags & f))
 		pad = SMALL_PAGE_SIZE;
@@ -292,10 +412,10 @@ static TEE_Result umap_add_region(struct vm_info *vmi, struct vm_region *reg,
 	return TEE_ERROR_ACCESS_CONFLICT;
 }
 
-TEE_Result vm_map_pad(struct user_mode_ctx *uctx, vaddr_t *va, size_t len,
-		      uint32_t prot, uint32_t flags, struct mobj *mobj,
-		      size_t offs, size_t pad_begin, size_t pad_end,
-		      size_t align)
+static TEE_Result map_pad(struct user_mode_ctx *uctx, vaddr_t *va, size_t len,
+			  uint32_t prot, uint32_t flags, struct mobj *mobj,
+			  size_t offs, size_t pad_begin, size_t pad_end,
+			  size_t align)
 {
 	TEE_Result res = TEE_SUCCESS;
 	struct vm_region *reg = NULL;
@@ -356,7 +476,7 @@ TEE_Result vm_map_pad(struct user_mode_ctx *uctx, vaddr_t *va, size_t len,
 	 * the mapping.
 	 */
 	if (thread_get_tsd()->ctx == uctx->ts_ctx)
-		vm_set_ctx(uctx->ts_ctx);
+		set_ctx(uctx->ts_ctx);
 
 	*va = reg->va;
 
@@ -371,6 +491,21 @@ err_free_reg:
 	return res;
 }
 
+TEE_Result vm_map_pad(struct user_mode_ctx *uctx, vaddr_t *va, size_t len,
+		      uint32_t prot, uint32_t flags, struct mobj *mobj,
+		      size_t offs, size_t pad_begin, size_t pad_end,
+		      size_t align)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	vm_lock(uctx);
+	res = map_pad(uctx, va, len, prot, flags, mobj, offs, pad_begin,
+		      pad_end, align);
+	vm_unlock(uctx);
+
+	return res;
+}
+
 static struct vm_region *find_vm_region(struct vm_info *vm_info, vaddr_t va)
 {
 	struct vm_region *r = NULL;
@@ -554,8 +689,9 @@ static bool cmp_region_for_remap(const struct vm_region *r0,
 	       r0->mobj == r->mobj && rn->offset == r->offset + r->size;
 }
 
-TEE_Result vm_remap(struct user_mode_ctx *uctx, vaddr_t *new_va, vaddr_t old_va,
-		    size_t len, size_t pad_begin, size_t pad_end)
+static TEE_Result remap(struct user_mode_ctx *uctx, vaddr_t *new_va,
+			vaddr_t old_va, size_t len, size_t pad_begin,
+			size_t pad_end)
 {
 	struct vm_region_head regs = TAILQ_HEAD_INITIALIZER(regs);
 	TEE_Result res = TEE_SUCCESS;
@@ -595,7 +731,7 @@ TEE_Result vm_remap(struct user_mode_ctx *uctx, vaddr_t *new_va, vaddr_t old_va,
 	 * Synchronize change to translation tables. Even though the pager
 	 * case unmaps immediately we may still free a translation table.
 	 */
-	vm_set_ctx(uctx->ts_ctx);
+	set_ctx(uctx->ts_ctx);
 
 	r_first = TAILQ_FIRST(&regs);
 	while (!TAILQ_EMPTY(&regs)) {
@@ -656,7 +792,7 @@ TEE_Result vm_remap(struct user_mode_ctx *uctx, vaddr_t *new_va, vaddr_t old_va,
 
 	fobj_put(fobj);
 
-	vm_set_ctx(uctx->ts_ctx);
+	set_ctx(uctx->ts_ctx);
 	*new_va = r_first->va;
 
 	return TEE_SUCCESS;
@@ -680,7 +816,19 @@ err_restore_map:
 		}
 	}
 	fobj_put(fobj);
-	vm_set_ctx(uctx->ts_ctx);
+	set_ctx(uctx->ts_ctx);
+
+	return res;
+}
+
+TEE_Result vm_remap(struct user_mode_ctx *uctx, vaddr_t *new_va, vaddr_t old_va,
+		    size_t len, size_t pad_begin, size_t pad_end)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	vm_lock(uctx);
+	res = remap(uctx, new_va, old_va, len, pad_begin, pad_end);
+	vm_unlock(uctx);
 
 	return res;
 }
@@ -695,21 +843,21 @@ static bool cmp_region_for_get_flags(const struct vm_region *r0,
 TEE_Result vm_get_flags(struct user_mode_ctx *uctx, vaddr_t va, size_t len,
 			uint32_t *flags)
 {
+	TEE_Result res = TEE_ERROR_BAD_PARAMETERS;
 	struct vm_region *r = NULL;
 
 	if (!len || ((len | va) & SMALL_PAGE_MASK))
 		return TEE_ERROR_BAD_PARAMETERS;
 
+	vm_read_lock(uctx);
 	r = find_vm_region(&uctx->vm_info, va);
-	if (!r)
-		return TEE_ERROR_BAD_PARAMETERS;
-
-	if (!va_range_is_contiguous(r, va, len, cmp_region_for_get_flags))
-		return TEE_ERROR_BAD_PARAMETERS;
-
-	*flags = r->flags;
+	if (r && va_range_is_contiguous(r, va, len, cmp_region_for_get_flags)) {
+		*flags = r->flags;
+		res = TEE_SUCCESS;
+	}
+	vm_read_unlock(uctx);
 
-	return TEE_SUCCESS;
+	return res;
 }
 
 static bool cmp_region_for_get_prot(const struct vm_region *r0,
@@ -723,25 +871,25 @@ static bool cmp_region_for_get_prot(const struct vm_region *r0,
 TEE_Result vm_get_prot(struct user_mode_ctx *uctx, vaddr_t va, size_t len,
 		       uint16_t *prot)
 {
+	TEE_Result res = TEE_ERROR_BAD_PARAMETERS;
 	struct vm_region *r = NULL;
 
 	if (!len || ((len | va) & SMALL_PAGE_MASK))
 		return TEE_ERROR_BAD_PARAMETERS;
 
+	vm_read_lock(uctx);
 	r = find_vm_region(&uctx->vm_info, va);
-	if (!r)
-		return TEE_ERROR_BAD_PARAMETERS;
-
-	if (!va_range_is_contiguous(r, va, len, cmp_region_for_get_prot))
-		return TEE_ERROR_BAD_PARAMETERS;
-
-	*prot = r->attr & TEE_MATTR_PROT_MASK;
+	if (r && va_range_is_contiguous(r, va, len, cmp_region_for_get_prot)) {
+		*prot = r->attr & TEE_MATTR_PROT_MASK;
+		res = TEE_SUCCESS;
+	}
+	vm_read_unlock(uctx);
 
-	return TEE_SUCCESS;
+	return res;
 }
 
-TEE_Result vm_set_prot(struct user_mode_ctx *uctx, vaddr_t va, size_t len,
-		       uint32_t prot)
+static TEE_Result set_prot(struct user_mode_ctx *uctx, vaddr_t va, size_t len,
+			   uint32_t prot)
 {
 	TEE_Result res = TEE_SUCCESS;
 	struct vm_region *r0 = NULL;
@@ -804,6 +952,18 @@ TEE_Result vm_set_prot(struct user_mode_ctx *uctx, vaddr_t va, size_t len,
 	return TEE_SUCCESS;
 }
 
+TEE_Result vm_set_prot(struct user_mode_ctx *uctx, vaddr_t va, size_t len,
+		       uint32_t prot)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	vm_lock(uctx);
+	res = set_prot(uctx, va, len, prot);
+	vm_unlock(uctx);
+
+	return res;
+}
+
 static void umap_remove_region(struct vm_info *vmi, struct vm_region *reg)
 {
 	TAILQ_REMOVE(&vmi->regions, reg, link);
@@ -811,7 +971,7 @@ static void umap_remove_region(struct vm_info *vmi, struct vm_region *reg)
 	free(reg);
 }
 
-TEE_Result vm_unmap(struct user_mode_ctx *uctx, vaddr_t va, size_t len)
+static TEE_Result unmap(struct user_mode_ctx *uctx, vaddr_t va, size_t len)
 {
 	TEE_Result res = TEE_SUCCESS;
 	struct vm_region *r = NULL;
@@ -848,6 +1008,17 @@ TEE_Result vm_unmap(struct user_mode_ctx *uctx, vaddr_t va, size_t len)
 	return TEE_SUCCESS;
 }
 
+TEE_Result vm_unmap(struct user_mode_ctx *uctx, vaddr_t va, size_t len)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	vm_lock(uctx);
+	res = unmap(uctx, va, len);
+	vm_unlock(uctx);
+
+	return res;
+}
+
 static TEE_Result map_kinit(struct user_mode_ctx *uctx)
 {
 	TEE_Result res = TEE_SUCCESS;
@@ -887,6 +1058,10 @@ TEE_Result vm_info_init(struct user_mode_ctx *uctx, struct ts_ctx *ts_ctx)
 	}
 
 	memset(uctx, 0, sizeof(*uctx));
+#ifdef CFG_TA_CONCURRENT
+	mutex_init(&uctx->vm_mutex);
+	mutex_init(&uctx->ldelf_mutex);
+#endif
 	TAILQ_INIT(&uctx->vm_info.regions);
 	SLIST_INIT(&uctx->pgt_cache);
 	uctx->vm_info.asid = asid;
@@ -898,31 +1073,81 @@ TEE_Result vm_info_init(struct user_mode_ctx *uctx, struct ts_ctx *ts_ctx)
 	return res;
 }
 
-void vm_clean_param(struct user_mode_ctx *uctx)
+static void clean_param(struct user_mode_ctx *uctx,
+			struct user_mode_thread *umt)
 {
 	struct vm_region *next_r;
 	struct vm_region *r;
 
 	TAILQ_FOREACH_SAFE(r, &uctx->vm_info.regions, link, next_r) {
-		if (r->flags & VM_FLAG_EPHEMERAL) {
+		if ((r->flags & VM_FLAG_EPHEMERAL) && region_has_owner(r, umt)) {
 			rem_um_region(uctx, r);
 			umap_remove_region(&uctx->vm_info, r);
 		}
 	}
 }
 
-static void check_param_map_empty(struct user_mode_ctx *uctx __maybe_unused)
+void vm_clean_param(struct user_mode_ctx *uctx, struct user_mode_thread *umt)
+{
+	vm_lock(uctx);
+	clean_param(uctx, umt);
+	vm_unlock(uctx);
+}
+
+static void check_param_map_empty(struct user_mode_ctx *uctx __maybe_unused,
+				  struct user_mode_thread *umt __maybe_unused)
 {
 	struct vm_region *r = NULL;
 
 	TAILQ_FOREACH(r, &uctx->vm_info.regions, link)
-		assert(!(r->flags & VM_FLAG_EPHEMERAL));
+		assert(!(r->flags & VM_FLAG_EPHEMERAL) ||
+		       !region_has_owner(r, umt));
+}
+
+/*
+ * Returns the VM_FLAG_GRANTED region mapping all of @offs and @size of
+ * @mobj, writeable by user mode if @write.
+ */
+static struct vm_region *find_granted_region(struct user_mode_ctx *uctx,
+					     struct mobj *mobj, size_t offs,
+					     size_t size, bool write)
+{
+	struct vm_region *r = NULL;
+
+	TAILQ_FOREACH(r, &uctx->vm_info.regions, link) {
+		if (!(r->flags & VM_FLAG_GRANTED) || r->mobj != mobj)
+			continue;
+		if (write && !(r->attr & TEE_MATTR_UW))
+			continue;
+		if (core_is_buffer_inside(offs, MAX(size, 1U), r->offset,
+					  r->size))
+			return r;
+	}
+
+	return NULL;
+}
+
+static bool param_is_written(uint32_t param_type)
+{
+	return param_type == TEE_PARAM_TYPE_MEMREF_OUTPUT ||
+	       param_type == TEE_PARAM_TYPE_MEMREF_INOUT;
 }
 
 static TEE_Result param_mem_to_user_va(struct user_mode_ctx *uctx,
-				       struct param_mem *mem, void **user_va)
+				       struct user_mode_thread *umt,
+				       struct param_mem *mem, bool write,
+				       void **user_va)
 {
 	struct vm_region *region = NULL;
+	size_t offs = 0;
+
+	offs = mobj_get_phys_offs(mem->mobj, CORE_MMU_USER_PARAM_SIZE) +
+	       mem->offs;
+	region = find_granted_region(uctx, mem->mobj, offs, mem->size, write);
+	if (region) {
+		*user_va = (void *)(region->va + offs - region->offset);
+		return TEE_SUCCESS;
+	}
 
 	TAILQ_FOREACH(region, &uctx->vm_info.regions, link) {
 		vaddr_t va = 0;
@@ -930,6 +1155,8 @@ static TEE_Result param_mem_to_user_va(struct user_mode_ctx *uctx,
 
 		if (!(region->flags & VM_FLAG_EPHEMERAL))
 			continue;
+		if (!region_has_owner(region, umt))
+			continue;
 		if (mem->mobj != region->mobj)
 			continue;
 
@@ -977,13 +1204,18 @@ static int cmp_param_mem(const void *a0, const void *a1)
 }
 
 TEE_Result vm_map_param(struct user_mode_ctx *uctx, struct tee_ta_param *param,
-			void *param_va[TEE_NUM_PARAMS])
+			void *param_va[TEE_NUM_PARAMS],
+			struct user_mode_thread *umt)
 {
 	TEE_Result res = TEE_SUCCESS;
 	size_t n;
 	size_t m;
 	struct param_mem mem[TEE_NUM_PARAMS];
 
+	evtrace_record(PTA_EVTRACE_ID_VM_MAP_PARAM_ENTER, param->types, 0);
+
+	vm_lock(uctx);
+
 	memset(mem, 0, sizeof(mem));
 	for (n = 0; n < TEE_NUM_PARAMS; n++) {
 		uint32_t param_type = TEE_PARAM_TYPE_GET(param->types, n);
@@ -1007,6 +1239,11 @@ TEE_Result vm_map_param(struct user_mode_ctx *uctx, struct tee_ta_param *param,
 		 */
 		if (!mem[n].size)
 			mem[n].size = CORE_MMU_USER_PARAM_SIZE;
+		/* Memory granted to the TA is already mapped */
+		if (find_granted_region(uctx, mem[n].mobj, mem[n].offs,
+					mem[n].size,
+					param_is_written(param_type)))
+			mem[n].mobj = NULL;
 	}
 
 	/*
@@ -1039,17 +1276,18 @@ TEE_Result vm_map_param(struct user_mode_ctx *uctx, struct tee_ta_param *param,
 	if (mem[0].mobj)
 		m++;
 
-	check_param_map_empty(uctx);
+	check_param_map_empty(uctx, umt);
 
 	for (n = 0; n < m; n++) {
 		vaddr_t va = 0;
 
-		res = vm_map(uctx, &va, mem[n].size,
-			     TEE_MATTR_PRW | TEE_MATTR_URW,
-			     VM_FLAG_EPHEMERAL | VM_FLAG_SHAREABLE,
-			     mem[n].mobj, mem[n].offs);
+		res = map_pad(uctx, &va, mem[n].size,
+			      TEE_MATTR_PRW | TEE_MATTR_URW,
+			      VM_FLAG_EPHEMERAL | VM_FLAG_SHAREABLE,
+			      mem[n].mobj, mem[n].offs, 0, 0, 0);
 		if (res)
 			goto out;
+		region_set_owner(find_vm_region(&uctx->vm_info, va), umt);
 	}
 
 	for (n = 0; n < TEE_NUM_PARAMS; n++) {
@@ -1062,7 +1300,8 @@ TEE_Result vm_map_param(struct user_mode_ctx *uctx, struct tee_ta_param *param,
 		if (!param->u[n].mem.mobj)
 			continue;
 
-		res = param_mem_to_user_va(uctx, &param->u[n].mem,
+		res = param_mem_to_user_va(uctx, umt, &param->u[n].mem,
+					   param_is_written(param_type),
 					   param_va + n);
 		if (res != TEE_SUCCESS)
 			goto out;
@@ -1071,7 +1310,11 @@ TEE_Result vm_map_param(struct user_mode_ctx *uctx, struct tee_ta_param *param,
 	res = alloc_pgt(uctx);
 out:
 	if (res)
-		vm_clean_param(uctx);
+		clean_param(uctx, umt);
+
+	vm_unlock(uctx);
+
+	evtrace_record(PTA_EVTRACE_ID_VM_MAP_PARAM_EXIT, res, 0);
 
 	return res;
 }
@@ -1095,9 +1338,8 @@ void vm_info_final(struct user_mode_ctx *uctx)
 				   TAILQ_FIRST(&uctx->vm_info.regions));
 }
 
-/* return true only if buffer fits inside TA private memory */
-bool vm_buf_is_inside_um_private(const struct user_mode_ctx *uctx,
-				 const void *va, size_t size)
+static bool buf_is_inside_um_private(const struct user_mode_ctx *uctx,
+				     const void *va, size_t size)
 {
 	struct vm_region *r = NULL;
 
@@ -1111,30 +1353,52 @@ bool vm_buf_is_inside_um_private(const struct user_mode_ctx *uctx,
 	return false;
 }
 
+/* return true only if buffer fits inside TA private memory */
+bool vm_buf_is_inside_um_private(const struct user_mode_ctx *uctx,
+				 const void *va, size_t size)
+{
+	bool ret = false;
+
+	vm_read_lock(uctx);
+	ret = buf_is_inside_um_private(uctx, va, size);
+	vm_read_unlock(uctx);
+
+	return ret;
+}
+
 /* return true only if buffer intersects TA private memory */
 bool vm_buf_intersects_um_private(const struct user_mode_ctx *uctx,
 				  const void *va, size_t size)
 {
 	struct vm_region *r = NULL;
+	bool ret = false;
 
+	vm_read_lock(uctx);
 	TAILQ_FOREACH(r, &uctx->vm_info.regions, link) {
 		if (r->attr & VM_FLAGS_NONPRIV)
 			continue;
-		if (core_is_buffer_intersect((vaddr_t)va, size, r->va, r->size))
-			return true;
+		if (core_is_buffer_intersect((vaddr_t)va, size, r->va,
+					     r->size)) {
+			ret = true;
+			break;
+		}
 	}
+	vm_read_unlock(uctx);
 
-	return false;
+	return ret;
 }
 
 TEE_Result vm_buf_to_mboj_offs(const struct user_mode_ctx *uctx,
 			       const void *va, size_t size,
 			       struct mobj **mobj, size_t *offs)
 {
+	struct user_mode_thread *umt = vm_get_current_umt(uctx);
+	TEE_Result res = TEE_ERROR_BAD_PARAMETERS;
 	struct vm_region *r = NULL;
 
+	vm_read_lock(uctx);
 	TAILQ_FOREACH(r, &uctx->vm_info.regions, link) {
-		if (!r->mobj)
+		if (!r->mobj || !region_is_visible(r, umt))
 			continue;
 		if (core_is_buffer_inside((vaddr_t)va, size, r->va, r->size)) {
 			size_t poffs;
@@ -1143,22 +1407,27 @@ TEE_Result vm_buf_to_mboj_offs(const struct user_mode_ctx *uctx,
 						   CORE_MMU_USER_PARAM_SIZE);
 			*mobj = r->mobj;
 			*offs = (vaddr_t)va - r->va + r->offset - poffs;
-			return TEE_SUCCESS;
+			res = TEE_SUCCESS;
+			break;
 		}
 	}
+	vm_read_unlock(uctx);
 
-	return TEE_ERROR_BAD_PARAMETERS;
+	return res;
 }
 
 static TEE_Result tee_mmu_user_va2pa_attr(const struct user_mode_ctx *uctx,
 					  void *ua, paddr_t *pa, uint32_t *attr)
 {
+	struct user_mode_thread *umt = vm_get_current_umt(uctx);
 	struct vm_region *region = NULL;
 
 	TAILQ_FOREACH(region, &uctx->vm_info.regions, link) {
 		if (!core_is_buffer_inside((vaddr_t)ua, 1, region->va,
 					   region->size))
 			continue;
+		if (!region_is_visible(region, umt))
+			return TEE_ERROR_ACCESS_DENIED;
 
 		if (pa) {
 			TEE_Result res;
@@ -1198,10 +1467,18 @@ static TEE_Result tee_mmu_user_va2pa_attr(const struct user_mode_ctx *uctx,
 
 TEE_Result vm_va2pa(const struct user_mode_ctx *uctx, void *ua, paddr_t *pa)
 {
-	return tee_mmu_user_va2pa_attr(uctx, ua, pa, NULL);
+	bool locked = vm_read_trylock(uctx);
+	TEE_Result res = TEE_SUCCESS;
+
+	res = tee_mmu_user_va2pa_attr(uctx, ua, pa, NULL);
+	if (locked)
+		vm_read_unlock(uctx);
+
+	return res;
 }
 
-void *vm_pa2va(const struct user_mode_ctx *uctx, paddr_t pa, size_t pa_size)
+static void *pa2va(const struct user_mode_ctx *uctx, paddr_t pa,
+		   size_t pa_size)
 {
 	paddr_t p = 0;
 	struct vm_region *region = NULL;
@@ -1248,8 +1525,21 @@ void *vm_pa2va(const struct user_mode_ctx *uctx, paddr_t pa, size_t pa_size)
 	return NULL;
 }
 
-TEE_Result vm_check_access_rights(const struct user_mode_ctx *uctx,
-				  uint32_t flags, uaddr_t uaddr, size_t len)
+void *vm_pa2va(const struct user_mode_ctx *uctx, paddr_t pa, size_t pa_size)
+{
+	bool locked = vm_read_trylock(uctx);
+	void *va = NULL;
+
+	va = pa2va(uctx, pa, pa_size);
+	if (locked)
+		vm_read_unlock(uctx);
+
+	return va;
+}
+
+static TEE_Result check_access_rights(const struct user_mode_ctx *uctx,
+				      uint32_t flags, uaddr_t uaddr,
+				      size_t len)
 {
 	uaddr_t a = 0;
 	uaddr_t end_addr = 0;
@@ -1268,7 +1558,7 @@ TEE_Result vm_check_access_rights(const struct user_mode_ctx *uctx,
 	 * to TA or not.
 	 */
 	if (!(flags & TEE_MEMORY_ACCESS_ANY_OWNER) &&
-	   !vm_buf_is_inside_um_private(uctx, (void *)uaddr, len))
+	   !buf_is_inside_um_private(uctx, (void *)uaddr, len))
 		return TEE_ERROR_ACCESS_DENIED;
 
 	for (a = ROUNDDOWN(uaddr, addr_incr); a < end_addr; a += addr_incr) {
@@ -1296,9 +1586,22 @@ TEE_Result vm_check_access_rights(const struct user_mode_ctx *uctx,
 	return TEE_SUCCESS;
 }
 
-void vm_set_ctx(struct ts_ctx *ctx)
+TEE_Result vm_check_access_rights(const struct user_mode_ctx *uctx,
+				  uint32_t flags, uaddr_t uaddr, size_t len)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	vm_read_lock(uctx);
+	res = check_access_rights(uctx, flags, uaddr, len);
+	vm_read_unlock(uctx);
+
+	return res;
+}
+
+static void set_ctx(struct ts_ctx *ctx)
 {
 	struct thread_specific_data *tsd = thread_get_tsd();
+	struct user_mode_thread *umt __maybe_unused = NULL;
 	struct user_mode_ctx *uctx = NULL;
 
 	core_mmu_set_user_map(NULL);
@@ -1319,27 +1622,53 @@ void vm_set_ctx(struct ts_ctx *ctx)
 		core_mmu_create_user_map(uctx, &map);
 		core_mmu_set_user_map(&map);
 		tee_pager_assign_um_tables(uctx);
+#ifdef CFG_TA_CONCURRENT
+		/* Tables kept unused until now aren't referenced any longer */
+		umt = vm_get_current_umt(uctx);
+		if (umt)
+			umt->pgt_gen = uctx->pgt_gen;
+#endif
 	}
 	tsd->ctx = ctx;
 }
 
+void vm_set_ctx(struct ts_ctx *ctx)
+{
+	struct user_mode_ctx *uctx = NULL;
+
+	if (!is_user_mode_ctx(ctx)) {
+		set_ctx(ctx);
+		return;
+	}
+
+	uctx = to_user_mode_ctx(ctx);
+	vm_read_lock(uctx);
+	set_ctx(ctx);
+	vm_read_unlock(uctx);
+}
+
 struct mobj *vm_get_mobj(struct user_mode_ctx *uctx, vaddr_t va, size_t *len,
 			 uint16_t *prot, size_t *offs)
 {
+	struct user_mode_thread *umt = vm_get_current_umt(uctx);
+	struct mobj *mobj = NULL;
 	struct vm_region *r = NULL;
 	size_t r_offs = 0;
 
 	if (!len || ((*len | va) & SMALL_PAGE_MASK))
 		return NULL;
 
+	vm_read_lock(uctx);
 	r = find_vm_region(&uctx->vm_info, va);
-	if (!r)
-		return NULL;
+	if (r && region_is_visible(r, umt)) {
+		r_offs = va - r->va;
 
-	r_offs = va - r->va;
+		*len = MIN(r->size - r_offs, *len);
+		*offs = r->offset + r_offs;
+		*prot = r->attr & TEE_MATTR_PROT_MASK;
+		mobj = mobj_get(r->mobj);
+	}
+	vm_read_unlock(uctx);
 
-	*len = MIN(r->size - r_offs, *len);
-	*offs = r->offset + r_offs;
-	*prot = r->attr & TEE_MATTR_PROT_MASK;
-	return mobj_get(r->mobj);
+	return mobj;
 }
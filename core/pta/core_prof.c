@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#include <kernel/core_prof.h>
+#include <kernel/pseudo_ta.h>
+#include <pta_core_prof.h>
+#include <tee_api_types.h>
+#include <trace.h>
+
+#define PTA_NAME "core_prof.pta"
+
+static TEE_Result start(uint32_t ptypes, TEE_Param params[TEE_NUM_PARAMS])
+{
+	uint32_t exp_pt = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+					  TEE_PARAM_TYPE_NONE,
+					  TEE_PARAM_TYPE_NONE,
+					  TEE_PARAM_TYPE_NONE);
+
+	if (ptypes != exp_pt)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	return core_prof_start(params[0].value.a);
+}
+
+static TEE_Result stop(uint32_t ptypes)
+{
+	if (ptypes != TEE_PARAM_TYPES(TEE_PARAM_TYPE_NONE, TEE_PARAM_TYPE_NONE,
+				      TEE_PARAM_TYPE_NONE, TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	core_prof_stop();
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result export(uint32_t ptypes, TEE_Param params[TEE_NUM_PARAMS])
+{
+	uint32_t exp_pt = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INOUT,
+					  TEE_PARAM_TYPE_MEMREF_OUTPUT,
+					  TEE_PARAM_TYPE_VALUE_OUTPUT,
+					  TEE_PARAM_TYPE_NONE);
+	size_t len = 0;
+	TEE_Result res = TEE_SUCCESS;
+
+	if (ptypes != exp_pt)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	len = params[1].memref.size;
+	res = core_prof_export(&params[0].value.a, params[1].memref.buffer,
+			       &len, &params[2].value.a, &params[2].value.b);
+	if (res)
+		return res;
+
+	params[1].memref.size = len;
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result invoke_command(void *session_context __unused,
+				 uint32_t cmd_id, uint32_t ptypes,
+				 TEE_Param params[TEE_NUM_PARAMS])
+{
+	switch (cmd_id) {
+	case PTA_CORE_PROF_CMD_START:
+		return start(ptypes, params);
+	case PTA_CORE_PROF_CMD_STOP:
+		return stop(ptypes);
+	case PTA_CORE_PROF_CMD_EXPORT:
+		return export(ptypes, params);
+	default:
+		break;
+	}
+
+	return TEE_ERROR_NOT_IMPLEMENTED;
+}
+
+pseudo_ta_register(.uuid = PTA_CORE_PROF_UUID, .name = PTA_NAME,
+		   .flags = PTA_DEFAULT_FLAGS,
+		   .invoke_command_entry_point = invoke_command);
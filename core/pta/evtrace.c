@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#include <kernel/delay.h>
+#include <kernel/evtrace.h>
+#include <kernel/pseudo_ta.h>
+#include <pta_evtrace.h>
+#include <tee_api_types.h>
+#include <trace.h>
+
+#define PTA_NAME "evtrace.pta"
+
+static TEE_Result get_info(uint32_t ptypes, TEE_Param params[TEE_NUM_PARAMS])
+{
+	uint32_t exp_pt = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_OUTPUT,
+					  TEE_PARAM_TYPE_VALUE_OUTPUT,
+					  TEE_PARAM_TYPE_NONE,
+					  TEE_PARAM_TYPE_NONE);
+
+	if (ptypes != exp_pt)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	params[0].value.a = CFG_TEE_CORE_NB_CORE;
+	params[0].value.b = CFG_CORE_EVTRACE_NUM_ENTRIES;
+	params[1].value.a = read_cntfrq();
+	params[1].value.b = atomic_load_uint(&evtrace_mask);
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result set_mask(uint32_t ptypes, TEE_Param params[TEE_NUM_PARAMS])
+{
+	uint32_t exp_pt = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+					  TEE_PARAM_TYPE_NONE,
+					  TEE_PARAM_TYPE_NONE,
+					  TEE_PARAM_TYPE_NONE);
+
+	if (ptypes != exp_pt)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	if (params[0].value.a & ~PTA_EVTRACE_MASK_ALL)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	evtrace_set_mask(params[0].value.a, params[0].value.b);
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result drain(uint32_t ptypes, TEE_Param params[TEE_NUM_PARAMS])
+{
+	uint32_t exp_pt = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+					  TEE_PARAM_TYPE_MEMREF_OUTPUT,
+					  TEE_PARAM_TYPE_VALUE_OUTPUT,
+					  TEE_PARAM_TYPE_NONE);
+	size_t remaining = 0;
+	size_t dropped = 0;
+	size_t count = 0;
+	TEE_Result res = TEE_SUCCESS;
+
+	if (ptypes != exp_pt)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	count = params[1].memref.size / sizeof(struct pta_evtrace_entry);
+	res = evtrace_drain(params[0].value.a, params[1].memref.buffer, &count,
+			    &remaining, &dropped);
+	if (res)
+		return res;
+
+	params[1].memref.size = count * sizeof(struct pta_evtrace_entry);
+	params[2].value.a = remaining;
+	params[2].value.b = dropped;
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result invoke_command(void *session_context __unused,
+				 uint32_t cmd_id, uint32_t ptypes,
+				 TEE_Param params[TEE_NUM_PARAMS])
+{
+	switch (cmd_id) {
+	case PTA_EVTRACE_CMD_GET_INFO:
+		return get_info(ptypes, params);
+	case PTA_EVTRACE_CMD_SET_MASK:
+		return set_mask(ptypes, params);
+	case PTA_EVTRACE_CMD_DRAIN:
+		return drain(ptypes, params);
+	default:
+		break;
+	}
+
+	return TEE_ERROR_NOT_IMPLEMENTED;
+}
+
+pseudo_ta_register(.uuid = PTA_EVTRACE_UUID, .name = PTA_NAME,
+		   .flags = PTA_DEFAULT_FLAGS,
+		   .invoke_command_entry_point = invoke_command);
@@ -4,6 +4,7 @@
  */
 
 #include <kernel/pseudo_ta.h>
+#include <kernel/user_ta.h>
 #include <tee/tadb.h>
 #include <pta_secstor_ta_mgmt.h>
 #include <signed_hdr.h>
@@ -125,7 +126,11 @@ static TEE_Result install_ta(struct shdr *shdr, const uint8_t *nw,
 
 	crypto_hash_free_ctx(hash_ctx);
 	free(buf);
-	return tee_tadb_ta_close_and_commit(ta);
+	res = tee_tadb_ta_close_and_commit(ta);
+	/* Preloaded instances of the TA are of the version it replaces */
+	if (!res)
+		user_ta_pool_flush(&property.uuid);
+	return res;
 
 err_ta_finalize:
 	tee_tadb_ta_close_and_delete(ta);
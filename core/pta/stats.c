@@ -5,9 +5,13 @@
 #include <compiler.h>
 #include <drivers/clk.h>
 #include <drivers/regulator.h>
+#include <drivers/scmi-msg.h>
+#include <kernel/deferred_work.h>
+#include <kernel/interrupt.h>
 #include <kernel/pseudo_ta.h>
 #include <kernel/tee_time.h>
 #include <malloc.h>
+#include <mm/slab.h>
 #include <mm/tee_mm.h>
 #include <mm/tee_pager.h>
 #include <pta_stats.h>
@@ -82,6 +86,14 @@ static TEE_Result get_alloc_stats(uint32_t type, TEE_Param p[TEE_NUM_PARAMS])
 			if (p[0].value.b)
 				nex_malloc_reset_stats();
 			break;
+#endif
+#ifdef CFG_CORE_SLAB
+		case ALLOC_ID_SLAB:
+			slab_get_stats(stats);
+			strlcpy(stats->desc, "Slab", sizeof(stats->desc));
+			if (p[0].value.b)
+				slab_reset_stats();
+			break;
 #endif
 		default:
 			EMSG("Wrong pool id");
@@ -197,6 +209,40 @@ static TEE_Result print_driver_info(uint32_t type, TEE_Param p[TEE_NUM_PARAMS])
 	return TEE_SUCCESS;
 }
 
+static TEE_Result get_itr_stats(uint32_t type, TEE_Param p[TEE_NUM_PARAMS])
+{
+	if (TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_OUTPUT,
+			    TEE_PARAM_TYPE_NONE,
+			    TEE_PARAM_TYPE_NONE,
+			    TEE_PARAM_TYPE_NONE) != type)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	return interrupt_stats(p[0].memref.buffer, &p[0].memref.size);
+}
+
+static TEE_Result get_work_stats(uint32_t type, TEE_Param p[TEE_NUM_PARAMS])
+{
+	if (TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_OUTPUT,
+			    TEE_PARAM_TYPE_NONE,
+			    TEE_PARAM_TYPE_NONE,
+			    TEE_PARAM_TYPE_NONE) != type)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	return deferred_work_stats(p[0].memref.buffer, &p[0].memref.size);
+}
+
+static TEE_Result get_scmi_perf_stats(uint32_t type,
+				      TEE_Param p[TEE_NUM_PARAMS])
+{
+	if (TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_OUTPUT,
+			    TEE_PARAM_TYPE_NONE,
+			    TEE_PARAM_TYPE_NONE,
+			    TEE_PARAM_TYPE_NONE) != type)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	return scmi_perf_domain_stats(p[0].memref.buffer, &p[0].memref.size);
+}
+
 /*
  * Trusted Application Entry Points
  */
@@ -218,6 +264,12 @@ static TEE_Result invoke_command(void *psess __unused,
 		return get_system_time(ptypes, params);
 	case STATS_CMD_PRINT_DRIVER_INFO:
 		return print_driver_info(ptypes, params);
+	case STATS_CMD_ITR_STATS:
+		return get_itr_stats(ptypes, params);
+	case STATS_CMD_WORK_STATS:
+		return get_work_stats(ptypes, params);
+	case STATS_CMD_SCMI_PERF_STATS:
+		return get_scmi_perf_stats(ptypes, params);
 	default:
 		break;
 	}
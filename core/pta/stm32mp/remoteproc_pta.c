@@ -3,6 +3,7 @@
  * Copyright (C) 2023, STMicroelectronics - All Rights Reserved
  */
 
+#include <arm.h>
 #include <crypto/crypto.h>
 #include <drivers/clk.h>
 #include <drivers/rstctrl.h>
@@ -10,6 +11,7 @@
 #include <drivers/stm32mp_dt_bindings.h>
 #include <drivers/stm32mp1_rcc.h>
 #include <initcall.h>
+#include <kernel/delay.h>
 #include <kernel/pseudo_ta.h>
 #include <kernel/user_ta.h>
 #include <remoteproc_pta.h>
@@ -53,6 +55,22 @@ enum rproc_load_state {
 /* Currently supporting a single remote processor instance */
 static enum rproc_load_state rproc_ta_state = REMOTEPROC_OFF;
 
+/*
+ * Segments are copied, hashed and decrypted by chunks of this size so that
+ * each chunk is still in the data cache for the next step.
+ */
+#define RPROC_LOAD_CHUNK_SIZE	(16 * 1024)
+
+/*
+ * Time in counter ticks spent in each step of the segment loads since
+ * PTA_REMOTEPROC_GET_MEM
+ */
+static struct {
+	uint64_t copy;
+	uint64_t hash;
+	uint64_t decrypt;
+} load_ticks;
+
 static TEE_Result rproc_pta_capabilities(uint32_t pt,
 					 TEE_Param params[TEE_NUM_PARAMS])
 {
@@ -81,45 +99,68 @@ static TEE_Result rproc_pta_capabilities(uint32_t pt,
 	return TEE_SUCCESS;
 }
 
-static TEE_Result rproc_pta_decrypt_aes(uint32_t enc_algo, uint8_t *iv,
-					uint8_t *buff, size_t len)
+static TEE_Result rproc_pta_get_aes_key(const uint8_t **key, size_t *key_len)
 {
-	TEE_Result res = TEE_SUCCESS;
-	const uint8_t *key = NULL;
-	size_t key_len = 0;
-	void *ctx = NULL;
-
 #ifndef CFG_REMOTEPROC_ENC_TEST
 	/* TODO: Implement code to retrieve code from OTP or secure storage. */
 	EMSG("Decryption not supported!");
+	*key = NULL;
+	*key_len = 0;
 	return TEE_ERROR_NOT_SUPPORTED;
 #else
-	key = aes_zero_tst_key;
-	key_len = TEE_AES_MAX_KEY_SIZE;
+	*key = aes_zero_tst_key;
+	*key_len = TEE_AES_MAX_KEY_SIZE;
+	return TEE_SUCCESS;
 #endif
+}
 
-	res = crypto_cipher_alloc_ctx(&ctx, enc_algo);
-	if (res)
-		return res;
+static uint64_t ticks_since(uint64_t *t)
+{
+	uint64_t prev = *t;
 
-	res = crypto_cipher_init(ctx, TEE_MODE_DECRYPT, key, key_len,
-				 NULL, 0, iv, TEE_AES_BLOCK_SIZE);
-	if (res)
-		goto out;
+	*t = barrier_read_counter_timer();
 
-	/* In-place decryption in the destination memory*/
-	res = crypto_cipher_update(ctx, TEE_MODE_DECRYPT, true, buff,
-				   len, buff);
-	if (res)
-		goto out;
+	return *t - prev;
+}
 
-	crypto_cipher_final(ctx);
-out:
-	if (res)
-		memzero_explicit(buff, len);
-	crypto_cipher_free_ctx(ctx);
+/*
+ * Copies @size bytes from @src to @dst, computes the hash of the copy and
+ * then decrypts it in place if @cipher_ctx isn't NULL, one chunk at a time.
+ */
+static TEE_Result load_chunks(void *dst, const uint8_t *src, size_t size,
+			      void *hash_ctx, void *cipher_ctx)
+{
+	TEE_Result res = TEE_SUCCESS;
+	uint8_t *d = dst;
+	size_t offs = 0;
+	uint64_t t = 0;
+	size_t n = 0;
+
+	t = barrier_read_counter_timer();
+	while (offs < size) {
+		n = MIN(size - offs, (size_t)RPROC_LOAD_CHUNK_SIZE);
+
+		memcpy(d + offs, src + offs, n);
+		load_ticks.copy += ticks_since(&t);
+
+		res = crypto_hash_update(hash_ctx, d + offs, n);
+		load_ticks.hash += ticks_since(&t);
+		if (res)
+			return res;
+
+		if (cipher_ctx) {
+			res = crypto_cipher_update(cipher_ctx, TEE_MODE_DECRYPT,
+						   offs + n == size, d + offs,
+						   n, d + offs);
+			load_ticks.decrypt += ticks_since(&t);
+			if (res)
+				return res;
+		}
+
+		offs += n;
+	}
 
-	return res;
+	return TEE_SUCCESS;
 }
 
 static TEE_Result rproc_pta_load_segment(uint32_t pt,
@@ -130,7 +171,12 @@ static TEE_Result rproc_pta_load_segment(uint32_t pt,
 						TEE_PARAM_TYPE_VALUE_INPUT,
 						TEE_PARAM_TYPE_MEMREF_INPUT);
 	struct rproc_pta_seg_info *seg_info = params[3].memref.buffer;
+	uint8_t digest[TEE_SHA256_HASH_SIZE] = { };
 	TEE_Result res = TEE_ERROR_GENERIC;
+	const uint8_t *key = NULL;
+	void *cipher_ctx = NULL;
+	void *hash_ctx = NULL;
+	size_t key_len = 0;
 	paddr_t pa = 0;
 	void *dst = NULL;
 	uint8_t *src = params[1].memref.buffer;
@@ -150,37 +196,66 @@ static TEE_Result rproc_pta_load_segment(uint32_t pt,
 	if (rproc_ta_state != REMOTEPROC_OFF)
 		return TEE_ERROR_BAD_STATE;
 
+	res = crypto_hash_alloc_ctx(&hash_ctx, TEE_ALG_SHA256);
+	if (res)
+		return res;
+	res = crypto_hash_init(hash_ctx);
+	if (res)
+		goto free_ctx;
+
+	if (seg_info->enc_algo) {
+		res = rproc_pta_get_aes_key(&key, &key_len);
+		if (res)
+			goto free_ctx;
+		res = crypto_cipher_alloc_ctx(&cipher_ctx, seg_info->enc_algo);
+		if (res)
+			goto free_ctx;
+		res = crypto_cipher_init(cipher_ctx, TEE_MODE_DECRYPT, key,
+					 key_len, NULL, 0, seg_info->iv,
+					 TEE_AES_BLOCK_SIZE);
+		if (res)
+			goto free_ctx;
+	}
+
 	/* Get the physical address in local context mapping */
 	res = stm32_rproc_da_to_pa(params[0].value.a, da, size, &pa);
 	if (res)
-		return res;
+		goto free_ctx;
 
 	if (stm32_rproc_map(params[0].value.a, pa, size, &dst)) {
 		EMSG("Can't map region %#"PRIxPA" size %zu", pa, size);
-		return TEE_ERROR_GENERIC;
+		res = TEE_ERROR_GENERIC;
+		goto free_ctx;
 	}
 
-	/* Copy the segment to the remote processor memory */
-	memcpy(dst, src, size);
-
-	/* Verify that loaded segment is valid */
-	res = hash_sha256_check(seg_info->hash, dst, size);
+	/*
+	 * Copy, hash and decrypt the segment in a single pass over the
+	 * remote processor memory. The decrypted data is cleared below if
+	 * the hash of the encrypted data doesn't match.
+	 */
+	res = load_chunks(dst, src, size, hash_ctx, cipher_ctx);
+	if (cipher_ctx)
+		crypto_cipher_final(cipher_ctx);
 	if (res)
 		goto clean_mem;
 
-	if (res || !seg_info->enc_algo)
-		goto unmap;
+	res = crypto_hash_final(hash_ctx, digest, sizeof(digest));
+	if (res)
+		goto clean_mem;
+	if (consttime_memcmp(digest, seg_info->hash, sizeof(digest))) {
+		res = TEE_ERROR_SECURITY;
+		goto clean_mem;
+	}
 
-	/* Decrypt the segment copied in destination memory */
-	res = rproc_pta_decrypt_aes(seg_info->enc_algo, seg_info->iv,
-				    dst, size);
-	if (res == TEE_SUCCESS)
-		goto unmap;
+	goto unmap;
 
 clean_mem:
 	memzero_explicit(dst, size);
 unmap:
 	stm32_rproc_unmap(params[0].value.a, dst, size);
+free_ctx:
+	crypto_cipher_free_ctx(cipher_ctx);
+	crypto_hash_free_ctx(hash_ctx);
 
 	return res;
 }
@@ -438,6 +513,9 @@ static TEE_Result rproc_pta_get_mem(uint32_t pt,
 	if (rproc_ta_state != REMOTEPROC_OFF)
 		return TEE_ERROR_BAD_STATE;
 
+	/* A new firmware load starts */
+	memset(&load_ticks, 0, sizeof(load_ticks));
+
 	return stm32_rproc_get_mem(params[0].value.a);
 }
 
@@ -458,6 +536,32 @@ static TEE_Result rproc_pta_release_mem(uint32_t pt,
 	return stm32_rproc_release_mem(params[0].value.a);
 }
 
+static uint32_t ticks_to_us(uint64_t ticks)
+{
+	return MIN(timer_cnt2us(ticks), (uint64_t)UINT32_MAX);
+}
+
+static TEE_Result rproc_pta_get_load_stats(uint32_t pt,
+					   TEE_Param params[TEE_NUM_PARAMS])
+{
+	const uint32_t exp_pt = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+						TEE_PARAM_TYPE_VALUE_OUTPUT,
+						TEE_PARAM_TYPE_VALUE_OUTPUT,
+						TEE_PARAM_TYPE_NONE);
+
+	if (pt != exp_pt)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	if (!stm32_rproc_get(params[0].value.a))
+		return TEE_ERROR_NOT_SUPPORTED;
+
+	params[1].value.a = ticks_to_us(load_ticks.copy);
+	params[1].value.b = ticks_to_us(load_ticks.hash);
+	params[2].value.a = ticks_to_us(load_ticks.decrypt);
+
+	return TEE_SUCCESS;
+}
+
 static TEE_Result rproc_pta_invoke_command(void *session __unused,
 					   uint32_t cmd_id,
 					   uint32_t param_types,
@@ -486,6 +590,8 @@ static TEE_Result rproc_pta_invoke_command(void *session __unused,
 		return rproc_pta_get_mem(param_types, params);
 	case PTA_REMOTEPROC_RELEASE_MEM:
 		return rproc_pta_release_mem(param_types, params);
+	case PTA_REMOTEPROC_GET_LOAD_STATS:
+		return rproc_pta_get_load_stats(param_types, params);
 	default:
 		return TEE_ERROR_NOT_IMPLEMENTED;
 	}
@@ -17,6 +17,7 @@
 #include <kernel/ts_store.h>
 #include <kernel/user_access.h>
 #include <kernel/user_mode_ctx.h>
+#include <kernel/user_ta.h>
 #include <ldelf.h>
 #include <mm/file.h>
 #include <mm/fobj.h>
@@ -186,6 +187,20 @@ static TEE_Result system_map_zi(struct user_mode_ctx *uctx,
 	return res;
 }
 
+static TEE_Result unmap(struct user_mode_ctx *uctx, vaddr_t va, size_t sz)
+{
+	TEE_Result res = TEE_SUCCESS;
+	uint32_t vm_flags = 0;
+
+	res = vm_get_flags(uctx, va, sz, &vm_flags);
+	if (res)
+		return res;
+	if (vm_flags & (VM_FLAG_PERMANENT | VM_FLAG_GRANTED))
+		return TEE_ERROR_ACCESS_DENIED;
+
+	return vm_unmap(uctx, va, sz);
+}
+
 static TEE_Result system_unmap(struct user_mode_ctx *uctx, uint32_t param_types,
 			       TEE_Param params[TEE_NUM_PARAMS])
 {
@@ -193,8 +208,8 @@ static TEE_Result system_unmap(struct user_mode_ctx *uctx, uint32_t param_types,
 					  TEE_PARAM_TYPE_VALUE_INPUT,
 					  TEE_PARAM_TYPE_NONE,
 					  TEE_PARAM_TYPE_NONE);
+	struct user_ta_ctx *utc = to_user_ta_ctx(uctx->ts_ctx);
 	TEE_Result res = TEE_SUCCESS;
-	uint32_t vm_flags = 0;
 	vaddr_t end_va = 0;
 	vaddr_t va = 0;
 	size_t sz = 0;
@@ -217,13 +232,14 @@ static TEE_Result system_unmap(struct user_mode_ctx *uctx, uint32_t param_types,
 	if (ADD_OVERFLOW(va, sz, &end_va))
 		return TEE_ERROR_BAD_PARAMETERS;
 
-	res = vm_get_flags(uctx, va, sz, &vm_flags);
+	/* Other invocations of a concurrent TA may use the tables */
+	res = user_ta_begin_exclusive(utc);
 	if (res)
 		return res;
-	if (vm_flags & VM_FLAG_PERMANENT)
-		return TEE_ERROR_ACCESS_DENIED;
+	res = unmap(uctx, va, sz);
+	user_ta_end_exclusive(utc);
 
-	return vm_unmap(uctx, va, sz);
+	return res;
 }
 
 static TEE_Result system_dlopen(struct user_mode_ctx *uctx,
@@ -251,10 +267,17 @@ static TEE_Result system_dlopen(struct user_mode_ctx *uctx,
 
 	flags = params[1].value.a;
 
+	/* ldelf may remap or unmap memory while loading */
+	res = user_ta_begin_exclusive(to_user_ta_ctx(uctx->ts_ctx));
+	if (res)
+		return res;
+
 	s = ts_pop_current_session();
 	res = ldelf_dlopen(uctx, &uuid, flags);
 	ts_push_current_session(s);
 
+	user_ta_end_exclusive(to_user_ta_ctx(uctx->ts_ctx));
+
 	return res;
 }
 
@@ -368,6 +391,70 @@ static TEE_Result open_session(uint32_t param_types __unused,
 	return TEE_SUCCESS;
 }
 
+static TEE_Result system_grant_shm(struct user_mode_ctx *uctx,
+				   uint32_t param_types,
+				   TEE_Param params[TEE_NUM_PARAMS])
+{
+	uint32_t exp_pt = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+					  TEE_PARAM_TYPE_VALUE_INPUT,
+					  TEE_PARAM_TYPE_VALUE_INPUT,
+					  TEE_PARAM_TYPE_NONE);
+	struct user_ta_ctx *utc = to_user_ta_ctx(uctx->ts_ctx);
+	uint32_t flags = TEE_MEMORY_ACCESS_READ | TEE_MEMORY_ACCESS_ANY_OWNER;
+	struct tee_ta_session *s = NULL;
+	TEE_Result res = TEE_SUCCESS;
+	struct mobj *mobj = NULL;
+	uint32_t vm_flags = 0;
+	bool writeable = false;
+	vaddr_t end_va = 0;
+	size_t offs = 0;
+	vaddr_t va = 0;
+	size_t sz = 0;
+
+	if (exp_pt != param_types)
+		return TEE_ERROR_BAD_PARAMETERS;
+	if (params[0].value.b & ~PTA_SYSTEM_MAP_FLAG_WRITEABLE)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	writeable = params[0].value.b & PTA_SYSTEM_MAP_FLAG_WRITEABLE;
+	if (writeable)
+		flags |= TEE_MEMORY_ACCESS_WRITE;
+
+	va = reg_pair_to_64(params[1].value.a, params[1].value.b);
+	sz = params[2].value.a;
+	if (!sz || ADD_OVERFLOW(va, sz, &end_va))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	res = vm_check_access_rights(uctx, flags, va, sz);
+	if (res)
+		return res;
+
+	/* Only whole pages of memory mapped to be shared can be granted */
+	va = ROUNDDOWN(va, SMALL_PAGE_SIZE);
+	if (ROUNDUP_OVERFLOW(end_va, SMALL_PAGE_SIZE, &end_va))
+		return TEE_ERROR_BAD_PARAMETERS;
+	sz = end_va - va;
+
+	res = vm_get_flags(uctx, va, sz, &vm_flags);
+	if (res)
+		return res;
+	if (!(vm_flags & VM_FLAG_SHAREABLE) || (vm_flags & VM_FLAG_EPHEMERAL))
+		return TEE_ERROR_ACCESS_DENIED;
+
+	res = vm_buf_to_mboj_offs(uctx, (void *)va, sz, &mobj, &offs);
+	if (res)
+		return res;
+
+	s = tee_ta_get_session(params[0].value.a, true, &utc->open_sessions);
+	if (!s)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	res = user_ta_grant_shm(s, mobj, offs, sz, writeable);
+	tee_ta_put_session(s);
+
+	return res;
+}
+
 static TEE_Result invoke_command(void *sess_ctx __unused, uint32_t cmd_id,
 				 uint32_t param_types,
 				 TEE_Param params[TEE_NUM_PARAMS])
@@ -392,6 +479,8 @@ static TEE_Result invoke_command(void *sess_ctx __unused, uint32_t cmd_id,
 		return system_get_tpm_event_log(param_types, params);
 	case PTA_SYSTEM_SUPP_PLUGIN_INVOKE:
 		return system_supp_plugin_invoke(param_types, params);
+	case PTA_SYSTEM_GRANT_SHM:
+		return system_grant_shm(uctx, param_types, params);
 	default:
 		break;
 	}
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#include <crypto/crypto.h>
+#include <drvcrypt_async.h>
+#include <kernel/tee_time.h>
+#include <malloc.h>
+#include <pta_invoke_tests.h>
+#include <tee_api_defines.h>
+#include <tee_api_types.h>
+#include <trace.h>
+#include <types_ext.h>
+#include <utee_defines.h>
+#include <util.h>
+
+#include "misc.h"
+
+static const uint8_t aes_key[] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+};
+
+static uint32_t elapsed_ms(TEE_Time *start)
+{
+	TEE_Time now = { };
+	TEE_Time delta = { };
+
+	if (tee_time_get_sys_time(&now))
+		return 0;
+	TEE_TIME_SUB(now, *start, delta);
+
+	return delta.seconds * 1000 + delta.millis;
+}
+
+static TEE_Result run_jobs(void *ctx, size_t unit, size_t max_jobs,
+			   const uint8_t *in, size_t sz, uint8_t *out,
+			   size_t *nb_busy)
+{
+	struct drvcrypt_job **job_ptrs = NULL;
+	struct drvcrypt_job *jobs = NULL;
+	TEE_Result res = TEE_SUCCESS;
+	size_t offs = 0;
+	size_t busy = 0;
+	size_t len = 0;
+	size_t n = 0;
+
+	jobs = calloc(max_jobs, sizeof(*jobs));
+	job_ptrs = calloc(max_jobs, sizeof(*job_ptrs));
+	if (!jobs || !job_ptrs) {
+		res = TEE_ERROR_OUT_OF_MEMORY;
+		goto out;
+	}
+
+	*nb_busy = 0;
+	while (offs < sz) {
+		for (n = 0; n < max_jobs && offs < sz; n++) {
+			len = MIN(unit, sz - offs);
+			jobs[n] = (struct drvcrypt_job){
+				.type = DRVCRYPT_JOB_CIPHER_UPDATE,
+				.ctx = ctx,
+				.mode = TEE_MODE_ENCRYPT,
+				.src = { .data = (uint8_t *)in + offs,
+					 .length = len },
+				.dst = { .data = out + offs, .length = len },
+			};
+			job_ptrs[n] = jobs + n;
+			offs += len;
+		}
+
+		res = drvcrypt_job_run(job_ptrs, n, &busy);
+		*nb_busy += busy;
+		if (res)
+			break;
+	}
+
+out:
+	free(jobs);
+	free(job_ptrs);
+
+	return res;
+}
+
+TEE_Result core_crypto_async_perf_tests(uint32_t param_types,
+					TEE_Param params[TEE_NUM_PARAMS])
+{
+	uint32_t exp_param_types = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+						   TEE_PARAM_TYPE_MEMREF_INPUT,
+						   TEE_PARAM_TYPE_MEMREF_OUTPUT,
+						   TEE_PARAM_TYPE_VALUE_OUTPUT);
+	size_t unit = params[0].value.a;
+	size_t max_jobs = params[0].value.b;
+	size_t sz = params[1].memref.size;
+	TEE_Result res = TEE_SUCCESS;
+	TEE_Time start = { };
+	size_t busy = 0;
+	void *ctx = NULL;
+
+	if (param_types != exp_param_types)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	if (!unit || unit % TEE_AES_BLOCK_SIZE || !max_jobs ||
+	    sz % TEE_AES_BLOCK_SIZE || sz > params[2].memref.size)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	res = crypto_cipher_alloc_ctx(&ctx, TEE_ALG_AES_ECB_NOPAD);
+	if (res)
+		return res;
+
+	res = crypto_cipher_init(ctx, TEE_MODE_ENCRYPT, aes_key,
+				 sizeof(aes_key), NULL, 0, NULL, 0);
+	if (res)
+		goto out;
+
+	res = tee_time_get_sys_time(&start);
+	if (res)
+		goto out;
+
+	res = run_jobs(ctx, unit, max_jobs, params[1].memref.buffer, sz,
+		       params[2].memref.buffer, &busy);
+	if (res)
+		goto out;
+
+	params[2].memref.size = sz;
+	params[3].value.a = elapsed_ms(&start);
+	params[3].value.b = busy;
+
+	DMSG("%zu bytes in jobs of %zu bytes: %"PRIu32" ms, %zu busy",
+	     sz, unit, params[3].value.a, busy);
+out:
+	crypto_cipher_free_ctx(ctx);
+
+	return res;
+}
@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#include <atomic.h>
+#include <kernel/deferred_work.h>
+#include <kernel/notif.h>
+#include <kernel/tee_time.h>
+#include <kernel/thread.h>
+#include <pta_invoke_tests.h>
+#include <tee_api_types.h>
+#include <trace.h>
+
+#include "misc.h"
+
+#define TEST_TIMEOUT_MS	1000
+
+struct test_work {
+	struct deferred_work work;
+	uint32_t count;
+	int thread_id;
+};
+
+static void test_work_fn(struct deferred_work *w)
+{
+	struct test_work *tw = w->data;
+
+	tw->thread_id = thread_get_id();
+	atomic_inc32(&tw->count);
+}
+
+/* Waits until @tw has run @count times, returns false on timeout */
+static bool wait_count(struct test_work *tw, uint32_t count)
+{
+	size_t n = 0;
+
+	for (n = 0; n < TEST_TIMEOUT_MS; n++) {
+		if (atomic_load_u32(&tw->count) >= count)
+			return true;
+		/* Lets the normal world deliver the bottom half */
+		tee_time_wait(1);
+	}
+
+	return false;
+}
+
+static TEE_Result test_queue(struct test_work *tw)
+{
+	deferred_work_queue(&tw->work);
+	if (!wait_count(tw, 1)) {
+		EMSG("Queued work didn't run");
+		return TEE_ERROR_GENERIC;
+	}
+
+	if (tw->thread_id == thread_get_id()) {
+		EMSG("Work ran in the thread queuing it");
+		return TEE_ERROR_GENERIC;
+	}
+
+	/* Queued again once run, the work runs again */
+	deferred_work_queue(&tw->work);
+	if (!wait_count(tw, 2)) {
+		EMSG("Work queued again didn't run");
+		return TEE_ERROR_GENERIC;
+	}
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result test_cancel(struct test_work *tw)
+{
+	uint32_t count = atomic_load_u32(&tw->count);
+	bool cancelled = false;
+
+	deferred_work_queue(&tw->work);
+	cancelled = deferred_work_cancel(&tw->work);
+
+	tee_time_wait(10);
+	if (cancelled && atomic_load_u32(&tw->count) != count) {
+		EMSG("Cancelled work ran");
+		return TEE_ERROR_GENERIC;
+	}
+
+	return TEE_SUCCESS;
+}
+
+TEE_Result core_deferred_work_tests(uint32_t param_types,
+				    TEE_Param params[TEE_NUM_PARAMS] __unused)
+{
+	struct test_work tw = { };
+	TEE_Result res = TEE_SUCCESS;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	/* Work only runs with the asynchronous notification bottom half */
+	if (!notif_async_is_started())
+		return TEE_ERROR_NOT_SUPPORTED;
+
+	deferred_work_init(&tw.work, "test", test_work_fn, &tw);
+
+	res = test_queue(&tw);
+	if (!res)
+		res = test_cancel(&tw);
+
+	deferred_work_remove(&tw.work);
+
+	return res;
+}
@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#include <kernel/tee_time.h>
+#include <kernel/ts_manager.h>
+#include <kernel/user_ta.h>
+#include <pta_invoke_tests.h>
+#include <tee/tee_fs.h>
+#include <tee/tee_pobj.h>
+#include <tee_api_defines.h>
+#include <tee_api_types.h>
+#include <trace.h>
+#include <types_ext.h>
+#include <utee_defines.h>
+#include <util.h>
+
+#include "misc.h"
+
+static const char obj_id[] = "fs_perf";
+
+static uint32_t elapsed_ms(TEE_Time *start)
+{
+	TEE_Time now = { };
+	TEE_Time delta = { };
+
+	if (tee_time_get_sys_time(&now))
+		return 0;
+	TEE_TIME_SUB(now, *start, delta);
+
+	return delta.seconds * 1000 + delta.millis;
+}
+
+/*
+ * With @user, @buf is TA memory and is passed as such to the file
+ * operations, as the storage syscalls do.
+ */
+static TEE_Result write_chunks(struct tee_pobj *po, size_t chunk,
+			       const uint8_t *buf, size_t sz, bool user)
+{
+	struct tee_file_handle *fh = NULL;
+	TEE_Result res = TEE_SUCCESS;
+	size_t offs = 0;
+
+	res = po->fops->create(po, true, NULL, 0, NULL, 0, NULL, NULL, 0, &fh);
+	if (res)
+		return res;
+
+	for (offs = 0; offs < sz && !res; offs += chunk)
+		res = po->fops->write(fh, offs, user ? NULL : buf + offs,
+				      user ? buf + offs : NULL,
+				      MIN(chunk, sz - offs));
+
+	po->fops->close(&fh);
+
+	return res;
+}
+
+static TEE_Result read_chunks(struct tee_pobj *po, size_t chunk,
+			      uint8_t *buf, size_t sz, bool user)
+{
+	struct tee_file_handle *fh = NULL;
+	TEE_Result res = TEE_SUCCESS;
+	size_t offs = 0;
+	size_t len = 0;
+
+	res = po->fops->open(po, NULL, &fh);
+	if (res)
+		return res;
+
+	for (offs = 0; offs < sz && !res; offs += chunk) {
+		len = MIN(chunk, sz - offs);
+		res = po->fops->read(fh, offs, user ? NULL : buf + offs,
+				     user ? buf + offs : NULL, &len);
+		if (!res && len != MIN(chunk, sz - offs))
+			res = TEE_ERROR_CORRUPT_OBJECT;
+	}
+
+	po->fops->close(&fh);
+
+	return res;
+}
+
+TEE_Result core_fs_perf_tests(uint32_t param_types,
+			      TEE_Param params[TEE_NUM_PARAMS])
+{
+	uint32_t exp_param_types = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+						   TEE_PARAM_TYPE_MEMREF_INPUT,
+						   TEE_PARAM_TYPE_MEMREF_OUTPUT,
+						   TEE_PARAM_TYPE_VALUE_OUTPUT);
+	const struct tee_file_operations *fops = NULL;
+	struct ts_session *sess = ts_get_current_session();
+	struct ts_session *caller = ts_get_calling_session();
+	size_t chunk = params[0].value.a;
+	size_t sz = params[1].memref.size;
+	TEE_Result res = TEE_SUCCESS;
+	struct tee_pobj *po = NULL;
+	TEE_Time start = { };
+	bool user = false;
+
+	if (param_types != exp_param_types)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	if (!chunk || sz > params[2].memref.size)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	/* Invoked by a TA the buffers are in the mapping of the TA */
+	user = caller && is_user_ta_ctx(caller->ctx);
+
+	fops = tee_svc_storage_file_ops(TEE_STORAGE_PRIVATE_REE);
+	if (!fops)
+		return TEE_ERROR_NOT_SUPPORTED;
+
+	res = tee_pobj_get(&sess->ctx->uuid, (void *)obj_id,
+			   sizeof(obj_id) - 1,
+			   TEE_DATA_FLAG_ACCESS_READ |
+			   TEE_DATA_FLAG_ACCESS_WRITE |
+			   TEE_DATA_FLAG_ACCESS_WRITE_META,
+			   TEE_POBJ_USAGE_CREATE, fops, &po);
+	if (res)
+		return res;
+
+	res = tee_time_get_sys_time(&start);
+	if (res)
+		goto out;
+	res = write_chunks(po, chunk, params[1].memref.buffer, sz, user);
+	if (res)
+		goto out;
+	params[3].value.a = elapsed_ms(&start);
+
+	res = tee_time_get_sys_time(&start);
+	if (res)
+		goto out;
+	res = read_chunks(po, chunk, params[2].memref.buffer, sz, user);
+	if (res)
+		goto out;
+	params[3].value.b = elapsed_ms(&start);
+
+	params[2].memref.size = sz;
+
+	DMSG("%zu bytes in chunks of %zu bytes from %s: write %"PRIu32" ms, read %"PRIu32" ms",
+	     sz, chunk, user ? "TA" : "core", params[3].value.a,
+	     params[3].value.b);
+out:
+	fops->remove(po);
+	tee_pobj_release(po);
+
+	return res;
+}
@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#include <kernel/ts_manager.h>
+#include <pta_invoke_tests.h>
+#include <string.h>
+#include <tee/tee_fs.h>
+#include <tee/tee_pobj.h>
+#include <tee/tee_svc_storage.h>
+#include <tee_api_defines.h>
+#include <tee_api_types.h>
+#include <trace.h>
+
+#include "misc.h"
+
+static const char committed[] = "committed";
+static const char staged[] = "staged";
+
+static TEE_Result get_pobj(struct ts_session *sess,
+			   const struct tee_file_operations *fops,
+			   const char *id, struct tee_pobj **po)
+{
+	return tee_pobj_get(&sess->ctx->uuid, (void *)id, strlen(id),
+			    TEE_DATA_FLAG_ACCESS_READ |
+			    TEE_DATA_FLAG_ACCESS_WRITE |
+			    TEE_DATA_FLAG_ACCESS_WRITE_META,
+			    TEE_POBJ_USAGE_CREATE, fops, po);
+}
+
+static TEE_Result create_obj(struct tee_pobj *po, const char *data)
+{
+	struct tee_file_handle *fh = NULL;
+	TEE_Result res = TEE_SUCCESS;
+
+	res = po->fops->create(po, true, NULL, 0, NULL, 0, data, NULL,
+			       strlen(data), &fh);
+	if (!res)
+		po->fops->close(&fh);
+
+	return res;
+}
+
+static TEE_Result write_obj(struct tee_pobj *po, const char *data)
+{
+	struct tee_file_handle *fh = NULL;
+	TEE_Result res = TEE_SUCCESS;
+
+	res = po->fops->open(po, NULL, &fh);
+	if (res)
+		return res;
+	res = po->fops->write(fh, 0, data, NULL, strlen(data));
+	po->fops->close(&fh);
+
+	return res;
+}
+
+/* Checks that the object of @po holds @data, or doesn't exist if NULL */
+static TEE_Result check_obj(struct tee_pobj *po, const char *data)
+{
+	struct tee_file_handle *fh = NULL;
+	char buf[sizeof(committed)] = { };
+	TEE_Result res = TEE_SUCCESS;
+	size_t len = sizeof(buf);
+
+	res = po->fops->open(po, NULL, &fh);
+	if (!data) {
+		if (res == TEE_ERROR_ITEM_NOT_FOUND)
+			return TEE_SUCCESS;
+		if (!res)
+			po->fops->close(&fh);
+		EMSG("Object found: %#"PRIx32, res);
+		return TEE_ERROR_GENERIC;
+	}
+	if (res) {
+		EMSG("Object not found: %#"PRIx32, res);
+		return TEE_ERROR_GENERIC;
+	}
+
+	res = po->fops->read(fh, 0, buf, NULL, &len);
+	po->fops->close(&fh);
+	if (res || len < strlen(data) || memcmp(buf, data, strlen(data))) {
+		EMSG("Unexpected content: %#"PRIx32, res);
+		return TEE_ERROR_GENERIC;
+	}
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result test_commit(struct ts_session *sess, struct tee_pobj *po)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	res = po->fops->begin_tx(sess);
+	if (!res)
+		res = create_obj(po, committed);
+	if (!res)
+		res = po->fops->commit_tx(sess);
+	if (res) {
+		EMSG("Transaction failed: %#"PRIx32, res);
+		po->fops->abort_tx(sess);
+		return TEE_ERROR_GENERIC;
+	}
+
+	return check_obj(po, committed);
+}
+
+static TEE_Result test_abort(struct ts_session *sess, struct tee_pobj *po,
+			     struct tee_pobj *po2)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	res = po->fops->begin_tx(sess);
+	if (!res)
+		res = write_obj(po, staged);
+	if (!res)
+		res = create_obj(po2, staged);
+	po->fops->abort_tx(sess);
+	if (res) {
+		EMSG("Transaction failed: %#"PRIx32, res);
+		return TEE_ERROR_GENERIC;
+	}
+
+	res = check_obj(po, committed);
+	if (!res)
+		res = check_obj(po2, NULL);
+
+	return res;
+}
+
+/* Done by user_ta.c when the invocation of the owner returns */
+static TEE_Result test_abort_on_return(struct ts_session *sess,
+				       struct tee_pobj *po2)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	res = po2->fops->begin_tx(sess);
+	if (res) {
+		EMSG("Begin failed: %#"PRIx32, res);
+		return TEE_ERROR_GENERIC;
+	}
+
+	res = po2->fops->begin_tx(sess);
+	if (res != TEE_ERROR_BAD_STATE) {
+		EMSG("Second begin returned %#"PRIx32, res);
+		res = TEE_ERROR_GENERIC;
+	} else {
+		res = create_obj(po2, staged);
+	}
+	tee_svc_storage_abort_all_tx(sess);
+	if (res)
+		return res;
+
+	return check_obj(po2, NULL);
+}
+
+TEE_Result core_fs_tx_tests(uint32_t param_types,
+			    TEE_Param params[TEE_NUM_PARAMS] __unused)
+{
+	const struct tee_file_operations *fops = NULL;
+	struct ts_session *sess = ts_get_current_session();
+	TEE_Result res = TEE_SUCCESS;
+	struct tee_pobj *po2 = NULL;
+	struct tee_pobj *po = NULL;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	fops = tee_svc_storage_file_ops(TEE_STORAGE_PRIVATE_REE);
+	if (!fops || !fops->begin_tx)
+		return TEE_ERROR_NOT_SUPPORTED;
+
+	res = get_pobj(sess, fops, "fs_tx", &po);
+	if (res)
+		return res;
+	res = get_pobj(sess, fops, "fs_tx2", &po2);
+	if (res)
+		goto out;
+
+	res = test_commit(sess, po);
+	if (!res)
+		res = test_abort(sess, po, po2);
+	if (!res)
+		res = test_abort_on_return(sess, po2);
+
+	fops->remove(po2);
+	tee_pobj_release(po2);
+out:
+	fops->remove(po);
+	tee_pobj_release(po);
+
+	return res;
+}
@@ -434,6 +434,22 @@ static TEE_Result invoke_command(void *pSessionContext __unused,
 		return core_aes_perf_tests(nParamTypes, pParams);
 	case PTA_INVOKE_TESTS_CMD_DT_DRIVER_TESTS:
 		return core_dt_driver_tests(nParamTypes, pParams);
+	case PTA_INVOKE_TESTS_CMD_CRYPTO_ASYNC_PERF:
+		return core_crypto_async_perf_tests(nParamTypes, pParams);
+	case PTA_INVOKE_TESTS_CMD_FS_PERF:
+		return core_fs_perf_tests(nParamTypes, pParams);
+	case PTA_INVOKE_TESTS_CMD_SCMI_PERF:
+		return core_scmi_perf_tests(nParamTypes, pParams);
+	case PTA_INVOKE_TESTS_CMD_TIMER_WHEEL:
+		return core_timer_wheel_tests(nParamTypes, pParams);
+	case PTA_INVOKE_TESTS_CMD_DEFERRED_WORK:
+		return core_deferred_work_tests(nParamTypes, pParams);
+	case PTA_INVOKE_TESTS_CMD_PARALLEL:
+		return core_parallel_tests(nParamTypes, pParams);
+	case PTA_INVOKE_TESTS_CMD_FS_TX:
+		return core_fs_tx_tests(nParamTypes, pParams);
+	case PTA_INVOKE_TESTS_CMD_SOCKET_LOOPBACK:
+		return core_socket_loopback_tests(nParamTypes, pParams);
 	case PTA_INVOKE_TESTS_CMD_MBOX_TESTS:
 		return core_mbox_tests(nParamTypes, pParams);
 	default:
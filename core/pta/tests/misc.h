@@ -37,4 +37,100 @@ TEE_Result core_aes_perf_tests(uint32_t param_types,
 TEE_Result core_dt_driver_tests(uint32_t param_types,
 				TEE_Param params[TEE_NUM_PARAMS]);
 
+#ifdef CFG_CRYPTO_DRV_ASYNC
+TEE_Result core_crypto_async_perf_tests(uint32_t param_types,
+					TEE_Param params[TEE_NUM_PARAMS]);
+#else
+static inline TEE_Result core_crypto_async_perf_tests(
+		uint32_t param_types __unused,
+		TEE_Param params[TEE_NUM_PARAMS] __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+#endif
+
+#ifdef CFG_REE_FS
+TEE_Result core_fs_perf_tests(uint32_t param_types,
+			      TEE_Param params[TEE_NUM_PARAMS]);
+#else
+static inline TEE_Result core_fs_perf_tests(
+		uint32_t param_types __unused,
+		TEE_Param params[TEE_NUM_PARAMS] __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+#endif
+
+#ifdef CFG_SCMI_MSG_SMT
+TEE_Result core_scmi_perf_tests(uint32_t param_types,
+				TEE_Param params[TEE_NUM_PARAMS]);
+#else
+static inline TEE_Result core_scmi_perf_tests(
+		uint32_t param_types __unused,
+		TEE_Param params[TEE_NUM_PARAMS] __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+#endif
+
+#ifdef CFG_TIMER_WHEEL
+TEE_Result core_timer_wheel_tests(uint32_t param_types,
+				  TEE_Param params[TEE_NUM_PARAMS]);
+#else
+static inline TEE_Result core_timer_wheel_tests(
+		uint32_t param_types __unused,
+		TEE_Param params[TEE_NUM_PARAMS] __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+#endif
+
+#ifdef CFG_DEFERRED_WORK
+TEE_Result core_deferred_work_tests(uint32_t param_types,
+				    TEE_Param params[TEE_NUM_PARAMS]);
+#else
+static inline TEE_Result core_deferred_work_tests(
+		uint32_t param_types __unused,
+		TEE_Param params[TEE_NUM_PARAMS] __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+#endif
+
+#ifdef CFG_CORE_PARALLEL_WORKERS
+TEE_Result core_parallel_tests(uint32_t param_types,
+			       TEE_Param params[TEE_NUM_PARAMS]);
+#else
+static inline TEE_Result core_parallel_tests(
+		uint32_t param_types __unused,
+		TEE_Param params[TEE_NUM_PARAMS] __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+#endif
+
+#ifdef CFG_REE_FS
+TEE_Result core_fs_tx_tests(uint32_t param_types,
+			    TEE_Param params[TEE_NUM_PARAMS]);
+#else
+static inline TEE_Result core_fs_tx_tests(
+		uint32_t param_types __unused,
+		TEE_Param params[TEE_NUM_PARAMS] __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+#endif
+
+#ifdef CFG_SOCKET_LOOPBACK
+TEE_Result core_socket_loopback_tests(uint32_t param_types,
+				      TEE_Param params[TEE_NUM_PARAMS]);
+#else
+static inline TEE_Result core_socket_loopback_tests(
+		uint32_t param_types __unused,
+		TEE_Param params[TEE_NUM_PARAMS] __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+#endif
+
 #endif /*CORE_PTA_TESTS_MISC_H*/
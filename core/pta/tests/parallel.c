@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#include <atomic.h>
+#include <kernel/delay.h>
+#include <kernel/parallel.h>
+#include <kernel/thread.h>
+#include <pta_invoke_tests.h>
+#include <tee_api_types.h>
+#include <trace.h>
+
+#include "misc.h"
+
+#define TEST_ITEMS	64
+
+struct test_job {
+	int thread_id;		/* Thread calling parallel_for() */
+	uint32_t ran[TEST_ITEMS];
+	uint32_t helped;	/* Items run by a helper thread */
+	size_t fail_idx[2];
+};
+
+static TEE_Result test_item(void *arg, size_t idx)
+{
+	struct test_job *job = arg;
+
+	atomic_inc32(job->ran + idx);
+	if (thread_get_id() != job->thread_id)
+		atomic_inc32(&job->helped);
+
+	/* Leaves a chance for the helpers to claim items */
+	udelay(100);
+
+	if (idx == job->fail_idx[0])
+		return TEE_ERROR_BAD_STATE;
+	if (idx == job->fail_idx[1])
+		return TEE_ERROR_GENERIC;
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result test_all_items(void)
+{
+	struct test_job job = {
+		.thread_id = thread_get_id(),
+		.fail_idx = { SIZE_MAX, SIZE_MAX },
+	};
+	TEE_Result res = TEE_SUCCESS;
+	size_t n = 0;
+
+	res = parallel_for(TEST_ITEMS, test_item, &job);
+	if (res) {
+		EMSG("parallel_for() failed: %#"PRIx32, res);
+		return TEE_ERROR_GENERIC;
+	}
+
+	for (n = 0; n < TEST_ITEMS; n++) {
+		if (job.ran[n] != 1) {
+			EMSG("Item %zu ran %"PRIu32" times", n, job.ran[n]);
+			return TEE_ERROR_GENERIC;
+		}
+	}
+
+	DMSG("%"PRIu32" of %d items run by helpers", job.helped, TEST_ITEMS);
+
+	return TEE_SUCCESS;
+}
+
+/*
+ * The error of the lowest failing index is returned whichever item failed
+ * first, and no item runs twice.
+ */
+static TEE_Result test_error(void)
+{
+	struct test_job job = {
+		.thread_id = thread_get_id(),
+		.fail_idx = { 20, 5 },
+	};
+	TEE_Result res = TEE_SUCCESS;
+	size_t n = 0;
+
+	res = parallel_for(TEST_ITEMS, test_item, &job);
+	if (res != TEE_ERROR_GENERIC) {
+		EMSG("Got %#"PRIx32" instead of the error of item 5", res);
+		return TEE_ERROR_GENERIC;
+	}
+
+	for (n = 0; n < TEST_ITEMS; n++) {
+		if (job.ran[n] > 1) {
+			EMSG("Item %zu ran %"PRIu32" times", n, job.ran[n]);
+			return TEE_ERROR_GENERIC;
+		}
+	}
+
+	return TEE_SUCCESS;
+}
+
+TEE_Result core_parallel_tests(uint32_t param_types,
+			       TEE_Param params[TEE_NUM_PARAMS] __unused)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	res = test_all_items();
+	if (!res)
+		res = test_error();
+
+	return res;
+}
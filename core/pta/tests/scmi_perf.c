@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#include <drivers/scmi-msg.h>
+#include <drivers/scmi.h>
+#include <kernel/delay.h>
+#include <malloc.h>
+#include <pta_invoke_tests.h>
+#include <string.h>
+#include <tee_api_types.h>
+#include <trace.h>
+#include <util.h>
+
+#include "misc.h"
+
+#define MAX_BATCH	64
+
+/* SCMI_PROTOCOL_VERSION of the base protocol, supported on all channels */
+#define PERF_MSG_HDR	SMT_HDR(SCMI_PROTOCOL_ID_BASE, 0)
+
+struct perf_agent {
+	struct scmi_msg_channel channel;
+	unsigned int channel_id;
+	uint8_t *shm;
+};
+
+static struct smt_header *get_slot(struct perf_agent *agent, size_t slot)
+{
+	return (void *)(agent->shm + slot * SMT_BUF_SLOT_SIZE);
+}
+
+static void post_message(struct smt_header *hdr)
+{
+	hdr->message_header = PERF_MSG_HDR;
+	hdr->length = sizeof(hdr->message_header);
+	hdr->status &= ~SMT_STATUS_FREE;
+}
+
+static TEE_Result check_response(struct smt_header *hdr)
+{
+	if ((hdr->status & (SMT_STATUS_FREE | SMT_STATUS_ERROR)) !=
+	    SMT_STATUS_FREE || hdr->payload[0] != SCMI_SUCCESS)
+		return TEE_ERROR_COMMUNICATION;
+
+	return TEE_SUCCESS;
+}
+
+/* Posts @batch messages @count times, with an entry per batch if @ring */
+static TEE_Result run_batches(struct perf_agent *agent, size_t batch,
+			      size_t count, bool ring, uint64_t *ticks)
+{
+	TEE_Result res = TEE_SUCCESS;
+	uint64_t start = 0;
+	size_t n = 0;
+	size_t i = 0;
+
+	agent->channel.ring_slots = ring ? batch : 1;
+	scmi_smt_init_agent_channel(&agent->channel);
+
+	start = barrier_read_counter_timer();
+
+	for (i = 0; i < count && !res; i++) {
+		if (ring) {
+			for (n = 0; n < batch; n++)
+				post_message(get_slot(agent, n));
+			scmi_smt_local_entry(&agent->channel,
+					     agent->channel_id);
+			for (n = 0; n < batch && !res; n++)
+				res = check_response(get_slot(agent, n));
+		} else {
+			for (n = 0; n < batch && !res; n++) {
+				post_message(get_slot(agent, 0));
+				scmi_smt_local_entry(&agent->channel,
+						     agent->channel_id);
+				res = check_response(get_slot(agent, 0));
+			}
+		}
+	}
+
+	*ticks = barrier_read_counter_timer() - start;
+
+	return res;
+}
+
+static uint32_t ticks_to_us(uint64_t ticks)
+{
+	return MIN(timer_cnt2us(ticks), (uint64_t)UINT32_MAX);
+}
+
+TEE_Result core_scmi_perf_tests(uint32_t param_types,
+				TEE_Param params[TEE_NUM_PARAMS])
+{
+	uint32_t exp_pt = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+					  TEE_PARAM_TYPE_VALUE_INPUT,
+					  TEE_PARAM_TYPE_VALUE_OUTPUT,
+					  TEE_PARAM_TYPE_NONE);
+	struct perf_agent agent = { };
+	TEE_Result res = TEE_SUCCESS;
+	uint64_t single_ticks = 0;
+	uint64_t ring_ticks = 0;
+	size_t batch = 0;
+	size_t count = 0;
+
+	if (param_types != exp_pt)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	agent.channel_id = params[0].value.a;
+	batch = params[0].value.b;
+	count = params[1].value.a;
+	if (!batch || batch > MAX_BATCH ||
+	    !plat_scmi_get_channel(agent.channel_id))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	agent.shm = malloc(batch * SMT_BUF_SLOT_SIZE);
+	if (!agent.shm)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	agent.channel.shm_size = SMT_BUF_SLOT_SIZE;
+	agent.channel.threaded = true;
+	scmi_smt_set_shared_buffer(&agent.channel, agent.shm);
+
+	res = run_batches(&agent, batch, count, false, &single_ticks);
+	if (!res)
+		res = run_batches(&agent, batch, count, true, &ring_ticks);
+	if (!res) {
+		params[2].value.a = ticks_to_us(single_ticks);
+		params[2].value.b = ticks_to_us(ring_ticks);
+		IMSG("SCMI %zu x %zu messages: %"PRIu32" us, batched %"PRIu32" us",
+		     count, batch, params[2].value.a, params[2].value.b);
+	}
+
+	scmi_smt_set_shared_buffer(&agent.channel, NULL);
+	free(agent.shm);
+
+	return res;
+}
@@ -0,0 +1,424 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#include <__tee_ipsocket.h>
+#include <__tee_isocket_defines.h>
+#include <__tee_udpsocket_defines.h>
+#include <assert.h>
+#include <kernel/pseudo_ta.h>
+#include <kernel/ts_manager.h>
+#include <kernel/user_access.h>
+#include <kernel/user_ta.h>
+#include <pta_invoke_tests.h>
+#include <pta_socket.h>
+#include <string.h>
+#include <tee_api_types.h>
+#include <trace.h>
+#include <util.h>
+
+#include "misc.h"
+
+/*
+ * The socket PTA is called through its entry points with buffers in the
+ * scratch buffer of the calling TA, as when the TA calls it. The sockets
+ * are served by CFG_SOCKET_LOOPBACK.
+ */
+
+/* Layout of the scratch buffer of the TA */
+#define OFFS_ADDR	0
+#define OFFS_IOV	32
+#define MAX_IOV		4
+#define OFFS_DATA	(OFFS_IOV + MAX_IOV * sizeof(struct pta_socket_iov))
+#define DATA_SIZE	160
+#define MIN_BUF_SIZE	(OFFS_DATA + DATA_SIZE)
+
+static const char *const dgrams[] = { "one", "two", "three" };
+static const char *const pieces[] = { "multi", "-iov", "-datagram" };
+
+struct socket_test {
+	const struct pseudo_ta_head *pta;
+	void *sess_ctx;
+	uint8_t *ubuf;		/* Scratch buffer of the TA */
+	uint32_t handle;
+};
+
+static const struct pseudo_ta_head *find_socket_pta(void)
+{
+	const struct pseudo_ta_head *pta = NULL;
+	const TEE_UUID uuid = PTA_SOCKET_UUID;
+
+	SCATTERED_ARRAY_FOREACH(pta, pseudo_tas, struct pseudo_ta_head)
+		if (!memcmp(&pta->uuid, &uuid, sizeof(uuid)))
+			return pta;
+
+	return NULL;
+}
+
+static TEE_Result invoke(struct socket_test *t, uint32_t cmd,
+			 uint32_t param_types, TEE_Param params[TEE_NUM_PARAMS])
+{
+	return t->pta->invoke_command_entry_point(t->sess_ctx, cmd,
+						  param_types, params);
+}
+
+static TEE_Result put(struct socket_test *t, size_t offs, const void *data,
+		      size_t len)
+{
+	return copy_to_user(t->ubuf + offs, data, len);
+}
+
+static TEE_Result open_udp(struct socket_test *t)
+{
+	static const char addr[] = "127.0.0.1";
+	TEE_Param params[TEE_NUM_PARAMS] = { };
+	TEE_Result res = TEE_SUCCESS;
+
+	res = put(t, OFFS_ADDR, addr, sizeof(addr));
+	if (res)
+		return res;
+
+	params[0].value.a = TEE_IP_VERSION_4;
+	params[0].value.b = 1234;
+	params[1].memref.buffer = t->ubuf + OFFS_ADDR;
+	params[1].memref.size = sizeof(addr);
+	params[2].value.a = TEE_ISOCKET_PROTOCOLID_UDP;
+	res = invoke(t, PTA_SOCKET_OPEN,
+		     TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+				     TEE_PARAM_TYPE_MEMREF_INPUT,
+				     TEE_PARAM_TYPE_VALUE_INPUT,
+				     TEE_PARAM_TYPE_VALUE_OUTPUT), params);
+	t->handle = params[3].value.a;
+
+	return res;
+}
+
+/*
+ * Invokes PTA_SOCKET_SENDV or PTA_SOCKET_RECVV with the @count entries of
+ * struct pta_socket_iov of the TA at OFFS_IOV
+ */
+static TEE_Result invoke_iov(struct socket_test *t, uint32_t cmd,
+			     size_t count, uint32_t *len)
+{
+	TEE_Param params[TEE_NUM_PARAMS] = { };
+	TEE_Result res = TEE_SUCCESS;
+
+	params[0].value.a = t->handle;
+	params[0].value.b = PTA_SOCKET_TIMEOUT_NONBLOCKING;
+	params[1].memref.buffer = t->ubuf + OFFS_IOV;
+	params[1].memref.size = count * sizeof(struct pta_socket_iov);
+	res = invoke(t, cmd,
+		     TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+				     TEE_PARAM_TYPE_MEMREF_INPUT,
+				     TEE_PARAM_TYPE_VALUE_OUTPUT,
+				     TEE_PARAM_TYPE_NONE), params);
+	*len = params[2].value.a;
+
+	return res;
+}
+
+/*
+ * Same as invoke_iov() with the @count buffers of the TA following each
+ * other from OFFS_DATA, of the lengths in @lens
+ */
+static TEE_Result invoke_data_iov(struct socket_test *t, uint32_t cmd,
+				  const size_t *lens, size_t count,
+				  uint32_t *len)
+{
+	struct pta_socket_iov iov[MAX_IOV] = { };
+	TEE_Result res = TEE_SUCCESS;
+	size_t offs = OFFS_DATA;
+	size_t n = 0;
+
+	assert(count <= ARRAY_SIZE(iov));
+	for (n = 0; n < count; n++) {
+		iov[n].buf = (vaddr_t)(t->ubuf + offs);
+		iov[n].len = lens[n];
+		offs += lens[n];
+	}
+	res = put(t, OFFS_IOV, iov, count * sizeof(iov[0]));
+	if (res)
+		return res;
+
+	return invoke_iov(t, cmd, count, len);
+}
+
+static TEE_Result send_str(struct socket_test *t, const char *s)
+{
+	size_t len = strlen(s);
+	TEE_Result res = TEE_SUCCESS;
+	uint32_t sent = 0;
+
+	res = put(t, OFFS_DATA, s, len);
+	if (res)
+		return res;
+	res = invoke_data_iov(t, PTA_SOCKET_SENDV, &len, 1, &sent);
+	if (!res && sent != len)
+		return TEE_ERROR_GENERIC;
+
+	return res;
+}
+
+/* The pieces are gathered into one datagram and scattered on receive */
+static TEE_Result test_iov(struct socket_test *t)
+{
+	const size_t recv_lens[] = { 5, 4, 64 };
+	const size_t short_lens[] = { 3, 5 };
+	size_t lens[ARRAY_SIZE(pieces)] = { };
+	struct pta_socket_iov iov = { };
+	char data[DATA_SIZE] = { };
+	TEE_Result res = TEE_SUCCESS;
+	size_t total = 0;
+	uint32_t len = 0;
+	size_t n = 0;
+
+	for (n = 0; n < ARRAY_SIZE(pieces); n++) {
+		lens[n] = strlen(pieces[n]);
+		res = put(t, OFFS_DATA + total, pieces[n], lens[n]);
+		if (res)
+			return res;
+		memcpy(data + total, pieces[n], lens[n]);
+		total += lens[n];
+	}
+
+	for (n = 0; n < 2; n++) {
+		res = invoke_data_iov(t, PTA_SOCKET_SENDV, lens,
+				      ARRAY_SIZE(lens), &len);
+		if (res)
+			return res;
+		if (len != total) {
+			EMSG("Sent %"PRIu32" bytes instead of %zu", len, total);
+			return TEE_ERROR_GENERIC;
+		}
+	}
+
+	/* The buffers are filled in order, the last one partly */
+	res = invoke_data_iov(t, PTA_SOCKET_RECVV, recv_lens,
+			      ARRAY_SIZE(recv_lens), &len);
+	if (res)
+		return res;
+	if (len != total) {
+		EMSG("Received %"PRIu32" bytes instead of %zu", len, total);
+		return TEE_ERROR_GENERIC;
+	}
+	res = copy_from_user(data + total, t->ubuf + OFFS_DATA, total);
+	if (res)
+		return res;
+	if (memcmp(data, data + total, total)) {
+		EMSG("Scattered datagram differs");
+		return TEE_ERROR_GENERIC;
+	}
+
+	/* The datagram is truncated to the buffers */
+	res = invoke_data_iov(t, PTA_SOCKET_RECVV, short_lens,
+			      ARRAY_SIZE(short_lens), &len);
+	if (res)
+		return res;
+	if (len != short_lens[0] + short_lens[1]) {
+		EMSG("Received %"PRIu32" bytes in short buffers", len);
+		return TEE_ERROR_GENERIC;
+	}
+	res = copy_from_user(data + total, t->ubuf + OFFS_DATA, len);
+	if (res)
+		return res;
+	if (memcmp(data, data + total, len)) {
+		EMSG("Truncated datagram differs");
+		return TEE_ERROR_GENERIC;
+	}
+
+	/* No buffer at all or one outside of the TA is refused */
+	res = invoke_iov(t, PTA_SOCKET_SENDV, 0, &len);
+	if (res != TEE_ERROR_BAD_PARAMETERS) {
+		EMSG("Got %#"PRIx32" without buffers", res);
+		return TEE_ERROR_GENERIC;
+	}
+	iov.buf = (vaddr_t)data;
+	iov.len = sizeof(data);
+	res = put(t, OFFS_IOV, &iov, sizeof(iov));
+	if (res)
+		return res;
+	res = invoke_iov(t, PTA_SOCKET_SENDV, 1, &len);
+	if (!res) {
+		EMSG("Sent a buffer of OP-TEE core");
+		return TEE_ERROR_GENERIC;
+	}
+
+	return TEE_SUCCESS;
+}
+
+/*
+ * Polls the socket for PTA_SOCKET_POLL_IN and PTA_SOCKET_POLL_OUT and a
+ * closed handle for PTA_SOCKET_POLL_IN, the events returned for the
+ * socket must be @exp_events
+ */
+static TEE_Result check_poll(struct socket_test *t, uint32_t exp_events)
+{
+	struct pta_socket_pollfd fds[2] = {
+		{ .handle = t->handle,
+		  .events = PTA_SOCKET_POLL_IN | PTA_SOCKET_POLL_OUT },
+		{ .handle = t->handle + 1, .events = PTA_SOCKET_POLL_IN },
+	};
+	TEE_Param params[TEE_NUM_PARAMS] = { };
+	TEE_Result res = TEE_SUCCESS;
+
+	res = put(t, OFFS_DATA, fds, sizeof(fds));
+	if (res)
+		return res;
+
+	params[0].memref.buffer = t->ubuf + OFFS_DATA;
+	params[0].memref.size = sizeof(fds);
+	params[1].value.a = PTA_SOCKET_TIMEOUT_NONBLOCKING;
+	res = invoke(t, PTA_SOCKET_POLL,
+		     TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_INOUT,
+				     TEE_PARAM_TYPE_VALUE_INOUT,
+				     TEE_PARAM_TYPE_NONE,
+				     TEE_PARAM_TYPE_NONE), params);
+	if (res)
+		return res;
+
+	res = copy_from_user(fds, t->ubuf + OFFS_DATA, sizeof(fds));
+	if (res)
+		return res;
+	if (fds[0].revents != exp_events ||
+	    fds[1].revents != PTA_SOCKET_POLL_ERR || params[1].value.b != 2) {
+		EMSG("Poll returned %#"PRIx32" %#"PRIx32" count %"PRIu32,
+		     fds[0].revents, fds[1].revents, params[1].value.b);
+		return TEE_ERROR_GENERIC;
+	}
+
+	return TEE_SUCCESS;
+}
+
+/*
+ * Receives a batch of at most @max datagrams which must be those from
+ * @first on
+ */
+static TEE_Result check_recv_batch(struct socket_test *t, uint32_t max,
+				   size_t first, size_t exp_count)
+{
+	TEE_Param params[TEE_NUM_PARAMS] = { };
+	uint8_t batch[DATA_SIZE] = { };
+	TEE_Result res = TEE_SUCCESS;
+	const void *data = NULL;
+	uint32_t data_len = 0;
+	uint32_t offs = 0;
+	size_t n = first;
+
+	params[0].value.a = t->handle;
+	params[0].value.b = PTA_SOCKET_TIMEOUT_NONBLOCKING;
+	params[1].memref.buffer = t->ubuf + OFFS_DATA;
+	params[1].memref.size = DATA_SIZE;
+	params[2].value.a = max;
+	res = invoke(t, PTA_SOCKET_RECV_BATCH,
+		     TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+				     TEE_PARAM_TYPE_MEMREF_OUTPUT,
+				     TEE_PARAM_TYPE_VALUE_INOUT,
+				     TEE_PARAM_TYPE_NONE), params);
+	if (res)
+		return res;
+
+	if (params[2].value.a != exp_count ||
+	    params[1].memref.size > sizeof(batch)) {
+		EMSG("Received %"PRIu32" datagrams instead of %zu",
+		     params[2].value.a, exp_count);
+		return TEE_ERROR_GENERIC;
+	}
+	res = copy_from_user(batch, t->ubuf + OFFS_DATA,
+			     params[1].memref.size);
+	if (res)
+		return res;
+
+	while (pta_socket_batch_next(batch, params[1].memref.size, &offs,
+				     &data, &data_len)) {
+		if (n >= first + exp_count || data_len != strlen(dgrams[n]) ||
+		    memcmp(data, dgrams[n], data_len)) {
+			EMSG("Datagram %zu differs", n);
+			return TEE_ERROR_GENERIC;
+		}
+		n++;
+	}
+	if (n != first + exp_count) {
+		EMSG("Found %zu datagrams instead of %zu", n - first,
+		     exp_count);
+		return TEE_ERROR_GENERIC;
+	}
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result test_batch(struct socket_test *t)
+{
+	TEE_Result res = TEE_SUCCESS;
+	size_t n = 0;
+
+	res = check_poll(t, PTA_SOCKET_POLL_OUT);
+	if (res)
+		return res;
+
+	for (n = 0; n < ARRAY_SIZE(dgrams); n++) {
+		res = send_str(t, dgrams[n]);
+		if (res)
+			return res;
+	}
+
+	res = check_poll(t, PTA_SOCKET_POLL_IN | PTA_SOCKET_POLL_OUT);
+	if (res)
+		return res;
+
+	/* The batches are limited to the requested number of datagrams */
+	res = check_recv_batch(t, 2, 0, 2);
+	if (res)
+		return res;
+	res = check_recv_batch(t, 8, 2, 1);
+	if (res)
+		return res;
+
+	res = check_recv_batch(t, 8, 0, 0);
+	if (res != TEE_ISOCKET_ERROR_TIMEOUT) {
+		EMSG("Got %#"PRIx32" from an empty socket", res);
+		return TEE_ERROR_GENERIC;
+	}
+
+	return check_poll(t, PTA_SOCKET_POLL_OUT);
+}
+
+TEE_Result core_socket_loopback_tests(uint32_t param_types,
+				      TEE_Param params[TEE_NUM_PARAMS])
+{
+	struct ts_session *caller = ts_get_calling_session();
+	struct socket_test t = { };
+	TEE_Result res = TEE_SUCCESS;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_INOUT,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	/* The socket PTA only serves TAs, the buffer is in the TA */
+	if (!caller || !is_user_ta_ctx(caller->ctx) ||
+	    params[0].memref.size < MIN_BUF_SIZE)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	t.pta = find_socket_pta();
+	if (!t.pta)
+		return TEE_ERROR_ITEM_NOT_FOUND;
+	t.ubuf = params[0].memref.buffer;
+
+	res = t.pta->open_session_entry_point(TEE_PARAM_TYPES(0, 0, 0, 0),
+					      NULL, &t.sess_ctx);
+	if (res)
+		return res;
+
+	res = open_udp(&t);
+	if (!res)
+		res = test_iov(&t);
+	if (!res)
+		res = test_batch(&t);
+
+	/* Closes the sockets of the TA */
+	t.pta->close_session_entry_point(t.sess_ctx);
+
+	return res;
+}
@@ -1,9 +1,17 @@
 srcs-$(call cfg-all-enabled,CFG_REE_FS CFG_WITH_USER_TA) += fs_htree.c
+srcs-$(CFG_REE_FS) += fs_perf.c
+srcs-$(CFG_REE_FS) += fs_tx.c
 srcs-y += invoke.c
 srcs-$(CFG_LOCKDEP) += lockdep.c
 srcs-y += misc.c
 cflags-misc.c-y += -fno-builtin
 srcs-y += mutex.c
 srcs-y += aes_perf.c
+srcs-$(CFG_CRYPTO_DRV_ASYNC) += crypto_async.c
 srcs-$(CFG_DT_DRIVER_EMBEDDED_TEST) += dt_driver_test.c
 srcs-$(CFG_DRIVERS_MAILBOX) += mbox.c
+srcs-$(CFG_SCMI_MSG_SMT) += scmi_perf.c
+srcs-$(CFG_TIMER_WHEEL) += timer_wheel.c
+srcs-$(CFG_DEFERRED_WORK) += deferred_work.c
+srcs-$(CFG_CORE_PARALLEL_WORKERS) += parallel.c
+srcs-$(CFG_SOCKET_LOOPBACK) += socket_loopback.c
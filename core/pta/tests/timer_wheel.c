@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#include <atomic.h>
+#include <kernel/mutex.h>
+#include <kernel/tee_time.h>
+#include <kernel/timer_wheel.h>
+#include <pta_invoke_tests.h>
+#include <tee_api_types.h>
+#include <trace.h>
+
+#include "misc.h"
+
+#define TEST_DELAY_MS	(4 * CFG_TIMER_WHEEL_TICK_MS)
+#define TEST_PERIOD_MS	(2 * CFG_TIMER_WHEEL_TICK_MS)
+#define TEST_TIMEOUT_MS	1000
+
+/*
+ * The callback of a stopped timer may still be running on another CPU,
+ * the timer and its counter are static and the tests serialized.
+ */
+static struct mutex test_mu = MUTEX_INITIALIZER;
+static struct tw_timer test_timer;
+static uint32_t test_count;
+
+static void count_expiry(struct tw_timer *t)
+{
+	atomic_inc32(t->data);
+}
+
+static uint32_t get_ms(void)
+{
+	TEE_Time t = { };
+
+	if (tee_time_get_sys_time(&t))
+		return 0;
+
+	return t.seconds * 1000 + t.millis;
+}
+
+/* Waits until test_count reaches @count, returns false on timeout */
+static bool wait_count(uint32_t count)
+{
+	uint32_t begin = get_ms();
+
+	while (atomic_load_u32(&test_count) < count) {
+		if (get_ms() - begin > TEST_TIMEOUT_MS)
+			return false;
+		tee_time_wait(1);
+	}
+
+	return true;
+}
+
+static void start_timer(uint32_t delay_ms, uint32_t period_ms)
+{
+	atomic_store_u32(&test_count, 0);
+	tw_timer_start(&test_timer, delay_ms, period_ms, 0);
+}
+
+static TEE_Result test_one_shot(void)
+{
+	uint32_t begin = get_ms();
+	uint32_t elapsed = 0;
+
+	start_timer(TEST_DELAY_MS, 0);
+	if (!wait_count(1)) {
+		EMSG("One-shot timer didn't expire");
+		tw_timer_stop(&test_timer);
+		return TEE_ERROR_GENERIC;
+	}
+
+	elapsed = get_ms() - begin;
+	if (elapsed + CFG_TIMER_WHEEL_TICK_MS < TEST_DELAY_MS) {
+		EMSG("One-shot timer expired after %"PRIu32" ms", elapsed);
+		return TEE_ERROR_GENERIC;
+	}
+
+	tee_time_wait(2 * TEST_DELAY_MS);
+	if (atomic_load_u32(&test_count) != 1) {
+		EMSG("One-shot timer expired more than once");
+		return TEE_ERROR_GENERIC;
+	}
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result test_periodic(void)
+{
+	uint32_t count = 0;
+
+	start_timer(TEST_PERIOD_MS, TEST_PERIOD_MS);
+	if (!wait_count(3)) {
+		EMSG("Periodic timer expired %"PRIu32" times",
+		     atomic_load_u32(&test_count));
+		tw_timer_stop(&test_timer);
+		return TEE_ERROR_GENERIC;
+	}
+
+	tw_timer_stop(&test_timer);
+	/* Let a callback running on another CPU return */
+	tee_time_wait(CFG_TIMER_WHEEL_TICK_MS);
+	count = atomic_load_u32(&test_count);
+
+	tee_time_wait(3 * TEST_PERIOD_MS);
+	if (atomic_load_u32(&test_count) != count) {
+		EMSG("Periodic timer expired once stopped");
+		return TEE_ERROR_GENERIC;
+	}
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result test_stop(void)
+{
+	start_timer(TEST_DELAY_MS, 0);
+	tw_timer_stop(&test_timer);
+
+	tee_time_wait(2 * TEST_DELAY_MS);
+	if (atomic_load_u32(&test_count)) {
+		EMSG("Timer stopped before its expiry expired");
+		return TEE_ERROR_GENERIC;
+	}
+
+	return TEE_SUCCESS;
+}
+
+TEE_Result core_timer_wheel_tests(uint32_t param_types,
+				  TEE_Param params[TEE_NUM_PARAMS] __unused)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	mutex_lock(&test_mu);
+
+	test_timer.fn = count_expiry;
+	test_timer.data = &test_count;
+
+	res = test_one_shot();
+	if (!res)
+		res = test_periodic();
+	if (!res)
+		res = test_stop();
+
+	mutex_unlock(&test_mu);
+
+	return res;
+}
@@ -9,6 +9,7 @@
 #include <compiler.h>
 #include <initcall.h>
 #include <io.h>
+#include <kernel/evtrace.h>
 #include <kernel/linker.h>
 #include <kernel/msg_param.h>
 #include <kernel/notif.h>
@@ -169,10 +170,10 @@ static TEE_Result set_rmem_param(const struct optee_msg_param_rmem *rmem,
 #endif /*CFG_CORE_DYN_SHM*/
 #endif /*!CFG_CORE_FFA*/
 
-static TEE_Result copy_in_params(const struct optee_msg_param *params,
-				 uint32_t num_params,
-				 struct tee_ta_param *ta_param,
-				 uint64_t *saved_attr)
+static TEE_Result __copy_in_params(const struct optee_msg_param *params,
+				   uint32_t num_params,
+				   struct tee_ta_param *ta_param,
+				   uint64_t *saved_attr)
 {
 	TEE_Result res;
 	size_t n;
@@ -249,6 +250,20 @@ static TEE_Result copy_in_params(const struct optee_msg_param *params,
 	return TEE_SUCCESS;
 }
 
+static TEE_Result copy_in_params(const struct optee_msg_param *params,
+				 uint32_t num_params,
+				 struct tee_ta_param *ta_param,
+				 uint64_t *saved_attr)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	evtrace_record(PTA_EVTRACE_ID_COPY_IN_PARAMS_ENTER, num_params, 0);
+	res = __copy_in_params(params, num_params, ta_param, saved_attr);
+	evtrace_record(PTA_EVTRACE_ID_COPY_IN_PARAMS_EXIT, res, 0);
+
+	return res;
+}
+
 static void cleanup_shm_refs(const uint64_t *saved_attr,
 			     struct tee_ta_param *param, uint32_t num_params)
 {
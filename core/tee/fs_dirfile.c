@@ -10,6 +10,7 @@
 #include <string.h>
 #include <tee/fs_dirfile.h>
 #include <types_ext.h>
+#include <util.h>
 
 struct tee_fs_dirfile_dirh {
 	const struct tee_fs_dirfile_operations *fops;
@@ -17,6 +18,31 @@ struct tee_fs_dirfile_dirh {
 	int nbits;
 	bitstr_t *files;
 	size_t ndents;
+	/* Resident index of the used entries, see "Index" below */
+	int nslots;
+	bitstr_t *used;
+	uint32_t *key_hash;
+	int *next;
+	int *bucket;
+	size_t nbuckets;
+	uint16_t *uuid_of;
+	int *unext;
+	int *uprev;
+	struct dirfile_uuid *uuids;
+	size_t nuuids;
+	bool no_index;
+};
+
+/*
+ * struct dirfile_uuid - Entries of one TA
+ * @uuid:	UUID of the TA
+ * @head:	Used entry of the TA with the lowest index, -1 if none
+ * @tail:	Used entry of the TA with the highest index, -1 if none
+ */
+struct dirfile_uuid {
+	TEE_UUID uuid;
+	int head;
+	int tail;
 };
 
 struct dirfile_entry {
@@ -93,6 +119,301 @@ static bool test_file(struct tee_fs_dirfile_dirh *dirh, int idx)
 	return false;
 }
 
+/*
+ * Index
+ *
+ * The used entries of the directory are tracked in a resident index built
+ * when the directory is opened and updated by write_dent(). The index
+ * holds for each entry, up to nslots:
+ * - a bit in used, set if the entry is in use, used to find a free entry
+ *   without reading the directory
+ * - the hash of the TA UUID and object ID of the entry in key_hash[]
+ * - the next entry in the same hash bucket in next[], -1 at the end
+ *
+ * - the TA the entry belongs to in uuid_of[], an index into uuids[]
+ * - the previous and next entries of the same TA in uprev[] and unext[],
+ *   -1 at the ends, the entries of a TA are sorted on index
+ *
+ * Each of the nbuckets (a power of two >= nslots) hash buckets in
+ * bucket[] holds the first entry of its chain or -1. A lookup reads only
+ * the entries with a matching hash, normally one, from the directory file
+ * to compare the full key. The entries of a TA are enumerated by
+ * following its list, without visiting the entries of other TAs.
+ *
+ * The index covers at most INDEX_MAX_SLOTS entries, about 22 bytes each.
+ * If the directory grows beyond that or the index can't be allocated, the
+ * index is dropped and the directory is scanned linearly instead until
+ * it's opened again.
+ */
+
+#define INDEX_MIN_SLOTS		32
+#define INDEX_MAX_SLOTS		1024
+
+static uint32_t key_hash(const TEE_UUID *uuid, const void *oid,
+			 size_t oidlen)
+{
+	const uint8_t *u = (const uint8_t *)uuid;
+	const uint8_t *o = oid;
+	uint32_t h = 2166136261;	/* FNV-1a */
+	size_t n = 0;
+
+	for (n = 0; n < sizeof(*uuid); n++)
+		h = (h ^ u[n]) * 16777619;
+	for (n = 0; n < oidlen; n++)
+		h = (h ^ o[n]) * 16777619;
+
+	return (h ^ oidlen) * 16777619;
+}
+
+static uint32_t dent_key_hash(struct dirfile_entry *dent)
+{
+	return key_hash(&dent->uuid, dent->oid, dent->oidlen);
+}
+
+static int *bucket_of(struct tee_fs_dirfile_dirh *dirh, uint32_t h)
+{
+	return dirh->bucket + (h & (dirh->nbuckets - 1));
+}
+
+static void link_slot(struct tee_fs_dirfile_dirh *dirh, int idx)
+{
+	int *b = bucket_of(dirh, dirh->key_hash[idx]);
+
+	dirh->next[idx] = *b;
+	*b = idx;
+}
+
+static TEE_Result rehash_index(struct tee_fs_dirfile_dirh *dirh,
+			       size_t nbuckets)
+{
+	int *b = malloc(nbuckets * sizeof(*b));
+	size_t n = 0;
+
+	if (!b)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	free(dirh->bucket);
+	dirh->bucket = b;
+	dirh->nbuckets = nbuckets;
+	for (n = 0; n < nbuckets; n++)
+		b[n] = -1;
+
+	for (n = 0; n < (size_t)dirh->nslots; n++)
+		if (bit_test(dirh->used, n))
+			link_slot(dirh, n);
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result maybe_grow_index(struct tee_fs_dirfile_dirh *dirh, int idx)
+{
+	int nslots = MAX(dirh->nslots * 2, INDEX_MIN_SLOTS);
+	size_t nbuckets = dirh->nbuckets;
+	TEE_Result res = TEE_SUCCESS;
+	void *p = NULL;
+
+	if (idx < dirh->nslots)
+		return TEE_SUCCESS;
+	if (idx >= INDEX_MAX_SLOTS)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	nslots = MIN(MAX(nslots, idx + 1), INDEX_MAX_SLOTS);
+
+	p = realloc(dirh->used, bitstr_size(nslots));
+	if (!p)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	dirh->used = p;
+	p = realloc(dirh->key_hash, nslots * sizeof(*dirh->key_hash));
+	if (!p)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	dirh->key_hash = p;
+	p = realloc(dirh->next, nslots * sizeof(*dirh->next));
+	if (!p)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	dirh->next = p;
+	p = realloc(dirh->uuid_of, nslots * sizeof(*dirh->uuid_of));
+	if (!p)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	dirh->uuid_of = p;
+	p = realloc(dirh->unext, nslots * sizeof(*dirh->unext));
+	if (!p)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	dirh->unext = p;
+	p = realloc(dirh->uprev, nslots * sizeof(*dirh->uprev));
+	if (!p)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	dirh->uprev = p;
+
+	if (!nbuckets)
+		nbuckets = INDEX_MIN_SLOTS;
+	while (nbuckets < (size_t)nslots)
+		nbuckets *= 2;
+	if (nbuckets != dirh->nbuckets) {
+		res = rehash_index(dirh, nbuckets);
+		if (res)
+			return res;
+	}
+
+	bit_nclear(dirh->used, dirh->nslots, nslots - 1);
+	dirh->nslots = nslots;
+
+	return TEE_SUCCESS;
+}
+
+static int find_uuid(struct tee_fs_dirfile_dirh *dirh, const TEE_UUID *uuid)
+{
+	size_t n = 0;
+
+	for (n = 0; n < dirh->nuuids; n++)
+		if (!memcmp(&dirh->uuids[n].uuid, uuid, sizeof(*uuid)))
+			return n;
+
+	return -1;
+}
+
+static TEE_Result maybe_add_uuid(struct tee_fs_dirfile_dirh *dirh,
+				 const TEE_UUID *uuid)
+{
+	struct dirfile_uuid *u = NULL;
+
+	if (find_uuid(dirh, uuid) >= 0)
+		return TEE_SUCCESS;
+	if (dirh->nuuids > UINT16_MAX)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	u = realloc(dirh->uuids, (dirh->nuuids + 1) * sizeof(*u));
+	if (!u)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	dirh->uuids = u;
+
+	u += dirh->nuuids;
+	u->uuid = *uuid;
+	u->head = -1;
+	u->tail = -1;
+	dirh->nuuids++;
+
+	return TEE_SUCCESS;
+}
+
+static void link_uuid(struct tee_fs_dirfile_dirh *dirh, int idx)
+{
+	struct dirfile_uuid *u = dirh->uuids + dirh->uuid_of[idx];
+	int prev = u->tail;
+	int next = -1;
+
+	/* New entries are normally appended, search from the tail */
+	while (prev > idx)
+		prev = dirh->uprev[prev];
+
+	if (prev >= 0) {
+		next = dirh->unext[prev];
+		dirh->unext[prev] = idx;
+	} else {
+		next = u->head;
+		u->head = idx;
+	}
+	if (next >= 0)
+		dirh->uprev[next] = idx;
+	else
+		u->tail = idx;
+
+	dirh->uprev[idx] = prev;
+	dirh->unext[idx] = next;
+}
+
+static void unlink_uuid(struct tee_fs_dirfile_dirh *dirh, int idx)
+{
+	struct dirfile_uuid *u = dirh->uuids + dirh->uuid_of[idx];
+	int prev = dirh->uprev[idx];
+	int next = dirh->unext[idx];
+
+	if (prev >= 0)
+		dirh->unext[prev] = next;
+	else
+		u->head = next;
+	if (next >= 0)
+		dirh->uprev[next] = prev;
+	else
+		u->tail = prev;
+}
+
+static void index_remove(struct tee_fs_dirfile_dirh *dirh, int idx)
+{
+	int *p = NULL;
+
+	if (idx >= dirh->nslots || !bit_test(dirh->used, idx))
+		return;
+
+	for (p = bucket_of(dirh, dirh->key_hash[idx]); *p != idx;
+	     p = dirh->next + *p)
+		assert(*p >= 0);
+	*p = dirh->next[idx];
+	unlink_uuid(dirh, idx);
+	bit_clear(dirh->used, idx);
+}
+
+/* prepare_insert() must have been called for @idx and @dent */
+static void index_insert(struct tee_fs_dirfile_dirh *dirh, int idx,
+			 struct dirfile_entry *dent)
+{
+	int uuid_idx = -1;
+
+	if (dirh->no_index)
+		return;
+
+	uuid_idx = find_uuid(dirh, &dent->uuid);
+	assert(idx < dirh->nslots && !bit_test(dirh->used, idx));
+	assert(uuid_idx >= 0);
+
+	dirh->key_hash[idx] = dent_key_hash(dent);
+	link_slot(dirh, idx);
+	dirh->uuid_of[idx] = uuid_idx;
+	link_uuid(dirh, idx);
+	bit_set(dirh->used, idx);
+}
+
+static void drop_index(struct tee_fs_dirfile_dirh *dirh)
+{
+	DMSG("Scanning the directory without index");
+
+	free(dirh->used);
+	dirh->used = NULL;
+	free(dirh->key_hash);
+	dirh->key_hash = NULL;
+	free(dirh->next);
+	dirh->next = NULL;
+	free(dirh->bucket);
+	dirh->bucket = NULL;
+	free(dirh->uuid_of);
+	dirh->uuid_of = NULL;
+	free(dirh->unext);
+	dirh->unext = NULL;
+	free(dirh->uprev);
+	dirh->uprev = NULL;
+	free(dirh->uuids);
+	dirh->uuids = NULL;
+	dirh->nslots = 0;
+	dirh->nbuckets = 0;
+	dirh->nuuids = 0;
+	dirh->no_index = true;
+}
+
+/* Makes room for @dent at @idx in the index, or drops the index */
+static void prepare_insert(struct tee_fs_dirfile_dirh *dirh, int idx,
+			   struct dirfile_entry *dent)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	if (dirh->no_index)
+		return;
+
+	res = maybe_grow_index(dirh, idx);
+	if (!res)
+		res = maybe_add_uuid(dirh, &dent->uuid);
+	if (res)
+		drop_index(dirh);
+}
+
 static TEE_Result read_dent(struct tee_fs_dirfile_dirh *dirh, int idx,
 			    struct dirfile_entry *dent)
 {
@@ -113,12 +434,23 @@ static TEE_Result write_dent(struct tee_fs_dirfile_dirh *dirh, size_t n,
 {
 	TEE_Result res;
 
+	/* Make room in the index first, it can't fail once written */
+	if (!is_free(dent))
+		prepare_insert(dirh, n, dent);
+
 	res = dirh->fops->write(dirh->fh, sizeof(*dent) * n, dent,
 				sizeof(*dent));
-	if (!res && n >= dirh->ndents)
+	if (res)
+		return res;
+
+	if (n >= dirh->ndents)
 		dirh->ndents = n + 1;
 
-	return res;
+	index_remove(dirh, n);
+	if (!is_free(dent))
+		index_insert(dirh, n, dent);
+
+	return TEE_SUCCESS;
 }
 
 TEE_Result tee_fs_dirfile_open(bool create, uint8_t *hash, uint32_t min_counter,
@@ -163,6 +495,9 @@ TEE_Result tee_fs_dirfile_open(bool create, uint8_t *hash, uint32_t min_counter,
 		res = set_file(dirh, dent.file_number);
 		if (res != TEE_SUCCESS)
 			goto out;
+
+		prepare_insert(dirh, n, &dent);
+		index_insert(dirh, n, &dent);
 	}
 out:
 	if (!res) {
@@ -179,6 +514,14 @@ void tee_fs_dirfile_close(struct tee_fs_dirfile_dirh *dirh)
 	if (dirh) {
 		dirh->fops->close(dirh->fh);
 		free(dirh->files);
+		free(dirh->used);
+		free(dirh->key_hash);
+		free(dirh->next);
+		free(dirh->bucket);
+		free(dirh->uuid_of);
+		free(dirh->unext);
+		free(dirh->uprev);
+		free(dirh->uuids);
 		free(dirh);
 	}
 }
@@ -208,31 +551,75 @@ TEE_Result tee_fs_dirfile_get_tmp(struct tee_fs_dirfile_dirh *dirh,
 	return res;
 }
 
+static TEE_Result find_linear(struct tee_fs_dirfile_dirh *dirh,
+			      const TEE_UUID *uuid, const void *oid,
+			      size_t oidlen, struct dirfile_entry *dent,
+			      int *idx)
+{
+	TEE_Result res = TEE_SUCCESS;
+	int n = 0;
+
+	for (n = 0;; n++) {
+		res = read_dent(dirh, n, dent);
+		if (res)
+			return res;
+
+		if (is_free(dent))
+			continue;
+		if (dent->oidlen != oidlen)
+			continue;
+
+		assert(test_file(dirh, dent->file_number));
+
+		if (!memcmp(&dent->uuid, uuid, sizeof(dent->uuid)) &&
+		    !memcmp(&dent->oid, oid, oidlen))
+			break;
+	}
+
+	*idx = n;
+	return TEE_SUCCESS;
+}
+
 TEE_Result tee_fs_dirfile_find(struct tee_fs_dirfile_dirh *dirh,
 			       const TEE_UUID *uuid, const void *oid,
 			       size_t oidlen, struct tee_fs_dirfile_fileh *dfh)
 {
 	TEE_Result res = TEE_SUCCESS;
 	struct dirfile_entry dent = { };
-	int n = 0;
+	uint32_t h = key_hash(uuid, oid, oidlen);
+	int n = -1;
 
-	for (n = 0;; n++) {
-		res = read_dent(dirh, n, &dent);
+	if (dirh->no_index) {
+		res = find_linear(dirh, uuid, oid, oidlen, &dent, &n);
 		if (res)
 			return res;
+		goto out;
+	}
 
-		if (is_free(&dent))
-			continue;
-		if (dent.oidlen != oidlen)
+	if (dirh->nbuckets)
+		n = *bucket_of(dirh, h);
+
+	for (; n >= 0; n = dirh->next[n]) {
+		if (dirh->key_hash[n] != h)
 			continue;
 
+		res = read_dent(dirh, n, &dent);
+		if (res)
+			return res;
+
+		assert(!is_free(&dent));
 		assert(test_file(dirh, dent.file_number));
 
-		if (!memcmp(&dent.uuid, uuid, sizeof(dent.uuid)) &&
+		if (dent.oidlen == oidlen &&
+		    !memcmp(&dent.uuid, uuid, sizeof(dent.uuid)) &&
 		    !memcmp(&dent.oid, oid, oidlen))
 			break;
 	}
 
+	if (n < 0)
+		return TEE_ERROR_ITEM_NOT_FOUND;
+
+out:
 	if (dfh) {
 		dfh->idx = n;
 		dfh->file_number = dent.file_number;
@@ -244,20 +631,32 @@ TEE_Result tee_fs_dirfile_find(struct tee_fs_dirfile_dirh *dirh,
 
 static TEE_Result find_empty_idx(struct tee_fs_dirfile_dirh *dh, int *idx)
 {
+	int nbits = MIN((int)dh->ndents, dh->nslots);
 	struct dirfile_entry dent = { };
 	TEE_Result res = TEE_SUCCESS;
-	int n = 0;
+	int n = -1;
 
-	for (n = 0;; n++) {
-		res = read_dent(dh, n, &dent);
-		if (res == TEE_ERROR_ITEM_NOT_FOUND)
-			break;
-		if (res)
-			return res;
-		if (is_free(&dent))
-			break;
+	if (dh->no_index) {
+		for (n = 0;; n++) {
+			res = read_dent(dh, n, &dent);
+			if (res == TEE_ERROR_ITEM_NOT_FOUND)
+				break;
+			if (res)
+				return res;
+			if (is_free(&dent))
+				break;
+		}
+
+		*idx = n;
+		return TEE_SUCCESS;
 	}
 
+	/* Entries beyond the index are free, as are those beyond ndents */
+	if (nbits)
+		bit_ffc(dh->used, nbits, &n);
+	if (n == -1)
+		n = nbits;
+
 	*idx = n;
 	return TEE_SUCCESS;
 }
@@ -368,21 +767,43 @@ TEE_Result tee_fs_dirfile_get_next(struct tee_fs_dirfile_dirh *dirh,
 				   size_t *oidlen)
 {
 	TEE_Result res;
-	int i = *idx + 1;
+	int uuid_idx = find_uuid(dirh, uuid);
+	int i = *idx;
 	struct dirfile_entry dent;
 
-	if (i < 0)
-		i = 0;
+	if (dirh->no_index) {
+		for (i = MAX(*idx + 1, 0);; i++) {
+			res = read_dent(dirh, i, &dent);
+			if (res)
+				return res;
+			if (!memcmp(&dent.uuid, uuid, sizeof(dent.uuid)) &&
+			    !is_free(&dent))
+				break;
+		}
+		goto out;
+	}
 
-	for (;; i++) {
-		res = read_dent(dirh, i, &dent);
-		if (res)
-			return res;
-		if (!memcmp(&dent.uuid, uuid, sizeof(dent.uuid)) &&
-		    !is_free(&dent))
-			break;
+	if (uuid_idx < 0)
+		return TEE_ERROR_ITEM_NOT_FOUND;
+
+	if (i >= 0 && i < dirh->nslots && bit_test(dirh->used, i) &&
+	    dirh->uuid_of[i] == uuid_idx) {
+		i = dirh->unext[i];
+	} else {
+		/* The previous entry has been removed, resume after it */
+		for (i = dirh->uuids[uuid_idx].head; i >= 0 && i <= *idx;
+		     i = dirh->unext[i])
+			;
 	}
+	if (i < 0)
+		return TEE_ERROR_ITEM_NOT_FOUND;
 
+	res = read_dent(dirh, i, &dent);
+	if (res)
+		return res;
+	assert(!memcmp(&dent.uuid, uuid, sizeof(dent.uuid)) && !is_free(&dent));
+
+out:
 	if (*oidlen < dent.oidlen)
 		return TEE_ERROR_SHORT_BUFFER;
 
@@ -4,9 +4,12 @@
  */
 
 #include <assert.h>
+#include <config.h>
 #include <crypto/crypto.h>
 #include <initcall.h>
+#include <kernel/parallel.h>
 #include <kernel/tee_common_otp.h>
+#include <kernel/user_access.h>
 #include <stdlib.h>
 #include <string_ext.h>
 #include <string.h>
@@ -30,6 +33,12 @@
 
 #define NODE_ID_TO_BLOCK_NUM(id)	((id) - 1)
 
+/*
+ * With CFG_CORE_PARALLEL_WORKERS=y the subtrees starting at this level are
+ * hashed in parallel, the nodes above them by the calling thread.
+ */
+#define HTREE_SPLIT_LEVEL		4
+
 /*
  * The hash tree is implemented as a binary tree with the purpose to ensure
  * integrity of the data in the nodes. The data in the nodes their turn
@@ -96,6 +105,27 @@ struct tee_fs_htree {
 	void *stor_aux;
 };
 
+/* Nodes of a subtree verified by verify_nodes() */
+struct verify_arg {
+	void *ctx;
+	size_t max_level;
+};
+
+/* Nodes of a subtree hashed by sync_subtree() */
+struct sync_arg {
+	void *ctx;
+	size_t min_level;
+	size_t max_level;
+	bool write;		/* Write the nodes once hashed */
+};
+
+/* Subtrees of a tree processed in parallel */
+struct htree_split {
+	struct tee_fs_htree *ht;
+	size_t count;
+	struct htree_node *node[BIT(HTREE_SPLIT_LEVEL - 1)];
+};
+
 struct traverse_arg;
 typedef TEE_Result (*traverse_cb_t)(struct traverse_arg *targ,
 				    struct htree_node *node);
@@ -565,14 +595,18 @@ static TEE_Result verify_root(struct tee_fs_htree *ht)
 static TEE_Result verify_node(struct traverse_arg *targ,
 			      struct htree_node *node)
 {
-	void *ctx = targ->arg;
+	struct verify_arg *varg = targ->arg;
 	TEE_Result res;
 	uint8_t digest[TEE_FS_HTREE_HASH_SIZE];
 
+	if (node_id_to_level(node->id) > varg->max_level)
+		return TEE_SUCCESS;
+
 	if (node->parent)
-		res = calc_node_hash(node, NULL, ctx, digest);
+		res = calc_node_hash(node, NULL, varg->ctx, digest);
 	else
-		res = calc_node_hash(node, &targ->ht->imeta.meta, ctx, digest);
+		res = calc_node_hash(node, &targ->ht->imeta.meta, varg->ctx,
+				     digest);
 	if (res == TEE_SUCCESS &&
 	    consttime_memcmp(digest, node->node.hash, sizeof(digest)))
 		return TEE_ERROR_CORRUPT_OBJECT;
@@ -580,17 +614,80 @@ static TEE_Result verify_node(struct traverse_arg *targ,
 	return res;
 }
 
-static TEE_Result verify_tree(struct tee_fs_htree *ht)
+/* Verifies the nodes of the subtree at @start down to @max_level */
+static TEE_Result verify_nodes(struct tee_fs_htree *ht,
+			       struct htree_node *start, size_t max_level)
 {
+	struct verify_arg varg = { .max_level = max_level };
+	struct traverse_arg targ = {
+		.ht = ht,
+		.cb = verify_node,
+		.arg = &varg,
+	};
 	TEE_Result res;
-	void *ctx;
 
-	res = crypto_hash_alloc_ctx(&ctx, TEE_FS_HTREE_HASH_ALG);
+	res = crypto_hash_alloc_ctx(&varg.ctx, TEE_FS_HTREE_HASH_ALG);
 	if (res != TEE_SUCCESS)
 		return res;
 
-	res = htree_traverse_post_order(ht, verify_node, ctx);
-	crypto_hash_free_ctx(ctx);
+	res = traverse_post_order(&targ, start);
+	crypto_hash_free_ctx(varg.ctx);
+
+	return res;
+}
+
+static TEE_Result add_split_node(struct traverse_arg *targ,
+				 struct htree_node *node)
+{
+	struct htree_split *split = targ->arg;
+
+	if (node_id_to_level(node->id) == HTREE_SPLIT_LEVEL)
+		split->node[split->count++] = node;
+
+	return TEE_SUCCESS;
+}
+
+/* Returns the subtrees to process in parallel, or NULL if not worth it */
+static struct htree_split *split_tree(struct tee_fs_htree *ht)
+{
+	struct htree_split *split = NULL;
+
+	if (!IS_ENABLED(CFG_CORE_PARALLEL_WORKERS))
+		return NULL;
+
+	split = calloc(1, sizeof(*split));
+	if (!split)
+		return NULL;
+
+	split->ht = ht;
+	htree_traverse_post_order(ht, add_split_node, split);
+	if (split->count < 2) {
+		free(split);
+		return NULL;
+	}
+
+	return split;
+}
+
+static TEE_Result verify_subtree(void *arg, size_t idx)
+{
+	struct htree_split *split = arg;
+
+	return verify_nodes(split->ht, split->node[idx], SIZE_MAX);
+}
+
+static TEE_Result verify_tree(struct tee_fs_htree *ht)
+{
+	struct htree_split *split = split_tree(ht);
+	TEE_Result res;
+
+	if (!split)
+		return verify_nodes(ht, &ht->root, SIZE_MAX);
+
+	res = parallel_for(split->count, verify_subtree, split);
+	if (res == TEE_SUCCESS)
+		res = verify_nodes(ht, &ht->root, HTREE_SPLIT_LEVEL - 1);
+	free(split);
 
 	return res;
 }
@@ -706,9 +803,11 @@ void tee_fs_htree_close(struct tee_fs_htree **ht)
 static TEE_Result htree_sync_node_to_storage(struct traverse_arg *targ,
 					     struct htree_node *node)
 {
+	struct sync_arg *sarg = targ->arg;
+	struct tee_fs_htree_meta *meta = NULL;
+	size_t level = node_id_to_level(node->id);
 	TEE_Result res;
 	uint8_t vers;
-	struct tee_fs_htree_meta *meta = NULL;
 
 	/*
 	 * The node can be dirty while the block isn't updated due to
@@ -717,7 +816,7 @@ static TEE_Result htree_sync_node_to_storage(struct traverse_arg *targ,
 	 */
 	assert(node->dirty >= node->block_updated);
 
-	if (!node->dirty)
+	if (!node->dirty || level < sarg->min_level || level > sarg->max_level)
 		return TEE_SUCCESS;
 
 	if (node->parent) {
@@ -735,8 +834,8 @@ static TEE_Result htree_sync_node_to_storage(struct traverse_arg *targ,
 		meta = &targ->ht->imeta.meta;
 	}
 
-	res = calc_node_hash(node, meta, targ->arg, node->node.hash);
-	if (res != TEE_SUCCESS)
+	res = calc_node_hash(node, meta, sarg->ctx, node->node.hash);
+	if (res != TEE_SUCCESS || !sarg->write)
 		return res;
 
 	node->dirty = false;
@@ -745,6 +844,91 @@ static TEE_Result htree_sync_node_to_storage(struct traverse_arg *targ,
 	return rpc_write_node(targ->ht, node->id, vers, &node->node);
 }
 
+/*
+ * Hashes the dirty nodes of the subtree at @start with a level in
+ * [@min_level, @max_level]. With @write the nodes are written as soon as
+ * they are hashed, else they are left dirty.
+ */
+static TEE_Result sync_subtree(struct tee_fs_htree *ht,
+			       struct htree_node *start, size_t min_level,
+			       size_t max_level, bool write)
+{
+	struct sync_arg sarg = {
+		.min_level = min_level,
+		.max_level = max_level,
+		.write = write,
+	};
+	struct traverse_arg targ = {
+		.ht = ht,
+		.cb = htree_sync_node_to_storage,
+		.arg = &sarg,
+	};
+	TEE_Result res;
+
+	res = crypto_hash_alloc_ctx(&sarg.ctx, TEE_FS_HTREE_HASH_ALG);
+	if (res != TEE_SUCCESS)
+		return res;
+
+	res = traverse_post_order(&targ, start);
+	crypto_hash_free_ctx(sarg.ctx);
+
+	return res;
+}
+
+/*
+ * Only the nodes below the root of the subtree are handled, the root
+ * flips the version of its parent which may be shared with another
+ * subtree.
+ */
+static TEE_Result hash_subtree(void *arg, size_t idx)
+{
+	struct htree_split *split = arg;
+
+	return sync_subtree(split->ht, split->node[idx],
+			    HTREE_SPLIT_LEVEL + 1, SIZE_MAX, false);
+}
+
+static TEE_Result write_dirty_node(struct traverse_arg *targ,
+				   struct htree_node *node)
+{
+	uint32_t f = 0;
+
+	if (!node->dirty)
+		return TEE_SUCCESS;
+
+	/* Only nodes below the split level are left, they have a parent */
+	f = HTREE_NODE_COMMITTED_CHILD(node->id & 1);
+	node->dirty = false;
+	node->block_updated = false;
+
+	return rpc_write_node(targ->ht, node->id,
+			      !!(node->parent->node.flags & f), &node->node);
+}
+
+static TEE_Result htree_sync_nodes_to_storage(struct tee_fs_htree *ht)
+{
+	struct htree_split *split = split_tree(ht);
+	TEE_Result res = TEE_SUCCESS;
+
+	if (!split)
+		return sync_subtree(ht, &ht->root, 1, SIZE_MAX, true);
+
+	/*
+	 * The deep nodes of the subtrees are hashed in parallel, the nodes
+	 * above them are hashed and written by this thread as usual. The
+	 * deep nodes are written last, storage is only accessed from this
+	 * thread.
+	 */
+	res = parallel_for(split->count, hash_subtree, split);
+	if (res == TEE_SUCCESS)
+		res = sync_subtree(ht, &ht->root, 1, HTREE_SPLIT_LEVEL, true);
+	free(split);
+	if (res != TEE_SUCCESS)
+		return res;
+
+	return htree_traverse_post_order(ht, write_dirty_node, NULL);
+}
+
 static TEE_Result update_root(struct tee_fs_htree *ht)
 {
 	TEE_Result res;
@@ -765,7 +949,6 @@ TEE_Result tee_fs_htree_sync_to_storage(struct tee_fs_htree **ht_arg,
 {
 	TEE_Result res;
 	struct tee_fs_htree *ht = *ht_arg;
-	void *ctx;
 
 	if (!ht)
 		return TEE_ERROR_CORRUPT_OBJECT;
@@ -773,11 +956,7 @@ TEE_Result tee_fs_htree_sync_to_storage(struct tee_fs_htree **ht_arg,
 	if (!ht->dirty)
 		return TEE_SUCCESS;
 
-	res = crypto_hash_alloc_ctx(&ctx, TEE_FS_HTREE_HASH_ALG);
-	if (res != TEE_SUCCESS)
-		return res;
-
-	res = htree_traverse_post_order(ht, htree_sync_node_to_storage, ctx);
+	res = htree_sync_nodes_to_storage(ht);
 	if (res != TEE_SUCCESS)
 		goto out;
 
@@ -796,7 +975,6 @@ TEE_Result tee_fs_htree_sync_to_storage(struct tee_fs_htree **ht_arg,
 	if (counter)
 		*counter = ht->head.counter;
 out:
-	crypto_hash_free_ctx(ctx);
 	if (res != TEE_SUCCESS)
 		tee_fs_htree_close(ht_arg);
 	return res;
@@ -815,8 +993,8 @@ static TEE_Result get_block_node(struct tee_fs_htree *ht, bool create,
 	return res;
 }
 
-TEE_Result tee_fs_htree_write_block(struct tee_fs_htree **ht_arg,
-				    size_t block_num, const void *block)
+static TEE_Result write_block(struct tee_fs_htree **ht_arg, size_t block_num,
+			      const void *block, bool user)
 {
 	struct tee_fs_htree *ht = *ht_arg;
 	TEE_Result res;
@@ -847,8 +1025,13 @@ TEE_Result tee_fs_htree_write_block(struct tee_fs_htree **ht_arg,
 			   ht->stor->block_size);
 	if (res != TEE_SUCCESS)
 		goto out;
+	/* A user block is encrypted directly into the RPC buffer */
+	if (user)
+		enter_user_access();
 	res = authenc_encrypt_final(ctx, node->node.tag, block,
 				    ht->stor->block_size, enc_block);
+	if (user)
+		exit_user_access();
 	if (res != TEE_SUCCESS)
 		goto out;
 
@@ -865,8 +1048,20 @@ out:
 	return res;
 }
 
-TEE_Result tee_fs_htree_read_block(struct tee_fs_htree **ht_arg,
-				   size_t block_num, void *block)
+TEE_Result tee_fs_htree_write_block(struct tee_fs_htree **ht,
+				    size_t block_num, const void *block)
+{
+	return write_block(ht, block_num, block, false);
+}
+
+TEE_Result tee_fs_htree_write_block_user(struct tee_fs_htree **ht,
+					 size_t block_num, const void *block)
+{
+	return write_block(ht, block_num, block, true);
+}
+
+static TEE_Result read_block(struct tee_fs_htree **ht_arg, size_t block_num,
+			     void *block, bool user)
 {
 	struct tee_fs_htree *ht = *ht_arg;
 	TEE_Result res;
@@ -904,14 +1099,33 @@ TEE_Result tee_fs_htree_read_block(struct tee_fs_htree **ht_arg,
 	if (res != TEE_SUCCESS)
 		goto out;
 
+	if (user)
+		enter_user_access();
 	res = authenc_decrypt_final(ctx, node->node.tag, enc_block,
 				    ht->stor->block_size, block);
+	/* Don't leave unauthenticated data behind */
+	if (res != TEE_SUCCESS)
+		memset(block, 0, ht->stor->block_size);
+	if (user)
+		exit_user_access();
 out:
 	if (res != TEE_SUCCESS)
 		tee_fs_htree_close(ht_arg);
 	return res;
 }
 
+TEE_Result tee_fs_htree_read_block(struct tee_fs_htree **ht,
+				   size_t block_num, void *block)
+{
+	return read_block(ht, block_num, block, false);
+}
+
+TEE_Result tee_fs_htree_read_block_user(struct tee_fs_htree **ht,
+					size_t block_num, void *block)
+{
+	return read_block(ht, block_num, block, true);
+}
+
 TEE_Result tee_fs_htree_truncate(struct tee_fs_htree **ht_arg, size_t block_num)
 {
 	struct tee_fs_htree *ht = *ht_arg;
@@ -10,6 +10,7 @@
 #include <optee_rpc_cmd.h>
 #include <pta_socket.h>
 #include <string.h>
+#include <tee/socket_loopback.h>
 #include <tee/tee_fs_rpc.h>
 
 static uint32_t get_instance_id(struct ts_session *sess)
@@ -17,6 +18,15 @@ static uint32_t get_instance_id(struct ts_session *sess)
 	return sess->ctx->ops->get_instance_id(sess->ctx);
 }
 
+/* Served by tee-supplicant, or in OP-TEE with CFG_SOCKET_LOOPBACK=y */
+static TEE_Result socket_rpc(size_t num_params, struct thread_param *params)
+{
+	if (IS_ENABLED(CFG_SOCKET_LOOPBACK))
+		return socket_loopback_rpc(num_params, params);
+
+	return thread_rpc_cmd(OPTEE_RPC_CMD_SOCKET, num_params, params);
+}
+
 static TEE_Result socket_open(uint32_t instance_id, uint32_t param_types,
 			      TEE_Param params[TEE_NUM_PARAMS])
 {
@@ -54,7 +64,7 @@ static TEE_Result socket_open(uint32_t instance_id, uint32_t param_types,
 	tpm[2] = THREAD_PARAM_MEMREF(IN, mobj, 0, params[1].memref.size);
 	tpm[3] = THREAD_PARAM_VALUE(OUT, 0, 0, 0);
 
-	res = thread_rpc_cmd(OPTEE_RPC_CMD_SOCKET, 4, tpm);
+	res = socket_rpc(4, tpm);
 	if (res == TEE_SUCCESS)
 		params[3].value.a = tpm[3].u.value.a;
 
@@ -79,7 +89,7 @@ static TEE_Result socket_close(uint32_t instance_id, uint32_t param_types,
 	tpm = THREAD_PARAM_VALUE(IN, OPTEE_RPC_SOCKET_CLOSE, instance_id,
 				 params[0].value.a);
 
-	return thread_rpc_cmd(OPTEE_RPC_CMD_SOCKET, 1, &tpm);
+	return socket_rpc(1, &tpm);
 }
 
 static TEE_Result socket_send(uint32_t instance_id, uint32_t param_types,
@@ -117,7 +127,7 @@ static TEE_Result socket_send(uint32_t instance_id, uint32_t param_types,
 	tpm[2] = THREAD_PARAM_VALUE(INOUT, params[0].value.b, /* timeout */
 				     0, 0);
 
-	res = thread_rpc_cmd(OPTEE_RPC_CMD_SOCKET, 3, tpm);
+	res = socket_rpc(3, tpm);
 	params[2].value.a = tpm[2].u.value.b; /* transmitted bytes */
 
 	return res;
@@ -154,7 +164,7 @@ static TEE_Result socket_recv(uint32_t instance_id, uint32_t param_types,
 	tpm[1] = THREAD_PARAM_MEMREF(OUT, mobj, 0, params[1].memref.size);
 	tpm[2] = THREAD_PARAM_VALUE(IN, params[0].value.b /* timeout */, 0, 0);
 
-	res = thread_rpc_cmd(OPTEE_RPC_CMD_SOCKET, 3, tpm);
+	res = socket_rpc(3, tpm);
 
 	if (params[1].memref.size) {
 		TEE_Result res2 = TEE_SUCCESS;
@@ -205,7 +215,7 @@ static TEE_Result socket_ioctl(uint32_t instance_id, uint32_t param_types,
 	tpm[2] = THREAD_PARAM_VALUE(IN, params[0].value.b /* ioctl command */,
 				    0, 0);
 
-	res = thread_rpc_cmd(OPTEE_RPC_CMD_SOCKET, 3, tpm);
+	res = socket_rpc(3, tpm);
 	if (tpm[1].u.memref.size <= params[1].memref.size) {
 		TEE_Result res2 = TEE_SUCCESS;
 
@@ -220,6 +230,265 @@ static TEE_Result socket_ioctl(uint32_t instance_id, uint32_t param_types,
 	return res;
 }
 
+static TEE_Result copy_iov_from_user(const TEE_Param *param,
+				     struct pta_socket_iov *iov,
+				     size_t *iov_count, size_t *total_len)
+{
+	TEE_Result res = TEE_SUCCESS;
+	size_t sz = param->memref.size;
+	size_t n = 0;
+
+	if (!sz || sz % sizeof(*iov) ||
+	    sz / sizeof(*iov) > PTA_SOCKET_IOV_MAX)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	res = copy_from_user(iov, param->memref.buffer, sz);
+	if (res)
+		return res;
+
+	*iov_count = sz / sizeof(*iov);
+	*total_len = 0;
+	for (n = 0; n < *iov_count; n++) {
+		if (iov[n].buf != (vaddr_t)iov[n].buf ||
+		    iov[n].len != (size_t)iov[n].len ||
+		    ADD_OVERFLOW(*total_len, iov[n].len, total_len))
+			return TEE_ERROR_BAD_PARAMETERS;
+	}
+	if (*total_len > UINT32_MAX)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	return TEE_SUCCESS;
+}
+
+/*
+ * The buffers are gathered in a single OPTEE_RPC_SOCKET_SEND as the data
+ * is sent the same way as with one buffer.
+ */
+static TEE_Result socket_sendv(uint32_t instance_id, uint32_t param_types,
+			       TEE_Param params[TEE_NUM_PARAMS])
+{
+	struct pta_socket_iov iov[PTA_SOCKET_IOV_MAX] = { };
+	struct thread_param tpm[3] = { };
+	struct mobj *mobj = NULL;
+	TEE_Result res = TEE_SUCCESS;
+	size_t iov_count = 0;
+	uint8_t *va = NULL;
+	size_t offs = 0;
+	size_t sz = 0;
+	size_t n = 0;
+	uint32_t exp_pt = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+					  TEE_PARAM_TYPE_MEMREF_INPUT,
+					  TEE_PARAM_TYPE_VALUE_OUTPUT,
+					  TEE_PARAM_TYPE_NONE);
+
+	if (exp_pt != param_types) {
+		DMSG("got param_types 0x%x, expected 0x%x",
+		     param_types, exp_pt);
+		return TEE_ERROR_BAD_PARAMETERS;
+	}
+
+	res = copy_iov_from_user(params + 1, iov, &iov_count, &sz);
+	if (res)
+		return res;
+
+	if (sz) {
+		va = thread_rpc_shm_cache_alloc(THREAD_SHM_CACHE_USER_SOCKET,
+						THREAD_SHM_TYPE_APPLICATION,
+						sz, &mobj);
+		if (!va)
+			return TEE_ERROR_OUT_OF_MEMORY;
+	}
+
+	for (n = 0; n < iov_count; n++) {
+		res = copy_from_user(va + offs, (void *)(vaddr_t)iov[n].buf,
+				     iov[n].len);
+		if (res)
+			return res;
+		offs += iov[n].len;
+	}
+
+	tpm[0] = THREAD_PARAM_VALUE(IN, OPTEE_RPC_SOCKET_SEND, instance_id,
+				    params[0].value.a /* handle */);
+	tpm[1] = THREAD_PARAM_MEMREF(IN, mobj, 0, sz);
+	tpm[2] = THREAD_PARAM_VALUE(INOUT, params[0].value.b, /* timeout */
+				     0, 0);
+
+	res = socket_rpc(3, tpm);
+	params[2].value.a = tpm[2].u.value.b; /* transmitted bytes */
+
+	return res;
+}
+
+/*
+ * Received with a single OPTEE_RPC_SOCKET_RECV which is scattered over the
+ * buffers.
+ */
+static TEE_Result socket_recvv(uint32_t instance_id, uint32_t param_types,
+			       TEE_Param params[TEE_NUM_PARAMS])
+{
+	struct pta_socket_iov iov[PTA_SOCKET_IOV_MAX] = { };
+	struct thread_param tpm[3] = { };
+	struct mobj *mobj = NULL;
+	TEE_Result res = TEE_SUCCESS;
+	size_t iov_count = 0;
+	uint8_t *va = NULL;
+	size_t offs = 0;
+	size_t sz = 0;
+	size_t l = 0;
+	size_t n = 0;
+	uint32_t exp_pt = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+					  TEE_PARAM_TYPE_MEMREF_INPUT,
+					  TEE_PARAM_TYPE_VALUE_OUTPUT,
+					  TEE_PARAM_TYPE_NONE);
+
+	if (exp_pt != param_types) {
+		DMSG("got param_types 0x%x, expected 0x%x",
+		     param_types, exp_pt);
+		return TEE_ERROR_BAD_PARAMETERS;
+	}
+
+	res = copy_iov_from_user(params + 1, iov, &iov_count, &sz);
+	if (res)
+		return res;
+
+	if (sz) {
+		va = thread_rpc_shm_cache_alloc(THREAD_SHM_CACHE_USER_SOCKET,
+						THREAD_SHM_TYPE_APPLICATION,
+						sz, &mobj);
+		if (!va)
+			return TEE_ERROR_OUT_OF_MEMORY;
+	}
+
+	tpm[0] = THREAD_PARAM_VALUE(IN, OPTEE_RPC_SOCKET_RECV, instance_id,
+				    params[0].value.a /* handle */);
+	tpm[1] = THREAD_PARAM_MEMREF(OUT, mobj, 0, sz);
+	tpm[2] = THREAD_PARAM_VALUE(IN, params[0].value.b /* timeout */, 0, 0);
+
+	res = socket_rpc(3, tpm);
+
+	sz = MIN(sz, tpm[1].u.memref.size);
+	for (n = 0; n < iov_count && offs < sz; n++) {
+		TEE_Result res2 = TEE_SUCCESS;
+
+		l = MIN(iov[n].len, sz - offs);
+		res2 = copy_to_user((void *)(vaddr_t)iov[n].buf, va + offs, l);
+		if (res2)
+			return res2;
+		offs += l;
+	}
+	params[2].value.a = tpm[1].u.memref.size;
+
+	return res;
+}
+
+static TEE_Result socket_poll(uint32_t instance_id, uint32_t param_types,
+			      TEE_Param params[TEE_NUM_PARAMS])
+{
+	struct thread_param tpm[3] = { };
+	struct mobj *mobj = NULL;
+	TEE_Result res = TEE_SUCCESS;
+	size_t sz = params[0].memref.size;
+	void *va = NULL;
+	uint32_t exp_pt = TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_INOUT,
+					  TEE_PARAM_TYPE_VALUE_INOUT,
+					  TEE_PARAM_TYPE_NONE,
+					  TEE_PARAM_TYPE_NONE);
+
+	static_assert(PTA_SOCKET_POLL_IN == OPTEE_RPC_SOCKET_POLL_IN &&
+		      PTA_SOCKET_POLL_OUT == OPTEE_RPC_SOCKET_POLL_OUT &&
+		      PTA_SOCKET_POLL_ERR == OPTEE_RPC_SOCKET_POLL_ERR &&
+		      PTA_SOCKET_POLL_HUP == OPTEE_RPC_SOCKET_POLL_HUP);
+
+	if (exp_pt != param_types) {
+		DMSG("got param_types 0x%x, expected 0x%x",
+		     param_types, exp_pt);
+		return TEE_ERROR_BAD_PARAMETERS;
+	}
+
+	if (!sz || sz % sizeof(struct pta_socket_pollfd) ||
+	    sz / sizeof(struct pta_socket_pollfd) > PTA_SOCKET_POLL_MAX)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	/* struct pta_socket_pollfd has the layout of the RPC entries */
+	va = thread_rpc_shm_cache_alloc(THREAD_SHM_CACHE_USER_SOCKET,
+					THREAD_SHM_TYPE_APPLICATION, sz, &mobj);
+	if (!va)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	res = copy_from_user(va, params[0].memref.buffer, sz);
+	if (res)
+		return res;
+
+	tpm[0] = THREAD_PARAM_VALUE(IN, OPTEE_RPC_SOCKET_POLL, instance_id, 0);
+	tpm[1] = THREAD_PARAM_MEMREF(INOUT, mobj, 0, sz);
+	tpm[2] = THREAD_PARAM_VALUE(INOUT, params[1].value.a /* timeout */,
+				    0, 0);
+
+	res = socket_rpc(3, tpm);
+	if (res)
+		return res;
+	if (tpm[1].u.memref.size != sz)
+		return TEE_ERROR_GENERIC;
+
+	res = copy_to_user(params[0].memref.buffer, va, sz);
+	if (res)
+		return res;
+	params[1].value.b = tpm[2].u.value.b; /* entries with events */
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result socket_recv_batch(uint32_t instance_id, uint32_t param_types,
+				    TEE_Param params[TEE_NUM_PARAMS])
+{
+	struct thread_param tpm[3] = { };
+	struct mobj *mobj = NULL;
+	TEE_Result res = TEE_SUCCESS;
+	size_t sz = params[1].memref.size;
+	void *va = NULL;
+	uint32_t exp_pt = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+					  TEE_PARAM_TYPE_MEMREF_OUTPUT,
+					  TEE_PARAM_TYPE_VALUE_INOUT,
+					  TEE_PARAM_TYPE_NONE);
+
+	if (exp_pt != param_types) {
+		DMSG("got param_types 0x%x, expected 0x%x",
+		     param_types, exp_pt);
+		return TEE_ERROR_BAD_PARAMETERS;
+	}
+
+	if (!sz || !params[2].value.a)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	va = thread_rpc_shm_cache_alloc(THREAD_SHM_CACHE_USER_SOCKET,
+					THREAD_SHM_TYPE_APPLICATION, sz, &mobj);
+	if (!va)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	tpm[0] = THREAD_PARAM_VALUE(IN, OPTEE_RPC_SOCKET_RECV_BATCH,
+				    instance_id,
+				    params[0].value.a /* handle */);
+	tpm[1] = THREAD_PARAM_MEMREF(OUT, mobj, 0, sz);
+	tpm[2] = THREAD_PARAM_VALUE(INOUT, params[0].value.b, /* timeout */
+				    params[2].value.a, /* max datagrams */
+				    0);
+
+	res = socket_rpc(3, tpm);
+	if (!res) {
+		if (tpm[1].u.memref.size > sz ||
+		    tpm[2].u.value.c > params[2].value.a)
+			return TEE_ERROR_GENERIC;
+		res = copy_to_user(params[1].memref.buffer, va,
+				   tpm[1].u.memref.size);
+		if (res)
+			return res;
+		params[2].value.a = tpm[2].u.value.c; /* datagrams */
+	}
+	params[1].memref.size = tpm[1].u.memref.size;
+
+	return res;
+}
+
 typedef TEE_Result (*ta_func)(uint32_t instance_id, uint32_t param_types,
 			      TEE_Param params[TEE_NUM_PARAMS]);
 
@@ -229,6 +498,10 @@ static const ta_func ta_funcs[] = {
 	[PTA_SOCKET_SEND] = socket_send,
 	[PTA_SOCKET_RECV] = socket_recv,
 	[PTA_SOCKET_IOCTL] = socket_ioctl,
+	[PTA_SOCKET_SENDV] = socket_sendv,
+	[PTA_SOCKET_RECVV] = socket_recvv,
+	[PTA_SOCKET_POLL] = socket_poll,
+	[PTA_SOCKET_RECV_BATCH] = socket_recv_batch,
 };
 
 /*
@@ -259,7 +532,7 @@ static void pta_socket_close_session(void *sess_ctx)
 		},
 	};
 
-	res = thread_rpc_cmd(OPTEE_RPC_CMD_SOCKET, 1, &tpm);
+	res = socket_rpc(1, &tpm);
 	if (res != TEE_SUCCESS)
 		DMSG("OPTEE_RPC_SOCKET_CLOSE_ALL failed: %#" PRIx32, res);
 }
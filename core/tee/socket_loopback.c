@@ -0,0 +1,403 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#include <__tee_isocket_defines.h>
+#include <__tee_tcpsocket_defines.h>
+#include <__tee_udpsocket_defines.h>
+#include <kernel/mutex.h>
+#include <kernel/thread.h>
+#include <mm/mobj.h>
+#include <optee_rpc_cmd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/queue.h>
+#include <tee/socket_loopback.h>
+#include <trace.h>
+#include <util.h>
+
+/*
+ * Stand-in for the OPTEE_RPC_CMD_SOCKET requests normally served by
+ * tee-supplicant. A socket is connected to an echo peer which isn't
+ * reachable by anything else: what's sent on a socket is queued to be
+ * received on the same socket. The address and port given when opening
+ * are ignored. Nothing ever blocks, a receive with nothing queued times
+ * out at once whatever the timeout.
+ */
+
+/* Maximum number of bytes queued on a socket */
+#define LOOPBACK_QUEUE_MAX	(16 * 1024)
+
+struct loopback_dgram {
+	size_t len;
+	size_t offs;		/* Bytes already received of a TCP chunk */
+	STAILQ_ENTRY(loopback_dgram) link;
+	uint8_t data[];
+};
+
+struct loopback_socket {
+	uint32_t instance_id;
+	uint32_t handle;
+	uint32_t protocol;
+	size_t queued;
+	STAILQ_HEAD(, loopback_dgram) dgrams;
+	TAILQ_ENTRY(loopback_socket) link;
+};
+
+static struct mutex loopback_mu = MUTEX_INITIALIZER;
+static TAILQ_HEAD(, loopback_socket) loopback_sockets =
+	TAILQ_HEAD_INITIALIZER(loopback_sockets);
+static uint32_t loopback_next_handle = 1;
+
+static bool check_params(size_t num_params, const struct thread_param *params,
+			 const enum thread_param_attr *attrs, size_t num_attrs)
+{
+	size_t n = 0;
+
+	if (num_params != num_attrs)
+		return false;
+	for (n = 0; n < num_attrs; n++)
+		if (params[n].attr != attrs[n])
+			return false;
+
+	return true;
+}
+
+static void *get_buf(const struct thread_param *param)
+{
+	if (!param->u.memref.size)
+		return NULL;
+
+	return mobj_get_va(param->u.memref.mobj, param->u.memref.offs,
+			   param->u.memref.size);
+}
+
+static struct loopback_socket *find_socket(uint32_t instance_id,
+					   uint32_t handle)
+{
+	struct loopback_socket *ls = NULL;
+
+	TAILQ_FOREACH(ls, &loopback_sockets, link)
+		if (ls->instance_id == instance_id && ls->handle == handle)
+			return ls;
+
+	return NULL;
+}
+
+static void free_socket(struct loopback_socket *ls)
+{
+	struct loopback_dgram *d = NULL;
+
+	while ((d = STAILQ_FIRST(&ls->dgrams))) {
+		STAILQ_REMOVE_HEAD(&ls->dgrams, link);
+		free(d);
+	}
+	TAILQ_REMOVE(&loopback_sockets, ls, link);
+	free(ls);
+}
+
+static TEE_Result loopback_open(uint32_t instance_id, size_t num_params,
+				struct thread_param *params)
+{
+	static const enum thread_param_attr attrs[] = {
+		THREAD_PARAM_ATTR_VALUE_IN, THREAD_PARAM_ATTR_VALUE_IN,
+		THREAD_PARAM_ATTR_MEMREF_IN, THREAD_PARAM_ATTR_VALUE_OUT,
+	};
+	struct loopback_socket *ls = NULL;
+	uint32_t protocol = 0;
+
+	if (!check_params(num_params, params, attrs, ARRAY_SIZE(attrs)))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	protocol = params[1].u.value.b;
+	if (protocol != TEE_ISOCKET_PROTOCOLID_TCP &&
+	    protocol != TEE_ISOCKET_PROTOCOLID_UDP)
+		return TEE_ERROR_NOT_SUPPORTED;
+
+	ls = calloc(1, sizeof(*ls));
+	if (!ls)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	ls->instance_id = instance_id;
+	ls->handle = loopback_next_handle++;
+	ls->protocol = protocol;
+	STAILQ_INIT(&ls->dgrams);
+	TAILQ_INSERT_TAIL(&loopback_sockets, ls, link);
+	params[3].u.value.a = ls->handle;
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result loopback_close(uint32_t instance_id, size_t num_params,
+				 struct thread_param *params)
+{
+	struct loopback_socket *ls = NULL;
+
+	if (num_params != 1)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	ls = find_socket(instance_id, params[0].u.value.c);
+	if (!ls)
+		return TEE_ERROR_BAD_PARAMETERS;
+	free_socket(ls);
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result loopback_close_all(uint32_t instance_id,
+				     size_t num_params,
+				     struct thread_param *params __unused)
+{
+	struct loopback_socket *next = NULL;
+	struct loopback_socket *ls = NULL;
+
+	if (num_params != 1)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	TAILQ_FOREACH_SAFE(ls, &loopback_sockets, link, next)
+		if (ls->instance_id == instance_id)
+			free_socket(ls);
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result loopback_send(uint32_t instance_id, size_t num_params,
+				struct thread_param *params)
+{
+	static const enum thread_param_attr attrs[] = {
+		THREAD_PARAM_ATTR_VALUE_IN, THREAD_PARAM_ATTR_MEMREF_IN,
+		THREAD_PARAM_ATTR_VALUE_INOUT,
+	};
+	struct loopback_socket *ls = NULL;
+	struct loopback_dgram *d = NULL;
+	size_t len = 0;
+	void *buf = NULL;
+
+	if (!check_params(num_params, params, attrs, ARRAY_SIZE(attrs)))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	ls = find_socket(instance_id, params[0].u.value.c);
+	if (!ls)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	len = params[1].u.memref.size;
+	buf = get_buf(params + 1);
+	if (len && !buf)
+		return TEE_ERROR_BAD_PARAMETERS;
+	if (len > LOOPBACK_QUEUE_MAX - ls->queued)
+		return TEE_ISOCKET_ERROR_OUT_OF_RESOURCES;
+
+	d = malloc(sizeof(*d) + len);
+	if (!d)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	d->len = len;
+	d->offs = 0;
+	memcpy(d->data, buf, len);
+	STAILQ_INSERT_TAIL(&ls->dgrams, d, link);
+	ls->queued += len;
+	params[2].u.value.b = len;
+
+	return TEE_SUCCESS;
+}
+
+/*
+ * Receives into @buf of @len bytes from @ls. A UDP datagram is received
+ * whole, truncated to @len. A TCP stream is received up to @len bytes.
+ */
+static size_t recv_queued(struct loopback_socket *ls, uint8_t *buf, size_t len)
+{
+	struct loopback_dgram *d = NULL;
+	size_t offs = 0;
+	size_t l = 0;
+
+	while ((d = STAILQ_FIRST(&ls->dgrams)) && offs < len) {
+		l = MIN(d->len - d->offs, len - offs);
+		memcpy(buf + offs, d->data + d->offs, l);
+		offs += l;
+
+		if (ls->protocol == TEE_ISOCKET_PROTOCOLID_TCP &&
+		    d->offs + l < d->len) {
+			d->offs += l;
+			ls->queued -= l;
+			break;
+		}
+
+		ls->queued -= d->len - d->offs;
+		STAILQ_REMOVE_HEAD(&ls->dgrams, link);
+		free(d);
+		if (ls->protocol == TEE_ISOCKET_PROTOCOLID_UDP)
+			break;
+	}
+
+	return offs;
+}
+
+static TEE_Result loopback_recv(uint32_t instance_id, size_t num_params,
+				struct thread_param *params)
+{
+	static const enum thread_param_attr attrs[] = {
+		THREAD_PARAM_ATTR_VALUE_IN, THREAD_PARAM_ATTR_MEMREF_OUT,
+		THREAD_PARAM_ATTR_VALUE_IN,
+	};
+	struct loopback_socket *ls = NULL;
+	void *buf = NULL;
+
+	if (!check_params(num_params, params, attrs, ARRAY_SIZE(attrs)))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	ls = find_socket(instance_id, params[0].u.value.c);
+	if (!ls)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	buf = get_buf(params + 1);
+	if (params[1].u.memref.size && !buf)
+		return TEE_ERROR_BAD_PARAMETERS;
+	if (STAILQ_EMPTY(&ls->dgrams)) {
+		params[1].u.memref.size = 0;
+		return TEE_ISOCKET_ERROR_TIMEOUT;
+	}
+
+	params[1].u.memref.size = recv_queued(ls, buf, params[1].u.memref.size);
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result loopback_poll(uint32_t instance_id, size_t num_params,
+				struct thread_param *params)
+{
+	static const enum thread_param_attr attrs[] = {
+		THREAD_PARAM_ATTR_VALUE_IN, THREAD_PARAM_ATTR_MEMREF_INOUT,
+		THREAD_PARAM_ATTR_VALUE_INOUT,
+	};
+	struct loopback_socket *ls = NULL;
+	uint32_t *entry = NULL;
+	size_t count = 0;
+	size_t n = 0;
+
+	if (!check_params(num_params, params, attrs, ARRAY_SIZE(attrs)))
+		return TEE_ERROR_BAD_PARAMETERS;
+	if (params[1].u.memref.size % (3 * sizeof(uint32_t)))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	entry = get_buf(params + 1);
+	if (!entry)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	for (n = 0; n < params[1].u.memref.size / (3 * sizeof(uint32_t));
+	     n++, entry += 3) {
+		ls = find_socket(instance_id, entry[0]);
+		if (!ls) {
+			entry[2] = OPTEE_RPC_SOCKET_POLL_ERR;
+		} else {
+			entry[2] = entry[1] & OPTEE_RPC_SOCKET_POLL_OUT;
+			if (!STAILQ_EMPTY(&ls->dgrams))
+				entry[2] |= entry[1] & OPTEE_RPC_SOCKET_POLL_IN;
+		}
+		if (entry[2])
+			count++;
+	}
+	params[2].u.value.b = count;
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result loopback_recv_batch(uint32_t instance_id, size_t num_params,
+				      struct thread_param *params)
+{
+	static const enum thread_param_attr attrs[] = {
+		THREAD_PARAM_ATTR_VALUE_IN, THREAD_PARAM_ATTR_MEMREF_OUT,
+		THREAD_PARAM_ATTR_VALUE_INOUT,
+	};
+	struct loopback_socket *ls = NULL;
+	struct loopback_dgram *d = NULL;
+	size_t sz = params[1].u.memref.size;
+	uint8_t *buf = NULL;
+	uint32_t len = 0;
+	size_t offs = 0;
+	size_t count = 0;
+
+	if (!check_params(num_params, params, attrs, ARRAY_SIZE(attrs)))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	ls = find_socket(instance_id, params[0].u.value.c);
+	if (!ls || ls->protocol != TEE_ISOCKET_PROTOCOLID_UDP)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	buf = get_buf(params + 1);
+	if (!buf)
+		return TEE_ERROR_BAD_PARAMETERS;
+	if (STAILQ_EMPTY(&ls->dgrams)) {
+		params[1].u.memref.size = 0;
+		return TEE_ISOCKET_ERROR_TIMEOUT;
+	}
+
+	while ((d = STAILQ_FIRST(&ls->dgrams)) &&
+	       count < params[2].u.value.b) {
+		/* The first datagram is truncated if it doesn't fit */
+		if (count && sizeof(len) + ROUNDUP(d->len, 4) > sz - offs)
+			break;
+		if (sizeof(len) > sz - offs)
+			break;
+
+		len = MIN(d->len, sz - offs - sizeof(len));
+		memcpy(buf + offs, &len, sizeof(len));
+		offs += sizeof(len);
+		memcpy(buf + offs, d->data, len);
+		offs += len;
+		memset(buf + offs, 0, MIN(ROUNDUP(len, 4) - len, sz - offs));
+		offs = MIN(ROUNDUP(offs, 4), sz);
+
+		ls->queued -= d->len;
+		STAILQ_REMOVE_HEAD(&ls->dgrams, link);
+		free(d);
+		count++;
+	}
+	params[1].u.memref.size = offs;
+	params[2].u.value.c = count;
+
+	return TEE_SUCCESS;
+}
+
+TEE_Result socket_loopback_rpc(size_t num_params, struct thread_param *params)
+{
+	TEE_Result res = TEE_SUCCESS;
+	uint32_t instance_id = 0;
+
+	if (!num_params || params[0].attr != THREAD_PARAM_ATTR_VALUE_IN)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	instance_id = params[0].u.value.b;
+
+	mutex_lock(&loopback_mu);
+	switch (params[0].u.value.a) {
+	case OPTEE_RPC_SOCKET_OPEN:
+		res = loopback_open(instance_id, num_params, params);
+		break;
+	case OPTEE_RPC_SOCKET_CLOSE:
+		res = loopback_close(instance_id, num_params, params);
+		break;
+	case OPTEE_RPC_SOCKET_CLOSE_ALL:
+		res = loopback_close_all(instance_id, num_params, params);
+		break;
+	case OPTEE_RPC_SOCKET_SEND:
+		res = loopback_send(instance_id, num_params, params);
+		break;
+	case OPTEE_RPC_SOCKET_RECV:
+		res = loopback_recv(instance_id, num_params, params);
+		break;
+	case OPTEE_RPC_SOCKET_POLL:
+		res = loopback_poll(instance_id, num_params, params);
+		break;
+	case OPTEE_RPC_SOCKET_RECV_BATCH:
+		res = loopback_recv_batch(instance_id, num_params, params);
+		break;
+	default:
+		res = TEE_ERROR_NOT_SUPPORTED;
+		break;
+	}
+	mutex_unlock(&loopback_mu);
+
+	return res;
+}
@@ -34,6 +34,7 @@ cppflags-tee_svc.c-y += -DTEE_IMPL_VERSION=$(TEE_IMPL_VERSION)
 srcs-y += tee_time_generic.c
 srcs-$(CFG_SECSTOR_TA) += tadb.c
 srcs-$(CFG_GP_SOCKETS) += socket.c
+srcs-$(CFG_SOCKET_LOOPBACK) += socket_loopback.c
 srcs-y += tee_ta_enc_manager.c
 endif #CFG_WITH_USER_TA,y
 
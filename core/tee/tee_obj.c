@@ -3,6 +3,7 @@
  * Copyright (c) 2014, STMicroelectronics International N.V.
  */
 
+#include <mm/slab.h>
 #include <mm/vm.h>
 #include <stdlib.h>
 #include <tee_api_defines.h>
@@ -72,9 +73,12 @@ TEE_Result tee_obj_verify(struct tee_ta_session *sess, struct tee_obj *o)
 	return res;
 }
 
+static struct slab_cache tee_obj_cache =
+	SLAB_CACHE_INITIALIZER("tee_obj", sizeof(struct tee_obj), 0, NULL);
+
 struct tee_obj *tee_obj_alloc(void)
 {
-	return calloc(1, sizeof(struct tee_obj));
+	return slab_zalloc(&tee_obj_cache);
 }
 
 void tee_obj_free(struct tee_obj *o)
@@ -82,6 +86,6 @@ void tee_obj_free(struct tee_obj *o)
 	if (o) {
 		tee_obj_attr_free(o);
 		free(o->attr);
-		free(o);
+		slab_free(&tee_obj_cache, o);
 	}
 }
@@ -9,6 +9,7 @@
 #include <kernel/nv_counter.h>
 #include <kernel/panic.h>
 #include <kernel/thread.h>
+#include <kernel/ts_manager.h>
 #include <kernel/user_access.h>
 #include <mempool.h>
 #include <mm/core_memprot.h>
@@ -37,6 +38,10 @@ struct tee_fs_fd {
 	int fd;
 	struct tee_fs_dirfile_fileh dfh;
 	const TEE_UUID *uuid;
+	/* Modified in a transaction, hash in dirf.db when it began */
+	bool in_tx;
+	uint8_t tx_hash[TEE_FS_HTREE_HASH_SIZE];
+	TAILQ_ENTRY(tee_fs_fd) tx_link;
 };
 
 struct tee_fs_dir {
@@ -73,7 +78,7 @@ static TEE_Result out_of_place_write(struct tee_fs_fd *fdp, size_t pos,
 	size_t remain_bytes = len;
 	uint8_t *data_core_ptr = (uint8_t *)buf_core;
 	uint8_t *data_user_ptr = (uint8_t *)buf_user;
-	uint8_t *block;
+	uint8_t *block = NULL;
 	struct tee_fs_htree_meta *meta = tee_fs_htree_get_meta(fdp->ht);
 
 	/*
@@ -84,9 +89,13 @@ static TEE_Result out_of_place_write(struct tee_fs_fd *fdp, size_t pos,
 	if (!len)
 		return TEE_ERROR_BAD_PARAMETERS;
 
-	block = get_tmp_block();
-	if (!block)
-		return TEE_ERROR_OUT_OF_MEMORY;
+	if (data_user_ptr) {
+		res = check_user_access(TEE_MEMORY_ACCESS_READ |
+					TEE_MEMORY_ACCESS_ANY_OWNER,
+					data_user_ptr, len);
+		if (res)
+			return res;
+	}
 
 	while (start_block_num <= end_block_num) {
 		size_t offset = pos % BLOCK_SIZE;
@@ -95,29 +104,55 @@ static TEE_Result out_of_place_write(struct tee_fs_fd *fdp, size_t pos,
 		if (size_to_write + offset > BLOCK_SIZE)
 			size_to_write = BLOCK_SIZE - offset;
 
-		if (start_block_num * BLOCK_SIZE <
-		    ROUNDUP(meta->length, BLOCK_SIZE)) {
-			res = tee_fs_htree_read_block(&fdp->ht,
-						      start_block_num, block);
-			if (res != TEE_SUCCESS)
-				goto exit;
+		/*
+		 * A whole block from a buffer is encrypted directly from
+		 * it, there's no old content to merge.
+		 */
+		if (size_to_write == BLOCK_SIZE && data_core_ptr) {
+			res = tee_fs_htree_write_block(&fdp->ht,
+						       start_block_num,
+						       data_core_ptr);
+		} else if (size_to_write == BLOCK_SIZE && data_user_ptr) {
+			res = tee_fs_htree_write_block_user(&fdp->ht,
+							    start_block_num,
+							    data_user_ptr);
 		} else {
-			memset(block, 0, BLOCK_SIZE);
-		}
+			if (!block) {
+				block = get_tmp_block();
+				if (!block) {
+					res = TEE_ERROR_OUT_OF_MEMORY;
+					goto exit;
+				}
+			}
 
-		if (data_core_ptr) {
-			memcpy(block + offset, data_core_ptr, size_to_write);
-		} else if (data_user_ptr) {
-			res = copy_from_user(block + offset, data_user_ptr,
-					     size_to_write);
-			if (res)
-				return res;
-		} else {
-			memset(block + offset, 0, size_to_write);
-		}
+			if (size_to_write < BLOCK_SIZE &&
+			    start_block_num * BLOCK_SIZE <
+			    ROUNDUP(meta->length, BLOCK_SIZE)) {
+				res = tee_fs_htree_read_block(&fdp->ht,
+							      start_block_num,
+							      block);
+				if (res != TEE_SUCCESS)
+					goto exit;
+			} else {
+				memset(block, 0, BLOCK_SIZE);
+			}
 
-		res = tee_fs_htree_write_block(&fdp->ht, start_block_num,
-					       block);
+			if (data_core_ptr) {
+				memcpy(block + offset, data_core_ptr,
+				       size_to_write);
+			} else if (data_user_ptr) {
+				res = copy_from_user(block + offset,
+						     data_user_ptr,
+						     size_to_write);
+				if (res)
+					goto exit;
+			} else {
+				memset(block + offset, 0, size_to_write);
+			}
+
+			res = tee_fs_htree_write_block(&fdp->ht,
+						       start_block_num, block);
+		}
 		if (res != TEE_SUCCESS)
 			goto exit;
 
@@ -321,6 +356,7 @@ static TEE_Result ree_fs_read_primitive(struct tee_file_handle *fh, size_t pos,
 	uint8_t *block = NULL;
 	struct tee_fs_fd *fdp = (struct tee_fs_fd *)fh;
 	struct tee_fs_htree_meta *meta = tee_fs_htree_get_meta(fdp->ht);
+	bool user_private = false;
 
 	/* One of buf_core and buf_user must be NULL */
 	assert(!buf_core || !buf_user);
@@ -341,10 +377,19 @@ static TEE_Result ree_fs_read_primitive(struct tee_file_handle *fh, size_t pos,
 	start_block_num = pos_to_block_num(pos);
 	end_block_num = pos_to_block_num(pos + remain_bytes - 1);
 
-	block = get_tmp_block();
-	if (!block) {
-		res = TEE_ERROR_OUT_OF_MEMORY;
-		goto exit;
+	if (data_user_ptr) {
+		res = check_user_access(TEE_MEMORY_ACCESS_WRITE |
+					TEE_MEMORY_ACCESS_ANY_OWNER,
+					data_user_ptr, remain_bytes);
+		if (res)
+			goto exit;
+
+		/*
+		 * A block decrypted directly into the buffer is there before
+		 * it's authenticated, shared memory must not see that.
+		 */
+		user_private = !check_user_access(TEE_MEMORY_ACCESS_WRITE,
+						  data_user_ptr, remain_bytes);
 	}
 
 	while (start_block_num <= end_block_num) {
@@ -354,21 +399,43 @@ static TEE_Result ree_fs_read_primitive(struct tee_file_handle *fh, size_t pos,
 		if (size_to_read + offset > BLOCK_SIZE)
 			size_to_read = BLOCK_SIZE - offset;
 
-		res = tee_fs_htree_read_block(&fdp->ht, start_block_num, block);
+		/* A whole block is decrypted directly into the buffer */
+		if (size_to_read == BLOCK_SIZE && data_core_ptr) {
+			res = tee_fs_htree_read_block(&fdp->ht, start_block_num,
+						      data_core_ptr);
+		} else if (size_to_read == BLOCK_SIZE && user_private) {
+			res = tee_fs_htree_read_block_user(&fdp->ht,
+							   start_block_num,
+							   data_user_ptr);
+		} else {
+			if (!block) {
+				block = get_tmp_block();
+				if (!block) {
+					res = TEE_ERROR_OUT_OF_MEMORY;
+					goto exit;
+				}
+			}
+
+			res = tee_fs_htree_read_block(&fdp->ht, start_block_num,
+						      block);
+			if (res != TEE_SUCCESS)
+				goto exit;
+
+			if (data_core_ptr)
+				memcpy(data_core_ptr, block + offset,
+				       size_to_read);
+			else if (data_user_ptr)
+				res = copy_to_user(data_user_ptr,
+						   block + offset,
+						   size_to_read);
+		}
 		if (res != TEE_SUCCESS)
 			goto exit;
 
-		if (data_core_ptr) {
-			memcpy(data_core_ptr, block + offset, size_to_read);
+		if (data_core_ptr)
 			data_core_ptr += size_to_read;
-		} else if (data_user_ptr) {
-			res = copy_to_user(data_user_ptr, block + offset,
-					   size_to_read);
-			if (res)
-				goto exit;
+		if (data_user_ptr)
 			data_user_ptr += size_to_read;
-		}
-
 		remain_bytes -= size_to_read;
 		pos += size_to_read;
 
@@ -569,6 +636,22 @@ out:
 	return res;
 }
 
+/* Opens dirf.db as last committed, ree_fs_dirh must be open */
+static TEE_Result open_committed_dirh(struct tee_fs_dirfile_dirh **dirh)
+{
+	uint8_t hash[TEE_FS_HTREE_HASH_SIZE] = { };
+	size_t l = sizeof(hash);
+	TEE_Result res = TEE_SUCCESS;
+
+	res = rpmb_fs_ops.read(ree_fs_rpmb_fh, 0, hash, NULL, &l);
+	if (res)
+		return res;
+	if (l != sizeof(hash))
+		return TEE_ERROR_ITEM_NOT_FOUND;
+
+	return tee_fs_dirfile_open(false, hash, 0, &ree_dirf_ops, dirh);
+}
+
 static TEE_Result commit_dirh_writes(struct tee_fs_dirfile_dirh *dirh)
 {
 	TEE_Result res;
@@ -588,12 +671,11 @@ static void close_dirh(struct tee_fs_dirfile_dirh **dirh)
 }
 
 #else /*!CFG_REE_FS_INTEGRITY_RPMB*/
-static TEE_Result open_dirh(struct tee_fs_dirfile_dirh **dirh)
+static TEE_Result get_min_counter(uint32_t *min_counter)
 {
 	TEE_Result res = TEE_SUCCESS;
-	uint32_t min_counter = 0;
 
-	res = nv_counter_get_ree_fs(&min_counter);
+	res = nv_counter_get_ree_fs(min_counter);
 	if (res) {
 		static bool once;
 
@@ -605,8 +687,20 @@ static TEE_Result open_dirh(struct tee_fs_dirfile_dirh **dirh)
 			IMSG("WARNING (insecure configuration): Failed to get monotonic counter for REE FS, using 0");
 			once = true;
 		}
-		min_counter = 0;
+		*min_counter = 0;
 	}
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result open_dirh(struct tee_fs_dirfile_dirh **dirh)
+{
+	TEE_Result res = TEE_SUCCESS;
+	uint32_t min_counter = 0;
+
+	res = get_min_counter(&min_counter);
+	if (res)
+		return res;
 	res = tee_fs_dirfile_open(false, NULL, min_counter, &ree_dirf_ops,
 				  dirh);
 	if (res == TEE_ERROR_ITEM_NOT_FOUND) {
@@ -624,6 +718,23 @@ static TEE_Result open_dirh(struct tee_fs_dirfile_dirh **dirh)
 	return res;
 }
 
+/*
+ * Opens dirf.db as last committed, its header is only written when
+ * committing
+ */
+static TEE_Result open_committed_dirh(struct tee_fs_dirfile_dirh **dirh)
+{
+	TEE_Result res = TEE_SUCCESS;
+	uint32_t min_counter = 0;
+
+	res = get_min_counter(&min_counter);
+	if (res)
+		return res;
+
+	return tee_fs_dirfile_open(false, NULL, min_counter, &ree_dirf_ops,
+				   dirh);
+}
+
 static TEE_Result commit_dirh_writes(struct tee_fs_dirfile_dirh *dirh)
 {
 	TEE_Result res = TEE_SUCCESS;
@@ -690,12 +801,351 @@ static void put_dirh_primitive(bool close)
 		close_dirh(&ree_fs_dirh);
 }
 
+/*
+ * A transaction stages the changes of its owner in the resident dirf.db
+ * and in the hash trees of the modified files. The files are synced and
+ * dirf.db is committed once, when the transaction is committed. Until
+ * then the version of each file referenced by the committed dirf.db is
+ * left untouched, an interrupted transaction leaves the state from
+ * before it began.
+ *
+ * The owner is the session which began the transaction, it is aborted
+ * when the invocation of the session returns. Updates by others than the
+ * owner would commit the staged changes, they wait for the transaction
+ * to end. A session called by the owner would wait for ever, its updates
+ * fail with TEE_ERROR_STORAGE_NOT_AVAILABLE instead. Lookups by others
+ * than the owner are served from the committed dirf.db.
+ *
+ * A file closed after having been modified is synced to its staged
+ * version, it can't be modified again in the same transaction without
+ * overwriting the committed version.
+ */
+enum tx_file_state {
+	TX_FILE_CREATED,	/* Removed if the transaction is aborted */
+	TX_FILE_REMOVED,	/* Removed when the transaction is committed */
+	TX_FILE_SYNCED,		/* Closed after having been modified */
+};
+
+struct tx_file {
+	struct tee_fs_dirfile_fileh dfh;
+	enum tx_file_state state;
+};
+
+static struct {
+	struct ts_session *owner;	/* NULL if no transaction is active */
+	TEE_Result res;			/* First error, only abort is left */
+	struct tee_fs_dirfile_dirh *dirh;
+	/* Committed dirf.db for lookups by others, opened on demand */
+	struct tee_fs_dirfile_dirh *committed_dirh;
+	TAILQ_HEAD(, tee_fs_fd) fds;	/* Modified files not synced yet */
+	struct tx_file *files;
+	size_t num_files;
+} ree_fs_tx = { .fds = TAILQ_HEAD_INITIALIZER(ree_fs_tx.fds) };
+
+/* Signalled with ree_fs_mutex held when a transaction ends */
+static struct condvar ree_fs_tx_cv = CONDVAR_INITIALIZER;
+
 static void put_dirh(struct tee_fs_dirfile_dirh *dirh, bool close)
 {
 	if (dirh) {
 		assert(dirh == ree_fs_dirh);
-		put_dirh_primitive(close);
+		/* The staged changes are only dropped by an abort */
+		put_dirh_primitive(close && !ree_fs_tx.owner);
+	}
+}
+
+static bool tx_is_other(void)
+{
+	return ree_fs_tx.owner &&
+	       ree_fs_tx.owner != ts_get_current_session_may_fail();
+}
+
+/*
+ * Returns true if the owner of the transaction has called the caller, or
+ * is another invocation of the same concurrent TA. The storage syscalls
+ * of such a TA are serialized by user_ta_lock_objects(), the owner can't
+ * end its transaction while the caller waits.
+ */
+static bool tx_owner_is_calling(void)
+{
+	struct ts_session *s = NULL;
+
+	TAILQ_FOREACH(s, &thread_get_tsd()->sess_stack, link_tsd)
+		if (s == ree_fs_tx.owner)
+			return true;
+
+	if (IS_ENABLED(CFG_TA_CONCURRENT)) {
+		s = ts_get_current_session_may_fail();
+		if (s && s->ctx == ree_fs_tx.owner->ctx)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Waits for the transaction of another caller to end, called with
+ * ree_fs_mutex held. Returns false if the owner of the transaction is
+ * waiting for the caller.
+ */
+static bool tx_wait_other(void)
+{
+	while (tx_is_other()) {
+		if (tx_owner_is_calling())
+			return false;
+		condvar_wait(&ree_fs_tx_cv, &ree_fs_mutex);
+	}
+
+	return true;
+}
+
+/*
+ * Locks ree_fs_mutex before an update, once the transaction of another
+ * caller has ended. Returns TEE_ERROR_STORAGE_NOT_AVAILABLE if that
+ * transaction can't end before the update, the error of the transaction
+ * of the caller otherwise, if any.
+ */
+static TEE_Result lock_for_update(void)
+{
+	mutex_lock(&ree_fs_mutex);
+	if (!tx_wait_other())
+		return TEE_ERROR_STORAGE_NOT_AVAILABLE;
+
+	return ree_fs_tx.res;
+}
+
+/*
+ * Returns the dirf.db lookups are served from, @dirh unless another
+ * caller has a transaction.
+ */
+static TEE_Result get_lookup_dirh(struct tee_fs_dirfile_dirh *dirh,
+				  struct tee_fs_dirfile_dirh **lookup_dirh)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	if (!tx_is_other()) {
+		*lookup_dirh = dirh;
+		return TEE_SUCCESS;
 	}
+
+	if (!ree_fs_tx.committed_dirh) {
+		res = open_committed_dirh(&ree_fs_tx.committed_dirh);
+		if (res)
+			return res;
+	}
+	*lookup_dirh = ree_fs_tx.committed_dirh;
+
+	return TEE_SUCCESS;
+}
+
+static bool tx_active(void)
+{
+	return ree_fs_tx.owner;
+}
+
+static void tx_fail(TEE_Result res)
+{
+	if (ree_fs_tx.owner && !ree_fs_tx.res)
+		ree_fs_tx.res = res;
+}
+
+static TEE_Result tx_add_file(const struct tee_fs_dirfile_fileh *dfh,
+			      enum tx_file_state state)
+{
+	struct tx_file *f = NULL;
+
+	f = realloc(ree_fs_tx.files, (ree_fs_tx.num_files + 1) * sizeof(*f));
+	if (!f)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	f[ree_fs_tx.num_files].dfh = *dfh;
+	f[ree_fs_tx.num_files].state = state;
+	ree_fs_tx.files = f;
+	ree_fs_tx.num_files++;
+
+	return TEE_SUCCESS;
+}
+
+static bool tx_has_file(uint32_t file_number, enum tx_file_state state)
+{
+	size_t n = 0;
+
+	for (n = 0; n < ree_fs_tx.num_files; n++)
+		if (ree_fs_tx.files[n].dfh.file_number == file_number &&
+		    ree_fs_tx.files[n].state == state)
+			return true;
+
+	return false;
+}
+
+static void tx_remove_fd(struct tee_fs_fd *fdp)
+{
+	TAILQ_REMOVE(&ree_fs_tx.fds, fdp, tx_link);
+	fdp->in_tx = false;
+}
+
+/* Defers the sync of @fdp until it's closed, called before modifying it */
+static TEE_Result tx_add_fd(struct tee_fs_fd *fdp)
+{
+	uint32_t num = fdp->dfh.file_number;
+
+	if (fdp->in_tx)
+		return TEE_SUCCESS;
+	if (tx_has_file(num, TX_FILE_REMOVED) ||
+	    (tx_has_file(num, TX_FILE_SYNCED) &&
+	     !tx_has_file(num, TX_FILE_CREATED)))
+		return TEE_ERROR_BAD_STATE;
+
+	memcpy(fdp->tx_hash, fdp->dfh.hash, sizeof(fdp->tx_hash));
+	fdp->in_tx = true;
+	TAILQ_INSERT_TAIL(&ree_fs_tx.fds, fdp, tx_link);
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result tx_sync_fd(struct tee_fs_fd *fdp)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	res = tee_fs_htree_sync_to_storage(&fdp->ht, fdp->dfh.hash, NULL);
+	if (res)
+		return res;
+
+	return tee_fs_dirfile_update_hash(ree_fs_tx.dirh, &fdp->dfh);
+}
+
+/* The file of @dfh is removed from the staged dirf.db */
+static TEE_Result tx_remove_file(const struct tee_fs_dirfile_fileh *dfh)
+{
+	struct tee_fs_fd *next = NULL;
+	struct tee_fs_fd *fdp = NULL;
+
+	TAILQ_FOREACH_SAFE(fdp, &ree_fs_tx.fds, tx_link, next)
+		if (fdp->dfh.file_number == dfh->file_number)
+			tx_remove_fd(fdp);
+
+	return tx_add_file(dfh, TX_FILE_REMOVED);
+}
+
+static void tx_end(bool close)
+{
+	free(ree_fs_tx.files);
+	ree_fs_tx.files = NULL;
+	ree_fs_tx.num_files = 0;
+	ree_fs_tx.owner = NULL;
+	ree_fs_tx.res = TEE_SUCCESS;
+	if (ree_fs_tx.committed_dirh) {
+		tee_fs_dirfile_close(ree_fs_tx.committed_dirh);
+		ree_fs_tx.committed_dirh = NULL;
+	}
+	put_dirh(ree_fs_tx.dirh, close);
+	ree_fs_tx.dirh = NULL;
+	condvar_broadcast(&ree_fs_tx_cv);
+}
+
+static void tx_rollback(void)
+{
+	struct tee_fs_fd *fdp = NULL;
+	size_t n = 0;
+
+	/* Return the modified files to their committed version */
+	while ((fdp = TAILQ_FIRST(&ree_fs_tx.fds))) {
+		tx_remove_fd(fdp);
+		tee_fs_htree_close(&fdp->ht);
+		memcpy(fdp->dfh.hash, fdp->tx_hash, sizeof(fdp->dfh.hash));
+		if (tee_fs_htree_open(false, fdp->dfh.hash, 0, fdp->uuid,
+				      &ree_fs_storage_ops, fdp, &fdp->ht))
+			DMSG("Can't reopen file %"PRIu32,
+			     fdp->dfh.file_number);
+	}
+
+	for (n = 0; n < ree_fs_tx.num_files; n++)
+		if (ree_fs_tx.files[n].state == TX_FILE_CREATED)
+			tee_fs_rpc_remove_dfh(OPTEE_RPC_CMD_FS,
+					      &ree_fs_tx.files[n].dfh);
+
+	/* Closing dirf.db drops its staged changes */
+	tx_end(true);
+}
+
+static TEE_Result ree_fs_begin_tx(struct ts_session *owner)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	if (!owner)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	mutex_lock(&ree_fs_mutex);
+
+	if (ree_fs_tx.owner == owner) {
+		res = TEE_ERROR_BAD_STATE;
+	} else if (!tx_wait_other()) {
+		res = TEE_ERROR_BUSY;
+	} else {
+		res = get_dirh(&ree_fs_tx.dirh);
+		if (!res)
+			ree_fs_tx.owner = owner;
+	}
+
+	mutex_unlock(&ree_fs_mutex);
+
+	return res;
+}
+
+static TEE_Result ree_fs_commit_tx(struct ts_session *owner)
+{
+	TEE_Result res = TEE_SUCCESS;
+	struct tee_fs_fd *fdp = NULL;
+	size_t n = 0;
+
+	mutex_lock(&ree_fs_mutex);
+
+	if (!owner || ree_fs_tx.owner != owner) {
+		res = TEE_ERROR_BAD_STATE;
+		goto out;
+	}
+
+	res = ree_fs_tx.res;
+	if (!res) {
+		TAILQ_FOREACH(fdp, &ree_fs_tx.fds, tx_link) {
+			res = tx_sync_fd(fdp);
+			if (res)
+				break;
+		}
+	}
+	if (!res)
+		res = commit_dirh_writes(ree_fs_tx.dirh);
+	if (res) {
+		tx_rollback();
+		goto out;
+	}
+
+	while ((fdp = TAILQ_FIRST(&ree_fs_tx.fds)))
+		tx_remove_fd(fdp);
+	for (n = 0; n < ree_fs_tx.num_files; n++)
+		if (ree_fs_tx.files[n].state == TX_FILE_REMOVED)
+			tee_fs_rpc_remove_dfh(OPTEE_RPC_CMD_FS,
+					      &ree_fs_tx.files[n].dfh);
+	tx_end(false);
+out:
+	mutex_unlock(&ree_fs_mutex);
+
+	return res;
+}
+
+static void ree_fs_abort_tx(struct ts_session *owner)
+{
+	/*
+	 * Called each time an invocation returns. Only @owner makes itself
+	 * the owner, no need to lock ree_fs_mutex to know it isn't.
+	 */
+	if (!owner || ree_fs_tx.owner != owner)
+		return;
+
+	mutex_lock(&ree_fs_mutex);
+	if (owner && ree_fs_tx.owner == owner)
+		tx_rollback();
+	mutex_unlock(&ree_fs_mutex);
 }
 
 static TEE_Result ree_fs_open(struct tee_pobj *po, size_t *size,
@@ -703,6 +1153,7 @@ static TEE_Result ree_fs_open(struct tee_pobj *po, size_t *size,
 {
 	TEE_Result res;
 	struct tee_fs_dirfile_dirh *dirh = NULL;
+	struct tee_fs_dirfile_dirh *lookup_dirh = NULL;
 	struct tee_fs_dirfile_fileh dfh;
 
 	mutex_lock(&ree_fs_mutex);
@@ -711,8 +1162,12 @@ static TEE_Result ree_fs_open(struct tee_pobj *po, size_t *size,
 	if (res != TEE_SUCCESS)
 		goto out;
 
-	res = tee_fs_dirfile_find(dirh, &po->uuid, po->obj_id, po->obj_id_len,
-				  &dfh);
+	res = get_lookup_dirh(dirh, &lookup_dirh);
+	if (res != TEE_SUCCESS)
+		goto out;
+
+	res = tee_fs_dirfile_find(lookup_dirh, &po->uuid, po->obj_id,
+				  po->obj_id_len, &dfh);
 	if (res != TEE_SUCCESS)
 		goto out;
 
@@ -761,6 +1216,14 @@ static TEE_Result set_name(struct tee_fs_dirfile_dirh *dirh,
 	old_dfh.idx = -1;
 	res = tee_fs_dirfile_rename(dirh, &po->uuid, &fdp->dfh,
 				    po->obj_id, po->obj_id_len);
+	if (!res && tx_active()) {
+		/* The old file is removed when the transaction is committed */
+		res = tx_add_file(&fdp->dfh, TX_FILE_CREATED);
+		if (!res && have_old_dfh)
+			res = tx_add_file(&old_dfh, TX_FILE_REMOVED);
+		tx_fail(res);
+		return res;
+	}
 	if (res)
 		return res;
 
@@ -776,8 +1239,18 @@ static TEE_Result set_name(struct tee_fs_dirfile_dirh *dirh,
 
 static void ree_fs_close(struct tee_file_handle **fh)
 {
+	struct tee_fs_fd *fdp = (struct tee_fs_fd *)*fh;
+	TEE_Result res = TEE_SUCCESS;
+
 	if (*fh) {
 		mutex_lock(&ree_fs_mutex);
+		if (fdp->in_tx) {
+			res = tx_sync_fd(fdp);
+			if (!res)
+				res = tx_add_file(&fdp->dfh, TX_FILE_SYNCED);
+			tx_fail(res);
+			tx_remove_fd(fdp);
+		}
 		put_dirh_primitive(false);
 		ree_fs_close_primitive(*fh);
 		*fh = NULL;
@@ -802,13 +1275,22 @@ static TEE_Result ree_fs_create(struct tee_pobj *po, bool overwrite,
 	assert(!data_core || !data_user);
 
 	*fh = NULL;
-	mutex_lock(&ree_fs_mutex);
+	res = lock_for_update();
+	if (res)
+		goto out;
 
 	res = get_dirh(&dirh);
 	if (res)
 		goto out;
 
-	res = tee_fs_dirfile_get_tmp(dirh, &dfh);
+	/*
+	 * The files removed in a transaction are kept until it's committed,
+	 * their numbers can't be used again before that.
+	 */
+	do {
+		res = tee_fs_dirfile_get_tmp(dirh, &dfh);
+	} while (!res && tx_active() &&
+		 tx_has_file(dfh.file_number, TX_FILE_REMOVED));
 	if (res)
 		goto out;
 
@@ -868,12 +1350,24 @@ static TEE_Result ree_fs_write(struct tee_file_handle *fh, size_t pos,
 	/* One of buf_core and buf_user must be NULL */
 	assert(!buf_core || !buf_user);
 
-	mutex_lock(&ree_fs_mutex);
+	res = lock_for_update();
+	if (res)
+		goto out;
 
 	res = get_dirh(&dirh);
 	if (res)
 		goto out;
 
+	if (tx_active()) {
+		res = tx_add_fd(fdp);
+		if (!res) {
+			res = ree_fs_write_primitive(fh, pos, buf_core,
+						     buf_user, len);
+			tx_fail(res);
+		}
+		goto out;
+	}
+
 	res = ree_fs_write_primitive(fh, pos, buf_core, buf_user, len);
 	if (res)
 		goto out;
@@ -904,7 +1398,9 @@ static TEE_Result ree_fs_rename(struct tee_pobj *old, struct tee_pobj *new,
 	if (!new)
 		return TEE_ERROR_BAD_PARAMETERS;
 
-	mutex_lock(&ree_fs_mutex);
+	res = lock_for_update();
+	if (res)
+		goto out;
 	res = get_dirh(&dirh);
 	if (res)
 		goto out;
@@ -923,14 +1419,16 @@ static TEE_Result ree_fs_rename(struct tee_pobj *old, struct tee_pobj *new,
 
 	res = tee_fs_dirfile_rename(dirh, &new->uuid, &dfh, new->obj_id,
 				    new->obj_id_len);
-	if (res)
-		goto out;
-
-	if (remove_dfh.idx != -1) {
+	if (!res && remove_dfh.idx != -1)
 		res = tee_fs_dirfile_remove(dirh, &remove_dfh);
-		if (res)
-			goto out;
+	if (tx_active()) {
+		if (!res && remove_dfh.idx != -1)
+			res = tx_remove_file(&remove_dfh);
+		tx_fail(res);
+		goto out;
 	}
+	if (res)
+		goto out;
 
 	res = commit_dirh_writes(dirh);
 	if (res)
@@ -953,7 +1451,9 @@ static TEE_Result ree_fs_remove(struct tee_pobj *po)
 	struct tee_fs_dirfile_dirh *dirh = NULL;
 	struct tee_fs_dirfile_fileh dfh;
 
-	mutex_lock(&ree_fs_mutex);
+	res = lock_for_update();
+	if (res)
+		goto out;
 	res = get_dirh(&dirh);
 	if (res)
 		goto out;
@@ -964,14 +1464,22 @@ static TEE_Result ree_fs_remove(struct tee_pobj *po)
 		goto out;
 
 	res = tee_fs_dirfile_remove(dirh, &dfh);
-	if (res)
-		goto out;
+	if (tx_active()) {
+		if (!res)
+			res = tx_remove_file(&dfh);
+		tx_fail(res);
+		if (res)
+			goto out;
+	} else {
+		if (res)
+			goto out;
 
-	res = commit_dirh_writes(dirh);
-	if (res)
-		goto out;
+		res = commit_dirh_writes(dirh);
+		if (res)
+			goto out;
 
-	tee_fs_rpc_remove_dfh(OPTEE_RPC_CMD_FS, &dfh);
+		tee_fs_rpc_remove_dfh(OPTEE_RPC_CMD_FS, &dfh);
+	}
 
 	assert(tee_fs_dirfile_find(dirh, &po->uuid, po->obj_id, po->obj_id_len,
 				   &dfh));
@@ -988,12 +1496,23 @@ static TEE_Result ree_fs_truncate(struct tee_file_handle *fh, size_t len)
 	struct tee_fs_dirfile_dirh *dirh = NULL;
 	struct tee_fs_fd *fdp = (struct tee_fs_fd *)fh;
 
-	mutex_lock(&ree_fs_mutex);
+	res = lock_for_update();
+	if (res)
+		goto out;
 
 	res = get_dirh(&dirh);
 	if (res)
 		goto out;
 
+	if (tx_active()) {
+		res = tx_add_fd(fdp);
+		if (!res) {
+			res = ree_fs_ftruncate_internal(fdp, len);
+			tx_fail(res);
+		}
+		goto out;
+	}
+
 	res = ree_fs_ftruncate_internal(fdp, len);
 	if (res)
 		goto out;
@@ -1019,6 +1538,7 @@ static TEE_Result ree_fs_opendir_rpc(const TEE_UUID *uuid,
 {
 	TEE_Result res;
 	struct tee_fs_dir *d = calloc(1, sizeof(*d));
+	struct tee_fs_dirfile_dirh *lookup_dirh = NULL;
 
 	if (!d)
 		return TEE_ERROR_OUT_OF_MEMORY;
@@ -1031,10 +1551,14 @@ static TEE_Result ree_fs_opendir_rpc(const TEE_UUID *uuid,
 	if (res)
 		goto out;
 
+	res = get_lookup_dirh(d->dirh, &lookup_dirh);
+	if (res)
+		goto out;
+
 	/* See that there's at least one file */
 	d->idx = -1;
 	d->d.oidlen = sizeof(d->d.oid);
-	res = tee_fs_dirfile_get_next(d->dirh, d->uuid, &d->idx, d->d.oid,
+	res = tee_fs_dirfile_get_next(lookup_dirh, d->uuid, &d->idx, d->d.oid,
 				      &d->d.oidlen);
 	d->idx = -1;
 
@@ -1066,16 +1590,22 @@ static void ree_fs_closedir_rpc(struct tee_fs_dir *d)
 static TEE_Result ree_fs_readdir_rpc(struct tee_fs_dir *d,
 				     struct tee_fs_dirent **ent)
 {
+	struct tee_fs_dirfile_dirh *lookup_dirh = NULL;
 	TEE_Result res;
 
 	mutex_lock(&ree_fs_mutex);
 
+	res = get_lookup_dirh(d->dirh, &lookup_dirh);
+	if (res)
+		goto out;
+
 	d->d.oidlen = sizeof(d->d.oid);
-	res = tee_fs_dirfile_get_next(d->dirh, d->uuid, &d->idx, d->d.oid,
+	res = tee_fs_dirfile_get_next(lookup_dirh, d->uuid, &d->idx, d->d.oid,
 				      &d->d.oidlen);
 	if (res == TEE_SUCCESS)
 		*ent = &d->d;
 
+out:
 	mutex_unlock(&ree_fs_mutex);
 
 	return res;
@@ -1093,4 +1623,7 @@ const struct tee_file_operations ree_fs_ops = {
 	.opendir = ree_fs_opendir_rpc,
 	.closedir = ree_fs_closedir_rpc,
 	.readdir = ree_fs_readdir_rpc,
+	.begin_tx = ree_fs_begin_tx,
+	.commit_tx = ree_fs_commit_tx,
+	.abort_tx = ree_fs_abort_tx,
 };
@@ -6,6 +6,7 @@
 
 #include <compiler.h>
 #include <kernel/chip_services.h>
+#include <kernel/mutex.h>
 #include <kernel/pseudo_ta.h>
 #include <kernel/tee_common.h>
 #include <kernel/tee_common_otp.h>
@@ -13,6 +14,7 @@
 #include <kernel/tee_time.h>
 #include <kernel/trace_ta.h>
 #include <kernel/user_access.h>
+#include <kernel/user_ta.h>
 #include <memtag.h>
 #include <mm/core_memprot.h>
 #include <mm/mobj.h>
@@ -1029,3 +1031,185 @@ TEE_Result syscall_set_ta_time(const TEE_Time *mytime)
 
 	return tee_time_set_ta_time((const void *)&s->ctx->uuid, &t);
 }
+
+#ifdef CFG_TA_CONCURRENT
+/* Number of hash buckets futex waiters are spread over, a power of 2 */
+#define FUTEX_BUCKET_COUNT	16
+
+/* A thread of a concurrent TA waiting for the value at @uaddr to change */
+struct futex_waiter {
+	struct ts_session *sess;
+	struct ts_ctx *ctx;
+	vaddr_t uaddr;
+	bool woken;
+	struct condvar cv;
+	LIST_ENTRY(futex_waiter) link;
+};
+
+/*
+ * Waiters are hashed on context and address so that threads of different
+ * TAs, or of one TA waiting on different futexes, don't contend on a
+ * single mutex.
+ */
+struct futex_bucket {
+	struct mutex mu;
+	LIST_HEAD(, futex_waiter) waiters;
+};
+
+static struct futex_bucket futex_buckets[FUTEX_BUCKET_COUNT] = {
+	[0 ... FUTEX_BUCKET_COUNT - 1] = {
+		.mu = MUTEX_INITIALIZER,
+		.waiters = LIST_HEAD_INITIALIZER(waiters),
+	},
+};
+
+static struct futex_bucket *futex_bucket(struct ts_ctx *ctx, vaddr_t uaddr)
+{
+	size_t h = (uaddr / sizeof(uint32_t)) ^ ((vaddr_t)ctx / 64);
+
+	h ^= h / FUTEX_BUCKET_COUNT;
+
+	return futex_buckets + (h & (FUTEX_BUCKET_COUNT - 1));
+}
+
+static TEE_Result check_futex(struct ts_ctx *ctx, const uint32_t *uaddr)
+{
+	if (!is_user_ta_ctx(ctx) || !to_user_ta_ctx(ctx)->uctx.threads)
+		return TEE_ERROR_NOT_SUPPORTED;
+	if (!IS_ALIGNED_WITH_TYPE(uaddr, uint32_t))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	return TEE_SUCCESS;
+}
+
+/* Wakes up to @count waiters, called with @b->mu held */
+static void wake_waiters(struct futex_bucket *b, struct ts_ctx *ctx,
+			 vaddr_t uaddr, bool any_uaddr, size_t count)
+{
+	struct futex_waiter *next = NULL;
+	struct futex_waiter *w = NULL;
+
+	LIST_FOREACH_SAFE(w, &b->waiters, link, next) {
+		if (!count)
+			break;
+		if (w->ctx != ctx || (!any_uaddr && w->uaddr != uaddr))
+			continue;
+
+		LIST_REMOVE(w, link);
+		w->woken = true;
+		condvar_signal(&w->cv);
+		count--;
+	}
+}
+
+/*
+ * Called with @b->mu held. Every waiter sleeps in condvar_wait(), a
+ * cancellable one is signalled by tee_svc_futex_cancel() when its session
+ * is cancelled. The expiry of a cancellation timeout has no one to signal
+ * it, it's noticed when the waiter is woken or signalled next.
+ */
+static TEE_Result wait_woken(struct futex_bucket *b, struct futex_waiter *w,
+			     bool cancellable)
+{
+	struct tee_ta_session *s = to_ta_session(w->sess);
+
+	LIST_INSERT_HEAD(&b->waiters, w, link);
+	while (!w->woken) {
+		if (cancellable && tee_ta_session_is_cancelled(s, NULL)) {
+			LIST_REMOVE(w, link);
+			return TEE_ERROR_CANCEL;
+		}
+
+		condvar_wait(&w->cv, &b->mu);
+	}
+
+	if (to_ta_ctx(w->ctx)->panicked)
+		return TEE_ERROR_TARGET_DEAD;
+
+	return TEE_SUCCESS;
+}
+
+TEE_Result syscall_futex_wait(uint32_t *uaddr, unsigned long val,
+			      unsigned long flags)
+{
+	struct ts_session *s = ts_get_current_session();
+	struct futex_waiter w = { .sess = s, .ctx = s->ctx };
+	struct futex_bucket *b = NULL;
+	TEE_Result res = TEE_SUCCESS;
+	uint32_t v = 0;
+
+	uaddr = memtag_strip_tag(uaddr);
+	res = check_futex(s->ctx, uaddr);
+	if (res)
+		return res;
+	if (flags & ~UTEE_FUTEX_WAIT_CANCELLABLE)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	w.uaddr = (vaddr_t)uaddr;
+	condvar_init(&w.cv);
+	b = futex_bucket(s->ctx, w.uaddr);
+
+	/*
+	 * The value is read with the bucket mutex held, a wake up done by
+	 * another thread after changing it can't be missed.
+	 */
+	mutex_lock(&b->mu);
+	if (to_ta_ctx(s->ctx)->panicked) {
+		res = TEE_ERROR_TARGET_DEAD;
+	} else {
+		res = copy_from_user_private(&v, uaddr, sizeof(v));
+		if (!res && v == val)
+			res = wait_woken(b, &w,
+					 flags & UTEE_FUTEX_WAIT_CANCELLABLE);
+	}
+	mutex_unlock(&b->mu);
+
+	condvar_destroy(&w.cv);
+
+	return res;
+}
+
+TEE_Result syscall_futex_wake(uint32_t *uaddr, unsigned long count)
+{
+	struct ts_session *s = ts_get_current_session();
+	struct futex_bucket *b = NULL;
+	TEE_Result res = TEE_SUCCESS;
+
+	uaddr = memtag_strip_tag(uaddr);
+	res = check_futex(s->ctx, uaddr);
+	if (res)
+		return res;
+
+	b = futex_bucket(s->ctx, (vaddr_t)uaddr);
+	mutex_lock(&b->mu);
+	wake_waiters(b, s->ctx, (vaddr_t)uaddr, false, count);
+	mutex_unlock(&b->mu);
+
+	return TEE_SUCCESS;
+}
+
+void tee_svc_futex_wake_all(struct ts_ctx *ctx)
+{
+	size_t n = 0;
+
+	for (n = 0; n < FUTEX_BUCKET_COUNT; n++) {
+		mutex_lock(&futex_buckets[n].mu);
+		wake_waiters(futex_buckets + n, ctx, 0, true, SIZE_MAX);
+		mutex_unlock(&futex_buckets[n].mu);
+	}
+}
+
+void tee_svc_futex_cancel(struct ts_session *sess)
+{
+	struct futex_waiter *w = NULL;
+	size_t n = 0;
+
+	for (n = 0; n < FUTEX_BUCKET_COUNT; n++) {
+		mutex_lock(&futex_buckets[n].mu);
+		LIST_FOREACH(w, &futex_buckets[n].waiters, link)
+			if (w->sess == sess)
+				condvar_signal(&w->cv);
+		mutex_unlock(&futex_buckets[n].mu);
+	}
+}
+#endif /*CFG_TA_CONCURRENT*/
@@ -13,6 +13,7 @@
 #include <kernel/tee_ta_manager.h>
 #include <kernel/user_access.h>
 #include <memtag.h>
+#include <mm/slab.h>
 #include <mm/vm.h>
 #include <stdlib_ext.h>
 #include <string_ext.h>
@@ -56,6 +57,10 @@ struct tee_cryp_state {
 	enum cryp_state state;
 };
 
+static struct slab_cache cryp_state_cache =
+	SLAB_CACHE_INITIALIZER("tee_cryp_state", sizeof(struct tee_cryp_state),
+			       0, NULL);
+
 struct tee_cryp_obj_secret {
 	uint32_t key_size;
 	uint32_t alloc_size;
@@ -1327,6 +1332,13 @@ TEE_Result syscall_cryp_obj_get_attr(unsigned long obj, unsigned long attr_id,
 	return ops->to_user(attr, sess, buffer, size);
 }
 
+/* Drop what the crypto implementation precomputed from the attributes */
+static void tee_obj_attr_clear_precomp(struct tee_obj *o)
+{
+	if (o->info.objectType == TEE_TYPE_RSA_KEYPAIR)
+		crypto_acipher_clear_rsa_precomp(o->attr);
+}
+
 void tee_obj_attr_free(struct tee_obj *o)
 {
 	const struct tee_cryp_obj_type_props *tp;
@@ -1338,6 +1350,7 @@ void tee_obj_attr_free(struct tee_obj *o)
 	if (!tp)
 		return;
 
+	tee_obj_attr_clear_precomp(o);
 	for (n = 0; n < tp->num_type_attrs; n++) {
 		const struct tee_cryp_obj_type_attrs *ta = tp->type_attrs + n;
 
@@ -1356,6 +1369,7 @@ void tee_obj_attr_clear(struct tee_obj *o)
 	if (!tp)
 		return;
 
+	tee_obj_attr_clear_precomp(o);
 	for (n = 0; n < tp->num_type_attrs; n++) {
 		const struct tee_cryp_obj_type_attrs *ta = tp->type_attrs + n;
 
@@ -2612,7 +2626,7 @@ static void cryp_state_free(struct user_ta_ctx *utc, struct tee_cryp_state *cs)
 		assert(!cs->ctx);
 	}
 
-	free(cs);
+	slab_free(&cryp_state_cache, cs);
 }
 
 static TEE_Result tee_svc_cryp_check_key_type(const struct tee_obj *o,
@@ -2801,7 +2815,7 @@ TEE_Result syscall_cryp_state_alloc(unsigned long algo, unsigned long mode,
 			return res;
 	}
 
-	cs = calloc(1, sizeof(struct tee_cryp_state));
+	cs = slab_zalloc(&cryp_state_cache);
 	if (!cs)
 		return TEE_ERROR_OUT_OF_MEMORY;
 	TAILQ_INSERT_TAIL(&utc->cryp_states, cs, link);
@@ -23,6 +23,7 @@
 #include <tee/tee_svc.h>
 #include <tee/tee_svc_storage.h>
 #include <trace.h>
+#include <util.h>
 
 /* Header of GP formated secure storage files */
 struct tee_svc_storage_head {
@@ -620,6 +621,49 @@ TEE_Result syscall_storage_start_enum(unsigned long obj_enum,
 	return fops->opendir(&sess->ctx->uuid, &e->dir);
 }
 
+static TEE_Result get_enum_obj_info(struct ts_session *sess,
+				    struct tee_storage_enum *e,
+				    struct tee_fs_dirent *d,
+				    struct utee_object_info *info)
+{
+	TEE_Result res = TEE_SUCCESS;
+	struct tee_obj *o = NULL;
+
+	o = tee_obj_alloc();
+	if (o == NULL)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	res = tee_pobj_get(&sess->ctx->uuid, d->oid, d->oidlen, 0,
+			   TEE_POBJ_USAGE_ENUM, e->fops, &o->pobj);
+	if (res)
+		goto exit;
+
+	o->info.handleFlags = o->pobj->flags | TEE_HANDLE_FLAG_PERSISTENT |
+			      TEE_HANDLE_FLAG_INITIALIZED;
+
+	tee_pobj_lock_usage(o->pobj);
+	res = tee_svc_storage_read_head(o);
+	*info = (struct utee_object_info){
+		.obj_type = o->info.objectType,
+		.obj_size = o->info.objectSize,
+		.max_obj_size = o->info.maxObjectSize,
+		.obj_usage = o->pobj->obj_info_usage,
+		.data_size = o->info.dataSize,
+		.data_pos = o->info.dataPosition,
+		.handle_flags = o->info.handleFlags,
+	};
+	tee_pobj_unlock_usage(o->pobj);
+
+exit:
+	if (o->pobj) {
+		o->pobj->fops->close(&o->fh);
+		tee_pobj_release(o->pobj);
+	}
+	tee_obj_free(o);
+
+	return res;
+}
+
 TEE_Result syscall_storage_next_enum(unsigned long obj_enum,
 				     struct utee_object_info *info,
 				     void *obj_id, uint64_t *len)
@@ -629,13 +673,12 @@ TEE_Result syscall_storage_next_enum(unsigned long obj_enum,
 	struct tee_storage_enum *e = NULL;
 	struct tee_fs_dirent *d = NULL;
 	TEE_Result res = TEE_SUCCESS;
-	struct tee_obj *o = NULL;
 	uint64_t l = 0;
 	struct utee_object_info bbuf = { };
 
 	res = tee_svc_storage_get_enum(utc, uref_to_vaddr(obj_enum), &e);
 	if (res != TEE_SUCCESS)
-		goto exit;
+		return res;
 
 	info = memtag_strip_tag(info);
 	obj_id = memtag_strip_tag(obj_id);
@@ -644,74 +687,157 @@ TEE_Result syscall_storage_next_enum(unsigned long obj_enum,
 	res = vm_check_access_rights(&utc->uctx, TEE_MEMORY_ACCESS_WRITE,
 				     (uaddr_t)info, sizeof(*info));
 	if (res != TEE_SUCCESS)
-		goto exit;
+		return res;
 
 	res = vm_check_access_rights(&utc->uctx, TEE_MEMORY_ACCESS_WRITE,
 				     (uaddr_t)obj_id, TEE_OBJECT_ID_MAX_LEN);
 	if (res != TEE_SUCCESS)
-		goto exit;
+		return res;
 
-	if (!e->fops) {
-		res = TEE_ERROR_ITEM_NOT_FOUND;
-		goto exit;
-	}
+	if (!e->fops)
+		return TEE_ERROR_ITEM_NOT_FOUND;
 
 	res = e->fops->readdir(e->dir, &d);
 	if (res != TEE_SUCCESS)
-		goto exit;
+		return res;
 
-	o = tee_obj_alloc();
-	if (o == NULL) {
-		res = TEE_ERROR_OUT_OF_MEMORY;
-		goto exit;
-	}
+	res = get_enum_obj_info(sess, e, d, &bbuf);
+	if (res != TEE_SUCCESS)
+		return res;
 
-	res = tee_pobj_get(&sess->ctx->uuid, d->oid, d->oidlen, 0,
-			   TEE_POBJ_USAGE_ENUM, e->fops, &o->pobj);
+	res = copy_to_user(info, &bbuf, sizeof(bbuf));
 	if (res)
-		goto exit;
+		return res;
 
-	o->info.handleFlags = o->pobj->flags | TEE_HANDLE_FLAG_PERSISTENT |
-			      TEE_HANDLE_FLAG_INITIALIZED;
+	res = copy_to_user(obj_id, d->oid, d->oidlen);
+	if (res)
+		return res;
 
-	tee_pobj_lock_usage(o->pobj);
-	res = tee_svc_storage_read_head(o);
-	bbuf = (struct utee_object_info){
-		.obj_type = o->info.objectType,
-		.obj_size = o->info.objectSize,
-		.max_obj_size = o->info.maxObjectSize,
-		.obj_usage = o->pobj->obj_info_usage,
-		.data_size = o->info.dataSize,
-		.data_pos = o->info.dataPosition,
-		.handle_flags = o->info.handleFlags,
-	};
-	tee_pobj_unlock_usage(o->pobj);
+	l = d->oidlen;
+	return copy_to_user_private(len, &l, sizeof(*len));
+}
+
+TEE_Result syscall_storage_next_enum_batch(unsigned long obj_enum,
+					   struct utee_object_enum_entry *entries,
+					   uint64_t *count)
+{
+	struct ts_session *sess = ts_get_current_session();
+	struct user_ta_ctx *utc = to_user_ta_ctx(sess->ctx);
+	struct utee_object_enum_entry ent = { };
+	struct tee_storage_enum *e = NULL;
+	struct utee_object_info info = { };
+	struct tee_fs_dirent *d = NULL;
+	TEE_Result res = TEE_SUCCESS;
+	uint64_t max_count = 0;
+	uint64_t n = 0;
+	size_t sz = 0;
+
+	res = tee_svc_storage_get_enum(utc, uref_to_vaddr(obj_enum), &e);
 	if (res != TEE_SUCCESS)
-		goto exit;
+		return res;
 
-	res = copy_to_user(info, &bbuf, sizeof(bbuf));
+	res = copy_from_user_private(&max_count, count, sizeof(max_count));
 	if (res)
-		goto exit;
+		return res;
+	if (!max_count)
+		return TEE_ERROR_BAD_PARAMETERS;
 
-	res = copy_to_user(obj_id, o->pobj->obj_id, o->pobj->obj_id_len);
-	if (res)
-		goto exit;
+	entries = memtag_strip_tag(entries);
+	if (MUL_OVERFLOW(max_count, sizeof(*entries), &sz))
+		return TEE_ERROR_OVERFLOW;
+	res = vm_check_access_rights(&utc->uctx, TEE_MEMORY_ACCESS_WRITE,
+				     (uaddr_t)entries, sz);
+	if (res != TEE_SUCCESS)
+		return res;
 
-	l = o->pobj->obj_id_len;
-	res = copy_to_user_private(len, &l, sizeof(*len));
+	if (!e->fops)
+		return TEE_ERROR_ITEM_NOT_FOUND;
 
-exit:
-	if (o) {
-		if (o->pobj) {
-			o->pobj->fops->close(&o->fh);
-			tee_pobj_release(o->pobj);
+	/*
+	 * Entries already copied when an error occurs are reported in
+	 * @count, the enumeration continues after the failing entry.
+	 */
+	for (n = 0; n < max_count; n++) {
+		res = e->fops->readdir(e->dir, &d);
+		if (res == TEE_ERROR_ITEM_NOT_FOUND && n) {
+			res = TEE_SUCCESS;
+			break;
 		}
-		tee_obj_free(o);
+		if (res)
+			break;
+
+		res = get_enum_obj_info(sess, e, d, &info);
+		if (res)
+			break;
+
+		memset(&ent, 0, sizeof(ent));
+		memcpy(ent.obj_id, d->oid, d->oidlen);
+		ent.obj_id_len = d->oidlen;
+		ent.data_size = info.data_size;
+		res = copy_to_user(entries + n, &ent, sizeof(ent));
+		if (res)
+			break;
 	}
 
+	if (copy_to_user_private(count, &n, sizeof(n)))
+		return TEE_ERROR_ACCESS_DENIED;
+
 	return res;
 }
 
+static TEE_Result get_tx_fops(unsigned long storage_id,
+			      const struct tee_file_operations **fops)
+{
+	*fops = tee_svc_storage_file_ops(storage_id);
+	if (!*fops)
+		return TEE_ERROR_ITEM_NOT_FOUND;
+	if (!(*fops)->begin_tx)
+		return TEE_ERROR_NOT_SUPPORTED;
+
+	return TEE_SUCCESS;
+}
+
+TEE_Result syscall_storage_tx_begin(unsigned long storage_id)
+{
+	struct ts_session *sess = ts_get_current_session();
+	const struct tee_file_operations *fops = NULL;
+	TEE_Result res = TEE_SUCCESS;
+
+	res = get_tx_fops(storage_id, &fops);
+	if (res)
+		return res;
+
+	return fops->begin_tx(sess);
+}
+
+TEE_Result syscall_storage_tx_commit(unsigned long storage_id)
+{
+	struct ts_session *sess = ts_get_current_session();
+	const struct tee_file_operations *fops = NULL;
+	TEE_Result res = TEE_SUCCESS;
+
+	res = get_tx_fops(storage_id, &fops);
+	if (res)
+		return res;
+
+	return fops->commit_tx(sess);
+}
+
+TEE_Result syscall_storage_tx_abort(unsigned long storage_id)
+{
+	struct ts_session *sess = ts_get_current_session();
+	const struct tee_file_operations *fops = NULL;
+	TEE_Result res = TEE_SUCCESS;
+
+	res = get_tx_fops(storage_id, &fops);
+	if (res)
+		return res;
+
+	fops->abort_tx(sess);
+
+	return TEE_SUCCESS;
+}
+
 TEE_Result syscall_storage_obj_read(unsigned long obj, void *data, size_t len,
 				    uint64_t *count)
 {
@@ -930,3 +1056,15 @@ void tee_svc_storage_close_all_enum(struct user_ta_ctx *utc)
 	while (!TAILQ_EMPTY(eh))
 		tee_svc_close_enum(utc, TAILQ_FIRST(eh));
 }
+
+void tee_svc_storage_abort_all_tx(struct ts_session *sess)
+{
+	const struct tee_file_operations *fops = NULL;
+
+	fops = tee_svc_storage_file_ops(TEE_STORAGE_PRIVATE_REE);
+	if (fops && fops->abort_tx)
+		fops->abort_tx(sess);
+	fops = tee_svc_storage_file_ops(TEE_STORAGE_PRIVATE_RPMB);
+	if (fops && fops->abort_tx)
+		fops->abort_tx(sess);
+}
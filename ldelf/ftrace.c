@@ -4,7 +4,11 @@
  */
 
 #include <assert.h>
+#include <elf32.h>
+#include <elf64.h>
+#include <elf_common.h>
 #include <printk.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/queue.h>
 #include <types_ext.h>
@@ -12,13 +16,189 @@
 #include <util.h>
 
 #include "ftrace.h"
+#include "sys.h"
 #include "ta_elf.h"
 
 #define MIN_FTRACE_BUF_SIZE	1024
 #define MAX_HEADER_STRLEN	128
+#define MAX_FILTER_FUNCS	256
+#define SYMS_PER_READ		32
+
+/*
+ * Size assumed for a filter function not found in the symbol table, the
+ * _mcount call site is in the prologue of the function
+ */
+#define DEFAULT_FUNC_SIZE	32
 
 static struct ftrace_buf *fbuf;
 
+static int cmp_func(const void *a, const void *b)
+{
+	const struct ftrace_filter_func *fa = a;
+	const struct ftrace_filter_func *fb = b;
+
+	return CMP_TRILEAN(fa->start, fb->start);
+}
+
+static void set_func_size(struct ftrace_filter_func *funcs, size_t num,
+			  uint64_t start, uint64_t size)
+{
+	size_t lo = 0;
+	size_t hi = num;
+	size_t mid = 0;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (funcs[mid].start == start) {
+			funcs[mid].end = start + size;
+			return;
+		}
+		if (funcs[mid].start < start)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+}
+
+/*
+ * Sets the end of the sorted filter functions @funcs from the symbol table
+ * of @elf. That table isn't loaded, it's read from the TA binary where the
+ * TA dev kit keeps it when CFG_FTRACE_SUPPORT=y.
+ */
+static void get_func_sizes(struct ta_elf *elf,
+			   struct ftrace_filter_func *funcs, size_t num)
+{
+	union {
+		Elf32_Sym s32[SYMS_PER_READ];
+		Elf64_Sym s64[SYMS_PER_READ];
+	} *syms = NULL;
+	size_t sym_size = sizeof(Elf64_Sym);
+	TEE_Result res = TEE_SUCCESS;
+	uint32_t handle = 0;
+	size_t tab_offs = 0;
+	size_t tab_size = 0;
+	size_t offs = 0;
+	size_t sz = 0;
+	size_t n = 0;
+
+	if (elf->is_32bit) {
+		Elf32_Shdr *shdr = elf->shdr;
+
+		sym_size = sizeof(Elf32_Sym);
+		for (n = 0; n < elf->e_shnum; n++) {
+			if (shdr[n].sh_type == SHT_SYMTAB) {
+				tab_offs = shdr[n].sh_offset;
+				tab_size = shdr[n].sh_size;
+				break;
+			}
+		}
+	} else {
+		Elf64_Shdr *shdr = elf->shdr;
+
+		for (n = 0; n < elf->e_shnum; n++) {
+			if (shdr[n].sh_type == SHT_SYMTAB) {
+				tab_offs = shdr[n].sh_offset;
+				tab_size = shdr[n].sh_size;
+				break;
+			}
+		}
+	}
+	if (!tab_size) {
+		DMSG("No symbol table, assuming %d byte filter functions",
+		     DEFAULT_FUNC_SIZE);
+		return;
+	}
+
+	syms = malloc(sizeof(*syms));
+	if (!syms)
+		return;
+
+	res = sys_open_ta_bin(&elf->uuid, &handle);
+	if (res)
+		goto out;
+
+	for (offs = 0; offs + sym_size <= tab_size; offs += sz) {
+		sz = MIN(tab_size - offs, SYMS_PER_READ * sym_size);
+		sz -= sz % sym_size;
+		res = sys_copy_from_ta_bin(syms, sz, handle, tab_offs + offs);
+		if (res)
+			break;
+
+		for (n = 0; n < sz / sym_size; n++) {
+			if (elf->is_32bit) {
+				Elf32_Sym *s = syms->s32 + n;
+
+				if (ELF32_ST_TYPE(s->st_info) == STT_FUNC &&
+				    s->st_size)
+					set_func_size(funcs, num,
+						      (s->st_value & ~1U) +
+						      elf->load_addr,
+						      s->st_size);
+			} else {
+				Elf64_Sym *s = syms->s64 + n;
+
+				if (ELF64_ST_TYPE(s->st_info) == STT_FUNC &&
+				    s->st_size)
+					set_func_size(funcs, num,
+						      s->st_value +
+						      elf->load_addr,
+						      s->st_size);
+			}
+		}
+	}
+
+	sys_close_ta_bin(handle);
+out:
+	free(syms);
+}
+
+/*
+ * Copies the functions of the optional __ftrace_filter of the TA, sorted
+ * by address, into the ftrace buffer from where ftrace_enter() looks them
+ * up
+ */
+static bool init_filter(struct ta_elf *elf, size_t fbuf_size)
+{
+	struct ftrace_filter_func *f = NULL;
+	struct __ftrace_filter *filt = NULL;
+	vaddr_t funcs = 0;
+	vaddr_t val = 0;
+	size_t n = 0;
+
+	fbuf->flags = 0;
+	fbuf->filter_off = sizeof(struct ftrace_buf);
+	fbuf->filter_num = 0;
+
+	if (ta_elf_resolve_sym("__ftrace_filter", &val, NULL, NULL))
+		return true;
+
+	filt = (struct __ftrace_filter *)val;
+	if (filt->num_funcs > MAX_FILTER_FUNCS ||
+	    fbuf->filter_off + filt->num_funcs * sizeof(*f) > fbuf_size) {
+		DMSG("ftrace filter too large");
+		return false;
+	}
+
+	f = (struct ftrace_filter_func *)((vaddr_t)fbuf + fbuf->filter_off);
+	funcs = filt->funcs.ptr64;
+	for (n = 0; n < filt->num_funcs; n++) {
+		if (elf->is_32bit)
+			f[n].start = ((uint32_t *)funcs)[n];
+		else
+			f[n].start = ((uint64_t *)funcs)[n];
+		/* Clear the Thumb bit, if present */
+		f[n].start &= ~1ULL;
+		f[n].end = f[n].start + DEFAULT_FUNC_SIZE;
+	}
+	qsort(f, filt->num_funcs, sizeof(*f), cmp_func);
+	get_func_sizes(elf, f, filt->num_funcs);
+
+	fbuf->flags = filt->flags & (FTRACE_FILTER_EXCLUDE | FTRACE_AGGREGATE);
+	fbuf->filter_num = filt->num_funcs;
+
+	return true;
+}
+
 bool ftrace_init(struct ftrace_buf **fbuf_ptr)
 {
 	struct __ftrace_info *finfo = NULL;
@@ -29,7 +209,7 @@ bool ftrace_init(struct ftrace_buf **fbuf_ptr)
 	size_t fbuf_size = 0;
 	size_t pad = 0;
 	char *p = NULL;
-	char magic[] = { 'F', 'T', 'R', 'A', 'C', 'E', 0x00, 0x01 };
+	char magic[] = { 'F', 'T', 'R', 'A', 'C', 'E', 0x00, 0x02 };
 
 	res = ta_elf_resolve_sym("__ftrace_info", &val, NULL, NULL);
 	if (res)
@@ -49,7 +229,17 @@ bool ftrace_init(struct ftrace_buf **fbuf_ptr)
 	}
 
 	fbuf = (struct ftrace_buf *)(vaddr_t)finfo->buf_start.ptr64;
-	fbuf->head_off = sizeof(struct ftrace_buf);
+	if (!init_filter(elf, fbuf_size))
+		return false;
+
+	fbuf->head_off = fbuf->filter_off +
+			 fbuf->filter_num * sizeof(struct ftrace_filter_func);
+	/* Room for the header, padding, delimiter and at least some records */
+	if (fbuf->head_off + MAX_HEADER_STRLEN + 8 + sizeof(magic) +
+	    sizeof(struct ftrace_func_stat) > fbuf_size) {
+		DMSG("ftrace buffer too small");
+		return false;
+	}
 	p = (char *)fbuf + fbuf->head_off;
 	count = snprintk(p, MAX_HEADER_STRLEN,
 			 "Function graph for TA: %pUl @ %lx\n",
@@ -61,6 +251,7 @@ bool ftrace_init(struct ftrace_buf **fbuf_ptr)
 	fbuf->ret_idx = 0;
 	fbuf->lr_idx = 0;
 	fbuf->suspend_time = 0;
+	fbuf->last_pc = 0;
 	fbuf->buf_off = fbuf->head_off + count;
 	/* For proper alignment of uint64_t values in the ftrace buffer  */
 	pad = 8 - (vaddr_t)p % 8;
@@ -71,14 +262,20 @@ bool ftrace_init(struct ftrace_buf **fbuf_ptr)
 		fbuf->buf_off++;
 		count++;
 	}
-	/* Delimiter for easier decoding */
+	/* Delimiter for easier decoding, tells the format of the records */
+	if (fbuf->flags & FTRACE_AGGREGATE)
+		magic[6] = 0x01;
 	memcpy(p, magic, sizeof(magic));
 	fbuf->buf_off += sizeof(magic);
 	count += sizeof(magic);
 	fbuf->curr_idx = 0;
-	fbuf->max_size = fbuf_size - sizeof(struct ftrace_buf) - count;
+	fbuf->max_size = fbuf_size - fbuf->head_off - count;
 	fbuf->syscall_trace_enabled = false;
 	fbuf->syscall_trace_suspended = false;
+	fbuf->overflow = false;
+
+	if (fbuf->flags & FTRACE_AGGREGATE)
+		memset((char *)fbuf + fbuf->buf_off, 0, fbuf->max_size);
 
 	*fbuf_ptr = fbuf;
 
@@ -92,28 +289,24 @@ void ftrace_copy_buf(void *pctx, void (*copy_func)(void *pctx, void *b,
 		struct ta_elf *elf = TAILQ_FIRST(&main_elf_queue);
 		char *hstart = (char *)fbuf + fbuf->head_off;
 		char *cstart = (char *)fbuf + fbuf->buf_off;
-		char *ccurr = cstart + fbuf->curr_idx * sizeof(uint64_t);
-		size_t csize = 0;
-		size_t dump_size = 0;
-		char *end = NULL;
+		struct ftrace_func_stat *st = (void *)cstart;
+		size_t n = 0;
 
 		assert(elf && elf->is_main);
 
-		if (fbuf->overflow)
-			csize = fbuf->max_size;
-		else
-			csize = fbuf->curr_idx * sizeof(uint64_t);
-		dump_size = fbuf->buf_off - fbuf->head_off + csize;
-		end = hstart + dump_size;
-
 		/* Header */
 		copy_func(pctx, hstart, fbuf->buf_off - fbuf->head_off);
-		if (fbuf->overflow) {
-			/* From current index to end of circular buffer */
-			copy_func(pctx, ccurr, end - ccurr);
+
+		if (!(fbuf->flags & FTRACE_AGGREGATE)) {
+			/* Records are never wrapped, see add_rec() */
+			copy_func(pctx, cstart, fbuf->curr_idx);
+			return;
 		}
-		/* From start of circular buffer to current index */
-		copy_func(pctx, cstart, ccurr - cstart);
+
+		/* Only the used entries of the aggregated mode table */
+		for (n = 0; n < fbuf->max_size / sizeof(*st); n++)
+			if (st[n].pc)
+				copy_func(pctx, st + n, sizeof(*st));
 	}
 }
 
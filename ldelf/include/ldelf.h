@@ -27,6 +27,8 @@
  * @ftrace_entry: [out] Dump TA mappings and ftrace buffer
  * @fbuf:         [out] ftrace buffer pointer
  * @dl_entry:     [out] Dynamic linking interface (for libdl)
+ * @thread_stack_ptr: [out] Stack pointers of the additional threads of a
+ *		  TA with TA_FLAG_CONCURRENT, @stack_ptr is used by the first
  */
 struct ldelf_arg {
 	TEE_UUID uuid;
@@ -39,6 +41,9 @@ struct ldelf_arg {
 	uint64_t ftrace_entry;
 	uint64_t dl_entry;
 	struct ftrace_buf *fbuf;
+#ifdef CFG_TA_CONCURRENT
+	uint64_t thread_stack_ptr[CFG_TA_CONCURRENT_MAX_THREADS - 1];
+#endif
 };
 
 #define DUMP_MAP_READ	BIT(0)
@@ -150,6 +150,11 @@ void ldelf(struct ldelf_arg *arg)
 	/* Load the main binary and get a list of dependencies, if any. */
 	ta_elf_load_main(&arg->uuid, &arg->is_32bit, &arg->stack_ptr,
 			 &arg->flags);
+#ifdef CFG_TA_CONCURRENT
+	if (arg->flags & TA_FLAG_CONCURRENT)
+		ta_elf_map_thread_stacks(arg->thread_stack_ptr,
+					 ARRAY_SIZE(arg->thread_stack_ptr));
+#endif
 
 	/*
 	 * Load binaries, ta_elf_load() may add external libraries to the
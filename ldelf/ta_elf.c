@@ -43,6 +43,9 @@ struct dl_phdr_info32 {
 
 static vaddr_t ta_stack;
 static vaddr_t ta_stack_size;
+#ifdef CFG_TA_CONCURRENT
+static vaddr_t ta_thread_stack[CFG_TA_CONCURRENT_MAX_THREADS - 1];
+#endif
 
 struct ta_elf_queue main_elf_queue = TAILQ_HEAD_INITIALIZER(main_elf_queue);
 
@@ -1279,6 +1282,28 @@ void ta_elf_load_main(const TEE_UUID *uuid, uint32_t *is_32bit, uint64_t *sp,
 	ta_stack_size = elf->head->stack_size;
 }
 
+#ifdef CFG_TA_CONCURRENT
+void ta_elf_map_thread_stacks(uint64_t *sp, size_t count)
+{
+	TEE_Result res = TEE_SUCCESS;
+	vaddr_t va = 0;
+	size_t n = 0;
+
+	assert(count <= ARRAY_SIZE(ta_thread_stack));
+
+	for (n = 0; n < count; n++) {
+		/* Leave an unmapped page below each stack to catch overflow */
+		va = 0;
+		res = sys_map_zi(ta_stack_size, 0, &va, SMALL_PAGE_SIZE, 0);
+		if (res)
+			err(res, "sys_map_zi thread stack");
+		ta_thread_stack[n] = va;
+		sp[n] = va + ta_stack_size;
+	}
+}
+
+#endif
+
 void ta_elf_finalize_load_main(uint64_t *entry, uint64_t *load_addr)
 {
 	struct ta_elf *elf = TAILQ_FIRST(&main_elf_queue);
@@ -1571,19 +1596,34 @@ bool find_exidx(vaddr_t addr, vaddr_t *idx_start, vaddr_t *idx_end)
 	return false;
 }
 
+/* Returns the stack of the thread with stack pointer @sp */
+static vaddr_t get_stack(vaddr_t sp __maybe_unused)
+{
+#ifdef CFG_TA_CONCURRENT
+	size_t n = 0;
+
+	for (n = 0; n < ARRAY_SIZE(ta_thread_stack); n++)
+		if (ta_thread_stack[n] && sp > ta_thread_stack[n] &&
+		    sp <= ta_thread_stack[n] + ta_stack_size)
+			return ta_thread_stack[n];
+#endif
+
+	return ta_stack;
+}
+
 void ta_elf_stack_trace_a32(uint32_t regs[16])
 {
 	struct unwind_state_arm32 state = { };
 
 	memcpy(state.registers, regs, sizeof(state.registers));
-	print_stack_arm32(&state, ta_stack, ta_stack_size);
+	print_stack_arm32(&state, get_stack(regs[13]), ta_stack_size);
 }
 
 void ta_elf_stack_trace_a64(uint64_t fp, uint64_t sp, uint64_t pc)
 {
 	struct unwind_state_arm64 state = { .fp = fp, .sp = sp, .pc = pc };
 
-	print_stack_arm64(&state, ta_stack, ta_stack_size);
+	print_stack_arm64(&state, get_stack(sp), ta_stack_size);
 }
 #elif defined(RV32) || defined(RV64)
 void ta_elf_stack_trace_riscv(uint64_t fp, uint64_t pc)
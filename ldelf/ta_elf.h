@@ -123,6 +123,9 @@ struct ta_elf *ta_elf_find_elf(const TEE_UUID *uuid);
 void ta_elf_load_main(const TEE_UUID *uuid, uint32_t *is_32bit, uint64_t *sp,
 		      uint32_t *ta_flags);
 void ta_elf_finalize_load_main(uint64_t *entry, uint64_t *load_addr);
+#ifdef CFG_TA_CONCURRENT
+void ta_elf_map_thread_stacks(uint64_t *sp, size_t count);
+#endif
 void ta_elf_load_dependency(struct ta_elf *elf, bool is_32bit);
 void ta_elf_relocate(struct ta_elf *elf);
 void ta_elf_finalize_mappings(struct ta_elf *elf);
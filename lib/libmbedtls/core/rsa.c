@@ -97,6 +97,80 @@ static uint32_t tee_algo_to_mbedtls_hash_algo(uint32_t algo)
 	}
 }
 
+/*
+ * struct rsa_precomp - values precomputed for a key pair
+ * @rn:	R^2 mod N
+ * @rp:	R^2 mod P
+ * @rq:	R^2 mod Q
+ *
+ * mbedtls_rsa_private() computes these for each operation unless they're
+ * already in the context. They're saved here by the first operation with a
+ * key and lent to the contexts of the next ones until the key changes.
+ * Operations with the same key may run concurrently, so a struct is only
+ * published in the key once complete and is read-only after that.
+ */
+struct rsa_precomp {
+	mbedtls_mpi rn;
+	mbedtls_mpi rp;
+	mbedtls_mpi rq;
+};
+
+static void precomp_lend(mbedtls_rsa_context *rsa, struct rsa_keypair *key)
+{
+	struct rsa_precomp *pc = __compiler_atomic_load_acquire(&key->precomp);
+
+	if (pc) {
+		rsa->RN = pc->rn;
+		rsa->RP = pc->rp;
+		rsa->RQ = pc->rq;
+	}
+}
+
+static void precomp_free(struct rsa_precomp *pc)
+{
+	mbedtls_mpi_free(&pc->rn);
+	mbedtls_mpi_free(&pc->rp);
+	mbedtls_mpi_free(&pc->rq);
+	free(pc);
+}
+
+/* Takes back the values lent to @rsa or saves the ones it computed */
+static void precomp_return(mbedtls_rsa_context *rsa, struct rsa_keypair *key)
+{
+	void *old = NULL;
+	struct rsa_precomp *pc = NULL;
+
+	if (__compiler_atomic_load_acquire(&key->precomp)) {
+		mbedtls_mpi_init(&rsa->RN);
+		mbedtls_mpi_init(&rsa->RP);
+		mbedtls_mpi_init(&rsa->RQ);
+		return;
+	}
+
+	if (!rsa->RN.p || !rsa->RP.p || !rsa->RQ.p)
+		return;
+
+	pc = calloc(1, sizeof(*pc));
+	if (!pc)
+		return;
+	mbedtls_mpi_init(&pc->rn);
+	mbedtls_mpi_init(&pc->rp);
+	mbedtls_mpi_init(&pc->rq);
+
+	/* Copied out of the scratch memory pool, only a speedup if it fails */
+	if (mbedtls_mpi_copy(&pc->rn, &rsa->RN) ||
+	    mbedtls_mpi_copy(&pc->rp, &rsa->RP) ||
+	    mbedtls_mpi_copy(&pc->rq, &rsa->RQ)) {
+		precomp_free(pc);
+		return;
+	}
+
+	/* Another operation with the key may have published its copy first */
+	if (!__atomic_compare_exchange_n(&key->precomp, &old, pc, false,
+					 __ATOMIC_RELEASE, __ATOMIC_ACQUIRE))
+		precomp_free(pc);
+}
+
 static TEE_Result rsa_init_and_complete_from_key_pair(mbedtls_rsa_context *rsa,
 						      struct rsa_keypair *key)
 {
@@ -139,6 +213,8 @@ static TEE_Result rsa_init_and_complete_from_key_pair(mbedtls_rsa_context *rsa,
 		}
 	}
 
+	precomp_lend(rsa, key);
+
 	return TEE_SUCCESS;
 err:
 	mbedtls_mpi_free(&rsa->P);
@@ -158,6 +234,7 @@ static void mbd_rsa_free(mbedtls_rsa_context *rsa, struct rsa_keypair *key)
 	 * we should only free the generated mpi's, the ones copied are
 	 * reset instead.
 	 */
+	precomp_return(rsa, key);
 	mbedtls_mpi_init(&rsa->E);
 	mbedtls_mpi_init(&rsa->N);
 	mbedtls_mpi_init(&rsa->D);
@@ -256,6 +333,19 @@ void sw_crypto_acipher_free_rsa_keypair(struct rsa_keypair *s)
 	crypto_bignum_free(&s->qp);
 	crypto_bignum_free(&s->dp);
 	crypto_bignum_free(&s->dq);
+	sw_crypto_acipher_clear_rsa_precomp(s);
+}
+
+void crypto_acipher_clear_rsa_precomp(struct rsa_keypair *s)
+__weak __alias("sw_crypto_acipher_clear_rsa_precomp");
+
+void sw_crypto_acipher_clear_rsa_precomp(struct rsa_keypair *s)
+{
+	if (!s || !s->precomp)
+		return;
+
+	precomp_free(s->precomp);
+	s->precomp = NULL;
 }
 
 TEE_Result crypto_acipher_gen_rsa_key(struct rsa_keypair *key,
@@ -301,6 +391,7 @@ TEE_Result sw_crypto_acipher_gen_rsa_key(struct rsa_keypair *key,
 		crypto_bignum_copy(key->qp, (void *)&rsa.QP);
 		crypto_bignum_copy(key->dp, (void *)&rsa.DP);
 		crypto_bignum_copy(key->dq, (void *)&rsa.DQ);
+		sw_crypto_acipher_clear_rsa_precomp(key);
 
 		res = TEE_SUCCESS;
 	}
@@ -0,0 +1,63 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+#ifndef __PTA_CORE_PROF_H
+#define __PTA_CORE_PROF_H
+
+/*
+ * Interface to the core profiler pseudo-TA. The OP-TEE core is sampled on
+ * each CPU from the secure physical timer interrupt, the sampled call
+ * stacks are accumulated in per-CPU histograms which can be exported in
+ * the "collapsed stack" format used by flame graph tools.
+ */
+
+#define PTA_CORE_PROF_UUID { 0xd84bc98c, 0x66d5, 0x4321, \
+		{ 0xb7, 0x7b, 0xed, 0x0c, 0xd0, 0x88, 0x96, 0xed } }
+
+/*
+ * PTA_CORE_PROF_CMD_START - Clear the histograms and start sampling
+ *
+ * [in]     value[0].a: Sampling period in microseconds
+ *
+ * Return codes:
+ * TEE_SUCCESS - Invoke command success
+ * TEE_ERROR_BAD_PARAMETERS - Incorrect input param
+ * TEE_ERROR_BAD_STATE - Sampling is already running
+ */
+#define PTA_CORE_PROF_CMD_START		0
+
+/*
+ * PTA_CORE_PROF_CMD_STOP - Stop sampling
+ *
+ * Return codes:
+ * TEE_SUCCESS - Invoke command success
+ */
+#define PTA_CORE_PROF_CMD_STOP		1
+
+/*
+ * PTA_CORE_PROF_CMD_EXPORT - Export sampled stacks as collapsed stacks
+ *
+ * Each exported line has the form "<frame>;<frame>;... <count>\n", outermost
+ * frame first. A frame is either the hexadecimal offset of a return
+ * address from the start of the TEE core text section, or one of
+ * "[normal_world]" or "[user]" for samples taken while the normal world
+ * or a user TA was interrupted. Lines are exported in batches, the caller
+ * passes back the returned cursor until it's 0 again. Sampling must be
+ * stopped.
+ *
+ * [inout]  value[0].a: Cursor, 0 on first call
+ * [out]    memref[1]: Text output buffer, the size is updated to the
+ *		       number of bytes written
+ * [out]    value[2].a: Total number of samples taken
+ * [out]    value[2].b: Number of samples which didn't fit in the histograms
+ *
+ * Return codes:
+ * TEE_SUCCESS - Invoke command success
+ * TEE_ERROR_BAD_PARAMETERS - Incorrect input param
+ * TEE_ERROR_BAD_STATE - Sampling is running
+ * TEE_ERROR_SHORT_BUFFER - Output buffer too small for one line
+ */
+#define PTA_CORE_PROF_CMD_EXPORT	2
+
+#endif /* __PTA_CORE_PROF_H */
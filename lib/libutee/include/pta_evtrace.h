@@ -0,0 +1,118 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+#ifndef __PTA_EVTRACE_H
+#define __PTA_EVTRACE_H
+
+#include <stdint.h>
+#include <util.h>
+
+/*
+ * Interface to the event tracer pseudo-TA, used to control the static
+ * tracepoints of the OP-TEE core and to drain the per-CPU ring buffers
+ * holding the recorded events.
+ */
+
+#define PTA_EVTRACE_UUID { 0xde28d533, 0xa8c7, 0x420d, \
+		{ 0xb7, 0x0b, 0xcf, 0x8b, 0xa3, 0x94, 0x3d, 0x85 } }
+
+/*
+ * Tracepoint identifiers, the meaning of @arg0 and @arg1 of a recorded
+ * struct pta_evtrace_entry depends on the identifier.
+ */
+/* arg0: SMC function ID (a0), arg1: a1 */
+#define PTA_EVTRACE_ID_STD_SMC			0
+/* arg0: allocated thread ID or -1 if none is free, arg1: thread flags */
+#define PTA_EVTRACE_ID_THREAD_ALLOC		1
+/* arg0: number of parameters */
+#define PTA_EVTRACE_ID_COPY_IN_PARAMS_ENTER	2
+/* arg0: TEE_Result */
+#define PTA_EVTRACE_ID_COPY_IN_PARAMS_EXIT	3
+/* arg0: parameter types */
+#define PTA_EVTRACE_ID_VM_MAP_PARAM_ENTER	4
+/* arg0: TEE_Result */
+#define PTA_EVTRACE_ID_VM_MAP_PARAM_EXIT	5
+/* arg0: RPC command, arg1: number of parameters */
+#define PTA_EVTRACE_ID_RPC_ENTER		6
+/* arg0: RPC command, arg1: returned value */
+#define PTA_EVTRACE_ID_RPC_EXIT			7
+/* arg0: syscall number */
+#define PTA_EVTRACE_ID_SYSCALL_ENTER		8
+/* arg0: syscall number, arg1: returned value */
+#define PTA_EVTRACE_ID_SYSCALL_EXIT		9
+/* arg0: faulting virtual address */
+#define PTA_EVTRACE_ID_PAGER_FAULT_ENTER	10
+/* arg0: faulting virtual address, arg1: 1 if handled, 0 if not */
+#define PTA_EVTRACE_ID_PAGER_FAULT_EXIT		11
+#define PTA_EVTRACE_ID_COUNT			12
+
+#define PTA_EVTRACE_MASK_ALL		GENMASK_32(PTA_EVTRACE_ID_COUNT - 1, 0)
+
+/* Value of @thread_id when the event is recorded outside a thread */
+#define PTA_EVTRACE_NO_THREAD		0xffff
+
+/*
+ * struct pta_evtrace_entry - A recorded event
+ * @timestamp:	Value of the system counter when the event was recorded
+ * @arg0:	First event argument
+ * @arg1:	Second event argument
+ * @id:		One of PTA_EVTRACE_ID_*
+ * @thread_id:	Thread ID or PTA_EVTRACE_NO_THREAD
+ * @cpu:	CPU which recorded the event
+ * @reserved:	Zero
+ */
+struct pta_evtrace_entry {
+	uint64_t timestamp;
+	uint64_t arg0;
+	uint64_t arg1;
+	uint16_t id;
+	uint16_t thread_id;
+	uint16_t cpu;
+	uint16_t reserved;
+};
+
+/*
+ * PTA_EVTRACE_CMD_GET_INFO - Get tracer properties
+ *
+ * [out]    value[0].a: Number of per-CPU ring buffers
+ * [out]    value[0].b: Number of entries in each ring buffer
+ * [out]    value[1].a: Frequency of the system counter in Hz
+ * [out]    value[1].b: Current mask of enabled tracepoints
+ *
+ * Return codes:
+ * TEE_SUCCESS - Invoke command success
+ * TEE_ERROR_BAD_PARAMETERS - Incorrect input param
+ */
+#define PTA_EVTRACE_CMD_GET_INFO	0
+
+/*
+ * PTA_EVTRACE_CMD_SET_MASK - Enable or disable tracepoints
+ *
+ * [in]     value[0].a: Mask of BIT(PTA_EVTRACE_ID_*) to enable, 0 stops
+ *			tracing
+ * [in]     value[0].b: If non-zero, discard all buffered events
+ *
+ * Return codes:
+ * TEE_SUCCESS - Invoke command success
+ * TEE_ERROR_BAD_PARAMETERS - Incorrect input param
+ */
+#define PTA_EVTRACE_CMD_SET_MASK	1
+
+/*
+ * PTA_EVTRACE_CMD_DRAIN - Move a batch of recorded events of one CPU into
+ * a normal world buffer
+ *
+ * [in]     value[0].a: CPU index
+ * [out]    memref[1]: Array of struct pta_evtrace_entry, oldest first.
+ *		       The size is updated to the number of bytes written.
+ * [out]    value[2].a: Number of events still buffered for this CPU
+ * [out]    value[2].b: Number of events dropped by this CPU since boot
+ *
+ * Return codes:
+ * TEE_SUCCESS - Invoke command success
+ * TEE_ERROR_BAD_PARAMETERS - Incorrect input param
+ */
+#define PTA_EVTRACE_CMD_DRAIN		2
+
+#endif /* __PTA_EVTRACE_H */
@@ -108,6 +108,88 @@
  */
 #define PTA_INVOKE_TESTS_CMD_DT_DRIVER_TESTS	11
 
+/*
+ * Asynchronous crypto jobs performance test, the input buffer is
+ * encrypted with AES-128-ECB by jobs run through the drvcrypt
+ * asynchronous job interface
+ *
+ * [in]     value[0].a	Unit size, bytes handled by each job, multiple of 16
+ * [in]     value[0].b	Maximum number of jobs submitted at once
+ * [in]     memref[1]	In buffer, size multiple of 16
+ * [out]    memref[2]	Out buffer
+ * [out]    value[3].a	Elapsed time in milliseconds
+ * [out]    value[3].b	Number of times the engine queue was full
+ */
+#define PTA_INVOKE_TESTS_CMD_CRYPTO_ASYNC_PERF	12
+
+/*
+ * REE FS throughput test, the input buffer is written to a persistent
+ * object in chunks, then read back in chunks of the same size. Chunks
+ * covering whole 4 KiB blocks are encrypted and decrypted directly
+ * between the buffers and the RPC buffer.
+ *
+ * Invoked by a TA, the buffers are TA memory and are passed to the REE FS
+ * as TA buffers like the storage syscalls do, exercising the user access
+ * path. Invoked from normal world they are passed as core buffers.
+ *
+ * [in]     value[0].a	Chunk size in bytes
+ * [in]     memref[1]	Data to write
+ * [out]    memref[2]	Data read back
+ * [out]    value[3].a	Write time in milliseconds
+ * [out]    value[3].b	Read time in milliseconds
+ */
+#define PTA_INVOKE_TESTS_CMD_FS_PERF		13
+
+/*
+ * SCMI SMT transport test, a local agent posts batches of messages to the
+ * SCMI server through a channel in secure memory, first with an entry per
+ * message then with an entry per batch through a ring of SMT buffers
+ *
+ * [in]     value[0].a	SCMI channel ID the messages are processed for
+ * [in]     value[0].b	Number of messages per batch, at most 64
+ * [in]     value[1].a	Number of batches
+ * [out]    value[2].a	Time in microseconds with an entry per message
+ * [out]    value[2].b	Time in microseconds with an entry per batch
+ */
+#define PTA_INVOKE_TESTS_CMD_SCMI_PERF		14
+
+/*
+ * Timer wheel tests, one-shot and periodic timers are started and stopped
+ * and their expiries checked. No parameters.
+ */
+#define PTA_INVOKE_TESTS_CMD_TIMER_WHEEL	15
+
+/*
+ * Deferred work tests, a work item is queued and cancelled and its runs
+ * checked. Needs the asynchronous notifications. No parameters.
+ */
+#define PTA_INVOKE_TESTS_CMD_DEFERRED_WORK	16
+
+/*
+ * parallel_for() tests, all items must run once and the error of the
+ * lowest failing item must be returned. No parameters.
+ */
+#define PTA_INVOKE_TESTS_CMD_PARALLEL		17
+
+/*
+ * REE FS transaction tests, a transaction is committed, one is aborted and
+ * one is aborted as when the invocation of its owner returns. No
+ * parameters.
+ */
+#define PTA_INVOKE_TESTS_CMD_FS_TX		18
+
+/*
+ * Socket loopback tests, the socket pseudo TA is called on behalf of the
+ * calling TA with a UDP socket served by CFG_SOCKET_LOOPBACK. Buffers are
+ * sent and received with PTA_SOCKET_SENDV and PTA_SOCKET_RECVV, also into
+ * buffers too short for the datagram. Datagrams are then sent and
+ * received with PTA_SOCKET_POLL and PTA_SOCKET_RECV_BATCH. Must be
+ * invoked by a TA.
+ *
+ * [in/out] memref[0]	Scratch buffer of the TA, at least 256 bytes
+ */
+#define PTA_INVOKE_TESTS_CMD_SOCKET_LOOPBACK	19
+
 /*
  * Tests Mailbox  *
  * [in]  value[0].a	Test function PTA_MBOX_TEST_*
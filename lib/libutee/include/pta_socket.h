@@ -6,6 +6,11 @@
 #ifndef __PTA_SOCKET
 #define __PTA_SOCKET
 
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <util.h>
+
 #define PTA_SOCKET_UUID { 0x3b996a7d, 0x2c2b, 0x4a49, { \
 			  0xa8, 0x96, 0xe1, 0xfb, 0x57, 0x66, 0xd2, 0xf4 } }
 
@@ -48,4 +53,95 @@
  */
 #define PTA_SOCKET_IOCTL	5
 
+/* Maximum number of buffers of PTA_SOCKET_SENDV and PTA_SOCKET_RECVV */
+#define PTA_SOCKET_IOV_MAX	16
+
+struct pta_socket_iov {
+	uint64_t buf;
+	uint64_t len;
+};
+
+/*
+ * [in]		value[0].a	socket handle
+ * [in]		value[0].b	timeout ms or TEE_TIMEOUT_INFINITE
+ * [in]		memref[1]	array of struct pta_socket_iov, buffers to
+ *				transmit in order
+ * [out]	value[2].a	number of transmitted bytes
+ */
+#define PTA_SOCKET_SENDV	6
+
+/*
+ * [in]		value[0].a	socket handle
+ * [in]		value[0].b	timeout ms or TEE_TIMEOUT_INFINITE
+ * [in]		memref[1]	array of struct pta_socket_iov, buffers to
+ *				fill in order
+ * [out]	value[2].a	number of received bytes
+ */
+#define PTA_SOCKET_RECVV	7
+
+/* Maximum number of entries of PTA_SOCKET_POLL */
+#define PTA_SOCKET_POLL_MAX	64
+
+#define PTA_SOCKET_POLL_IN	BIT32(0)
+#define PTA_SOCKET_POLL_OUT	BIT32(1)
+#define PTA_SOCKET_POLL_ERR	BIT32(2)
+#define PTA_SOCKET_POLL_HUP	BIT32(3)
+
+struct pta_socket_pollfd {
+	uint32_t handle;
+	uint32_t events;	/* PTA_SOCKET_POLL_* to wait for */
+	uint32_t revents;	/* PTA_SOCKET_POLL_* that occurred */
+};
+
+/*
+ * [in/out]	memref[0]	array of struct pta_socket_pollfd
+ * [in]		value[1].a	timeout ms or TEE_TIMEOUT_INFINITE
+ * [out]	value[1].b	number of entries with events
+ */
+#define PTA_SOCKET_POLL		8
+
+/*
+ * Receives the first datagram as PTA_SOCKET_RECV and then the datagrams
+ * already received until @memref[1] or the maximum number of datagrams is
+ * full. Each datagram is stored as a 32-bit length followed by the data,
+ * padded to a multiple of 4 bytes.
+ *
+ * [in]		value[0].a	socket handle
+ * [in]		value[0].b	timeout ms or TEE_TIMEOUT_INFINITE
+ * [out]	memref[1]	buffer
+ * [in/out]	value[2].a	maximum number of datagrams [in], number of
+ *				received datagrams [out]
+ */
+#define PTA_SOCKET_RECV_BATCH	9
+
+/*
+ * Reads the datagram at *@offs of the @length bytes of @buf filled by
+ * PTA_SOCKET_RECV_BATCH and moves *@offs to the next one. Returns false
+ * when there's no datagram left.
+ */
+static inline bool pta_socket_batch_next(const void *buf, uint32_t length,
+					 uint32_t *offs, const void **data,
+					 uint32_t *data_len)
+{
+	const uint8_t *b = buf;
+	uint32_t next = 0;
+	uint32_t l = 0;
+
+	if (*offs >= length || length - *offs < sizeof(l))
+		return false;
+
+	memcpy(&l, b + *offs, sizeof(l));
+	if (l > length - *offs - sizeof(l))
+		return false;
+
+	*data = b + *offs + sizeof(l);
+	*data_len = l;
+	if (ADD_OVERFLOW(*offs + sizeof(l), l, &next) ||
+	    ROUNDUP_OVERFLOW(next, sizeof(l), &next))
+		next = length;
+	*offs = next;
+
+	return true;
+}
+
 #endif /*__PTA_SOCKET*/
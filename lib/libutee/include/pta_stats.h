@@ -38,6 +38,7 @@
 #define ALLOC_ID_PUBLIC_DDR	2	/* Public DDR allocator (deprecated) */
 #define ALLOC_ID_TA_RAM		3	/* TA_RAM allocator */
 #define ALLOC_ID_NEXUS_HEAP	4	/* Nexus heap allocator */
+#define ALLOC_ID_SLAB		5	/* Slab object caches */
 #define STATS_NB_POOLS		5
 
 #define TEE_ALLOCATOR_DESC_LENGTH 32
@@ -69,6 +70,8 @@ struct pta_stats_ta {
 	uint32_t panicked;	/* True if TA has panicked */
 	uint32_t sess_num;	/* Number of opened session */
 	struct pta_stats_alloc heap;
+	uint32_t pool_hits;	/* Sessions opened on a preloaded instance */
+	uint32_t pool_misses;	/* Sessions which had to load an instance */
 };
 
 /*
@@ -91,4 +94,57 @@ struct pta_stats_ta {
 #define STATS_DRIVER_TYPE_CLOCK		0
 #define STATS_DRIVER_TYPE_REGULATOR	1
 
+/*
+ * STATS_CMD_ITR_STATS - Get statistics on interrupt handlers
+ *
+ * [out]    memref[0]        Array of struct pta_stats_itr per handler
+ */
+#define STATS_CMD_ITR_STATS		6
+
+#define STATS_ITR_CHIP_NAME_LENGTH	16
+
+struct pta_stats_itr {
+	char chip_name[STATS_ITR_CHIP_NAME_LENGTH];
+	uint32_t itr_num;	/* Interrupt number */
+	uint32_t flags;		/* ITRF_* flags of the handler */
+	uint32_t max_us;	/* Longest call of the handler */
+	uint32_t reserved;
+	uint64_t count;		/* Number of calls of the handler */
+	uint64_t total_us;	/* Time spent in the handler */
+};
+
+/*
+ * STATS_CMD_WORK_STATS - Get statistics on deferred work items
+ *
+ * [out]    memref[0]        Array of struct pta_stats_work per work item
+ */
+#define STATS_CMD_WORK_STATS		7
+
+#define STATS_WORK_NAME_LENGTH		16
+
+struct pta_stats_work {
+	char name[STATS_WORK_NAME_LENGTH];
+	uint32_t max_us;	/* Longest run of the work */
+	uint32_t max_latency_us; /* Longest wait from queuing to running */
+	uint64_t count;		/* Number of runs of the work */
+	uint64_t total_us;	/* Time spent running the work */
+};
+
+/*
+ * STATS_CMD_SCMI_PERF_STATS - Get statistics on SCMI performance domains
+ *
+ * [out]    memref[0]        Array of struct pta_stats_scmi_perf per domain
+ */
+#define STATS_CMD_SCMI_PERF_STATS	8
+
+struct pta_stats_scmi_perf {
+	uint32_t channel_id;	/* SCMI channel ID */
+	uint32_t domain_id;	/* SCMI performance domain ID */
+	uint32_t level;		/* Current level, 0 if unknown */
+	uint32_t max_us;	/* Longest level transition */
+	uint64_t set_count;	/* Number of level transitions */
+	uint64_t skip_count;	/* Number of requests for the current level */
+	uint64_t total_us;	/* Time spent in level transitions */
+};
+
 #endif /*__PTA_STATS_H*/
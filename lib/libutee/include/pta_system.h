@@ -201,4 +201,21 @@
  */
 #define PTA_SYSTEM_SUPP_PLUGIN_INVOKE	13
 
+/*
+ * Grant memory to a session opened by the caller
+ *
+ * The memory must have been mapped with PTA_SYSTEM_MAP_FLAG_SHAREABLE. It's
+ * mapped into the TA of the session until the session is closed, memory
+ * references inside it are then passed to the session without mapping.
+ * The TA of the session must not have TA_FLAG_MULTI_SESSION, its other
+ * sessions would see the memory too.
+ *
+ * [in]     value[0].a: Session identifier
+ * [in]     value[0].b: Flags, 0 or PTA_SYSTEM_MAP_FLAG_WRITEABLE
+ * [in]     value[1].a: Address upper 32-bits
+ * [in]     value[1].b: Address lower 32-bits
+ * [in]     value[2].a: Number of bytes
+ */
+#define PTA_SYSTEM_GRANT_SHM		14
+
 #endif /* __PTA_SYSTEM_H */
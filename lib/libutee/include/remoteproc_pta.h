@@ -217,4 +217,18 @@ static inline size_t rproc_pta_keyinfo_size(struct rproc_pta_key_info *keyinf)
  */
 #define PTA_REMOTEPROC_RELEASE_MEM	12
 
+/*
+ * Get the time spent loading the firmware segments.
+ *
+ * Time spent by PTA_RPROC_LOAD_SEGMENT in each step since the last
+ * PTA_REMOTEPROC_GET_MEM, in microseconds. The segments are copied, hashed
+ * and decrypted chunk by chunk in a single pass.
+ *
+ * [in]  params[0].value.a:	Unique 32bit remote processor identifier
+ * [out] params[1].value.a:	Time spent copying the segments
+ * [out] params[1].value.b:	Time spent hashing the segments
+ * [out] params[2].value.a:	Time spent decrypting the segments
+ */
+#define PTA_REMOTEPROC_GET_LOAD_STATS	13
+
 #endif /* __REMOTEPROC_PTA_H */
@@ -12,6 +12,7 @@
 #include <stdio.h>
 #include <tee_api_defines_extensions.h>
 #include <tee_api_types.h>
+#include <utee_types.h>
 
 void tee_user_mem_mark_heap(void);
 size_t tee_user_mem_check_heap(void);
@@ -56,6 +57,26 @@ void *tee_map_zi(size_t len, uint32_t flags);
  */
 TEE_Result tee_unmap(void *buf, size_t len);
 
+/*
+ * tee_grant_shm() - Grant memory to a TA session
+ * @session:	Session opened with TEE_OpenTASession()
+ * @buf:	Buffer returned by tee_map_zi() with TEE_MEMORY_ACCESS_ANY_OWNER
+ * @len:	Number of bytes
+ * @flags:	TEE_MEMORY_ACCESS_READ, optionally with TEE_MEMORY_ACCESS_WRITE
+ *		to let the TA of @session write to the memory
+ *
+ * The pages of @buf are mapped into the TA of @session until the session
+ * is closed. Memory references inside them are then passed to
+ * TEE_InvokeTACommand() without mapping them for each call. The memory
+ * can't be unmapped by the TA of @session.
+ *
+ * Return TEE_SUCCESS on success, TEE_ERROR_NOT_SUPPORTED if the TA of
+ * @session is multi-session as its other sessions would see the memory,
+ * or another TEE_ERRROR_* on failure.
+ */
+TEE_Result tee_grant_shm(TEE_TASessionHandle session, void *buf, size_t len,
+			 uint32_t flags);
+
 /*
  * Convert a UUID string @s into a TEE_UUID @uuid
  * Expected format for @s is: xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx
@@ -63,6 +84,106 @@ TEE_Result tee_unmap(void *buf, size_t len);
  */
 TEE_Result tee_uuid_from_str(TEE_UUID *uuid, const char *s);
 
+/*
+ * tee_get_next_persistent_objects() - get a batch of enumerated objects
+ * @enumerator:	started enumerator
+ * @entries:	receives the object ID and data size of each object
+ * @count:	number of entries in @entries [in], number of entries
+ *		returned [out]
+ *
+ * Same as calling TEE_GetNextPersistentObject() up to @count times with a
+ * single system call. Returns TEE_ERROR_ITEM_NOT_FOUND when no object is
+ * left. If an error occurs for an object, @count holds the number of
+ * entries returned before it and the enumeration continues after it.
+ */
+TEE_Result
+tee_get_next_persistent_objects(TEE_ObjectEnumHandle enumerator,
+				struct utee_object_enum_entry *entries,
+				size_t *count);
+
+/*
+ * tee_begin_persistent_object_transaction() - begin a storage transaction
+ * @storageID:	storage of the transaction
+ *
+ * The persistent objects created, written, truncated, renamed and deleted
+ * by the session in @storageID are staged until
+ * tee_commit_persistent_object_transaction() commits all of them
+ * atomically, or tee_abort_persistent_object_transaction() drops them. A
+ * transaction not committed when the entry point of the TA that began it
+ * returns is aborted. Meanwhile updates of @storageID by other sessions,
+ * and transactions they begin, wait for the transaction to end while
+ * their lookups see the objects as before the transaction. A session
+ * called by the owner of the transaction can't wait for it, its updates
+ * fail with TEE_ERROR_STORAGE_NOT_AVAILABLE. An object closed after having
+ * been modified can't be modified again in the same transaction,
+ * TEE_ERROR_BAD_STATE is returned.
+ *
+ * Returns TEE_ERROR_NOT_SUPPORTED if @storageID has no transactions,
+ * TEE_ERROR_BAD_STATE if the session already has a transaction in
+ * @storageID, TEE_ERROR_BUSY if a session calling this one has one.
+ */
+TEE_Result tee_begin_persistent_object_transaction(uint32_t storageID);
+
+/*
+ * tee_commit_persistent_object_transaction() - commit a storage transaction
+ * @storageID:	storage of the transaction
+ *
+ * If the transaction had an error or its commit fails, it is aborted and
+ * the error returned.
+ */
+TEE_Result tee_commit_persistent_object_transaction(uint32_t storageID);
+
+/*
+ * tee_abort_persistent_object_transaction() - abort a storage transaction
+ * @storageID:	storage of the transaction
+ *
+ * Drops the staged changes. The objects modified in the transaction and
+ * still open return to their previous content, but the handles should be
+ * closed as their data size and position aren't updated.
+ *
+ * Returns TEE_ERROR_NOT_SUPPORTED if @storageID has no transactions, for
+ * instance TEE_STORAGE_PRIVATE_RPMB.
+ */
+TEE_Result tee_abort_persistent_object_transaction(uint32_t storageID);
+
+/*
+ * Mutex and condition variable for TAs with TA_FLAG_CONCURRENT, where
+ * several invocations of the TA may run at the same time. A thread waiting
+ * for a mutex or a condition variable sleeps in the TEE core. Both are
+ * valid when zero initialized.
+ */
+struct tee_mutex {
+	uint32_t state;
+};
+
+struct tee_condvar {
+	uint32_t seq;
+};
+
+#define TEE_MUTEX_INITIALIZER	{ .state = 0 }
+#define TEE_CONDVAR_INITIALIZER	{ .seq = 0 }
+
+void tee_mutex_lock(struct tee_mutex *mutex);
+/* Returns TEE_ERROR_BUSY if @mutex is locked */
+TEE_Result tee_mutex_trylock(struct tee_mutex *mutex);
+void tee_mutex_unlock(struct tee_mutex *mutex);
+
+/*
+ * tee_condvar_wait() - wait for a condition variable
+ * @cv:		condition variable
+ * @mutex:	locked mutex, unlocked while waiting and locked again
+ *		before returning
+ *
+ * As usual the condition should be checked again after returning as
+ * tee_condvar_wait() may return without a matching signal.
+ *
+ * Returns TEE_ERROR_CANCEL if the operation was cancelled, as TEE_Wait()
+ * does, or TEE_SUCCESS. tee_mutex_lock() isn't cancellable.
+ */
+TEE_Result tee_condvar_wait(struct tee_condvar *cv, struct tee_mutex *mutex);
+void tee_condvar_signal(struct tee_condvar *cv);
+void tee_condvar_broadcast(struct tee_condvar *cv);
+
 /*
  * tee_invoke_supp_plugin() - invoke a tee-supplicant's plugin
  * @uuid:       uuid of the plugin
@@ -0,0 +1,114 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#ifndef __TEE_ISOCKET_EXTENSIONS_H
+#define __TEE_ISOCKET_EXTENSIONS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <tee_api_types.h>
+#include <tee_isocket.h>
+#include <util.h>
+
+/*
+ * Extensions of the sockets opened with TEE_tcpSocket or TEE_udpSocket,
+ * each function is a single request to the normal world.
+ */
+
+/* Maximum number of buffers of tee_isocket_sendv() and tee_isocket_recvv() */
+#define TEE_ISOCKET_IOV_MAX	16
+
+struct tee_isocket_iov {
+	void *buf;
+	uint32_t len;
+};
+
+/*
+ * tee_isocket_sendv() - send several buffers
+ * @ctx:	socket
+ * @iov:	buffers to send in order
+ * @iov_count:	number of entries in @iov
+ * @length:	number of bytes sent
+ * @timeout:	as for TEE_iSocket::send()
+ *
+ * The buffers are sent as one buffer would, a UDP socket sends a single
+ * datagram.
+ */
+TEE_Result tee_isocket_sendv(TEE_iSocketHandle ctx,
+			     const struct tee_isocket_iov *iov,
+			     uint32_t iov_count, uint32_t *length,
+			     uint32_t timeout);
+
+/*
+ * tee_isocket_recvv() - receive into several buffers
+ * @ctx:	socket
+ * @iov:	buffers to fill in order
+ * @iov_count:	number of entries in @iov
+ * @length:	number of bytes received, may be larger than the total
+ *		length of @iov if a datagram was truncated
+ * @timeout:	as for TEE_iSocket::recv()
+ */
+TEE_Result tee_isocket_recvv(TEE_iSocketHandle ctx,
+			     const struct tee_isocket_iov *iov,
+			     uint32_t iov_count, uint32_t *length,
+			     uint32_t timeout);
+
+/* Maximum number of sockets of tee_isocket_poll() */
+#define TEE_ISOCKET_POLL_MAX	64
+
+#define TEE_ISOCKET_POLL_IN	BIT32(0)	/* Data can be received */
+#define TEE_ISOCKET_POLL_OUT	BIT32(1)	/* Data can be sent */
+#define TEE_ISOCKET_POLL_ERR	BIT32(2)	/* Error, always reported */
+#define TEE_ISOCKET_POLL_HUP	BIT32(3)	/* Hang up, always reported */
+
+struct tee_isocket_pollfd {
+	TEE_iSocketHandle ctx;
+	uint32_t events;	/* TEE_ISOCKET_POLL_* to wait for */
+	uint32_t revents;	/* TEE_ISOCKET_POLL_* that occurred */
+};
+
+/*
+ * tee_isocket_poll() - wait for events on several sockets
+ * @fds:	sockets and events
+ * @count:	number of entries in @fds
+ * @timeout:	timeout in milliseconds, TEE_TIMEOUT_INFINITE or 0 to
+ *		return immediately
+ * @ready:	number of entries in @fds with events
+ *
+ * Returns TEE_SUCCESS with *@ready 0 if the timeout expired.
+ */
+TEE_Result tee_isocket_poll(struct tee_isocket_pollfd *fds, uint32_t count,
+			    uint32_t timeout, uint32_t *ready);
+
+/*
+ * tee_udpsocket_recv_batch() - receive several datagrams
+ * @ctx:	socket
+ * @buf:	buffer receiving the datagrams
+ * @length:	length of @buf [in], number of bytes used [out]
+ * @count:	maximum number of datagrams [in], number received [out]
+ * @timeout:	timeout for the first datagram as for TEE_iSocket::recv()
+ *
+ * The datagrams already received after the first one are added without
+ * waiting. Use tee_udpsocket_batch_next() to read them from @buf.
+ */
+TEE_Result tee_udpsocket_recv_batch(TEE_iSocketHandle ctx, void *buf,
+				    uint32_t *length, uint32_t *count,
+				    uint32_t timeout);
+
+/*
+ * tee_udpsocket_batch_next() - read a datagram of tee_udpsocket_recv_batch()
+ * @buf:	buffer passed to tee_udpsocket_recv_batch()
+ * @length:	length returned by tee_udpsocket_recv_batch()
+ * @offs:	offset of the datagram, 0 for the first, updated to the next
+ * @data:	datagram
+ * @data_len:	length of @data
+ *
+ * Returns false when there's no datagram left.
+ */
+bool tee_udpsocket_batch_next(const void *buf, uint32_t length,
+			      uint32_t *offs, const void **data,
+			      uint32_t *data_len);
+
+#endif /*__TEE_ISOCKET_EXTENSIONS_H*/
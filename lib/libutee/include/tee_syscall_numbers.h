@@ -79,8 +79,14 @@
 #define TEE_SCN_SE_CHANNEL_CLOSE__DEPRECATED		69
 /* End of deprecated Secure Element API syscalls */
 #define TEE_SCN_CACHE_OPERATION			70
+#define TEE_SCN_STORAGE_ENUM_NEXT_BATCH		71
+#define TEE_SCN_STORAGE_TX_BEGIN		72
+#define TEE_SCN_STORAGE_TX_COMMIT		73
+#define TEE_SCN_STORAGE_TX_ABORT		74
+#define TEE_SCN_FUTEX_WAIT			75
+#define TEE_SCN_FUTEX_WAKE			76
 
-#define TEE_SCN_MAX				70
+#define TEE_SCN_MAX				76
 
 /* Maximum number of allowed arguments for a syscall */
 #define TEE_SVC_MAX_ARGS			8
@@ -20,7 +20,7 @@
 #define TA_FLAG_CACHE_MAINTENANCE	BIT32(7) /* use cache flush syscall */
 	/*
 	 * TA instance can execute multiple sessions concurrently
-	 * (pseudo-TAs only).
+	 * (pseudo-TAs, and user TAs with CFG_TA_CONCURRENT=y).
 	 */
 #define TA_FLAG_CONCURRENT		BIT32(8)
 	/*
@@ -60,20 +60,81 @@ struct __ftrace_info {
 	union compat_ptr ret_ptr;
 };
 
+/* Trace all but the functions in the filter instead of only those */
+#define FTRACE_FILTER_EXCLUDE	0x1
+/* Keep per-function call counts and cumulative time instead of a trace */
+#define FTRACE_AGGREGATE	0x2
+
+/*
+ * Optional ftrace configuration of a TA, defined with FTRACE_FILTER() and
+ * picked up by ldelf when the TA is loaded
+ */
+struct __ftrace_filter {
+	uint32_t flags;		/* FTRACE_FILTER_EXCLUDE, FTRACE_AGGREGATE */
+	uint32_t num_funcs;
+	union compat_ptr funcs;	/* Array of @num_funcs function pointers */
+};
+
+#ifdef __ILP32__
+#define __FTRACE_COMPAT_PTR(p)	{ .ptr32 = { .lo = (uint32_t)(p) } }
+#else
+#define __FTRACE_COMPAT_PTR(p)	{ .ptr64 = (uint64_t)(p) }
+#endif
+
+/*
+ * FTRACE_FILTER() - Configure function tracing of the TA
+ * @_flags:	Bitwise OR of FTRACE_FILTER_EXCLUDE and FTRACE_AGGREGATE
+ * @...:	Functions to trace, or not to trace with FTRACE_FILTER_EXCLUDE.
+ *		All functions are traced if none is given.
+ *
+ * To be used once at file scope in a TA source file, for instance:
+ * FTRACE_FILTER(FTRACE_AGGREGATE, TA_InvokeCommandEntryPoint, do_sign);
+ *
+ * ldelf takes the extent of the functions of the main TA from its symbol
+ * table. Other functions are only matched if _mcount is called within
+ * their first 32 bytes.
+ */
+#define FTRACE_FILTER(_flags, ...) \
+	static const void *const __ftrace_filter_funcs[] = { __VA_ARGS__ }; \
+	const struct __ftrace_filter __ftrace_filter = { \
+		.flags = (_flags), \
+		.num_funcs = sizeof(__ftrace_filter_funcs) / \
+			     sizeof(__ftrace_filter_funcs[0]), \
+		.funcs = __FTRACE_COMPAT_PTR(__ftrace_filter_funcs), \
+	}
+
+/* Function of the filter, stored sorted by address in the ftrace buffer */
+struct ftrace_filter_func {
+	uint64_t start;
+	uint64_t end;		/* First address past the function */
+};
+
+/* Entry of the table recorded in place of the trace with FTRACE_AGGREGATE */
+struct ftrace_func_stat {
+	uint64_t pc;		/* Address in the function, 0 if unused */
+	uint64_t calls;		/* Number of calls */
+	uint64_t total_ns;	/* Cumulative time spent in the function */
+};
+
 struct ftrace_buf {
 	uint64_t ret_func_ptr;	/* __ftrace_return pointer */
 	uint64_t ret_stack[FTRACE_RETFUNC_DEPTH]; /* Return stack */
 	uint32_t ret_idx;	/* Return stack index */
 	uint32_t lr_idx;	/* lr index used for stack unwinding */
 	uint64_t begin_time[FTRACE_RETFUNC_DEPTH]; /* Timestamp */
+	uint32_t ret_slot[FTRACE_RETFUNC_DEPTH]; /* Aggregated mode entry */
 	uint64_t suspend_time;	/* Suspend timestamp */
-	uint32_t curr_idx;	/* Current entry in the (circular) buffer */
+	uint64_t last_pc;	/* Last traced function, for delta encoding */
+	uint32_t curr_idx;	/* Bytes used, or entries in aggregated mode */
 	uint32_t max_size;	/* Max allowed size of ftrace buffer */
 	uint32_t head_off;	/* Ftrace buffer header offset */
 	uint32_t buf_off;	/* Ftrace buffer offset */
+	uint32_t filter_off;	/* Offset of the sorted filter functions */
+	uint32_t filter_num;	/* Number of filter functions */
+	uint32_t flags;		/* FTRACE_FILTER_EXCLUDE, FTRACE_AGGREGATE */
 	bool syscall_trace_enabled; /* Some syscalls are never traced */
 	bool syscall_trace_suspended; /* By foreign interrupt or RPC */
-	bool overflow;		/* Circular buffer has wrapped */
+	bool overflow;		/* Buffer full, later records are dropped */
 };
 
 /* Defined by the linker script */
@@ -145,7 +206,10 @@ extern const size_t ta_num_props;
 
 extern uint8_t __ta_no_share_heap[];
 extern const size_t __ta_no_share_heap_size;
-/* Needed by TEE_CheckMemoryAccessRights() */
+/*
+ * Needed by TEE_CheckMemoryAccessRights(), concurrent invocations of a TA
+ * with TA_FLAG_CONCURRENT keep their parameters in struct utee_thread
+ */
 extern uint32_t ta_param_types;
 extern TEE_Param ta_params[TEE_NUM_PARAMS];
 extern struct malloc_ctx *__ta_no_share_malloc_ctx;
@@ -203,6 +203,33 @@ TEE_Result _utee_storage_next_enum(unsigned long obj_enum,
 				   struct utee_object_info *info,
 				   void *obj_id, uint64_t *len);
 
+/*
+ * obj_enum is of type TEE_ObjectEnumHandle
+ * count is in: number of entries in the entries array, out: number of
+ * entries returned
+ */
+TEE_Result _utee_storage_next_enum_batch(unsigned long obj_enum,
+					 struct utee_object_enum_entry *entries,
+					 uint64_t *count);
+
+TEE_Result _utee_storage_tx_begin(unsigned long storage_id);
+
+TEE_Result _utee_storage_tx_commit(unsigned long storage_id);
+
+TEE_Result _utee_storage_tx_abort(unsigned long storage_id);
+
+/*
+ * Waits until woken by _utee_futex_wake() if *uaddr == val, only supported
+ * by TAs with TA_FLAG_CONCURRENT. With UTEE_FUTEX_WAIT_CANCELLABLE in
+ * flags TEE_ERROR_CANCEL is returned once the session is cancelled, as
+ * with _utee_wait().
+ */
+TEE_Result _utee_futex_wait(uint32_t *uaddr, unsigned long val,
+			    unsigned long flags);
+
+/* Wakes up to count threads waiting on uaddr */
+TEE_Result _utee_futex_wake(uint32_t *uaddr, unsigned long count);
+
 /* Data Stream Access Functions */
 /* obj is of type TEE_ObjectHandle */
 TEE_Result _utee_storage_obj_read(unsigned long obj, void *data, size_t len,
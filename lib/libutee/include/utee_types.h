@@ -67,4 +67,14 @@ struct utee_object_info {
 	uint32_t handle_flags;
 };
 
+/* Flags of _utee_futex_wait() */
+#define UTEE_FUTEX_WAIT_CANCELLABLE	0x00000001
+
+/* Entry returned by _utee_storage_next_enum_batch() */
+struct utee_object_enum_entry {
+	uint8_t obj_id[TEE_OBJECT_ID_MAX_LEN];
+	uint32_t obj_id_len;
+	uint32_t data_size;
+};
+
 #endif /* UTEE_TYPES_H */
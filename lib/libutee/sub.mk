@@ -10,6 +10,7 @@ srcs-y += base64.c
 srcs-y += tee_api.c
 srcs-y += tee_api_arith_mpi.c
 cppflags-tee_api_arith_mpi.c-y += -DMBEDTLS_ALLOW_PRIVATE_ACCESS
+srcs-$(CFG_TA_CONCURRENT) += tee_api_mutex.c
 srcs-y += tee_api_objects.c
 srcs-y += tee_api_operations.c
 srcs-y += tee_api_panic.c
@@ -5,13 +5,17 @@
 /*
  * Support for Thread-Local Storage (TLS) ABIs for ARMv7/Aarch32 and Aarch64.
  *
- * TAs are currently single-threaded, so the only benefit of implementing these
+ * TAs are usually single-threaded, so the main benefit of implementing these
  * ABIs is to support toolchains that need them even when the target program is
  * single-threaded. Such as, the g++ compiler from the GCC toolchain targeting a
  * "Posix thread" Linux runtime, which OP-TEE has been using for quite some time
  * (arm-linux-gnueabihf-* and aarch64-linux-gnu-*). This allows building C++ TAs
  * without having to build a specific toolchain with --disable-threads.
  *
+ * With CFG_TA_CONCURRENT, each invocation of a TA with TA_FLAG_CONCURRENT is
+ * a thread with its own TCB, allocated when the invocation is entered and
+ * pointed to by the thread pointer register (TPIDR_EL0 or TPIDRURW).
+ *
  * This implementation is based on [1].
  *
  *  - "TLS data structures variant 1" (section 3): the AArch64 compiler uses the
@@ -32,12 +36,13 @@
  *     https://www.akkadia.org/drepper/tls.pdf
  */
 
-#include <arm64_user_sysreg.h>
+#include <arm_user_sysreg.h>
 #include <assert.h>
 #include <link.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/queue.h>
+#include "tee_api_private.h"
 #include "user_ta_header.h"
 
 /* DTV - Dynamic Thread Vector
@@ -58,7 +63,10 @@ union dtv {
 
 /* Thread Control Block */
 struct tcb_head {
-	/* Two words are reserved as per the "TLS variant 1" ABI */
+	/*
+	 * Two words are reserved as per the "TLS variant 1" ABI, the second
+	 * one points to the struct utee_thread of a concurrent TA invocation.
+	 */
 	union dtv *dtv;
 	unsigned long reserved;
 	/*
@@ -69,30 +77,60 @@ struct tcb_head {
 	uint8_t tls[];
 };
 
-/*
- * Since TAs are single threaded, only one TCB is needed. This would need to
- * change if multi-threading is introduced.
- */
+/* The TCB of a TA without TA_FLAG_CONCURRENT */
 static struct tcb_head *_tcb;
 static size_t _tls_size;
 
-#define TCB_SIZE(tls_size) (sizeof(*_tcb) + (tls_size))
+#define TCB_SIZE(tls_size) (sizeof(struct tcb_head) + (tls_size))
 
-/*
- * Initialize or update the TCB.
- * Called on application initialization and when additional shared objects are
- * loaded via dlopen().
- */
-void __utee_tcb_init(void)
+#ifdef CFG_TA_CONCURRENT
+/* From user_ta_header.c, built within TA */
+extern struct ta_head ta_head;
+
+static bool is_concurrent(void)
+{
+	return ta_head.flags & TA_FLAG_CONCURRENT;
+}
+#endif
+
+static struct tcb_head *get_tcb(void)
+{
+#ifdef CFG_TA_CONCURRENT
+	if (is_concurrent()) {
+#ifdef ARM64
+		return (struct tcb_head *)read_tpidr_el0();
+#else
+		return (struct tcb_head *)read_tpidrurw();
+#endif
+	}
+#endif
+	return _tcb;
+}
+
+static void set_thread_pointer(struct tcb_head *tcb __maybe_unused)
+{
+	/*
+	 * Aarch64 ABI requirement: the thread pointer shall point to the
+	 * thread's TCB. ARMv7 and Aarch32 access the TCB via _tls_get_addr(),
+	 * which uses the thread pointer only for concurrent TAs.
+	 */
+#ifdef ARM64
+	write_tpidr_el0((vaddr_t)tcb);
+#elif defined(CFG_TA_CONCURRENT)
+	if (is_concurrent())
+		write_tpidrurw((vaddr_t)tcb);
+#endif
+}
+
+/* Returns the size needed for the TLS blocks of all the loaded ELF modules */
+static size_t get_tls_size(void)
 {
 	struct dl_phdr_info *dlpi = NULL;
 	const Elf_Phdr *phdr = NULL;
 	size_t total_size = 0;
-	size_t size = 0;
 	size_t i = 0;
 	size_t j = 0;
 
-	/* Compute the size needed for all the TLS blocks */
 	for (i = 0; i < __elf_phdr_info.count; i++) {
 		dlpi = __elf_phdr_info.dlpi + i;
 		for (j = 0; j < dlpi->dlpi_phnum; j++) {
@@ -104,23 +142,42 @@ void __utee_tcb_init(void)
 		}
 	}
 
-	/* ELF modules currently cannot be unmapped */
-	assert(total_size >= _tls_size);
+	return total_size;
+}
 
-	if (total_size == _tls_size)
-		return;
+/*
+ * Returns @tcb (re-)allocated to hold @total_size bytes of TLS blocks.
+ * @tls_size is the size of the TLS blocks already initialized in @tcb.
+ */
+static struct tcb_head *update_tcb(struct tcb_head *tcb, size_t *tls_size,
+				   size_t total_size)
+{
+	struct tcb_head *new_tcb = NULL;
+	struct dl_phdr_info *dlpi = NULL;
+	const Elf_Phdr *phdr = NULL;
+	size_t size = 0;
+	size_t i = 0;
+	size_t j = 0;
+
+	/* ELF modules currently cannot be unmapped */
+	assert(total_size >= *tls_size);
 
 	/* (Re-)allocate the TCB */
-	_tcb = realloc(_tcb, TCB_SIZE(total_size));
-	if (!_tcb) {
+	new_tcb = realloc(tcb, TCB_SIZE(total_size));
+	if (!new_tcb) {
 		EMSG("TCB allocation failed (%zu bytes)", TCB_SIZE(total_size));
 		abort();
 	}
+	if (!tcb) {
+		new_tcb->dtv = NULL;
+		new_tcb->reserved = 0;
+	}
+	tcb = new_tcb;
 
 	/* (Re-)allocate the DTV. + 1 since dtv[0] holds the size */
 	size = DTV_SIZE((__elf_phdr_info.count + 1) * sizeof(union dtv));
-	_tcb->dtv = realloc(_tcb->dtv, size);
-	if (!_tcb->dtv) {
+	tcb->dtv = realloc(tcb->dtv, size);
+	if (!tcb->dtv) {
 		EMSG("DTV allocation failed (%zu bytes)", size);
 		abort();
 	}
@@ -133,32 +190,102 @@ void __utee_tcb_init(void)
 			phdr = dlpi->dlpi_phdr + j;
 			if (phdr->p_type != PT_TLS)
 				continue;
-			if (size + phdr->p_memsz <= _tls_size) {
+			if (size + phdr->p_memsz <= *tls_size) {
 				/* Already copied */
 				break;
 			}
-			_tcb->dtv[i + 1].tls = _tcb->tls + size;
+			tcb->dtv[i + 1].tls = tcb->tls + size;
 			/* Copy .tdata */
-			memcpy(_tcb->tls + size,
+			memcpy(tcb->tls + size,
 			       (void *)(dlpi->dlpi_addr + phdr->p_vaddr),
 			       phdr->p_filesz);
 			/* Initialize .tbss */
-			memset(_tcb->tls + size + phdr->p_filesz, 0,
+			memset(tcb->tls + size + phdr->p_filesz, 0,
 			       phdr->p_memsz - phdr->p_filesz);
 			size += phdr->p_memsz;
 		}
 	}
-	_tcb->dtv[0].size = i;
+	tcb->dtv[0].size = i;
 
-	_tls_size = total_size;
-#ifdef ARM64
-	/*
-	 * Aarch64 ABI requirement: the thread pointer shall point to the
-	 * thread's TCB. ARMv7 and Aarch32 access the TCB via _tls_get_addr().
-	 */
-	write_tpidr_el0((vaddr_t)_tcb);
+	*tls_size = total_size;
+	return tcb;
+}
+
+/*
+ * Initialize or update the TCB.
+ * Called on application initialization and when additional shared objects are
+ * loaded via dlopen(). For a concurrent TA, it's also called when an
+ * invocation is entered after the application is initialized.
+ */
+void __utee_tcb_init(void)
+{
+	size_t total_size = get_tls_size();
+
+#ifdef CFG_TA_CONCURRENT
+	struct utee_thread *thr = __utee_get_thread();
+
+	if (thr) {
+		struct tcb_head *tcb = thr->tcb;
+
+		if (thr->tcb == thr->initial_tcb)
+			tcb = NULL;
+		if (!tcb || total_size != thr->tls_size)
+			thr->tcb = update_tcb(tcb, &thr->tls_size, total_size);
+		((struct tcb_head *)thr->tcb)->reserved = (unsigned long)thr;
+		set_thread_pointer(thr->tcb);
+		return;
+	}
 #endif
+
+	if (total_size == _tls_size)
+		return;
+	_tcb = update_tcb(_tcb, &_tls_size, total_size);
+	set_thread_pointer(_tcb);
+}
+
+#ifdef CFG_TA_CONCURRENT
+struct utee_thread *__utee_get_thread(void)
+{
+	struct tcb_head *tcb = NULL;
+
+	if (!is_concurrent())
+		return NULL;
+
+	tcb = get_tcb();
+	if (!tcb)
+		return NULL;
+	return (struct utee_thread *)tcb->reserved;
+}
+
+/*
+ * The TLS blocks need the heap, which isn't ready before the first
+ * session is opened, so an invocation starts with a TCB without TLS
+ * blocks in @thr. __utee_tcb_init() replaces it with a complete TCB.
+ */
+void __utee_thread_enter(struct utee_thread *thr)
+{
+	static_assert(sizeof(thr->initial_tcb) == sizeof(struct tcb_head));
+
+	/* dtv and reserved of struct tcb_head */
+	thr->initial_tcb[0] = 0;
+	thr->initial_tcb[1] = (unsigned long)thr;
+	thr->tcb = thr->initial_tcb;
+	thr->tls_size = 0;
+	set_thread_pointer(thr->tcb);
+}
+
+void __utee_thread_exit(struct utee_thread *thr)
+{
+	struct tcb_head *tcb = thr->tcb;
+
+	set_thread_pointer(NULL);
+	if (thr->tcb != thr->initial_tcb) {
+		free(tcb->dtv);
+		free(tcb);
+	}
+	thr->tcb = NULL;
 }
+#endif /*CFG_TA_CONCURRENT*/
 
 struct tls_index {
 	unsigned long module;
@@ -169,12 +296,13 @@ void *__tls_get_addr(struct tls_index *ti);
 
 void *__tls_get_addr(struct tls_index *ti)
 {
-	return _tcb->dtv[ti->module].tls + ti->offset;
+	return get_tcb()->dtv[ti->module].tls + ti->offset;
 }
 
 int dl_iterate_phdr(int (*callback)(struct dl_phdr_info *, size_t, void *),
 		    void *data)
 {
+	struct tcb_head *tcb = get_tcb();
 	struct dl_phdr_info *dlpi = NULL;
 	size_t id = 0;
 	size_t i = 0;
@@ -198,7 +326,7 @@ int dl_iterate_phdr(int (*callback)(struct dl_phdr_info *, size_t, void *),
 		dlpi->dlpi_tls_data = NULL;
 		id = dlpi->dlpi_tls_modid;
 		if (id)
-			dlpi->dlpi_tls_data = _tcb->dtv[id].tls;
+			dlpi->dlpi_tls_data = tcb->dtv[id].tls;
 		st = callback(dlpi, sizeof(*dlpi), data);
 	}
 
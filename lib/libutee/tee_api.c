@@ -253,12 +253,22 @@ static bool bufs_intersect(void *buf1, size_t sz1, void *buf2, size_t sz2)
 static TEE_Result check_mem_access_rights_params(uint32_t flags, void *buf,
 						 size_t len)
 {
+	uint32_t param_types = ta_param_types;
+	TEE_Param *params = ta_params;
 	size_t n = 0;
+#if defined(CFG_TA_CONCURRENT)
+	struct utee_thread *thr = __utee_get_thread();
+
+	if (thr) {
+		param_types = thr->param_types;
+		params = thr->params;
+	}
+#endif
 
 	for (n = 0; n < TEE_NUM_PARAMS; n++) {
 		uint32_t f = TEE_MEMORY_ACCESS_ANY_OWNER;
 
-		switch (TEE_PARAM_TYPE_GET(ta_param_types, n)) {
+		switch (TEE_PARAM_TYPE_GET(param_types, n)) {
 		case TEE_PARAM_TYPE_MEMREF_OUTPUT:
 		case TEE_PARAM_TYPE_MEMREF_INOUT:
 			f |= TEE_MEMORY_ACCESS_WRITE;
@@ -266,8 +276,8 @@ static TEE_Result check_mem_access_rights_params(uint32_t flags, void *buf,
 		case TEE_PARAM_TYPE_MEMREF_INPUT:
 			f |= TEE_MEMORY_ACCESS_READ;
 			if (bufs_intersect(buf, len,
-					   ta_params[n].memref.buffer,
-					   ta_params[n].memref.size)) {
+					   params[n].memref.buffer,
+					   params[n].memref.size)) {
 				if ((flags & f) != flags)
 					return TEE_ERROR_ACCESS_DENIED;
 			}
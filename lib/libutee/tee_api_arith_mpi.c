@@ -680,11 +680,177 @@ static bool mpi_is_even(mbedtls_mpi *x)
 	return !mpi_is_odd(x);
 }
 
+/*
+ * FMM implementation using Montgomery representation: a value x is
+ * represented as x * R mod N where R = 2^(32 * nblimbs) and nblimbs is
+ * the number of limbs of the modulus N. The multiplication is done with
+ * the CIOS method directly on the limbs of the TEE_BigInt operands.
+ *
+ * The context holds the precomputed values needed by the conversions and
+ * the multiplication:
+ * struct fmm_ctx_hdr
+ * uint32_t n[nblimbs]	- the modulus
+ * uint32_t rr[nblimbs]	- R^2 mod N
+ *
+ * An even modulus has no Montgomery representation, nblimbs is set to 0
+ * in that case and the functions below fall back to the plain modular
+ * arithmetic on the normal big int representation.
+ *
+ * Note that these functions (along with all the other functions in this
+ * file) only are used directly by the TA doing bigint arithmetics on its
+ * own. Performance of RSA operations in TEE Internal API are not affected
+ * by this.
+ */
+struct fmm_ctx_hdr {
+	uint32_t nblimbs;
+	uint32_t mm;		/* -N^-1 mod 2^32 */
+};
+
+#define FMM_CTX_HDR_SIZE_IN_U32	2
+#define FMM_MAX_LIMBS		(CFG_TA_BIGNUM_MAX_BITS / 32)
+
+/*
+ * Scratch limbs needed by one FMM operation on a @nl limbs modulus: the
+ * (@nl + 2) limbs accumulator of fmm_mul() followed by three @nl limbs
+ * buffers for the two operands and the result.
+ */
+struct fmm_scratch {
+	uint32_t *t;
+	uint32_t *buf1;
+	uint32_t *buf2;
+	uint32_t *res;
+};
+
+static const uint32_t *bigint_limbs(const TEE_BigInt *bigInt)
+{
+	return (const uint32_t *)((const struct bigint_hdr *)bigInt + 1);
+}
+
+static const uint32_t *fmm_ctx_n(const struct fmm_ctx_hdr *ctx)
+{
+	return (const uint32_t *)(ctx + 1);
+}
+
+static const uint32_t *fmm_ctx_rr(const struct fmm_ctx_hdr *ctx)
+{
+	return fmm_ctx_n(ctx) + ctx->nblimbs;
+}
+
+/*
+ * Initializes a read-only MPI referring to the limbs of @nl limbs at @p,
+ * the MPI must not be modified or freed.
+ */
+static void get_const_mpi(mbedtls_mpi *mpi, const uint32_t *p, size_t nl)
+{
+	mbedtls_mpi_init(mpi);
+	mpi->s = 1;
+	mpi->n = nl;
+	mpi->p = (mbedtls_mpi_uint *)p;
+}
+
+/* Returns -@n0^-1 mod 2^32, @n0 is odd */
+static uint32_t fmm_minus_inv(uint32_t n0)
+{
+	uint32_t x = n0;	/* Correct to 3 bits since n0 * n0 = 1 mod 8 */
+	int n = 0;
+
+	/* Each Newton iteration doubles the number of correct bits */
+	for (n = 0; n < 4; n++)
+		x *= 2 - n0 * x;
+
+	return -x;
+}
+
+/*
+ * Allocates zero initialized scratch limbs for a @nl limbs modulus from
+ * the bignum memory pool instead of the stack, which would otherwise have
+ * to hold four FMM_MAX_LIMBS arrays per call.
+ */
+static void fmm_scratch_alloc(struct fmm_scratch *s, size_t nl)
+{
+	s->t = mempool_calloc(mbedtls_mpi_mempool, 4 * nl + 2,
+			      sizeof(uint32_t));
+	if (!s->t)
+		TEE_Panic(TEE_ERROR_OUT_OF_MEMORY);
+	s->buf1 = s->t + nl + 2;
+	s->buf2 = s->buf1 + nl;
+	s->res = s->buf2 + nl;
+}
+
+static void fmm_scratch_free(struct fmm_scratch *s)
+{
+	mempool_free(mbedtls_mpi_mempool, s->t);
+}
+
+/*
+ * Computes d = a * b * R^-1 mod N, @a and @b are @nl limbs long with
+ * a * b < R * N. @d may overlap @a or @b. @t is (@nl + 2) limbs of
+ * scratch which are cleared first.
+ */
+static void fmm_mul(uint32_t *d, const uint32_t *a, const uint32_t *b,
+		    const uint32_t *n, size_t nl, uint32_t mm, uint32_t *t)
+{
+	uint32_t mask = 0;
+	uint64_t c = 0;
+	uint32_t m = 0;
+	size_t i = 0;
+	size_t j = 0;
+
+	memset(t, 0, (nl + 2) * sizeof(uint32_t));
+
+	for (i = 0; i < nl; i++) {
+		/* t += a[i] * b */
+		c = 0;
+		for (j = 0; j < nl; j++) {
+			c += (uint64_t)a[i] * b[j] + t[j];
+			t[j] = c;
+			c >>= 32;
+		}
+		c += t[nl];
+		t[nl] = c;
+		t[nl + 1] = c >> 32;
+
+		/* t = (t + m * n) / 2^32 with m chosen to clear t[0] */
+		m = t[0] * mm;
+		c = ((uint64_t)m * n[0] + t[0]) >> 32;
+		for (j = 1; j < nl; j++) {
+			c += (uint64_t)m * n[j] + t[j];
+			t[j - 1] = c;
+			c >>= 32;
+		}
+		c += t[nl];
+		t[nl - 1] = c;
+		t[nl] = t[nl + 1] + (c >> 32);
+	}
+
+	/* t < 2 * N, subtract N unless t < N without branching on t */
+	c = 0;
+	for (j = 0; j < nl; j++) {
+		c = (uint64_t)t[j] - n[j] - c;
+		d[j] = c;
+		c = (c >> 32) & 1;
+	}
+	mask = -(uint32_t)(((uint64_t)t[nl] - c) >> 63);
+	for (j = 0; j < nl; j++)
+		d[j] = (t[j] & mask) | (d[j] & ~mask);
+}
+
+/* Returns true if @ctx was initialized for the modulus @n */
+static bool fmm_ctx_matches(const struct fmm_ctx_hdr *ctx,
+			    const mbedtls_mpi *n)
+{
+	return ctx->nblimbs && ctx->nblimbs == n->n &&
+	       !memcmp(fmm_ctx_n(ctx), n->p, n->n * sizeof(uint32_t));
+}
+
 TEE_Result TEE_BigIntExpMod(TEE_BigInt *dest, const TEE_BigInt *op1,
 			    const TEE_BigInt *op2, const TEE_BigInt *n,
-			    const TEE_BigIntFMMContext *context __unused)
+			    const TEE_BigIntFMMContext *context)
 {
+	const struct fmm_ctx_hdr *ctx = (const struct fmm_ctx_hdr *)context;
 	TEE_Result res = TEE_SUCCESS;
+	mbedtls_mpi mpi_rr = { };
+	mbedtls_mpi *prec_rr = NULL;
 	mbedtls_mpi mpi_dest = { };
 	mbedtls_mpi mpi_op1 = { };
 	mbedtls_mpi mpi_op2 = { };
@@ -713,7 +879,13 @@ TEE_Result TEE_BigIntExpMod(TEE_BigInt *dest, const TEE_BigInt *op1,
 		goto out;
 	}
 
-	MPI_CHECK(mbedtls_mpi_exp_mod(&mpi_dest, pop1, pop2, &mpi_n, NULL));
+	/* Reuse R^2 mod N of the FMM context if it matches the modulus */
+	if (ctx && fmm_ctx_matches(ctx, &mpi_n)) {
+		get_const_mpi(&mpi_rr, fmm_ctx_rr(ctx), mpi_n.n);
+		prec_rr = &mpi_rr;
+	}
+
+	MPI_CHECK(mbedtls_mpi_exp_mod(&mpi_dest, pop1, pop2, &mpi_n, prec_rr));
 	MPI_CHECK(copy_mpi_to_bigint(&mpi_dest, dest));
 out:
 	mbedtls_mpi_free(&mpi_dest);
@@ -908,13 +1080,65 @@ int32_t TEE_BigIntIsProbablePrime(const TEE_BigInt *op,
 }
 
 /*
- * Not so fast FMM implementation based on the normal big int functions.
- *
- * Note that these functions (along with all the other functions in this
- * file) only are used directly by the TA doing bigint arithmetics on its
- * own. Performance of RSA operations in TEE Internal API are not affected
- * by this.
+ * Returns the limbs of @op zero extended to the modulus size, using @buf
+ * only if needed. An operand which isn't less than the modulus is reduced
+ * first.
  */
+static const uint32_t *fmm_get_op(const TEE_BigInt *op,
+				  const struct fmm_ctx_hdr *ctx, uint32_t *buf)
+{
+	const struct bigint_hdr *hdr = (const struct bigint_hdr *)op;
+	const uint32_t *p = bigint_limbs(op);
+	size_t nl = ctx->nblimbs;
+	mbedtls_mpi mpi_op;
+	mbedtls_mpi mpi_n;
+	mbedtls_mpi mpi_r;
+
+	get_const_mpi(&mpi_n, fmm_ctx_n(ctx), nl);
+
+	if (hdr->sign > 0 || !hdr->nblimbs) {
+		if (hdr->nblimbs < nl) {
+			memcpy(buf, p, hdr->nblimbs * sizeof(uint32_t));
+			memset(buf + hdr->nblimbs, 0,
+			       (nl - hdr->nblimbs) * sizeof(uint32_t));
+			return buf;
+		}
+		if (hdr->nblimbs == nl) {
+			get_const_mpi(&mpi_op, p, nl);
+			if (mbedtls_mpi_cmp_abs(&mpi_op, &mpi_n) < 0)
+				return p;
+		}
+	}
+
+	get_mpi(&mpi_op, op);
+	get_mpi(&mpi_r, NULL);
+
+	MPI_CHECK(mbedtls_mpi_mod_mpi(&mpi_r, &mpi_op, &mpi_n));
+	MPI_CHECK(mbedtls_mpi_write_binary_le(&mpi_r, (uint8_t *)buf,
+					      nl * sizeof(uint32_t)));
+
+	mbedtls_mpi_free(&mpi_r);
+	mbedtls_mpi_free(&mpi_op);
+
+	return buf;
+}
+
+static void fmm_set_res(TEE_BigInt *dest, const uint32_t *res, size_t nl)
+{
+	struct bigint_hdr *hdr = (struct bigint_hdr *)dest;
+
+	/* Trim of eventual insignificant zeroes */
+	while (nl && !res[nl - 1])
+		nl--;
+
+	if (hdr->alloc_size < nl)
+		API_PANIC("Too small destination");
+
+	hdr->sign = 1;
+	hdr->nblimbs = nl;
+	memcpy(hdr + 1, res, nl * sizeof(uint32_t));
+}
+
 void TEE_BigIntInitFMM(TEE_BigIntFMM *bigIntFMM, size_t len)
 {
 	TEE_BigIntInit(bigIntFMM, len);
@@ -925,10 +1149,47 @@ void __GP11_TEE_BigIntInitFMM(TEE_BigIntFMM *bigIntFMM, uint32_t len)
 	TEE_BigIntInitFMM(bigIntFMM, len);
 }
 
-void TEE_BigIntInitFMMContext(TEE_BigIntFMMContext *context __unused,
-			      size_t len __unused,
-			      const TEE_BigInt *modulus __unused)
+void TEE_BigIntInitFMMContext(TEE_BigIntFMMContext *context, size_t len,
+			      const TEE_BigInt *modulus)
 {
+	struct fmm_ctx_hdr *ctx = (struct fmm_ctx_hdr *)context;
+	const uint32_t *n = bigint_limbs(modulus);
+	size_t nl = ((const struct bigint_hdr *)modulus)->nblimbs;
+	mbedtls_mpi mpi_n;
+	mbedtls_mpi mpi_rr;
+
+	COMPILE_TIME_ASSERT(sizeof(struct fmm_ctx_hdr) ==
+			    sizeof(uint32_t) * FMM_CTX_HDR_SIZE_IN_U32);
+
+	/* Trim of eventual insignificant zeroes */
+	while (nl && !n[nl - 1])
+		nl--;
+
+	if (nl > FMM_MAX_LIMBS)
+		API_PANIC("Too large modulus");
+	if (len < FMM_CTX_HDR_SIZE_IN_U32 + 2 * nl)
+		API_PANIC("Too small FMM context");
+
+	ctx->nblimbs = 0;
+	ctx->mm = 0;
+	if (((const struct bigint_hdr *)modulus)->sign < 0 || !nl ||
+	    !(n[0] & 1) || (nl == 1 && n[0] < 3))
+		return;
+
+	ctx->nblimbs = nl;
+	ctx->mm = fmm_minus_inv(n[0]);
+	memcpy(ctx + 1, n, nl * sizeof(uint32_t));
+
+	/* R^2 mod N, computed once per modulus */
+	get_mpi(&mpi_rr, NULL);
+	get_const_mpi(&mpi_n, n, nl);
+	MPI_CHECK(mbedtls_mpi_lset(&mpi_rr, 1));
+	MPI_CHECK(mbedtls_mpi_shift_l(&mpi_rr, nl * 2 * 32));
+	MPI_CHECK(mbedtls_mpi_mod_mpi(&mpi_rr, &mpi_rr, &mpi_n));
+	MPI_CHECK(mbedtls_mpi_write_binary_le(&mpi_rr,
+					      (uint8_t *)fmm_ctx_rr(ctx),
+					      nl * sizeof(uint32_t)));
+	mbedtls_mpi_free(&mpi_rr);
 }
 
 void __GP11_TEE_BigIntInitFMMContext(TEE_BigIntFMMContext *context,
@@ -937,10 +1198,11 @@ void __GP11_TEE_BigIntInitFMMContext(TEE_BigIntFMMContext *context,
 	TEE_BigIntInitFMMContext(context, len, modulus);
 }
 
-TEE_Result TEE_BigIntInitFMMContext1(TEE_BigIntFMMContext *context __unused,
-				     size_t len __unused,
-				     const TEE_BigInt *modulus __unused)
+TEE_Result TEE_BigIntInitFMMContext1(TEE_BigIntFMMContext *context,
+				     size_t len, const TEE_BigInt *modulus)
 {
+	TEE_BigIntInitFMMContext(context, len, modulus);
+
 	return TEE_SUCCESS;
 }
 
@@ -954,10 +1216,10 @@ uint32_t __GP11_TEE_BigIntFMMSizeInU32(uint32_t modulusSizeInBits)
 	return TEE_BigIntFMMSizeInU32(modulusSizeInBits);
 }
 
-size_t TEE_BigIntFMMContextSizeInU32(size_t modulusSizeInBits __unused)
+size_t TEE_BigIntFMMContextSizeInU32(size_t modulusSizeInBits)
 {
-	/* Return something larger than 0 to keep malloc() and friends happy */
-	return 1;
+	return FMM_CTX_HDR_SIZE_IN_U32 +
+	       2 * ROUNDUP_DIV(modulusSizeInBits, 32);
 }
 
 uint32_t __GP11_TEE_BigIntFMMContextSizeInU32(uint32_t modulusSizeInBits)
@@ -967,18 +1229,45 @@ uint32_t __GP11_TEE_BigIntFMMContextSizeInU32(uint32_t modulusSizeInBits)
 
 void TEE_BigIntConvertToFMM(TEE_BigIntFMM *dest, const TEE_BigInt *src,
 			    const TEE_BigInt *n,
-			    const TEE_BigIntFMMContext *context __unused)
+			    const TEE_BigIntFMMContext *context)
 {
-	TEE_BigIntMod(dest, src, n);
+	const struct fmm_ctx_hdr *ctx = (const struct fmm_ctx_hdr *)context;
+	struct fmm_scratch s = { };
+	size_t nl = ctx->nblimbs;
+
+	if (!nl) {
+		TEE_BigIntMod(dest, src, n);
+		return;
+	}
+
+	fmm_scratch_alloc(&s, nl);
+	fmm_mul(s.res, fmm_get_op(src, ctx, s.buf1), fmm_ctx_rr(ctx),
+		fmm_ctx_n(ctx), nl, ctx->mm, s.t);
+	fmm_set_res(dest, s.res, nl);
+	fmm_scratch_free(&s);
 }
 
 void TEE_BigIntConvertFromFMM(TEE_BigInt *dest, const TEE_BigIntFMM *src,
 			      const TEE_BigInt *n __unused,
-			      const TEE_BigIntFMMContext *context __unused)
+			      const TEE_BigIntFMMContext *context)
 {
+	const struct fmm_ctx_hdr *ctx = (const struct fmm_ctx_hdr *)context;
+	struct fmm_scratch s = { };
+	size_t nl = ctx->nblimbs;
 	mbedtls_mpi mpi_dst;
 	mbedtls_mpi mpi_src;
 
+	if (nl) {
+		fmm_scratch_alloc(&s, nl);
+		/* Multiplying by 1 leaves the Montgomery domain */
+		s.buf2[0] = 1;
+		fmm_mul(s.res, fmm_get_op(src, ctx, s.buf1), s.buf2,
+			fmm_ctx_n(ctx), nl, ctx->mm, s.t);
+		fmm_set_res(dest, s.res, nl);
+		fmm_scratch_free(&s);
+		return;
+	}
+
 	get_mpi(&mpi_dst, dest);
 	get_mpi(&mpi_src, src);
 
@@ -991,14 +1280,28 @@ void TEE_BigIntConvertFromFMM(TEE_BigInt *dest, const TEE_BigIntFMM *src,
 
 void TEE_BigIntComputeFMM(TEE_BigIntFMM *dest, const TEE_BigIntFMM *op1,
 			  const TEE_BigIntFMM *op2, const TEE_BigInt *n,
-			  const TEE_BigIntFMMContext *context __unused)
+			  const TEE_BigIntFMMContext *context)
 {
+	const struct fmm_ctx_hdr *ctx = (const struct fmm_ctx_hdr *)context;
+	struct fmm_scratch s = { };
+	size_t nl = ctx->nblimbs;
 	mbedtls_mpi mpi_dst;
 	mbedtls_mpi mpi_op1;
 	mbedtls_mpi mpi_op2;
 	mbedtls_mpi mpi_n;
 	mbedtls_mpi mpi_t;
 
+	if (nl) {
+		/* Both operands are already in Montgomery form */
+		fmm_scratch_alloc(&s, nl);
+		fmm_mul(s.res, fmm_get_op(op1, ctx, s.buf1),
+			fmm_get_op(op2, ctx, s.buf2), fmm_ctx_n(ctx), nl,
+			ctx->mm, s.t);
+		fmm_set_res(dest, s.res, nl);
+		fmm_scratch_free(&s);
+		return;
+	}
+
 	get_mpi(&mpi_dst, dest);
 	get_mpi(&mpi_op1, op1);
 	get_mpi(&mpi_op2, op2);
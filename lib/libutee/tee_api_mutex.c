@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, The OP-TEE Project Contributors
+ */
+
+#include <limits.h>
+#include <stdbool.h>
+#include <tee_internal_api.h>
+#include <tee_internal_api_extensions.h>
+#include <utee_syscalls.h>
+
+/*
+ * Values of struct tee_mutex::state:
+ * 0 - unlocked
+ * 1 - locked, no waiters
+ * 2 - locked, there may be waiters sleeping in the TEE core
+ */
+#define MUTEX_UNLOCKED		0
+#define MUTEX_LOCKED		1
+#define MUTEX_CONTENDED		2
+
+static TEE_Result futex_wait(uint32_t *addr, uint32_t val, uint32_t flags)
+{
+	TEE_Result res = _utee_futex_wait(addr, val, flags);
+
+	if (res && res != TEE_ERROR_CANCEL)
+		TEE_Panic(res);
+
+	return res;
+}
+
+static void futex_wake(uint32_t *addr, uint32_t count)
+{
+	TEE_Result res = _utee_futex_wake(addr, count);
+
+	if (res)
+		TEE_Panic(res);
+}
+
+void tee_mutex_lock(struct tee_mutex *mutex)
+{
+	uint32_t s = MUTEX_UNLOCKED;
+
+	if (__atomic_compare_exchange_n(&mutex->state, &s, MUTEX_LOCKED, false,
+					__ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+		return;
+
+	/*
+	 * Contended, mark the mutex so that the thread unlocking it wakes
+	 * up a waiter.
+	 */
+	if (s != MUTEX_CONTENDED)
+		s = __atomic_exchange_n(&mutex->state, MUTEX_CONTENDED,
+					__ATOMIC_ACQUIRE);
+	while (s != MUTEX_UNLOCKED) {
+		futex_wait(&mutex->state, MUTEX_CONTENDED, 0);
+		s = __atomic_exchange_n(&mutex->state, MUTEX_CONTENDED,
+					__ATOMIC_ACQUIRE);
+	}
+}
+
+TEE_Result tee_mutex_trylock(struct tee_mutex *mutex)
+{
+	uint32_t s = MUTEX_UNLOCKED;
+
+	if (__atomic_compare_exchange_n(&mutex->state, &s, MUTEX_LOCKED, false,
+					__ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+		return TEE_SUCCESS;
+
+	return TEE_ERROR_BUSY;
+}
+
+void tee_mutex_unlock(struct tee_mutex *mutex)
+{
+	if (__atomic_exchange_n(&mutex->state, MUTEX_UNLOCKED,
+				__ATOMIC_RELEASE) == MUTEX_CONTENDED)
+		futex_wake(&mutex->state, 1);
+}
+
+TEE_Result tee_condvar_wait(struct tee_condvar *cv, struct tee_mutex *mutex)
+{
+	uint32_t seq = __atomic_load_n(&cv->seq, __ATOMIC_RELAXED);
+	TEE_Result res = TEE_SUCCESS;
+
+	/*
+	 * A signal after the mutex is unlocked changes cv->seq, the core
+	 * doesn't put the thread to sleep in that case.
+	 */
+	tee_mutex_unlock(mutex);
+	res = futex_wait(&cv->seq, seq, UTEE_FUTEX_WAIT_CANCELLABLE);
+
+	/*
+	 * Other threads woken by a broadcast may be waiting for the mutex
+	 * too, lock it as contended to have them woken up when unlocked.
+	 */
+	while (__atomic_exchange_n(&mutex->state, MUTEX_CONTENDED,
+				   __ATOMIC_ACQUIRE) != MUTEX_UNLOCKED)
+		futex_wait(&mutex->state, MUTEX_CONTENDED, 0);
+
+	return res;
+}
+
+void tee_condvar_signal(struct tee_condvar *cv)
+{
+	__atomic_fetch_add(&cv->seq, 1, __ATOMIC_RELEASE);
+	futex_wake(&cv->seq, 1);
+}
+
+void tee_condvar_broadcast(struct tee_condvar *cv)
+{
+	__atomic_fetch_add(&cv->seq, 1, __ATOMIC_RELEASE);
+	futex_wake(&cv->seq, UINT32_MAX);
+}
+
+/* Used by malloc() and friends in libutils */
+static struct tee_mutex malloc_mutex = TEE_MUTEX_INITIALIZER;
+
+void __utee_malloc_lock(void);
+void __utee_malloc_unlock(void);
+
+void __utee_malloc_lock(void)
+{
+	tee_mutex_lock(&malloc_mutex);
+}
+
+void __utee_malloc_unlock(void)
+{
+	tee_mutex_unlock(&malloc_mutex);
+}
@@ -6,6 +6,7 @@
 #include <string.h>
 
 #include <tee_api.h>
+#include <tee_internal_api_extensions.h>
 #include <utee_syscalls.h>
 #include "tee_api_private.h"
 
@@ -847,6 +848,46 @@ out:
 	return res;
 }
 
+TEE_Result
+tee_get_next_persistent_objects(TEE_ObjectEnumHandle enumerator,
+				struct utee_object_enum_entry *entries,
+				size_t *count)
+{
+	TEE_Result res = TEE_SUCCESS;
+	uint64_t cnt = 0;
+
+	__utee_check_inout_annotation(count, sizeof(*count));
+	__utee_check_out_annotation(entries, *count * sizeof(*entries));
+
+	cnt = *count;
+	res = _utee_storage_next_enum_batch((unsigned long)enumerator,
+					    entries, &cnt);
+	*count = cnt;
+
+	if (res != TEE_SUCCESS &&
+	    res != TEE_ERROR_ITEM_NOT_FOUND &&
+	    res != TEE_ERROR_CORRUPT_OBJECT &&
+	    res != TEE_ERROR_STORAGE_NOT_AVAILABLE)
+		TEE_Panic(res);
+
+	return res;
+}
+
+TEE_Result tee_begin_persistent_object_transaction(uint32_t storageID)
+{
+	return _utee_storage_tx_begin(storageID);
+}
+
+TEE_Result tee_commit_persistent_object_transaction(uint32_t storageID)
+{
+	return _utee_storage_tx_commit(storageID);
+}
+
+TEE_Result tee_abort_persistent_object_transaction(uint32_t storageID)
+{
+	return _utee_storage_tx_abort(storageID);
+}
+
 TEE_Result
 __GP11_TEE_GetNextPersistentObject(TEE_ObjectEnumHandle objectEnumerator,
 				   __GP11_TEE_ObjectInfo *objectInfo,
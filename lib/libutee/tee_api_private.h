@@ -18,6 +18,32 @@ void __utee_from_gp11_attr(struct utee_attribute *ua,
 TEE_Result __utee_entry(unsigned long func, unsigned long session_id,
 			struct utee_params *up, unsigned long cmd_id);
 
+#if defined(CFG_TA_CONCURRENT)
+/*
+ * struct utee_thread - state of an invocation of a TA with
+ * TA_FLAG_CONCURRENT, kept on the stack of the invocation
+ * @param_types:	parameter types of the invocation
+ * @params:		parameters of the invocation
+ * @tcb:		thread control block of the invocation
+ * @tls_size:		size of the TLS blocks in @tcb
+ * @initial_tcb:	TCB without TLS blocks used until the heap is ready
+ */
+struct utee_thread {
+	uint32_t param_types;
+	TEE_Param params[TEE_NUM_PARAMS];
+	void *tcb;
+	size_t tls_size;
+	unsigned long initial_tcb[2];
+};
+
+/* Returns NULL unless the TA has TA_FLAG_CONCURRENT */
+struct utee_thread *__utee_get_thread(void);
+void __utee_thread_enter(struct utee_thread *thr);
+void __utee_thread_exit(struct utee_thread *thr);
+#else
+static inline void *__utee_get_thread(void) { return NULL; }
+#endif
+
 
 #if defined(CFG_TA_GPROF_SUPPORT)
 void __utee_gprof_init(void);
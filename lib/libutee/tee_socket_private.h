@@ -29,4 +29,24 @@ TEE_Result __tee_socket_pta_recv(uint32_t handle, void *buf, uint32_t *len,
 TEE_Result __tee_socket_pta_ioctl(uint32_t handle, uint32_t command, void *buf,
 				  uint32_t *len);
 
+struct pta_socket_iov;
+struct pta_socket_pollfd;
+
+TEE_Result __tee_socket_pta_sendv(uint32_t handle,
+				  const struct pta_socket_iov *iov,
+				  uint32_t iov_count, uint32_t *len,
+				  uint32_t timeout);
+
+TEE_Result __tee_socket_pta_recvv(uint32_t handle,
+				  const struct pta_socket_iov *iov,
+				  uint32_t iov_count, uint32_t *len,
+				  uint32_t timeout);
+
+TEE_Result __tee_socket_pta_poll(struct pta_socket_pollfd *fds, uint32_t count,
+				 uint32_t timeout, uint32_t *ready);
+
+TEE_Result __tee_socket_pta_recv_batch(uint32_t handle, void *buf,
+				       uint32_t *len, uint32_t *count,
+				       uint32_t timeout);
+
 #endif /*__TEE_SOCKET_PRIVATE_H*/
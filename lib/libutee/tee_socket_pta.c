@@ -160,3 +160,97 @@ TEE_Result __tee_socket_pta_ioctl(uint32_t handle, uint32_t command, void *buf,
 	*len =  params[1].memref.size;
 	return res;
 }
+
+static TEE_Result invoke_iov(uint32_t cmd_id, uint32_t handle,
+			     const struct pta_socket_iov *iov,
+			     uint32_t iov_count, uint32_t *len,
+			     uint32_t timeout)
+{
+	TEE_Result res;
+	uint32_t param_types;
+	TEE_Param params[TEE_NUM_PARAMS];
+
+	param_types = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+				      TEE_PARAM_TYPE_MEMREF_INPUT,
+				      TEE_PARAM_TYPE_VALUE_OUTPUT,
+				      TEE_PARAM_TYPE_NONE);
+	memset(params, 0, sizeof(params));
+
+	params[0].value.a = handle;
+	params[0].value.b = timeout;
+
+	params[1].memref.buffer = (void *)iov;
+	params[1].memref.size = iov_count * sizeof(*iov);
+
+	res = invoke_socket_pta(cmd_id, param_types, params);
+	*len = params[2].value.a;
+	return res;
+}
+
+TEE_Result __tee_socket_pta_sendv(uint32_t handle,
+				  const struct pta_socket_iov *iov,
+				  uint32_t iov_count, uint32_t *len,
+				  uint32_t timeout)
+{
+	return invoke_iov(PTA_SOCKET_SENDV, handle, iov, iov_count, len,
+			  timeout);
+}
+
+TEE_Result __tee_socket_pta_recvv(uint32_t handle,
+				  const struct pta_socket_iov *iov,
+				  uint32_t iov_count, uint32_t *len,
+				  uint32_t timeout)
+{
+	return invoke_iov(PTA_SOCKET_RECVV, handle, iov, iov_count, len,
+			  timeout);
+}
+
+TEE_Result __tee_socket_pta_poll(struct pta_socket_pollfd *fds, uint32_t count,
+				 uint32_t timeout, uint32_t *ready)
+{
+	TEE_Result res;
+	uint32_t param_types;
+	TEE_Param params[TEE_NUM_PARAMS];
+
+	param_types = TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_INOUT,
+				      TEE_PARAM_TYPE_VALUE_INOUT,
+				      TEE_PARAM_TYPE_NONE, TEE_PARAM_TYPE_NONE);
+	memset(params, 0, sizeof(params));
+
+	params[0].memref.buffer = fds;
+	params[0].memref.size = count * sizeof(*fds);
+	params[1].value.a = timeout;
+
+	res = invoke_socket_pta(PTA_SOCKET_POLL, param_types, params);
+	if (res == TEE_SUCCESS)
+		*ready = params[1].value.b;
+	return res;
+}
+
+TEE_Result __tee_socket_pta_recv_batch(uint32_t handle, void *buf,
+				       uint32_t *len, uint32_t *count,
+				       uint32_t timeout)
+{
+	TEE_Result res;
+	uint32_t param_types;
+	TEE_Param params[TEE_NUM_PARAMS];
+
+	param_types = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+				      TEE_PARAM_TYPE_MEMREF_OUTPUT,
+				      TEE_PARAM_TYPE_VALUE_INOUT,
+				      TEE_PARAM_TYPE_NONE);
+	memset(params, 0, sizeof(params));
+
+	params[0].value.a = handle;
+	params[0].value.b = timeout;
+
+	params[1].memref.buffer = buf;
+	params[1].memref.size = *len;
+
+	params[2].value.a = *count;
+
+	res = invoke_socket_pta(PTA_SOCKET_RECV_BATCH, param_types, params);
+	*len = params[1].memref.size;
+	*count = res == TEE_SUCCESS ? params[2].value.a : 0;
+	return res;
+}
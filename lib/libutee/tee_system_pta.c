@@ -78,6 +78,36 @@ TEE_Result tee_unmap(void *buf, size_t len)
 	return res;
 }
 
+TEE_Result tee_grant_shm(TEE_TASessionHandle session, void *buf, size_t len,
+			 uint32_t flags)
+{
+	uint32_t param_types = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+					       TEE_PARAM_TYPE_VALUE_INPUT,
+					       TEE_PARAM_TYPE_VALUE_INPUT,
+					       TEE_PARAM_TYPE_NONE);
+	TEE_Param params[TEE_NUM_PARAMS] = { };
+
+	if (session == TEE_HANDLE_NULL || !buf || !len)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	params[0].value.a = (uintptr_t)session;
+	switch (flags) {
+	case TEE_MEMORY_ACCESS_READ:
+		break;
+	case TEE_MEMORY_ACCESS_READ | TEE_MEMORY_ACCESS_WRITE:
+		params[0].value.b = PTA_SYSTEM_MAP_FLAG_WRITEABLE;
+		break;
+	default:
+		return TEE_ERROR_BAD_PARAMETERS;
+	}
+	reg_pair_from_64((vaddr_t)buf, &params[1].value.a, &params[1].value.b);
+	params[2].value.a = len;
+	if (params[2].value.a != len)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	return invoke_system_pta(PTA_SYSTEM_GRANT_SHM, param_types, params);
+}
+
 TEE_Result tee_invoke_supp_plugin(const TEE_UUID *uuid, uint32_t cmd,
 				  uint32_t sub_cmd, void *buf, size_t len,
 				  size_t *outlen)
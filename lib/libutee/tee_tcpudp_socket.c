@@ -6,6 +6,7 @@
 #include <pta_socket.h>
 #include <tee_internal_api.h>
 #include <tee_isocket.h>
+#include <tee_isocket_extensions.h>
 #include <tee_tcpsocket.h>
 #include <__tee_tcpsocket_defines_extensions.h>
 #include <tee_udpsocket.h>
@@ -203,7 +204,122 @@ static TEE_Result udp_ioctl(TEE_iSocketHandle ctx, uint32_t commandCode,
 	return res;
 }
 
+static void iov_to_pta(struct pta_socket_iov *pta_iov,
+		       const struct tee_isocket_iov *iov, uint32_t iov_count)
+{
+	uint32_t n = 0;
+
+	for (n = 0; n < iov_count; n++) {
+		if (!iov[n].buf && iov[n].len)
+			TEE_Panic(0);
+		pta_iov[n].buf = (uintptr_t)iov[n].buf;
+		pta_iov[n].len = iov[n].len;
+	}
+}
+
+TEE_Result tee_isocket_sendv(TEE_iSocketHandle ctx,
+			     const struct tee_isocket_iov *iov,
+			     uint32_t iov_count, uint32_t *length,
+			     uint32_t timeout)
+{
+	struct pta_socket_iov pta_iov[TEE_ISOCKET_IOV_MAX] = { };
+	struct socket_ctx *sock_ctx = (struct socket_ctx *)ctx;
+	TEE_Result res = TEE_SUCCESS;
+
+	if (ctx == TEE_HANDLE_NULL || !iov || !length)
+		TEE_Panic(0);
+	if (!iov_count || iov_count > TEE_ISOCKET_IOV_MAX)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	iov_to_pta(pta_iov, iov, iov_count);
+	res = __tee_socket_pta_sendv(sock_ctx->handle, pta_iov, iov_count,
+				     length, timeout);
+	sock_ctx->proto_error = res;
+
+	return res;
+}
+
+TEE_Result tee_isocket_recvv(TEE_iSocketHandle ctx,
+			     const struct tee_isocket_iov *iov,
+			     uint32_t iov_count, uint32_t *length,
+			     uint32_t timeout)
+{
+	struct pta_socket_iov pta_iov[TEE_ISOCKET_IOV_MAX] = { };
+	struct socket_ctx *sock_ctx = (struct socket_ctx *)ctx;
+	TEE_Result res = TEE_SUCCESS;
+
+	if (ctx == TEE_HANDLE_NULL || !iov || !length)
+		TEE_Panic(0);
+	if (!iov_count || iov_count > TEE_ISOCKET_IOV_MAX)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	iov_to_pta(pta_iov, iov, iov_count);
+	res = __tee_socket_pta_recvv(sock_ctx->handle, pta_iov, iov_count,
+				     length, timeout);
+	sock_ctx->proto_error = res;
+
+	return res;
+}
+
+TEE_Result tee_isocket_poll(struct tee_isocket_pollfd *fds, uint32_t count,
+			    uint32_t timeout, uint32_t *ready)
+{
+	struct pta_socket_pollfd *pta_fds = NULL;
+	TEE_Result res = TEE_SUCCESS;
+	uint32_t n = 0;
 
+	if (!fds || !ready)
+		TEE_Panic(0);
+	if (!count || count > TEE_ISOCKET_POLL_MAX)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	pta_fds = TEE_Malloc(count * sizeof(*pta_fds), TEE_MALLOC_FILL_ZERO);
+	if (!pta_fds)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	for (n = 0; n < count; n++) {
+		if (fds[n].ctx == TEE_HANDLE_NULL)
+			TEE_Panic(0);
+		pta_fds[n].handle = ((struct socket_ctx *)fds[n].ctx)->handle;
+		pta_fds[n].events = fds[n].events;
+	}
+
+	res = __tee_socket_pta_poll(pta_fds, count, timeout, ready);
+	if (res == TEE_SUCCESS)
+		for (n = 0; n < count; n++)
+			fds[n].revents = pta_fds[n].revents;
+
+	TEE_Free(pta_fds);
+
+	return res;
+}
+
+TEE_Result tee_udpsocket_recv_batch(TEE_iSocketHandle ctx, void *buf,
+				    uint32_t *length, uint32_t *count,
+				    uint32_t timeout)
+{
+	struct socket_ctx *sock_ctx = (struct socket_ctx *)ctx;
+	TEE_Result res = TEE_SUCCESS;
+
+	if (ctx == TEE_HANDLE_NULL || !buf || !length || !count)
+		TEE_Panic(0);
+
+	res = __tee_socket_pta_recv_batch(sock_ctx->handle, buf, length, count,
+					  timeout);
+	sock_ctx->proto_error = res;
+
+	return res;
+}
+
+bool tee_udpsocket_batch_next(const void *buf, uint32_t length,
+			      uint32_t *offs, const void **data,
+			      uint32_t *data_len)
+{
+	if (!buf || !offs || !data || !data_len)
+		TEE_Panic(0);
+
+	return pta_socket_batch_next(buf, length, offs, data, data_len);
+}
 
 static TEE_iSocket tcp_socket_instance = {
 	.TEE_iSocketVersion = TEE_ISOCKET_VERSION,
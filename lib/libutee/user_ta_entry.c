@@ -30,6 +30,29 @@ static TAILQ_HEAD(ta_sessions, ta_session) ta_sessions =
 
 static bool init_done;
 
+#if defined(CFG_TA_CONCURRENT)
+/* Protects ta_sessions and init_done against concurrent invocations */
+static struct tee_mutex ta_sessions_mutex = TEE_MUTEX_INITIALIZER;
+
+static void lock_sessions(void)
+{
+	tee_mutex_lock(&ta_sessions_mutex);
+}
+
+static void unlock_sessions(void)
+{
+	tee_mutex_unlock(&ta_sessions_mutex);
+}
+#else
+static void lock_sessions(void)
+{
+}
+
+static void unlock_sessions(void)
+{
+}
+#endif
+
 /* From user_ta_header.c, built within TA */
 extern uint8_t ta_heap[];
 extern const size_t ta_heap_size;
@@ -196,15 +219,26 @@ static void uninit_instance(void)
 static void ta_header_save_params(uint32_t param_types,
 				  TEE_Param params[TEE_NUM_PARAMS])
 {
-	ta_param_types = param_types;
+	uint32_t *types = &ta_param_types;
+	TEE_Param *p = ta_params;
+#if defined(CFG_TA_CONCURRENT)
+	struct utee_thread *thr = __utee_get_thread();
+
+	if (thr) {
+		types = &thr->param_types;
+		p = thr->params;
+	}
+#endif
+
+	*types = param_types;
 
 	if (params)
-		memcpy(ta_params, params, sizeof(ta_params));
+		memcpy(p, params, sizeof(ta_params));
 	else
-		memset(ta_params, 0, sizeof(ta_params));
+		memset(p, 0, sizeof(ta_params));
 }
 
-static struct ta_session *ta_header_get_session(uint32_t session_id)
+static struct ta_session *find_session(uint32_t session_id)
 {
 	struct ta_session *itr;
 
@@ -215,9 +249,27 @@ static struct ta_session *ta_header_get_session(uint32_t session_id)
 	return NULL;
 }
 
-static TEE_Result ta_header_add_session(uint32_t session_id)
+static struct ta_session *ta_header_get_session(uint32_t session_id)
 {
-	struct ta_session *itr = ta_header_get_session(session_id);
+	struct ta_session *itr = NULL;
+
+	lock_sessions();
+	itr = find_session(session_id);
+	unlock_sessions();
+
+	/*
+	 * A concurrent invocation gets its TLS blocks once the instance
+	 * is initialized
+	 */
+	if (itr && __utee_get_thread())
+		__utee_tcb_init();
+
+	return itr;
+}
+
+static TEE_Result add_session(uint32_t session_id)
+{
+	struct ta_session *itr = find_session(session_id);
 	TEE_Result res;
 
 	if (itr)
@@ -241,11 +293,23 @@ static TEE_Result ta_header_add_session(uint32_t session_id)
 	return TEE_SUCCESS;
 }
 
+static TEE_Result ta_header_add_session(uint32_t session_id)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	lock_sessions();
+	res = add_session(session_id);
+	unlock_sessions();
+
+	return res;
+}
+
 static void ta_header_remove_session(uint32_t session_id)
 {
 	struct ta_session *itr;
 	bool keep_alive;
 
+	lock_sessions();
 	TAILQ_FOREACH(itr, &ta_sessions, link) {
 		if (itr->session_id == session_id) {
 			TAILQ_REMOVE(&ta_sessions, itr, link);
@@ -257,9 +321,10 @@ static void ta_header_remove_session(uint32_t session_id)
 			if (TAILQ_EMPTY(&ta_sessions) && !keep_alive)
 				uninit_instance();
 
-			return;
+			break;
 		}
 	}
+	unlock_sessions();
 }
 
 static void to_utee_params(struct utee_params *up, uint32_t param_types,
@@ -420,6 +485,12 @@ TEE_Result __utee_entry(unsigned long func, unsigned long session_id,
 			struct utee_params *up, unsigned long cmd_id)
 {
 	TEE_Result res;
+#if defined(CFG_TA_CONCURRENT)
+	struct utee_thread thr = { };
+
+	if (ta_head.flags & TA_FLAG_CONCURRENT)
+		__utee_thread_enter(&thr);
+#endif
 
 	switch (func) {
 	case UTEE_ENTRY_FUNC_OPEN_SESSION:
@@ -441,6 +512,10 @@ TEE_Result __utee_entry(unsigned long func, unsigned long session_id,
 		break;
 	}
 	ta_header_save_params(0, NULL);
+#if defined(CFG_TA_CONCURRENT)
+	if (ta_head.flags & TA_FLAG_CONCURRENT)
+		__utee_thread_exit(&thr);
+#endif
 
 	return res;
 }
@@ -67,40 +67,160 @@ static __noprof struct ftrace_buf *get_fbuf(void)
 #endif
 }
 
-static void __noprof add_elem(struct ftrace_buf *fbuf, uint8_t level,
-			       uint64_t val)
+/* Max size of a LEB128 encoded 64-bit value */
+#define FTRACE_MAX_REC_SIZE	10
+
+#define FTRACE_NO_SLOT		UINT32_MAX
+
+static bool __noprof is_traced(struct ftrace_buf *fbuf __maybe_unused,
+			       unsigned long pc __maybe_unused)
 {
-	uint64_t *elem = NULL;
-	size_t idx = fbuf->curr_idx;
+#if defined(__KERNEL__)
+	/* The filter only holds TA functions, syscalls are always traced */
+	return true;
+#else
+	const struct ftrace_filter_func *f = NULL;
+	bool match = false;
+	size_t lo = 0;
+	size_t hi = 0;
+	size_t mid = 0;
 
-	/* Make sure the topmost byte doesn't contain useful information */
-	assert(!(val >> 56));
+	if (!fbuf->filter_num)
+		return true;
+
+	/*
+	 * Find the last filter function starting at or below @pc, the
+	 * _mcount call site in the instrumented function
+	 */
+	f = (const struct ftrace_filter_func *)((vaddr_t)fbuf +
+						fbuf->filter_off);
+	hi = fbuf->filter_num;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (f[mid].start <= pc)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	match = lo && pc < f[lo - 1].end;
 
-	elem = (uint64_t *)((vaddr_t)fbuf + fbuf->buf_off) + idx;
-	*elem = SHIFT_U64(level, 56) | val;
+	return match != !!(fbuf->flags & FTRACE_FILTER_EXCLUDE);
+#endif
+}
 
-	idx++;
-	if ((idx + 1) * sizeof(*elem) > fbuf->max_size) {
-		idx = 0;
+/*
+ * Records are LEB128 encoded. Once a record doesn't fit the buffer is
+ * considered full and tracing stops, keeping the beginning of the trace
+ * and a consistent stream.
+ */
+static void __noprof add_rec(struct ftrace_buf *fbuf, uint64_t val)
+{
+	uint8_t *p = (uint8_t *)fbuf + fbuf->buf_off + fbuf->curr_idx;
+	size_t n = 0;
+
+	if (fbuf->overflow)
+		return;
+
+	if (fbuf->curr_idx + FTRACE_MAX_REC_SIZE > fbuf->max_size) {
 		fbuf->overflow = true;
+		return;
+	}
+
+	while (val >= 0x80) {
+		p[n++] = val | 0x80;
+		val >>= 7;
+	}
+	p[n++] = val;
+
+	fbuf->curr_idx += n;
+}
+
+/*
+ * A function entry is encoded as the zigzag encoded difference from the
+ * previously traced function shifted left by two. The stack depth is
+ * implied by the sequence of entries and returns.
+ */
+static void __noprof add_entry(struct ftrace_buf *fbuf, uint64_t pc)
+{
+	uint64_t delta = pc - fbuf->last_pc;
+
+	/* Make sure the topmost byte doesn't contain useful information */
+	assert(!(pc >> 56));
+
+	fbuf->last_pc = pc;
+	add_rec(fbuf, ((delta << 1) ^ (uint64_t)((int64_t)delta >> 63)) << 2);
+}
+
+/* A function return is encoded as the duration shifted left by one, ORed 1 */
+static void __noprof add_return(struct ftrace_buf *fbuf, uint64_t elapsed)
+{
+	add_rec(fbuf, (elapsed << 1) | 1);
+}
+
+/*
+ * A depth record, the stack depth shifted left by two ORed 2, sets the
+ * depth the following records are relative to
+ */
+static void __noprof __maybe_unused add_depth(struct ftrace_buf *fbuf,
+					      uint64_t depth)
+{
+	add_rec(fbuf, (depth << 2) | 2);
+}
+
+static __noprof struct ftrace_func_stat *get_stats(struct ftrace_buf *fbuf)
+{
+	return (struct ftrace_func_stat *)((vaddr_t)fbuf + fbuf->buf_off);
+}
+
+/* Returns the index of the entry of the aggregated mode table for @pc */
+static uint32_t __noprof get_slot(struct ftrace_buf *fbuf, uint64_t pc)
+{
+	struct ftrace_func_stat *st = get_stats(fbuf);
+	size_t num = fbuf->max_size / sizeof(*st);
+	size_t idx = (size_t)(pc >> 2) % num;
+	size_t n = 0;
+
+	for (n = 0; n < num; n++) {
+		if (st[idx].pc == pc)
+			return idx;
+		if (!st[idx].pc) {
+			st[idx].pc = pc;
+			fbuf->curr_idx++;
+			return idx;
+		}
+		idx++;
+		if (idx == num)
+			idx = 0;
 	}
 
-	fbuf->curr_idx = idx;
+	fbuf->overflow = true;
+	return FTRACE_NO_SLOT;
 }
 
 void __noprof ftrace_enter(unsigned long pc, unsigned long *lr)
 {
 	uint64_t now = barrier_read_counter_timer();
 	struct ftrace_buf *fbuf = get_fbuf();
+	uint32_t slot = FTRACE_NO_SLOT;
 
 	if (!fbuf || !fbuf->buf_off || !fbuf->max_size)
 		return;
 
-	add_elem(fbuf, fbuf->ret_idx + 1, pc);
+	if (!is_traced(fbuf, pc))
+		return;
+
+	if (fbuf->flags & FTRACE_AGGREGATE) {
+		slot = get_slot(fbuf, pc);
+		if (slot != FTRACE_NO_SLOT)
+			get_stats(fbuf)[slot].calls++;
+	} else {
+		add_entry(fbuf, pc);
+	}
 
 	if (fbuf->ret_idx < FTRACE_RETFUNC_DEPTH) {
 		fbuf->ret_stack[fbuf->ret_idx] = *lr;
 		fbuf->begin_time[fbuf->ret_idx] = now;
+		fbuf->ret_slot[fbuf->ret_idx] = slot;
 		fbuf->ret_idx++;
 	} else {
 		/*
@@ -121,6 +241,7 @@ unsigned long __noprof ftrace_return(void)
 {
 	uint64_t now = barrier_read_counter_timer();
 	struct ftrace_buf *fbuf = get_fbuf();
+	uint32_t slot = FTRACE_NO_SLOT;
 	uint64_t start = 0;
 	uint64_t elapsed = 0;
 
@@ -131,16 +252,34 @@ unsigned long __noprof ftrace_return(void)
 	fbuf->ret_idx--;
 	start = fbuf->begin_time[fbuf->ret_idx];
 	elapsed = (now - start) * 1000000000 / read_cntfrq();
-	add_elem(fbuf, 0, elapsed);
+
+	if (fbuf->flags & FTRACE_AGGREGATE) {
+		slot = fbuf->ret_slot[fbuf->ret_idx];
+		if (slot != FTRACE_NO_SLOT)
+			get_stats(fbuf)[slot].total_ns += elapsed;
+	} else {
+		add_return(fbuf, elapsed);
+	}
 
 	return fbuf->ret_stack[fbuf->ret_idx];
 }
 
 #if !defined(__KERNEL__)
+/*
+ * The frames skipped by longjmp() get a return record each, then a depth
+ * record tells where the trace resumes. The decoder doesn't have to infer
+ * the depth across the jump.
+ */
 void __noprof ftrace_longjmp(unsigned int *ret_idx)
 {
-	while (__ftrace_buf_start.ret_idx > *ret_idx)
+	struct ftrace_buf *fbuf = &__ftrace_buf_start;
+
+	while (fbuf->ret_idx > *ret_idx)
 		ftrace_return();
+
+	if (fbuf->buf_off && fbuf->max_size &&
+	    !(fbuf->flags & FTRACE_AGGREGATE))
+		add_depth(fbuf, fbuf->ret_idx);
 }
 
 void __noprof ftrace_setjmp(unsigned int *ret_idx)
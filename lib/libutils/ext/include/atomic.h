@@ -63,4 +63,20 @@ static inline void atomic_store_u32(uint32_t *p, uint32_t val)
 	__compiler_atomic_store(p, val);
 }
 
+/*
+ * Acquire/release variants, used when the value guards access to other
+ * memory, for instance the indexes of a single producer/single consumer
+ * ring buffer.
+ */
+static inline unsigned int atomic_load_acquire_uint(unsigned int *p)
+{
+	return __compiler_atomic_load_acquire(p);
+}
+
+static inline void atomic_store_release_uint(unsigned int *p,
+					     unsigned int val)
+{
+	__compiler_atomic_store_release(p, val);
+}
+
 #endif /*__ATOMIC_H*/
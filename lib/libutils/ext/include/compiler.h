@@ -263,6 +263,10 @@
 #define __compiler_atomic_load(p) __atomic_load_n((p), __ATOMIC_RELAXED)
 #define __compiler_atomic_store(p, val) \
 	__atomic_store_n((p), (val), __ATOMIC_RELAXED)
+#define __compiler_atomic_load_acquire(p) \
+	__atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define __compiler_atomic_store_release(p, val) \
+	__atomic_store_n((p), (val), __ATOMIC_RELEASE)
 
 #define barrier() asm volatile ("" : : : "memory")
 
@@ -131,6 +131,28 @@ struct malloc_pool {
 	size_t len;
 };
 
+#if defined(CFG_TA_MALLOC_TCACHE) && !defined(__KERNEL__) && \
+	!defined(__LDELF__) && !defined(ENABLE_MDBG)
+#define WITH_TCACHE
+
+/*
+ * Small buffers released by a TA are kept in per size class bins in front
+ * of bget, from which allocations of the same size class are served in
+ * constant time. The buffers in the bins are still allocated from the
+ * bget point of view, each bin holds at most TCACHE_BIN_MAX_COUNT buffers
+ * and the bins are flushed back to bget when an allocation fails.
+ */
+#define TCACHE_MAX_SIZE		256
+#define TCACHE_NUM_BINS		(TCACHE_MAX_SIZE / SizeQuant)
+#define TCACHE_BIN_MAX_COUNT	16
+
+struct tcache {
+	void *bin[TCACHE_NUM_BINS];	/* Buffers linked via their first word */
+	uint8_t count[TCACHE_NUM_BINS];
+	size_t bytes;			/* bget block bytes held in the bins */
+};
+#endif
+
 struct malloc_ctx {
 	struct bpoolset poolset;
 	struct malloc_pool *pool;
@@ -141,6 +163,9 @@ struct malloc_ctx {
 #ifdef __KERNEL__
 	unsigned int spinlock;
 #endif
+#ifdef WITH_TCACHE
+	struct tcache tcache;
+#endif
 };
 
 #ifdef __KERNEL__
@@ -155,6 +180,24 @@ static void malloc_unlock(struct malloc_ctx *ctx, uint32_t exceptions)
 	cpu_spin_unlock_xrestore(&ctx->spinlock, exceptions);
 }
 
+#elif defined(CFG_TA_CONCURRENT) && !defined(__LDELF__)
+
+/* Provided by libutee, invocations of a TA may run concurrently */
+void __utee_malloc_lock(void);
+void __utee_malloc_unlock(void);
+
+static uint32_t malloc_lock(struct malloc_ctx *ctx __unused)
+{
+	__utee_malloc_lock();
+	return 0;
+}
+
+static void malloc_unlock(struct malloc_ctx *ctx __unused,
+			  uint32_t exceptions __unused)
+{
+	__utee_malloc_unlock();
+}
+
 #else  /* __KERNEL__ */
 
 static uint32_t malloc_lock(struct malloc_ctx *ctx __unused)
@@ -270,14 +313,148 @@ static void tag_asan_free(void *buf __maybe_unused, size_t len __maybe_unused)
 #endif
 }
 
+#ifdef WITH_TCACHE
+static size_t tcache_block_size(void *buf)
+{
+	return bget_buf_size(buf) + sizeof(struct bhead);
+}
+
+static void *tcache_get(struct malloc_ctx *ctx, size_t size)
+{
+	struct tcache *tc = &ctx->tcache;
+	size_t idx = 0;
+	void *p = NULL;
+
+	if (size > TCACHE_MAX_SIZE || MEMTAG_IS_ENABLED)
+		return NULL;
+
+	idx = ROUNDUP(MAX(size, (size_t)1), SizeQuant) / SizeQuant - 1;
+	p = tc->bin[idx];
+	if (p) {
+		tc->bin[idx] = *(void **)p;
+		tc->count[idx]--;
+		tc->bytes -= tcache_block_size(p);
+	}
+
+	return p;
+}
+
+static bool tcache_put(struct malloc_ctx *ctx, void *buf)
+{
+	struct tcache *tc = &ctx->tcache;
+	void *p __maybe_unused = NULL;
+	size_t sz = 0;
+	size_t idx = 0;
+
+	if (MEMTAG_IS_ENABLED)
+		return false;
+
+	sz = bget_buf_size(buf);
+	if (sz > TCACHE_MAX_SIZE)
+		return false;
+
+	/* Round down, the buffer must fit any size of its class */
+	idx = sz / SizeQuant - 1;
+	if (tc->count[idx] >= TCACHE_BIN_MAX_COUNT)
+		return false;
+
+	/*
+	 * A buffer freed twice would be handed out twice, check it like
+	 * brel() checks the buffers it releases
+	 */
+	for (p = tc->bin[idx]; p; p = *(void **)p)
+		assert(p != buf);
+
+	*(void **)buf = tc->bin[idx];
+	tc->bin[idx] = buf;
+	tc->count[idx]++;
+	tc->bytes += tcache_block_size(buf);
+
+	return true;
+}
+
+/* Returns true if any buffer was released to bget */
+static bool tcache_flush(struct malloc_ctx *ctx)
+{
+	struct tcache *tc = &ctx->tcache;
+	bool flushed = false;
+	void *p = NULL;
+	size_t n = 0;
+
+	for (n = 0; n < TCACHE_NUM_BINS; n++) {
+		while (tc->bin[n]) {
+			p = tc->bin[n];
+			tc->bin[n] = *(void **)p;
+			brel(p, &ctx->poolset, false /*!wipe*/);
+			flushed = true;
+		}
+		tc->count[n] = 0;
+	}
+	tc->bytes = 0;
+
+	return flushed;
+}
+
+static bool tcache_contains(struct malloc_ctx *ctx, void *buf)
+{
+	struct tcache *tc = &ctx->tcache;
+	void *p = NULL;
+	size_t n = 0;
+
+	for (n = 0; n < TCACHE_NUM_BINS; n++)
+		for (p = tc->bin[n]; p; p = *(void **)p)
+			if (p == buf)
+				return true;
+
+	return false;
+}
+
+static __maybe_unused size_t tcache_bytes(struct malloc_ctx *ctx)
+{
+	return ctx->tcache.bytes;
+}
+#else
+static void *tcache_get(struct malloc_ctx *ctx __unused, size_t size __unused)
+{
+	return NULL;
+}
+
+static bool tcache_put(struct malloc_ctx *ctx __unused, void *buf __unused)
+{
+	return false;
+}
+
+static bool tcache_flush(struct malloc_ctx *ctx __unused)
+{
+	return false;
+}
+
+static bool tcache_contains(struct malloc_ctx *ctx __unused,
+			    void *buf __unused)
+{
+	return false;
+}
+
+static __maybe_unused size_t tcache_bytes(struct malloc_ctx *ctx __unused)
+{
+	return 0;
+}
+#endif
+
 #ifdef BufStats
 
+/* Buffers held in the tcache bins are not accounted as allocated */
+static bufsize allocated_bytes(struct malloc_ctx *ctx)
+{
+	return ctx->poolset.totalloc - tcache_bytes(ctx);
+}
+
 static void *raw_malloc_return_hook(void *p, size_t hdr_size,
 				    size_t requested_size,
 				    struct malloc_ctx *ctx)
 {
-	if (ctx->poolset.totalloc > ctx->mstats.max_allocated)
-		ctx->mstats.max_allocated = ctx->poolset.totalloc;
+	if (allocated_bytes(ctx) > ctx->mstats.max_allocated)
+		ctx->mstats.max_allocated = allocated_bytes(ctx);
 
 	if (!p) {
 		ctx->mstats.num_alloc_fail++;
@@ -285,7 +462,7 @@ static void *raw_malloc_return_hook(void *p, size_t hdr_size,
 		if (requested_size > ctx->mstats.biggest_alloc_fail) {
 			ctx->mstats.biggest_alloc_fail = requested_size;
 			ctx->mstats.biggest_alloc_fail_used =
-				ctx->poolset.totalloc;
+				allocated_bytes(ctx);
 		}
 	}
 
@@ -438,6 +615,8 @@ void *raw_memalign(size_t hdr_size, size_t ftr_size, size_t alignment,
 		s++;
 
 	ptr = bget(alignment, hdr_size, s, &ctx->poolset);
+	if (!ptr && tcache_flush(ctx))
+		ptr = bget(alignment, hdr_size, s, &ctx->poolset);
 out:
 	return raw_malloc_return_hook(ptr, hdr_size, pl_size, ctx);
 }
@@ -445,6 +624,14 @@ out:
 void *raw_malloc(size_t hdr_size, size_t ftr_size, size_t pl_size,
 		 struct malloc_ctx *ctx)
 {
+	void *ptr = NULL;
+
+	if (!hdr_size && !ftr_size) {
+		ptr = tcache_get(ctx, pl_size);
+		if (ptr)
+			return raw_malloc_return_hook(ptr, 0, pl_size, ctx);
+	}
+
 	/*
 	 * Note that we're feeding SizeQ as alignment, this is the smallest
 	 * alignment that bget() can use.
@@ -456,7 +643,7 @@ void raw_free(void *ptr, struct malloc_ctx *ctx, bool wipe)
 {
 	raw_malloc_validate_pools(ctx);
 
-	if (ptr)
+	if (ptr && (wipe || !tcache_put(ctx, ptr)))
 		brel(maybe_untag_buf(ptr), &ctx->poolset, wipe);
 }
 
@@ -474,11 +661,21 @@ void *raw_calloc(size_t hdr_size, size_t ftr_size, size_t pl_nmemb,
 	if (ADD_OVERFLOW(s, ftr_size, &s))
 		goto out;
 
+	if (!hdr_size && !ftr_size) {
+		ptr = tcache_get(ctx, s);
+		if (ptr) {
+			memset_unchecked(ptr, 0, s);
+			goto out;
+		}
+	}
+
 	/* BGET doesn't like 0 sized allocations */
 	if (!s)
 		s++;
 
 	ptr = bgetz(0, hdr_size, s, &ctx->poolset);
+	if (!ptr && tcache_flush(ctx))
+		ptr = bgetz(0, hdr_size, s, &ctx->poolset);
 out:
 	return raw_malloc_return_hook(ptr, hdr_size, pl_nmemb * pl_size, ctx);
 }
@@ -502,6 +699,8 @@ void *raw_realloc(void *ptr, size_t hdr_size, size_t ftr_size,
 		s++;
 
 	p = bget(0, 0, s, &ctx->poolset);
+	if (!p && tcache_flush(ctx))
+		p = bget(0, 0, s, &ctx->poolset);
 
 	if (p && ptr) {
 		void *old_ptr = maybe_untag_buf(ptr);
@@ -990,7 +1189,7 @@ bool raw_malloc_buffer_is_within_alloced(struct malloc_ctx *ctx,
 		start_b = strip_tag(get_payload_start_size(b, &s));
 		end_b = start_b + s;
 		if (start_buf >= start_b && end_buf <= end_b)
-			return true;
+			return !tcache_contains(ctx, b);
 	}
 
 	return false;
@@ -1000,7 +1199,7 @@ bool raw_malloc_buffer_is_within_alloced(struct malloc_ctx *ctx,
 void raw_malloc_get_stats(struct malloc_ctx *ctx, struct pta_stats_alloc *stats)
 {
 	memcpy_unchecked(stats, &ctx->mstats, sizeof(*stats));
-	stats->allocated = ctx->poolset.totalloc;
+	stats->allocated = allocated_bytes(ctx);
 }
 #endif
 
@@ -537,6 +537,13 @@ CFG_TEE_CORE_EMBED_INTERNAL_TESTS ?= $(CFG_ENABLE_EMBEDDED_TESTS)
 # Compiles bget_main_test() to be called from a test TA
 CFG_TA_BGET_TEST ?= $(CFG_ENABLE_EMBEDDED_TESTS)
 
+# CFG_TA_MALLOC_TCACHE, when enabled, keeps small buffers freed by a TA in
+# bounded per size class bins in front of the TA heap allocator, so that
+# allocations of up to 256 bytes are usually served in constant time.
+# Buffers released with free_wipe() bypass the bins. A buffer freed twice
+# is only caught while it is still in its bin.
+CFG_TA_MALLOC_TCACHE ?= n
+
 # CFG_DT_DRIVER_EMBEDDED_TEST when enabled embedded DT driver probing tests.
 # This also requires embedding a DTB with expected content.
 # Default disable CFG_DRIVERS_CLK_EARLY_PROBE to probe clocks as other drivers.
@@ -567,6 +574,13 @@ CFG_CORE_HEAP_SIZE ?= 65536
 # is enabled
 CFG_CORE_NEX_HEAP_SIZE ?= 16384
 
+# Slab caches for small fixed size core objects. When enabled, frequently
+# allocated objects are carved from pages of secure DDR, or of the heap when
+# none is available, and recycled through per-CPU magazines instead of going
+# through malloc() each time.
+# When disabled, the slab API falls back to malloc() and free().
+CFG_CORE_SLAB ?= n
+
 # TA profiling.
 # When this option is enabled, OP-TEE can execute Trusted Applications
 # instrumented with GCC's -pg flag and will output profiling information
@@ -584,6 +598,10 @@ CFG_TA_GPROF_SUPPORT ?= n
 # instrumented with GCC's -pg flag and will output function tracing
 # information for all functions compiled with -pg to
 # /tmp/ftrace-<ta_uuid>.out (path is defined in tee-supplicant).
+# Use scripts/ftrace_format.py to convert the output to text. A TA can
+# restrict tracing to, or exclude, a set of functions and select an
+# aggregated mode which only keeps per-function call counts and cumulative
+# time with FTRACE_FILTER() from <user_ta_header.h>.
 CFG_FTRACE_SUPPORT ?= n
 
 # Core syscall function tracing.
@@ -593,6 +611,15 @@ CFG_FTRACE_SUPPORT ?= n
 CFG_SYSCALL_FTRACE ?= n
 $(call cfg-depends-all,CFG_SYSCALL_FTRACE,CFG_FTRACE_SUPPORT)
 
+# Core event tracing.
+# When this option is enabled, static tracepoints on the standard call,
+# RPC, syscall and pager paths record timestamped events in lock-free
+# per-CPU ring buffers of CFG_CORE_EVTRACE_NUM_ENTRIES entries (a power
+# of two). The evtrace pseudo TA enables the tracepoints and drains the
+# ring buffers into normal world buffers.
+CFG_CORE_EVTRACE ?= n
+CFG_CORE_EVTRACE_NUM_ENTRIES ?= 256
+
 # Enable to compile user TA libraries with profiling (-pg).
 # Depends on CFG_TA_GPROF_SUPPORT or CFG_FTRACE_SUPPORT.
 CFG_ULIBS_MCOUNT ?= n
@@ -623,6 +650,14 @@ endif
 # Enable Global Platform Sockets support
 CFG_GP_SOCKETS ?= y
 
+# CFG_SOCKET_LOOPBACK, when enabled, serves the socket requests of the socket
+# PTA in OP-TEE core instead of tee-supplicant, for testing. What's sent on a
+# socket is received on the same socket and nothing ever blocks. It's the only
+# in-tree implementation of OPTEE_RPC_SOCKET_POLL and
+# OPTEE_RPC_SOCKET_RECV_BATCH.
+CFG_SOCKET_LOOPBACK ?= n
+$(eval $(call cfg-depends-all,CFG_SOCKET_LOOPBACK,CFG_GP_SOCKETS))
+
 # Enable Secure Data Path support in OP-TEE core (TA may be invoked with
 # invocation parameters referring to specific secure memories).
 CFG_SECURE_DATA_PATH ?= n
@@ -1012,6 +1047,38 @@ $(eval $(call cfg-depends-one,CFG_PAN,CFG_ARM64_core CFG_RV64_core CFG_RV32_core
 # CFG_CORE_ASYNC_NOTIF_GIC_INTID defined.
 CFG_CORE_ASYNC_NOTIF ?= n
 
+# CFG_CORE_PARALLEL_WORKERS, when enabled, lets the threads delivering the
+# asynchronous notification bottom half help with parallel_for() jobs, for
+# instance hashing the subtrees of the secure storage hash trees.
+# CFG_CORE_PARALLEL_MAX_WORKERS is the maximum number of helper threads of
+# a job.
+CFG_CORE_PARALLEL_WORKERS ?= n
+CFG_CORE_PARALLEL_MAX_WORKERS ?= 2
+$(eval $(call cfg-depends-all,CFG_CORE_PARALLEL_WORKERS,CFG_CORE_ASYNC_NOTIF))
+
+# CFG_DEFERRED_WORK, when enabled, lets the threads delivering the
+# asynchronous notification bottom half run work deferred out of the
+# latency path of its caller, see <kernel/deferred_work.h>.
+CFG_DEFERRED_WORK ?= n
+$(eval $(call cfg-depends-all,CFG_DEFERRED_WORK,CFG_CORE_ASYNC_NOTIF))
+
+# CFG_SCMI_MSG_PERF_DOMAIN_ASYNC, when enabled, answers the SCMI performance
+# level set requests once the level is checked and sets the level from a
+# deferred work, see plat_scmi_perf_level_set_done().
+CFG_SCMI_MSG_PERF_DOMAIN_ASYNC ?= n
+$(eval $(call cfg-depends-all,CFG_SCMI_MSG_PERF_DOMAIN_ASYNC, \
+	 CFG_SCMI_MSG_PERF_DOMAIN CFG_DEFERRED_WORK))
+
+# CFG_TIMER_WHEEL adds timers driven by the Armv8-A secure physical timer,
+# see <kernel/timer_wheel.h>. The platform registers the timer interrupt
+# with timer_wheel_init(). CFG_TIMER_WHEEL_TICK_MS is the resolution of the
+# timers. The wheel replaces the generic_timer_*() functions, platforms
+# using these force CFG_TIMER_WHEEL=n. It can't be combined with
+# CFG_CORE_PROF_SAMPLING which uses the same timer.
+CFG_TIMER_WHEEL ?= n
+CFG_TIMER_WHEEL_TICK_MS ?= 10
+$(eval $(call cfg-depends-all,CFG_TIMER_WHEEL,CFG_ARM64_core))
+
 $(eval $(call cfg-enable-all-depends,CFG_MEMPOOL_REPORT_LAST_OFFSET, \
 	 CFG_WITH_STATS))
 
@@ -1084,6 +1151,41 @@ ifeq (y-y,$(CFG_CORE_PREALLOC_EL0_TBLS)-$(CFG_WITH_PAGER))
 $(error "CFG_WITH_PAGER can't support CFG_CORE_PREALLOC_EL0_TBLS")
 endif
 
+# CFG_TA_CONCURRENT, when enabled, lets user TAs with TA_FLAG_CONCURRENT in
+# their header run several invocations at the same time, each on its own
+# user stack. Such TAs can use the tee_mutex_*() and tee_condvar_*()
+# extensions. CFG_TA_CONCURRENT_MAX_THREADS is the maximum number of
+# invocations of one TA instance running at the same time, further
+# invocations wait. The cryptographic and storage syscalls of an instance
+# are still serialized, since its operations, objects and enumerators are
+# shared by its invocations.
+# The translation tables of a TA are shared by its threads so they must
+# not be recycled while the TA is running, hence the dependency on
+# CFG_CORE_PREALLOC_EL0_TBLS. This also means that the memory reference
+# parameters of an invocation are accessible by the other invocations.
+CFG_TA_CONCURRENT ?= n
+CFG_TA_CONCURRENT_MAX_THREADS ?= 4
+$(eval $(call cfg-depends-all,CFG_TA_CONCURRENT,CFG_CORE_PREALLOC_EL0_TBLS CFG_ARM64_core))
+
+# CFG_TA_INSTANCE_POOL, when enabled, keeps instances of multi instance user
+# TAs loaded ahead of time so that opening a session doesn't have to run
+# ldelf. The instances are loaded by the threads delivering the asynchronous
+# notification bottom half. Installing a TA in secure storage releases its
+# preloaded instances, and an instance loaded before the TA was installed is
+# evicted rather than handed out when a session is opened. The REE file
+# system doesn't report replaced TAs, such a TA is only picked up once its
+# instances are released or its pool entry is recycled.
+# CFG_TA_INSTANCE_POOL_MAX_TAS is the number of TAs with preloaded instances,
+# the least recently used TA is dropped when another one is loaded.
+# CFG_TA_INSTANCE_POOL_PER_TA is the maximum number of preloaded instances
+# of a TA and CFG_TA_INSTANCE_POOL_TA_BUDGET the maximum number of bytes
+# mapped by them. Each preloaded instance also uses an ASID.
+CFG_TA_INSTANCE_POOL ?= n
+CFG_TA_INSTANCE_POOL_MAX_TAS ?= 4
+CFG_TA_INSTANCE_POOL_PER_TA ?= 2
+CFG_TA_INSTANCE_POOL_TA_BUDGET ?= 1048576
+$(eval $(call cfg-depends-all,CFG_TA_INSTANCE_POOL,CFG_WITH_USER_TA CFG_CORE_ASYNC_NOTIF))
+
 
 # CFG_DRIVERS_REMOTEPROC, when enabled, embeds support for remote processor
 # management including generic DT bindings for the configuration.
@@ -6,13 +6,29 @@
 # Converts a ftrace binary file to text. The input file has the following
 # format:
 #
-#  <ASCII text> <zero or more nul bytes> FTRACE\x00\x01 <binary data>...
+#  <ASCII text> <zero or more nul bytes> FTRACE <mode> <version> <binary data>
 #
-# <binary data> is an array of 64-bit integers.
+# With version 1, <binary data> is an array of 64-bit integers.
 # - When the topmost byte is 0, the entry indicates a function return and the
 # remaining bytes are a duration in nanoseconds.
 # - A non-zero value is a stack depth, indicating a function entry, and the
 # remaining bytes are the function's address.
+#
+# With version 2 and mode 0, <binary data> is a sequence of LEB128 encoded
+# records. The stack depth is implied by the sequence of entries and returns,
+# except after a depth record.
+# - When bit 0 is set, the record indicates a function return and the
+# remaining bits are a duration in nanoseconds.
+# - When bits 1:0 are 0b00, the record indicates a function entry and the
+# remaining bits are the zigzag encoded difference between the function's
+# address and the address of the previous function entry.
+# - When bits 1:0 are 0b10, the remaining bits are the stack depth the next
+# records are relative to. It follows the returns of the functions skipped
+# by longjmp().
+#
+# With version 2 and mode 1 (aggregated mode), <binary data> is an array of
+# struct ftrace_func_stat, that is three 64-bit integers: function address,
+# number of calls and cumulative time in nanoseconds.
 
 import sys
 
@@ -57,22 +73,90 @@ def display(depth, val):
                       " " * curr_depth + "}")
 
 
+def decode_v1(s):
+    for i in range(0, len(s), 8):
+        elem = int.from_bytes(s[i:i + 8], byteorder="little", signed=False)
+        depth = elem >> 56
+        val = elem & 0xFFFFFFFFFFFFFF
+        display(depth, val)
+
+
+def reset_depth(depth, new_depth):
+    global line, curr_depth
+    if depth > new_depth and line != "":
+        print(line.replace("TIME", " " * 10) + " {")
+        line = ""
+    # Functions left without a return record
+    while depth > new_depth:
+        print(" " * 12 + f"| {depth:3} | " + " " * depth + "} (longjmp)")
+        depth -= 1
+    curr_depth = new_depth + 1
+    return new_depth
+
+
+def decode_v2(s):
+    depth = 0
+    pc = 0
+    val = 0
+    shift = 0
+    for b in s:
+        val |= (b & 0x7f) << shift
+        shift += 7
+        if b & 0x80:
+            continue
+        if val & 1:
+            display(0, val >> 1)
+            depth = max(depth - 1, 0)
+        elif val & 2:
+            depth = reset_depth(depth, val >> 2)
+        else:
+            zz = val >> 2
+            pc = (pc + ((zz >> 1) ^ -(zz & 1))) & 0xFFFFFFFFFFFFFFFF
+            depth += 1
+            display(depth, pc)
+        val = 0
+        shift = 0
+    if line != "":
+        print(line.replace("TIME", " " * 10))
+    if depth:
+        print(f"Trace truncated, {depth} function(s) still active")
+
+
+def decode_aggregated(s):
+    stats = []
+    for i in range(0, len(s) - 23, 24):
+        pc, calls, total = [int.from_bytes(s[j:j + 8], byteorder="little")
+                            for j in range(i, i + 24, 8)]
+        stats.append((total, calls, pc))
+    print("     total |    calls |    average | function")
+    for total, calls, pc in sorted(stats, reverse=True):
+        avg = total // calls if calls else 0
+        print(f"{format_time(total)} | {calls:8} | {format_time(avg)} | " +
+              f"0x{pc:016x}()")
+
+
 def main():
     if len(sys.argv) < 2:
         usage()
     with open(sys.argv[1], 'rb') as f:
         s = f.read()
-    magic = s.find(b'FTRACE\x00\x01')
-    if magic == -1:
+    magic = s.find(b'FTRACE')
+    if magic == -1 or len(s) < magic + 8:
         print("Magic not found", file=sys.stderr)
         sys.exit(1)
     print(s[:magic].rstrip(b'\x00').decode())
+    mode = s[magic + 6]
+    version = s[magic + 7]
     s = s[magic + 8:]
-    for i in range(0, len(s), 8):
-        elem = int.from_bytes(s[i:i + 8], byteorder="little", signed=False)
-        depth = elem >> 56
-        val = elem & 0xFFFFFFFFFFFFFF
-        display(depth, val)
+    if version == 1:
+        decode_v1(s)
+    elif version == 2 and mode == 0:
+        decode_v2(s)
+    elif version == 2 and mode == 1:
+        decode_aggregated(s)
+    else:
+        print(f"Unsupported format {mode}.{version}", file=sys.stderr)
+        sys.exit(1)
 
 
 if __name__ == "__main__":
@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: BSD-2-Clause
+#
+# Copyright (c) 2026, The OP-TEE Project Contributors
+#
+# Symbolizes the collapsed stacks exported by the core profiler pseudo-TA
+# (CFG_CORE_PROF_SAMPLING=y). The output can be fed directly to flame graph
+# tools, or reduced to a flat profile with --flat.
+#
+
+import argparse
+import subprocess
+import sys
+from collections import Counter
+
+
+def get_args():
+    parser = argparse.ArgumentParser(
+        description='Symbolizes collapsed stacks from the OP-TEE core '
+                    'profiler, reading from stdin and writing to stdout.')
+    parser.add_argument('-e', '--elf', required=True,
+                        help='Path to tee.elf')
+    parser.add_argument('--flat', action='store_true',
+                        help='Print a flat profile of the sampled functions '
+                             'instead of collapsed stacks')
+    parser.add_argument('--cross-compile', default='',
+                        help='Toolchain prefix, for instance aarch64-linux-'
+                             'gnu-')
+    return parser.parse_args()
+
+
+def get_text_start(args):
+    out = subprocess.check_output([args.cross_compile + 'nm', args.elf])
+    for line in out.decode().splitlines():
+        f = line.split()
+        if len(f) == 3 and f[2] == '__text_start':
+            return int(f[0], 16)
+    sys.exit('__text_start not found in ' + args.elf)
+
+
+def symbolize(args, offsets):
+    text_start = get_text_start(args)
+    offsets = sorted(offsets)
+    # Offsets are stored as (offset, is_leaf). Except for the sampled PC,
+    # frames are return addresses pointing past the call, so look up the
+    # call instruction instead.
+    addrs = ['0x{:x}'.format(text_start + o - (0 if leaf else 4))
+             for o, leaf in offsets]
+    out = subprocess.check_output([args.cross_compile + 'addr2line', '-f',
+                                   '-e', args.elf] + addrs)
+    lines = out.decode().splitlines()
+    return {o: lines[2 * n] for n, o in enumerate(offsets)}
+
+
+def main():
+    args = get_args()
+    stacks = []
+    offsets = set()
+
+    for line in sys.stdin:
+        line = line.strip()
+        if not line:
+            continue
+        frames, count = line.rsplit(' ', 1)
+        frames = frames.split(';')
+        stacks.append((frames, int(count)))
+        for n, f in enumerate(frames):
+            if not f.startswith('['):
+                offsets.add((int(f, 16), n == len(frames) - 1))
+
+    syms = symbolize(args, offsets) if offsets else {}
+
+    def name(f, leaf):
+        return f if f.startswith('[') else syms[(int(f, 16), leaf)]
+
+    if not args.flat:
+        collapsed = Counter()
+        for frames, count in stacks:
+            collapsed[';'.join(name(f, n == len(frames) - 1)
+                               for n, f in enumerate(frames))] += count
+        for s, count in collapsed.items():
+            print('{} {}'.format(s, count))
+        return
+
+    flat = Counter()
+    for frames, count in stacks:
+        flat[name(frames[-1], True)] += count
+    total = sum(flat.values())
+    for func, count in flat.most_common():
+        print('{:6.2f}% {:8d} {}'.format(100.0 * count / total, count, func))
+
+
+if __name__ == '__main__':
+    main()
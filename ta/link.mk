@@ -44,6 +44,7 @@ $(link-out-dir$(sm))/dyn_list: FORCE
 	$(q)echo "__elf_phdr_info;" >>$@.tmp
 ifeq ($(CFG_FTRACE_SUPPORT),y)
 	$(q)echo "__ftrace_info;" >>$@.tmp
+	$(q)echo "__ftrace_filter;" >>$@.tmp
 endif
 	$(q)echo "trace_ext_prefix;" >>$@.tmp
 	$(q)echo "trace_level;" >>$@.tmp
@@ -68,6 +69,14 @@ link-ldadd-after-libgcc += $(addprefix -l,$(libnames-after-libgcc))
 ldargs-$(user-ta-uuid).elf := $(link-ldflags) $(objs) $(link-ldadd) \
 				$(libgcc$(sm)) $(link-ldadd-after-libgcc)
 
+# ldelf reads the sizes of the functions of an ftrace filter from the symbol
+# table, see FTRACE_FILTER()
+ifeq ($(CFG_FTRACE_SUPPORT),y)
+strip-flags$(sm) := --strip-debug
+else
+strip-flags$(sm) := --strip-unneeded
+endif
+
 link-script-cppflags-$(sm) := \
 	$(filter-out $(CPPFLAGS_REMOVE) $(cppflags-remove), \
 		$(nostdinc$(sm)) $(CPPFLAGS) \
@@ -101,7 +110,7 @@ $(link-out-dir$(sm))/$(user-ta-uuid).dmp: \
 $(link-out-dir$(sm))/$(user-ta-uuid).stripped.elf: \
 			$(link-out-dir$(sm))/$(user-ta-uuid).elf
 	@$(cmd-echo-silent) '  OBJCOPY $$@'
-	$(q)$(OBJCOPY$(sm)) --strip-unneeded $$< $$@
+	$(q)$(OBJCOPY$(sm)) $(strip-flags$(sm)) $$< $$@
 
 cmd-echo$(user-ta-uuid) := SIGN   #
 ifeq ($(CFG_ENCRYPT_TA),y)
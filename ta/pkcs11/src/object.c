@@ -212,6 +212,7 @@ enum pkcs11_rc create_object(void *sess, struct obj_attrs *head,
 	struct pkcs11_object *obj = NULL;
 	struct pkcs11_session *session = (struct pkcs11_session *)sess;
 	uint32_t obj_handle = 0;
+	bool tx = false;
 
 #ifdef DEBUG
 	trace_attributes("[create]", head);
@@ -249,12 +250,20 @@ enum pkcs11_rc create_object(void *sess, struct obj_attrs *head,
 		uint32_t tee_obj_flags = TEE_DATA_FLAG_ACCESS_READ |
 					 TEE_DATA_FLAG_ACCESS_WRITE |
 					 TEE_DATA_FLAG_ACCESS_WRITE_META;
+		struct ck_token *token = get_session_token(session);
+		uint32_t storage = TEE_STORAGE_PRIVATE;
 
-		rc = create_object_uuid(get_session_token(session), obj);
+		rc = create_object_uuid(token, obj);
 		if (rc)
 			goto err;
 
-		res = TEE_CreatePersistentObject(TEE_STORAGE_PRIVATE,
+		/*
+		 * Commit the object and the updated database at once where
+		 * the storage supports it
+		 */
+		tx = !tee_begin_persistent_object_transaction(storage);
+
+		res = TEE_CreatePersistentObject(storage,
 						 obj->uuid, sizeof(TEE_UUID),
 						 tee_obj_flags,
 						 TEE_HANDLE_NULL,
@@ -273,6 +282,17 @@ enum pkcs11_rc create_object(void *sess, struct obj_attrs *head,
 		TEE_CloseObject(obj->attribs_hdl);
 		obj->attribs_hdl = TEE_HANDLE_NULL;
 
+		if (tx) {
+			tx = false;
+			res = tee_commit_persistent_object_transaction(storage);
+			if (res) {
+				/* Drop the object from the database in memory */
+				unregister_persistent_object(token, obj->uuid);
+				rc = tee2pkcs_error(res);
+				goto err;
+			}
+		}
+
 		/* Move object from temporary list to target token list */
 		LIST_REMOVE(obj, link);
 		LIST_INSERT_HEAD(&session->token->object_list, obj, link);
@@ -286,6 +306,8 @@ enum pkcs11_rc create_object(void *sess, struct obj_attrs *head,
 
 	return PKCS11_CKR_OK;
 err:
+	if (tx)
+		tee_abort_persistent_object_transaction(TEE_STORAGE_PRIVATE);
 	/* make sure that supplied "head" isn't freed */
 	obj->attributes = NULL;
 	handle_put(get_object_handle_db(session), obj_handle);
@@ -1208,6 +1208,42 @@ out:
 	return res;
 }
 
+/* Returns the milliseconds elapsed since @t and updates @t to now */
+static uint32_t elapsed_ms(TEE_Time *t)
+{
+	TEE_Time prev = *t;
+
+	TEE_GetSystemTime(t);
+
+	return (t->seconds - prev.seconds) * 1000 + t->millis - prev.millis;
+}
+
+static void remoteproc_report_load_time(struct remoteproc_context *ctx,
+					uint32_t auth_ms, uint32_t load_ms)
+{
+	uint32_t param_types = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+					       TEE_PARAM_TYPE_VALUE_OUTPUT,
+					       TEE_PARAM_TYPE_VALUE_OUTPUT,
+					       TEE_PARAM_TYPE_NONE);
+	TEE_Param params[TEE_NUM_PARAMS] = { };
+	TEE_Result res = TEE_ERROR_GENERIC;
+
+	params[0].value.a = ctx->rproc_id;
+
+	res = TEE_InvokeTACommand(pta_session, TEE_TIMEOUT_INFINITE,
+				  PTA_REMOTEPROC_GET_LOAD_STATS, param_types,
+				  params, NULL);
+	if (res) {
+		IMSG("Firmware %"PRIu32" authenticated in %"PRIu32" ms, loaded in %"PRIu32" ms",
+		     ctx->rproc_id, auth_ms, load_ms);
+		return;
+	}
+
+	IMSG("Firmware %"PRIu32" authenticated in %"PRIu32" ms, loaded in %"PRIu32" ms (copy %"PRIu32" us, hash %"PRIu32" us, decrypt %"PRIu32" us)",
+	     ctx->rproc_id, auth_ms, load_ms, params[1].value.a,
+	     params[1].value.b, params[2].value.a);
+}
+
 static TEE_Result remoteproc_load_fw(uint32_t pt,
 				     TEE_Param params[TEE_NUM_PARAMS])
 {
@@ -1219,6 +1255,9 @@ static TEE_Result remoteproc_load_fw(uint32_t pt,
 	uint32_t rproc_id = params[0].value.a;
 	TEE_Result res = TEE_ERROR_GENERIC;
 	TEE_Result res2 = TEE_ERROR_GENERIC;
+	uint32_t auth_ms = 0;
+	uint32_t load_ms = 0;
+	TEE_Time t = { };
 
 	if (pt != exp_pt)
 		return TEE_ERROR_BAD_PARAMETERS;
@@ -1244,18 +1283,22 @@ static TEE_Result remoteproc_load_fw(uint32_t pt,
 		goto out;
 	}
 
+	TEE_GetSystemTime(&t);
 	res = remoteproc_verify_firmware(ctx, params[1].memref.buffer,
 					 params[1].memref.size);
 	if (res) {
 		EMSG("Can't Authenticate the firmware (res = %#"PRIx32")", res);
 		goto put_mems;
 	}
+	auth_ms = elapsed_ms(&t);
 
 	res = remoteproc_load_elf(ctx);
 	if (res)
 		goto put_mems;
+	load_ms = elapsed_ms(&t);
 
 	ctx->state = REMOTEPROC_LOADED;
+	remoteproc_report_load_time(ctx, auth_ms, load_ms);
 
 put_mems:
 	res2 = remoteproc_release_mems(ctx);